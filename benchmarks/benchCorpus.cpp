@@ -0,0 +1,422 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "benchCorpus.hpp"
+
+#include <sstream>
+
+
+namespace {
+
+
+// Small linear congruential generator: std::rand() and the standard
+// distributions may give different sequences on different platforms
+class randomGenerator {
+
+public:
+
+	randomGenerator(const unsigned int seed)
+		: m_state(seed * 2654435761u + 1) {
+
+	}
+
+	unsigned int next() {
+
+		m_state = m_state * 1664525u + 1013904223u;
+		return m_state >> 8;
+	}
+
+	unsigned int next(const unsigned int max) {
+
+		return next() % max;
+	}
+
+private:
+
+	unsigned int m_state;
+};
+
+
+const char* const WORDS[] = {
+	"lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+	"elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore",
+	"et", "dolore", "magna", "aliqua", "enim", "ad", "minim", "veniam",
+	"quis", "nostrud", "exercitation", "ullamco", "laboris", "nisi",
+	"aliquip", "ex", "ea", "commodo", "consequat"
+};
+
+const char* const NON_ASCII_WORDS[] = {
+	"caf\xe9", "na\xefve", "r\xe9sum\xe9", "d\xe9j\xe0", "vu", "\xfc" "ber",
+	"Stra\xdf" "e", "se\xf1or", "fa\xe7" "ade", "co\xf6perate"
+};
+
+const char* const NAMES[] = {
+	"Alice", "Bob", "Carol", "Dave", "Eve", "Frank", "Grace", "Heidi"
+};
+
+
+const std::string randomWord(randomGenerator& rnd, const bool nonASCII) {
+
+	if (nonASCII && rnd.next(4) == 0) {
+		return NON_ASCII_WORDS[rnd.next(sizeof(NON_ASCII_WORDS) / sizeof(NON_ASCII_WORDS[0]))];
+	}
+
+	return WORDS[rnd.next(sizeof(WORDS) / sizeof(WORDS[0]))];
+}
+
+
+const std::string randomAddress(randomGenerator& rnd) {
+
+	std::ostringstream oss;
+
+	const char* name = NAMES[rnd.next(sizeof(NAMES) / sizeof(NAMES[0]))];
+
+	oss << name << " <";
+
+	for (const char* p = name ; *p ; ++p) {
+		oss << static_cast <char>(*p | 0x20);
+	}
+
+	oss << rnd.next(1000) << "@example.com>";
+
+	return oss.str();
+}
+
+
+const std::string randomSentence(randomGenerator& rnd, const size_t wordCount, const bool nonASCII) {
+
+	std::string s;
+
+	for (size_t i = 0 ; i < wordCount ; ++i) {
+
+		if (i != 0) {
+			s += ' ';
+		}
+
+		s += randomWord(rnd, nonASCII);
+	}
+
+	return s;
+}
+
+
+// Encode Latin-1 text as a RFC-2047 "Q" encoded word
+const std::string encodedWord(const std::string& text) {
+
+	static const char hex[] = "0123456789ABCDEF";
+
+	std::string s = "=?iso-8859-1?Q?";
+
+	for (std::string::const_iterator it = text.begin() ; it != text.end() ; ++it) {
+
+		const unsigned char c = static_cast <unsigned char>(*it);
+
+		if (c == ' ') {
+			s += '_';
+		} else if (c >= 128 || c == '=' || c == '?' || c == '_') {
+			s += '=';
+			s += hex[c >> 4];
+			s += hex[c & 0xf];
+		} else {
+			s += static_cast <char>(c);
+		}
+	}
+
+	s += "?=";
+
+	return s;
+}
+
+
+const std::string base64(const std::string& data) {
+
+	static const char alphabet[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	std::string s;
+	s.reserve(data.length() * 4 / 3 + data.length() / 38 + 4);
+
+	size_t lineLength = 0;
+
+	for (size_t i = 0 ; i < data.length() ; i += 3) {
+
+		const size_t n = data.length() - i;
+
+		const unsigned int b0 = static_cast <unsigned char>(data[i]);
+		const unsigned int b1 = n > 1 ? static_cast <unsigned char>(data[i + 1]) : 0;
+		const unsigned int b2 = n > 2 ? static_cast <unsigned char>(data[i + 2]) : 0;
+
+		s += alphabet[b0 >> 2];
+		s += alphabet[((b0 & 0x03) << 4) | (b1 >> 4)];
+		s += n > 1 ? alphabet[((b1 & 0x0f) << 2) | (b2 >> 6)] : '=';
+		s += n > 2 ? alphabet[b2 & 0x3f] : '=';
+
+		if ((lineLength += 4) >= 76) {
+			s += "\r\n";
+			lineLength = 0;
+		}
+	}
+
+	if (lineLength != 0) {
+		s += "\r\n";
+	}
+
+	return s;
+}
+
+
+void writeCommonHeaders(std::ostringstream& oss, randomGenerator& rnd, const unsigned int seed) {
+
+	oss << "Received: from mx" << rnd.next(100) << ".example.com (mx.example.com [192.0.2."
+	    << rnd.next(256) << "])\r\n\tby mail.example.org with ESMTPS id " << rnd.next()
+	    << "\r\n\tfor <someone@example.org>; Mon, 5 Feb 2024 10:"
+	    << (10 + rnd.next(50)) << ":00 +0100\r\n";
+	oss << "Date: Mon, 5 Feb 2024 10:" << (10 + rnd.next(50)) << ":00 +0100\r\n";
+	oss << "From: " << randomAddress(rnd) << "\r\n";
+	oss << "To: " << randomAddress(rnd) << ", " << randomAddress(rnd) << "\r\n";
+	oss << "Cc: " << randomAddress(rnd) << "\r\n";
+	oss << "Message-Id: <" << seed << "." << rnd.next() << "@example.com>\r\n";
+	oss << "Subject: " << randomSentence(rnd, 6, false) << "\r\n";
+	oss << "MIME-Version: 1.0\r\n";
+}
+
+
+const std::string generateMessage(
+	const benchCorpus::MessageType type,
+	randomGenerator& rnd,
+	const unsigned int seed,
+	const int depth
+) {
+
+	std::ostringstream oss;
+
+	switch (type) {
+
+		case benchCorpus::PLAIN:
+		default:
+
+			writeCommonHeaders(oss, rnd, seed);
+
+			oss << "Content-Type: text/plain; charset=us-ascii; format=flowed\r\n"
+			    << "Content-Transfer-Encoding: 7bit\r\n"
+			    << "\r\n"
+			    << benchCorpus::generateText(4096, rnd.next());
+
+			break;
+
+		case benchCorpus::ALTERNATIVE: {
+
+			const std::string text = benchCorpus::generateText(4096, rnd.next());
+
+			writeCommonHeaders(oss, rnd, seed);
+
+			oss << "Content-Type: multipart/alternative; boundary=\"=_alt_" << seed << "\"\r\n"
+			    << "\r\n"
+			    << "This is a multi-part message in MIME format.\r\n"
+			    << "\r\n"
+			    << "--=_alt_" << seed << "\r\n"
+			    << "Content-Type: text/plain; charset=us-ascii\r\n"
+			    << "Content-Transfer-Encoding: quoted-printable\r\n"
+			    << "\r\n"
+			    << text
+			    << "\r\n"
+			    << "--=_alt_" << seed << "\r\n"
+			    << "Content-Type: text/html; charset=us-ascii\r\n"
+			    << "Content-Transfer-Encoding: quoted-printable\r\n"
+			    << "\r\n"
+			    << "<html><body><p>\r\n" << text << "</p></body></html>\r\n"
+			    << "\r\n"
+			    << "--=_alt_" << seed << "--\r\n";
+
+			break;
+		}
+		case benchCorpus::NESTED_RFC822: {
+
+			writeCommonHeaders(oss, rnd, seed);
+
+			oss << "Content-Type: multipart/mixed; boundary=\"=_mixed_" << depth << "_" << seed << "\"\r\n"
+			    << "\r\n"
+			    << "--=_mixed_" << depth << "_" << seed << "\r\n"
+			    << "Content-Type: text/plain; charset=us-ascii\r\n"
+			    << "\r\n"
+			    << benchCorpus::generateText(1024, rnd.next())
+			    << "\r\n";
+
+			for (int i = 0 ; i < 2 ; ++i) {
+
+				oss << "--=_mixed_" << depth << "_" << seed << "\r\n"
+				    << "Content-Type: message/rfc822\r\n"
+				    << "Content-Disposition: attachment\r\n"
+				    << "\r\n"
+				    << generateMessage(
+				           depth < 2 ? benchCorpus::NESTED_RFC822 : benchCorpus::ALTERNATIVE,
+				           rnd, seed + i + 1, depth + 1
+				       )
+				    << "\r\n";
+			}
+
+			oss << "--=_mixed_" << depth << "_" << seed << "--\r\n";
+
+			break;
+		}
+		case benchCorpus::BASE64_ATTACHMENT:
+
+			writeCommonHeaders(oss, rnd, seed);
+
+			oss << "Content-Type: multipart/mixed; boundary=\"=_att_" << seed << "\"\r\n"
+			    << "\r\n"
+			    << "--=_att_" << seed << "\r\n"
+			    << "Content-Type: text/plain; charset=us-ascii\r\n"
+			    << "\r\n"
+			    << benchCorpus::generateText(1024, rnd.next())
+			    << "\r\n"
+			    << "--=_att_" << seed << "\r\n"
+			    << "Content-Type: application/octet-stream; name=\"data.bin\"\r\n"
+			    << "Content-Disposition: attachment; filename=\"data.bin\"\r\n"
+			    << "Content-Transfer-Encoding: base64\r\n"
+			    << "\r\n"
+			    << base64(benchCorpus::generateBinary(4 * 1024 * 1024, rnd.next()))
+			    << "\r\n"
+			    << "--=_att_" << seed << "--\r\n";
+
+			break;
+
+		case benchCorpus::MANY_HEADERS:
+
+			for (int i = 0 ; i < 480 ; ++i) {
+
+				oss << "Received: from relay" << i << ".example.com (relay" << i
+				    << ".example.com [198.51.100." << rnd.next(256) << "])\r\n"
+				    << "\tby relay" << (i + 1) << ".example.com with SMTP id " << rnd.next()
+				    << ";\r\n\tMon, 5 Feb 2024 10:" << (10 + rnd.next(50)) << ":00 +0100\r\n";
+			}
+
+			for (int i = 0 ; i < 12 ; ++i) {
+				oss << "X-Custom-Header-" << i << ": " << randomSentence(rnd, 4, false) << "\r\n";
+			}
+
+			writeCommonHeaders(oss, rnd, seed);
+
+			oss << "Content-Type: text/plain; charset=us-ascii\r\n"
+			    << "\r\n"
+			    << benchCorpus::generateText(512, rnd.next());
+
+			break;
+
+		case benchCorpus::NON_ASCII_HEADERS:
+
+			oss << "Date: Mon, 5 Feb 2024 10:00:00 +0100\r\n"
+			    << "From: " << encodedWord(randomSentence(rnd, 2, true)) << " <from@example.com>\r\n"
+			    << "To: " << encodedWord(randomSentence(rnd, 2, true)) << " <to@example.com>, "
+			    << encodedWord(randomSentence(rnd, 2, true)) << " <to2@example.com>\r\n"
+			    << "Subject: " << encodedWord(randomSentence(rnd, 5, true)) << "\r\n"
+			    << " " << encodedWord(randomSentence(rnd, 5, true)) << "\r\n"
+			    << "Organization: " << encodedWord(randomSentence(rnd, 3, true)) << "\r\n"
+			    << "MIME-Version: 1.0\r\n"
+			    << "Content-Type: text/plain; charset=iso-8859-1\r\n"
+			    << "Content-Transfer-Encoding: 8bit\r\n"
+			    << "\r\n"
+			    << benchCorpus::generateText(2048, rnd.next(), true);
+
+			break;
+	}
+
+	return oss.str();
+}
+
+
+} // namespace
+
+
+// static
+const std::string benchCorpus::generate(const MessageType type, const unsigned int seed) {
+
+	randomGenerator rnd(seed);
+	return generateMessage(type, rnd, seed, 0);
+}
+
+
+// static
+const std::string benchCorpus::generateBinary(const size_t size, const unsigned int seed) {
+
+	randomGenerator rnd(seed);
+
+	std::string data(size, '\0');
+
+	for (size_t i = 0 ; i < size ; ++i) {
+		data[i] = static_cast <char>(rnd.next(256));
+	}
+
+	return data;
+}
+
+
+// static
+const std::string benchCorpus::generateText(const size_t size, const unsigned int seed, const bool nonASCII) {
+
+	randomGenerator rnd(seed);
+
+	std::string text;
+	text.reserve(size + 100);
+
+	size_t lineLength = 0;
+
+	while (text.length() < size) {
+
+		const std::string word = randomWord(rnd, nonASCII);
+
+		if (lineLength + word.length() >= 72) {
+			text += "\r\n";
+			lineLength = 0;
+		} else if (lineLength != 0) {
+			text += ' ';
+			++lineLength;
+		}
+
+		text += word;
+		lineLength += word.length();
+	}
+
+	text += "\r\n";
+
+	return text;
+}
+
+
+// static
+const char* benchCorpus::getTypeName(const MessageType type) {
+
+	switch (type) {
+
+		case PLAIN: return "plain";
+		case ALTERNATIVE: return "alternative";
+		case NESTED_RFC822: return "nested-rfc822";
+		case BASE64_ATTACHMENT: return "base64-attachment";
+		case MANY_HEADERS: return "500-headers";
+		case NON_ASCII_HEADERS: return "non-ascii-headers";
+		case MESSAGE_TYPE_COUNT: break;
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,85 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_BENCHMARKS_BENCHCORPUS_HPP_INCLUDED
+#define VMIME_BENCHMARKS_BENCHCORPUS_HPP_INCLUDED
+
+
+#include <string>
+
+
+/** Generates synthetic messages for the benchmarks. For a given type
+  * and seed, the generated message is always the same, so that the
+  * results of different runs can be compared.
+  */
+class benchCorpus {
+
+public:
+
+	enum MessageType {
+		PLAIN,                /**< Simple text/plain message. */
+		ALTERNATIVE,          /**< multipart/alternative with text and HTML. */
+		NESTED_RFC822,        /**< multipart/mixed with nested message/rfc822 parts. */
+		BASE64_ATTACHMENT,    /**< Message with a large base64 attachment. */
+		MANY_HEADERS,         /**< Message with 500 header fields. */
+		NON_ASCII_HEADERS,    /**< Headers with RFC-2047 encoded words. */
+
+		MESSAGE_TYPE_COUNT
+	};
+
+	/** Generate a message.
+	  *
+	  * @param type type of message to generate
+	  * @param seed seed for the pseudo-random generator
+	  * @return message data, with CRLF line endings
+	  */
+	static const std::string generate(const MessageType type, const unsigned int seed = 1);
+
+	/** Generate random binary data.
+	  *
+	  * @param size number of bytes to generate
+	  * @param seed seed for the pseudo-random generator
+	  * @return binary data
+	  */
+	static const std::string generateBinary(const size_t size, const unsigned int seed = 1);
+
+	/** Generate random text, made of words and lines.
+	  *
+	  * @param size approximate number of bytes to generate
+	  * @param seed seed for the pseudo-random generator
+	  * @param nonASCII whether to include Latin-1 accented characters
+	  * @return text data
+	  */
+	static const std::string generateText(const size_t size, const unsigned int seed = 1, const bool nonASCII = false);
+
+	/** Return the name of a message type.
+	  *
+	  * @param type message type
+	  * @return name of the message type
+	  */
+	static const char* getTypeName(const MessageType type);
+};
+
+
+#endif // VMIME_BENCHMARKS_BENCHCORPUS_HPP_INCLUDED
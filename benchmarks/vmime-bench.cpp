@@ -0,0 +1,376 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+//
+// Benchmarks for the parsing, generation and encoding hot paths.
+//
+// Usage: vmime-bench [--filter <text>] [--iterations <n>] [--time <seconds>]
+//
+// For each benchmark, reports the throughput, the number of memory
+// allocations per iteration and latency percentiles. The input data
+// is generated by benchCorpus, so results of different runs (and
+// different builds) can be compared.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "vmime/vmime.hpp"
+#include "vmime/platforms/posix/posixHandler.hpp"
+
+#include "benchCorpus.hpp"
+
+
+// Count memory allocations made by the whole process (including
+// the library), by replacing the global allocation functions
+static std::atomic <unsigned long> g_allocationCount(0);
+
+
+void* operator new(size_t size) {
+
+	++g_allocationCount;
+
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+
+	std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+
+	std::free(p);
+}
+
+
+struct benchOptions {
+
+	benchOptions()
+		: minIterations(10),
+		  minTime(1.0) {
+
+	}
+
+	std::string filter;
+	unsigned long minIterations;
+	double minTime;
+};
+
+
+struct benchResult {
+
+	std::string name;
+	unsigned long iterations;
+	double throughput;         // MB/s
+	double allocations;        // per iteration
+	double p50, p90, p99;      // microseconds
+};
+
+
+/** Run a function repeatedly, until both the minimum number of iterations
+  * and the minimum time have been reached.
+  *
+  * @param name name of the benchmark
+  * @param bytes number of bytes processed by one iteration
+  * @param func function to run
+  */
+static void runBenchmark(
+	const benchOptions& opts,
+	const std::string& name,
+	const size_t bytes,
+	const std::function <void ()>& func
+) {
+
+	if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) {
+		return;
+	}
+
+	typedef std::chrono::steady_clock clock;
+
+	// Warm up (caches, lazily-initialized singletons...)
+	func();
+
+	std::vector <double> latencies;
+	unsigned long allocations = 0;
+
+	const clock::time_point start = clock::now();
+	double elapsed = 0;
+
+	while (latencies.size() < opts.minIterations || elapsed < opts.minTime) {
+
+		const unsigned long allocationsBefore = g_allocationCount;
+		const clock::time_point before = clock::now();
+
+		func();
+
+		const clock::time_point after = clock::now();
+
+		allocations += g_allocationCount - allocationsBefore;
+		latencies.push_back(std::chrono::duration <double, std::micro>(after - before).count());
+
+		elapsed = std::chrono::duration <double>(after - start).count();
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	double total = 0;
+
+	for (size_t i = 0 ; i < latencies.size() ; ++i) {
+		total += latencies[i];
+	}
+
+	benchResult res;
+	res.name = name;
+	res.iterations = latencies.size();
+	res.throughput = (static_cast <double>(bytes) * latencies.size()) / total;  // bytes/us = MB/s
+	res.allocations = static_cast <double>(allocations) / latencies.size();
+	res.p50 = latencies[latencies.size() * 50 / 100];
+	res.p90 = latencies[latencies.size() * 90 / 100];
+	res.p99 = latencies[latencies.size() * 99 / 100];
+
+	std::printf(
+		"%-42s %8lu %10.2f %12.1f %10.1f %10.1f %10.1f\n",
+		res.name.c_str(), res.iterations, res.throughput,
+		res.allocations, res.p50, res.p90, res.p99
+	);
+
+	std::fflush(stdout);
+}
+
+
+static void benchMessages(const benchOptions& opts) {
+
+	for (int t = 0 ; t < benchCorpus::MESSAGE_TYPE_COUNT ; ++t) {
+
+		const benchCorpus::MessageType type = static_cast <benchCorpus::MessageType>(t);
+		const std::string typeName = benchCorpus::getTypeName(type);
+
+		const std::string data = benchCorpus::generate(type);
+
+		runBenchmark(opts, "parse/" + typeName, data.length(), [&data]() {
+
+			vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+			msg->parse(data);
+		});
+
+		runBenchmark(opts, "parse-arena/" + typeName, data.length(), [&data]() {
+
+			vmime::parsingContext ctx;
+			ctx.setMemoryArena(vmime::make_shared <vmime::utility::memoryArena>());
+
+			vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+			msg->parse(ctx, data);
+		});
+
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+		msg->parse(data);
+
+		runBenchmark(opts, "generate/" + typeName, data.length(), [&msg]() {
+
+			std::string out;
+			vmime::utility::outputStreamStringAdapter os(out);
+
+			msg->generate(os);
+		});
+
+		runBenchmark(opts, "getGeneratedSize/" + typeName, data.length(), [&msg]() {
+
+			msg->getGeneratedSize(vmime::generationContext::getDefaultContext());
+		});
+
+		runBenchmark(opts, "messageParser/" + typeName, data.length(), [&data]() {
+
+			vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+			msg->parse(data);
+
+			vmime::messageParser mp(msg);
+			mp.getAttachmentCount();
+			mp.getTextPartCount();
+		});
+	}
+}
+
+
+static void benchEncoder(
+	const benchOptions& opts,
+	const std::string& name,
+	const std::string& data
+) {
+
+	vmime::shared_ptr <vmime::utility::encoder::encoder> enc =
+		vmime::utility::encoder::encoderFactory::getInstance()->create(name);
+
+	runBenchmark(opts, "encode/" + name, data.length(), [&enc, &data]() {
+
+		vmime::utility::inputStreamStringAdapter in(data);
+
+		std::string out;
+		vmime::utility::outputStreamStringAdapter os(out);
+
+		enc->encode(in, os);
+	});
+
+	std::string encoded;
+
+	{
+		vmime::utility::inputStreamStringAdapter in(data);
+		vmime::utility::outputStreamStringAdapter os(encoded);
+
+		enc->encode(in, os);
+	}
+
+	runBenchmark(opts, "decode/" + name, data.length(), [&enc, &encoded]() {
+
+		vmime::utility::inputStreamStringAdapter in(encoded);
+
+		std::string out;
+		vmime::utility::outputStreamStringAdapter os(out);
+
+		enc->decode(in, os);
+	});
+}
+
+
+static void benchEncoders(const benchOptions& opts) {
+
+	benchEncoder(opts, "base64", benchCorpus::generateBinary(1024 * 1024));
+	benchEncoder(opts, "quoted-printable", benchCorpus::generateText(1024 * 1024, 1, true));
+}
+
+
+static void benchCharsetConverter(
+	const benchOptions& opts,
+	const std::string& name,
+	const vmime::charset& source,
+	const vmime::charset& dest,
+	const std::string& data
+) {
+
+	vmime::shared_ptr <vmime::charsetConverter> conv =
+		vmime::charsetConverter::create(source, dest);
+
+	runBenchmark(opts, "convert/" + name, data.length(), [&conv, &data]() {
+
+		std::string out;
+		conv->convert(data, out);
+	});
+}
+
+
+static void benchCharsetConverters(const benchOptions& opts) {
+
+	const std::string latin1 = benchCorpus::generateText(1024 * 1024, 1, true);
+
+	std::string utf8;
+	vmime::charset::convert(latin1, utf8, vmime::charsets::ISO8859_1, vmime::charsets::UTF_8);
+
+	benchCharsetConverter(opts, "iso-8859-1-to-utf-8", vmime::charsets::ISO8859_1, vmime::charsets::UTF_8, latin1);
+	benchCharsetConverter(opts, "utf-8-to-iso-8859-1", vmime::charsets::UTF_8, vmime::charsets::ISO8859_1, utf8);
+	benchCharsetConverter(opts, "utf-8-to-utf-8", vmime::charsets::UTF_8, vmime::charsets::UTF_8, utf8);
+}
+
+
+static void usage(const char* prog) {
+
+	std::cerr << "Usage: " << prog << " [--filter <text>] [--iterations <n>] [--time <seconds>]" << std::endl;
+}
+
+
+int main(int argc, char* argv[]) {
+
+	benchOptions opts;
+
+	for (int i = 1 ; i < argc ; ++i) {
+
+		const std::string arg = argv[i];
+
+		if (arg == "--filter" && i + 1 < argc) {
+			opts.filter = argv[++i];
+		} else if (arg == "--iterations" && i + 1 < argc) {
+			opts.minIterations = std::strtoul(argv[++i], NULL, 10);
+		} else if (arg == "--time" && i + 1 < argc) {
+			opts.minTime = std::strtod(argv[++i], NULL);
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (opts.minIterations == 0) {
+		opts.minIterations = 1;
+	}
+
+	try {
+
+		std::printf(
+			"%-42s %8s %10s %12s %10s %10s %10s\n",
+			"benchmark", "iter", "MB/s", "allocs/iter", "p50 (us)", "p90 (us)", "p99 (us)"
+		);
+
+		benchMessages(opts);
+		benchEncoders(opts);
+		benchCharsetConverters(opts);
+
+	} catch (vmime::exception& e) {
+
+		std::cerr << "vmime::exception: " << e.what() << std::endl;
+		return 1;
+
+	} catch (std::exception& e) {
+
+		std::cerr << "std::exception: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
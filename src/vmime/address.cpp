@@ -225,7 +225,7 @@ shared_ptr <address> address::parseNext(
 
 			if (allowGroup) {
 
-				parsedAddress = make_shared <mailboxGroup>();
+				parsedAddress = utility::makeShared <mailboxGroup>(ctx.getMemoryArena());
 
 			} else {  // group not allowed in group, ignore group and continue parsing
 
@@ -242,7 +242,7 @@ shared_ptr <address> address::parseNext(
 
 		} else {
 
-			parsedAddress = make_shared <mailbox>();
+			parsedAddress = utility::makeShared <mailbox>(ctx.getMemoryArena());
 		}
 
 		if (parsedAddress) {
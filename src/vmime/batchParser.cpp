@@ -0,0 +1,301 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/batchParser.hpp"
+#include "vmime/utility/memoryArena.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+
+namespace vmime {
+
+
+struct batchParser::batch {
+
+	batch(const size_t count_, std::vector <shared_ptr <message> >& messages_)
+		: count(count_),
+		  sharedBuffers(NULL),
+		  buffers(NULL),
+		  messages(messages_),
+		  useArena(false),
+		  next(0),
+		  remaining(count_),
+		  errorIndex(0) {
+
+	}
+
+	const size_t count;
+
+	// Input (only one of them is set)
+	const std::vector <shared_ptr <const string> >* sharedBuffers;
+	const std::vector <string>* buffers;
+
+	std::vector <shared_ptr <message> >& messages;
+
+	parsingContext ctx;
+	bool useArena;
+
+	// Index of the next message to parse
+	std::atomic <size_t> next;
+
+	// Guarded by batchParser::m_mutex
+	size_t remaining;
+	std::exception_ptr error;
+	size_t errorIndex;
+};
+
+
+batchParser::batchParser(const size_t threadCount)
+	: m_useArena(false),
+	  m_batchId(0),
+	  m_stop(false) {
+
+	startThreads(threadCount);
+}
+
+
+batchParser::batchParser(const parsingContext& ctx, const size_t threadCount)
+	: m_ctx(ctx),
+	  m_useArena(false),
+	  m_batchId(0),
+	  m_stop(false) {
+
+	m_ctx.setMemoryArena(null);
+
+	startThreads(threadCount);
+}
+
+
+batchParser::~batchParser() {
+
+	{
+		std::lock_guard <std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_workCond.notify_all();
+
+	for (size_t i = 0 ; i < m_threads.size() ; ++i) {
+		m_threads[i].join();
+	}
+}
+
+
+void batchParser::startThreads(const size_t threadCount) {
+
+	size_t count = threadCount;
+
+	if (count == 0) {
+		count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	m_threads.reserve(count);
+
+	for (size_t i = 0 ; i < count ; ++i) {
+		m_threads.push_back(std::thread(&batchParser::workerMain, this));
+	}
+}
+
+
+size_t batchParser::getThreadCount() const {
+
+	return m_threads.size();
+}
+
+
+parsingContext batchParser::getParsingContext() const {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+	return m_ctx;
+}
+
+
+void batchParser::setParsingContext(const parsingContext& ctx) {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+
+	m_ctx = ctx;
+	m_ctx.setMemoryArena(null);
+}
+
+
+bool batchParser::getUseMemoryArena() const {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+	return m_useArena;
+}
+
+
+void batchParser::setUseMemoryArena(const bool useArena) {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+	m_useArena = useArena;
+}
+
+
+std::vector <shared_ptr <message> > batchParser::parse(
+	const std::vector <shared_ptr <const string> >& buffers
+) {
+
+	std::vector <shared_ptr <message> > messages(buffers.size());
+
+	shared_ptr <batch> b = make_shared <batch>(buffers.size(), messages);
+	b->sharedBuffers = &buffers;
+
+	runBatch(b);
+
+	return messages;
+}
+
+
+std::vector <shared_ptr <message> > batchParser::parse(const std::vector <string>& buffers) {
+
+	std::vector <shared_ptr <message> > messages(buffers.size());
+
+	shared_ptr <batch> b = make_shared <batch>(buffers.size(), messages);
+	b->buffers = &buffers;
+
+	runBatch(b);
+
+	return messages;
+}
+
+
+void batchParser::runBatch(const shared_ptr <batch>& b) {
+
+	if (b->count == 0) {
+		return;
+	}
+
+	std::lock_guard <std::mutex> batchLock(m_batchMutex);
+	std::unique_lock <std::mutex> lock(m_mutex);
+
+	b->ctx = m_ctx;
+	b->useArena = m_useArena;
+
+	m_batch = b;
+	++m_batchId;
+
+	m_workCond.notify_all();
+
+	while (b->remaining != 0) {
+		m_doneCond.wait(lock);
+	}
+
+	m_batch = null;
+
+	lock.unlock();
+
+	if (b->error) {
+		std::rethrow_exception(b->error);
+	}
+}
+
+
+// static
+void batchParser::parseMessage(batch& b, const size_t index) {
+
+	parsingContext ctx(b.ctx);
+
+	if (b.useArena) {
+		ctx.setMemoryArena(make_shared <utility::memoryArena>());
+	}
+
+	shared_ptr <message> msg = make_shared <message>();
+
+	if (b.sharedBuffers) {
+		msg->parse(ctx, (*b.sharedBuffers)[index]);
+	} else {
+		msg->parse(ctx, (*b.buffers)[index]);
+	}
+
+	b.messages[index] = msg;
+}
+
+
+void batchParser::workerMain() {
+
+	unsigned long lastBatchId = 0;
+
+	std::unique_lock <std::mutex> lock(m_mutex);
+
+	for (;;) {
+
+		while (!m_stop && (!m_batch || m_batchId == lastBatchId)) {
+			m_workCond.wait(lock);
+		}
+
+		if (m_stop) {
+			break;
+		}
+
+		lastBatchId = m_batchId;
+
+		shared_ptr <batch> b = m_batch;
+
+		lock.unlock();
+
+		size_t processed = 0;
+		std::exception_ptr error;
+		size_t errorIndex = 0;
+
+		// Take messages one by one, so that threads which parse small
+		// messages are not waiting for a thread which got bigger ones
+		for (size_t index = b->next++ ; index < b->count ; index = b->next++) {
+
+			try {
+
+				parseMessage(*b, index);
+
+			} catch (...) {
+
+				if (!error) {
+					error = std::current_exception();
+					errorIndex = index;
+				}
+			}
+
+			++processed;
+		}
+
+		lock.lock();
+
+		// Report the error of the first message which failed
+		if (error && (!b->error || errorIndex < b->errorIndex)) {
+			b->error = error;
+			b->errorIndex = errorIndex;
+		}
+
+		b->remaining -= processed;
+
+		if (b->remaining == 0) {
+			m_doneCond.notify_all();
+		}
+	}
+}
+
+
+} // vmime
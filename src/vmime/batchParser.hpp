@@ -0,0 +1,173 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_BATCHPARSER_HPP_INCLUDED
+#define VMIME_BATCHPARSER_HPP_INCLUDED
+
+
+#include "vmime/message.hpp"
+#include "vmime/parsingContext.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace vmime {
+
+
+/** Parses batches of messages on a pool of worker threads.
+  *
+  * The worker threads are started when the parser is created, and are
+  * reused for each batch. Each message is parsed with its own copy of
+  * the parsing context of the batch parser, so that the state recorded
+  * while parsing (eg. header recovery) is not shared between threads.
+  *
+  * The registries used while parsing (header field factory, encoder
+  * factory, charset converter pool) can be read concurrently. Messages
+  * returned by a batch are not shared with the worker threads, and can
+  * be used by any thread once parse() has returned.
+  *
+  * A batch parser can be used from several threads, but batches are
+  * parsed one at a time.
+  */
+class VMIME_EXPORT batchParser : public object {
+
+public:
+
+	/** Construct a new batch parser and start its worker threads.
+	  *
+	  * @param threadCount number of worker threads, or 0 to start
+	  * one thread per hardware thread
+	  */
+	explicit batchParser(const size_t threadCount = 0);
+
+	/** Construct a new batch parser and start its worker threads.
+	  *
+	  * @param ctx parsing context used as a template for parsing
+	  * each message
+	  * @param threadCount number of worker threads, or 0 to start
+	  * one thread per hardware thread
+	  */
+	batchParser(const parsingContext& ctx, const size_t threadCount = 0);
+
+	/** Stop the worker threads.
+	  */
+	~batchParser();
+
+	/** Return the number of worker threads.
+	  *
+	  * @return number of worker threads
+	  */
+	size_t getThreadCount() const;
+
+	/** Return the parsing context used as a template for parsing
+	  * each message.
+	  *
+	  * @return parsing context
+	  */
+	parsingContext getParsingContext() const;
+
+	/** Set the parsing context used as a template for parsing each
+	  * message. Its memory arena is never used, as arenas are not
+	  * thread-safe: use setUseMemoryArena() instead.
+	  *
+	  * @param ctx parsing context
+	  */
+	void setParsingContext(const parsingContext& ctx);
+
+	/** Return whether each message is allocated from its own memory arena.
+	  *
+	  * @return true if messages are allocated from memory arenas,
+	  * false otherwise
+	  */
+	bool getUseMemoryArena() const;
+
+	/** Enable or disable allocating each message from its own memory
+	  * arena (see parsingContext::setMemoryArena()). Disabled by default.
+	  *
+	  * @param useArena true to allocate each message from its own arena
+	  */
+	void setUseMemoryArena(const bool useArena);
+
+	/** Parse a batch of messages. The buffers are shared with the
+	  * messages, they are not copied.
+	  *
+	  * If parsing one of the messages throws an exception, the exception
+	  * is thrown again once the whole batch has been processed.
+	  *
+	  * @param buffers input buffers, one for each message
+	  * @return parsed messages, in the same order as the input buffers
+	  */
+	std::vector <shared_ptr <message> > parse(
+		const std::vector <shared_ptr <const string> >& buffers
+	);
+
+	/** Parse a batch of messages.
+	  *
+	  * If parsing one of the messages throws an exception, the exception
+	  * is thrown again once the whole batch has been processed.
+	  *
+	  * @param buffers input buffers, one for each message
+	  * @return parsed messages, in the same order as the input buffers
+	  */
+	std::vector <shared_ptr <message> > parse(const std::vector <string>& buffers);
+
+private:
+
+	batchParser(const batchParser&);
+	batchParser& operator=(const batchParser&);
+
+	struct batch;
+
+	void startThreads(const size_t threadCount);
+	void runBatch(const shared_ptr <batch>& b);
+	void workerMain();
+
+	static void parseMessage(batch& b, const size_t index);
+
+
+	parsingContext m_ctx;
+	bool m_useArena;
+
+	std::vector <std::thread> m_threads;
+
+	shared_ptr <batch> m_batch;
+	unsigned long m_batchId;
+	bool m_stop;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_workCond;
+	std::condition_variable m_doneCond;
+
+	// Only one batch is parsed at a time
+	std::mutex m_batchMutex;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_BATCHPARSER_HPP_INCLUDED
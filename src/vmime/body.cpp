@@ -25,12 +25,14 @@
 #include "vmime/body.hpp"
 
 #include "vmime/contentTypeField.hpp"
+#include "vmime/encodedContentsCache.hpp"
 #include "vmime/text.hpp"
 
 #include "vmime/utility/random.hpp"
 
 #include "vmime/utility/seekableInputStreamRegionAdapter.hpp"
 #include "vmime/utility/outputStreamAdapter.hpp"
+#include "vmime/utility/outputStreamStringAdapter.hpp"
 
 #include "vmime/parserHelpers.hpp"
 
@@ -69,30 +71,23 @@ size_t body::findNextBoundaryPosition(
 	size_t* boundaryEnd
 ) {
 
+	// Boundary should be at the beginning of a line, and should start
+	// with "--": search for "[LF]--boundary" directly, so that the
+	// scanner does not stop on every occurrence of the boundary itself
+	const string token = "\n--" + boundary;
+
 	size_t pos = position;
 
 	for (; pos != npos && pos < end; ++pos) {
 
-		pos = parser->findNext(boundary, pos);
+		const size_t tokenPos = parser->findNext(token, pos >= 3 ? pos - 3 : 0);
 
-		if (pos == npos) {
+		if (tokenPos == npos) {
+			pos = npos;
 			break;  // not found
 		}
 
-		if (pos == 0) {
-			// Boundary is a prefix of another, continue the search (same for the other "continue"s)
-			continue;
-		}
-
-		// Ensure the bytes before boundary are "[LF]--": boundary should be
-		// at the beginning of a line, and should start with "--"
-		if (pos < 3) {
-			continue;
-		}
-		parser->seek(pos - 3);
-		if (!parser->matchBytes("\n--", 3)) {
-			continue;
-		}
+		pos = tokenPos + 3;
 
 		parser->seek(pos + boundary.length());
 
@@ -139,6 +134,10 @@ void body::parseImpl(
 
 		setParsedBounds(position, end);
 
+		if (ctx.getRetainParsedData()) {
+			retainParsedData(parser);
+		}
+
 		if (newPosition) {
 			*newPosition = end;
 		}
@@ -243,6 +242,13 @@ void body::parseImpl(
 	// This is a multi-part body
 	if (isMultipart && !boundary.empty()) {
 
+		// Context shared by all parts whose parsing is deferred
+		shared_ptr <parsingContext> lazyCtx;
+
+		if (ctx.getLazyBodyPartParsing()) {
+			lazyCtx = createDeferredParsingContext(ctx);
+		}
+
 		size_t partStart = position;
 		size_t pos = position;
 
@@ -269,8 +275,10 @@ void body::parseImpl(
 			// line appears to end with white space, the white
 			// space must be presumed to have been added by a
 			// gateway, and must be deleted."""
+			static const byte_t spaceOrTab[] = { ' ', '\t' };
+
 			parser->seek(boundaryEnd);
-			boundaryEnd += parser->skipIf(parserHelpers::isSpaceOrTab, end);
+			boundaryEnd += parser->skipAnyOf(spaceOrTab, 2, end);
 
 			// End of boundary line
 			if (boundaryEnd + 1 < end && parser->matchBytes("\r\n", 2)) {
@@ -316,7 +324,13 @@ void body::parseImpl(
 					std::swap(partStart, partEnd);
 				}
 
-				part->parse(ctx, parser, partStart, partEnd, NULL);
+				// Each deferred part reads through its own adapter, so
+				// that sibling parts can be parsed from several threads
+				if (lazyCtx) {
+					part->deferParsing(lazyCtx, parser->fork(), partStart, partEnd);
+				} else {
+					part->parse(ctx, parser, partStart, partEnd, NULL);
+				}
 
 				m_parts.push_back(part);
 			}
@@ -336,10 +350,10 @@ void body::parseImpl(
 
 			shared_ptr <bodyPart> part = m_part->createChildPart();
 
-			try {
+			if (lazyCtx) {
+				part->deferParsing(lazyCtx, parser->fork(), partStart, end);
+			} else {
 				part->parse(ctx, parser, partStart, end);
-			} catch (std::exception&) {
-				throw;
 			}
 
 			m_parts.push_back(part);
@@ -388,6 +402,10 @@ void body::parseImpl(
 
 	setParsedBounds(position, end);
 
+	if (ctx.getRetainParsedData()) {
+		retainParsedData(parser);
+	}
+
 	if (newPosition) {
 		*newPosition = end;
 	}
@@ -437,6 +455,13 @@ void body::generateImpl(
 	size_t* newLinePos
 ) const {
 
+	// Unmodified since parsed: copy the original data
+	if (isParsedDataReusable()) {
+
+		copyParsedData(os, newLinePos);
+		return;
+	}
+
 	// MIME-Multipart
 	if (getPartCount() != 0) {
 
@@ -515,17 +540,54 @@ void body::generateImpl(
 	// Simple body
 	} else {
 
-		// Generate the contents
-		shared_ptr <contentHandler> contents = m_contents->clone();
-		contents->setContentTypeHint(getContentType());
+		const encoding enc = getEncoding();
+		const mediaType type = getContentType();
+
+		shared_ptr <encodedContentsCache> cache = ctx.getEncodedContentsCache();
+		shared_ptr <const string> encoded;
+
+		// Contents may have already been encoded with the same parameters
+		if (cache) {
+			encoded = cache->find(m_contents, enc, ctx.getMaxLineLength(), type);
+		}
+
+		if (encoded) {
+
+			os.write(encoded->data(), encoded->length());
+
+		} else {
+
+			// Generate the contents
+			shared_ptr <contentHandler> contents = m_contents->clone();
+			contents->setContentTypeHint(type);
+
+			if (cache) {
+
+				shared_ptr <string> buffer = make_shared <string>();
+				utility::outputStreamStringAdapter bufferStream(*buffer);
 
-		contents->generate(os, getEncoding(), ctx.getMaxLineLength());
+				contents->generate(bufferStream, enc, ctx.getMaxLineLength());
+				bufferStream.flush();
+
+				cache->store(m_contents, enc, ctx.getMaxLineLength(), type, buffer);
+
+				os.write(buffer->data(), buffer->length());
+
+			} else {
+
+				contents->generate(os, enc, ctx.getMaxLineLength());
+			}
+		}
 	}
 }
 
 
 size_t body::getGeneratedSize(const generationContext& ctx) {
 
+	if (isParsedDataReusable()) {
+		return getParsedLength();
+	}
+
 	// MIME-Multipart
 	if (getPartCount() != 0) {
 
@@ -573,6 +635,19 @@ size_t body::getGeneratedSize(const generationContext& ctx) {
 	// Simple body
 	} else {
 
+		// Exact size is known if contents have already been encoded
+		shared_ptr <encodedContentsCache> cache = ctx.getEncodedContentsCache();
+
+		if (cache) {
+
+			shared_ptr <const string> encoded =
+				cache->find(m_contents, getEncoding(), ctx.getMaxLineLength(), getContentType());
+
+			if (encoded) {
+				return encoded->length();
+			}
+		}
+
 		if (getEncoding() == m_contents->getEncoding()) {
 
 			// No re-encoding has to be performed
@@ -829,6 +904,11 @@ void body::copyFrom(const component& other) {
 
 		m_parts.push_back(part);
 	}
+
+	m_parsedContentTypeField = bdy.m_parsedContentTypeField;
+	m_parsedContentTransferEncodingField = bdy.m_parsedContentTransferEncodingField;
+
+	copyParsedDataFrom(bdy);
 }
 
 
@@ -848,6 +928,8 @@ const string& body::getPrologText() const {
 void body::setPrologText(const string& prologText) {
 
 	m_prologText = prologText;
+
+	discardParsedData();
 }
 
 
@@ -860,6 +942,8 @@ const string& body::getEpilogText() const {
 void body::setEpilogText(const string& epilogText) {
 
 	m_epilogText = epilogText;
+
+	discardParsedData();
 }
 
 
@@ -872,6 +956,8 @@ const shared_ptr <const contentHandler> body::getContents() const {
 void body::setContents(const shared_ptr <const contentHandler>& contents) {
 
 	m_contents = contents;
+
+	discardParsedData();
 }
 
 
@@ -882,6 +968,8 @@ void body::setContents(
 
 	m_contents = contents;
 
+	discardParsedData();
+
 	setContentType(type);
 }
 
@@ -894,6 +982,8 @@ void body::setContents(
 
 	m_contents = contents;
 
+	discardParsedData();
+
 	setContentType(type, chset);
 }
 
@@ -907,6 +997,8 @@ void body::setContents(
 
 	m_contents = contents;
 
+	discardParsedData();
+
 	setContentType(type, chset);
 	setEncoding(enc);
 }
@@ -971,6 +1063,8 @@ void body::appendPart(const shared_ptr <bodyPart>& part) {
 	initNewPart(part);
 
 	m_parts.push_back(part);
+
+	discardParsedData();
 }
 
 
@@ -990,6 +1084,8 @@ void body::insertPartBefore(
 	}
 
 	m_parts.insert(it, part);
+
+	discardParsedData();
 }
 
 
@@ -1001,6 +1097,8 @@ void body::insertPartBefore(
 	initNewPart(part);
 
 	m_parts.insert(m_parts.begin() + pos, part);
+
+	discardParsedData();
 }
 
 
@@ -1020,6 +1118,8 @@ void body::insertPartAfter(
 	}
 
 	m_parts.insert(it + 1, part);
+
+	discardParsedData();
 }
 
 
@@ -1028,6 +1128,8 @@ void body::insertPartAfter(const size_t pos, const shared_ptr <bodyPart>& part)
 	initNewPart(part);
 
 	m_parts.insert(m_parts.begin() + pos + 1, part);
+
+	discardParsedData();
 }
 
 
@@ -1042,18 +1144,24 @@ void body::removePart(const shared_ptr <bodyPart>& part) {
 	}
 
 	m_parts.erase(it);
+
+	discardParsedData();
 }
 
 
 void body::removePart(const size_t pos) {
 
 	m_parts.erase(m_parts.begin() + pos);
+
+	discardParsedData();
 }
 
 
 void body::removeAllParts() {
 
 	m_parts.clear();
+
+	discardParsedData();
 }
 
 
@@ -1103,6 +1211,75 @@ const std::vector <shared_ptr <bodyPart> > body::getPartList() {
 }
 
 
+bool body::isParsedDataReusable() const {
+
+	if (!hasParsedData()) {
+		return false;
+	}
+
+	// Generated data also depends on the "Content-Type" (boundary) and
+	// "Content-Transfer-Encoding" fields of the parent part: they must
+	// be unmodified copies of the ones present when the body was parsed
+	if (m_part) {
+
+		shared_ptr <const header> hdr = m_part->getHeader();
+
+		const shared_ptr <const headerField> ctf = hdr->findField(fields::CONTENT_TYPE);
+		const shared_ptr <const headerField> cef = hdr->findField(fields::CONTENT_TRANSFER_ENCODING);
+
+		if (!isSameParsedField(m_parsedContentTypeField, ctf) ||
+		    !isSameParsedField(m_parsedContentTransferEncodingField, cef)) {
+
+			return false;
+		}
+	}
+
+	for (std::vector <shared_ptr <bodyPart> >::const_iterator it = m_parts.begin() ;
+	     it != m_parts.end() ; ++it) {
+
+		if (!(*it)->isParsedDataReusable()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// static
+bool body::isSameParsedField(
+	const shared_ptr <const headerField>& parsedField,
+	const shared_ptr <const headerField>& field
+) {
+
+	if (!parsedField || !field) {
+		return !parsedField && !field;
+	}
+
+	// The field may have been copied (eg. if the header has been cloned)
+	return field->isParsedDataReusable() && haveSameParsedData(*field, *parsedField);
+}
+
+
+void body::retainParsedData(const shared_ptr <utility::parserInputStreamAdapter>& source) {
+
+	component::retainParsedData(source);
+
+	if (m_part && source) {
+
+		shared_ptr <const header> hdr = m_part->getHeader();
+
+		m_parsedContentTypeField = hdr->findField(fields::CONTENT_TYPE);
+		m_parsedContentTransferEncodingField = hdr->findField(fields::CONTENT_TRANSFER_ENCODING);
+
+	} else {
+
+		m_parsedContentTypeField = null;
+		m_parsedContentTransferEncodingField = null;
+	}
+}
+
+
 const std::vector <shared_ptr <component> > body::getChildComponents() {
 
 	std::vector <shared_ptr <component> > list;
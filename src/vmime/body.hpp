@@ -297,6 +297,8 @@ public:
 
 	size_t getGeneratedSize(const generationContext& ctx);
 
+	bool isParsedDataReusable() const;
+
 private:
 
 	text getActualPrologText(const generationContext& ctx) const;
@@ -315,6 +317,10 @@ private:
 
 	std::vector <shared_ptr <bodyPart> > m_parts;
 
+	// Fields of the parent part the parsed data depends on
+	shared_ptr <const headerField> m_parsedContentTypeField;
+	shared_ptr <const headerField> m_parsedContentTransferEncodingField;
+
 	bool isRootPart() const;
 
 	void initNewPart(const shared_ptr <bodyPart>& part);
@@ -357,6 +363,13 @@ protected:
 		const size_t curLinePos = 0,
 		size_t* newLinePos = NULL
 	) const;
+
+	void retainParsedData(const shared_ptr <utility::parserInputStreamAdapter>& source);
+
+	static bool isSameParsedField(
+		const shared_ptr <const headerField>& parsedField,
+		const shared_ptr <const headerField>& field
+	);
 };
 
 
@@ -30,7 +30,10 @@ namespace vmime {
 bodyPart::bodyPart()
 	: m_header(make_shared <header>()),
 	  m_body(make_shared <body>()),
-	  m_parent() {
+	  m_parent(),
+	  m_deferredPending(false),
+	  m_deferredStart(0),
+	  m_deferredEnd(0) {
 
 	m_body->setParentPart(this);
 }
@@ -44,6 +47,16 @@ void bodyPart::parseImpl(
 	size_t* newPosition
 ) {
 
+	// Not reached while the part is being parsed from parseDeferred(),
+	// as the parser has already been released at this point
+	if (m_deferredParser) {
+
+		m_deferredParser = null;
+		m_deferredCtx = null;
+
+		m_deferredPending = false;
+	}
+
 	// Parse the headers
 	size_t pos = position;
 	m_header->parse(ctx, parser, pos, end, &pos);
@@ -53,6 +66,10 @@ void bodyPart::parseImpl(
 
 	setParsedBounds(position, end);
 
+	if (ctx.getRetainParsedData()) {
+		retainParsedData(parser);
+	}
+
 	if (newPosition) {
 		*newPosition = end;
 	}
@@ -66,6 +83,15 @@ void bodyPart::generateImpl(
 	size_t* newLinePos
 ) const {
 
+	// Unmodified since parsed: copy the original data
+	if (isParsedDataReusable()) {
+
+		copyParsedData(os, newLinePos);
+		return;
+	}
+
+	parseDeferred();
+
 	m_header->generate(ctx, os);
 
 	os << CRLF;
@@ -80,12 +106,20 @@ void bodyPart::generateImpl(
 
 size_t bodyPart::getGeneratedSize(const generationContext& ctx) {
 
+	if (isParsedDataReusable()) {
+		return getParsedLength();
+	}
+
+	parseDeferred();
+
 	return m_header->getGeneratedSize(ctx) + 2 /* CRLF */ + m_body->getGeneratedSize(ctx);
 }
 
 
 shared_ptr <component> bodyPart::clone() const {
 
+	parseDeferred();
+
 	shared_ptr <bodyPart> p = make_shared <bodyPart>();
 
 	p->m_parent = NULL;
@@ -101,8 +135,16 @@ void bodyPart::copyFrom(const component& other) {
 
 	const bodyPart& bp = dynamic_cast <const bodyPart&>(other);
 
+	bp.parseDeferred();
+
+	m_deferredParser = null;
+	m_deferredCtx = null;
+	m_deferredPending = false;
+
 	m_header->copyFrom(*(bp.m_header));
 	m_body->copyFrom(*(bp.m_body));
+
+	copyParsedDataFrom(bp);
 }
 
 
@@ -115,41 +157,57 @@ bodyPart& bodyPart::operator=(const bodyPart& other) {
 
 const shared_ptr <const header> bodyPart::getHeader() const {
 
+	parseDeferred();
+
 	return m_header;
 }
 
 
 shared_ptr <header> bodyPart::getHeader() {
 
+	parseDeferred();
+
 	return m_header;
 }
 
 
 void bodyPart::setHeader(const shared_ptr <header>& h) {
 
+	parseDeferred();
+
 	m_header = h;
+
+	discardParsedData();
 }
 
 
 const shared_ptr <const body> bodyPart::getBody() const {
 
+	parseDeferred();
+
 	return m_body;
 }
 
 
 shared_ptr <body> bodyPart::getBody() {
 
+	parseDeferred();
+
 	return m_body;
 }
 
 
 void bodyPart::setBody(const shared_ptr <body>& b) {
 
+	parseDeferred();
+
 	bodyPart* oldPart = b->m_part;
 
 	m_body = b;
 	m_body->setParentPart(this);
 
+	discardParsedData();
+
 	// A body is associated to one and only one part
 	if (oldPart) {
 		oldPart->setBody(make_shared <body>());
@@ -184,8 +242,76 @@ void bodyPart::importChildPart(const shared_ptr <bodyPart>& part) {
 }
 
 
+void bodyPart::deferParsing(
+	const shared_ptr <parsingContext>& ctx,
+	const shared_ptr <utility::parserInputStreamAdapter>& parser,
+	const size_t position,
+	const size_t end
+) {
+
+	m_deferredParser = parser;
+	m_deferredCtx = ctx;
+	m_deferredStart = position;
+	m_deferredEnd = end;
+	m_deferredPending = true;
+
+	setParsedBounds(position, end);
+
+	if (ctx->getRetainParsedData()) {
+		retainParsedData(parser);
+	} else {
+		discardParsedData();
+	}
+}
+
+
+void bodyPart::parseDeferred() const {
+
+	if (!m_deferredPending.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	// The part may be accessed by several threads at the same time. While
+	// the lock is held, no other component is parsed: sub-parts are only
+	// located (their parsing is deferred, too), and the header fields
+	// needed to parse the body are not deferred
+	std::lock_guard <std::recursive_mutex> lock(m_deferredMutex);
+
+	if (!m_deferredParser) {
+		return;  // already parsed (or being parsed by this thread)
+	}
+
+	shared_ptr <utility::parserInputStreamAdapter> parser;
+	parser.swap(m_deferredParser);
+
+	shared_ptr <parsingContext> ctx;
+	ctx.swap(m_deferredCtx);
+
+	const_cast <bodyPart*>(this)->parseImpl(*ctx, parser, m_deferredStart, m_deferredEnd, NULL);
+
+	m_deferredPending.store(false, std::memory_order_release);
+}
+
+
+bool bodyPart::isParsedDataReusable() const {
+
+	if (!hasParsedData()) {
+		return false;
+	}
+
+	// Not parsed yet, so it cannot have been modified
+	if (m_deferredPending) {
+		return true;
+	}
+
+	return m_header->isParsedDataReusable() && m_body->isParsedDataReusable();
+}
+
+
 const std::vector <shared_ptr <component> > bodyPart::getChildComponents() {
 
+	parseDeferred();
+
 	std::vector <shared_ptr <component> > list;
 
 	list.push_back(m_header);
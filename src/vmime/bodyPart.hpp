@@ -31,6 +31,9 @@
 #include "vmime/header.hpp"
 #include "vmime/body.hpp"
 
+#include <atomic>
+#include <mutex>
+
 
 namespace vmime {
 
@@ -102,6 +105,8 @@ public:
 
 	size_t getGeneratedSize(const generationContext& ctx);
 
+	bool isParsedDataReusable() const;
+
 private:
 
 	shared_ptr <header> m_header;
@@ -111,6 +116,36 @@ private:
 	// have been allocated on the stack
 	bodyPart* m_parent;
 
+	// Input and context used for lazy parsing (NULL parser if parsed).
+	// The flag is cleared once the part has been parsed, so that it can
+	// be tested without locking. The mutex is recursive, as the part is
+	// accessed by its body while it is being parsed
+	mutable std::atomic <bool> m_deferredPending;
+	mutable std::recursive_mutex m_deferredMutex;
+	mutable shared_ptr <utility::parserInputStreamAdapter> m_deferredParser;
+	mutable shared_ptr <parsingContext> m_deferredCtx;
+	size_t m_deferredStart;
+	size_t m_deferredEnd;
+
+	/** Record the location of this part in the input, so that it is
+	  * parsed the first time it is accessed. Called by the body class.
+	  *
+	  * @param ctx parsing context to use
+	  * @param parser parser object
+	  * @param position start position of the part in the input
+	  * @param end end position of the part in the input
+	  */
+	void deferParsing(
+		const shared_ptr <parsingContext>& ctx,
+		const shared_ptr <utility::parserInputStreamAdapter>& parser,
+		const size_t position,
+		const size_t end
+	);
+
+	/** Parse this part, if its parsing has been deferred.
+	  */
+	void parseDeferred() const;
+
 protected:
 
 	/** Creates and returns a new part and set this part as its
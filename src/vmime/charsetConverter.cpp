@@ -24,6 +24,7 @@
 #include "vmime/charsetConverter.hpp"
 
 #include "vmime/charsetConverter_idna.hpp"
+#include "vmime/charsetConverter_native.hpp"
 
 
 namespace vmime {
@@ -38,6 +39,8 @@ shared_ptr <charsetConverter> charsetConverter::create(
 
 	if (source == "idna" || dest == "idna") {
 		return make_shared <charsetConverter_idna>(source, dest, opts);
+	} else if (charsetConverter_native::isSupported(source, dest)) {
+		return make_shared <charsetConverter_native>(source, dest, opts);
 	} else {
 		return createGenericConverter(source, dest, opts);
 	}
@@ -0,0 +1,155 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/charsetConverterPool.hpp"
+
+
+namespace vmime {
+
+
+charsetConverterPool::charsetConverterPool(
+	const closeFunction closeFunc,
+	const size_t maxIdleHandles
+)
+	: m_closeFunc(closeFunc),
+	  m_maxIdleHandles(maxIdleHandles),
+	  m_hitCount(0),
+	  m_missCount(0) {
+
+}
+
+
+charsetConverterPool::~charsetConverterPool() {
+
+	clear();
+}
+
+
+charsetConverterPool::handle charsetConverterPool::acquire(const string& key) {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+
+	std::unordered_map <string, std::vector <handle> >::iterator it = m_idleHandles.find(key);
+
+	if (it == m_idleHandles.end() || it->second.empty()) {
+
+		++m_missCount;
+		return NULL;
+	}
+
+	const handle h = it->second.back();
+	it->second.pop_back();
+
+	++m_hitCount;
+
+	return h;
+}
+
+
+void charsetConverterPool::release(const string& key, const handle h) {
+
+	{
+		std::lock_guard <std::mutex> lock(m_mutex);
+
+		std::vector <handle>& handles = m_idleHandles[key];
+
+		if (handles.size() < m_maxIdleHandles) {
+
+			handles.push_back(h);
+			return;
+		}
+	}
+
+	m_closeFunc(h);
+}
+
+
+void charsetConverterPool::clear() {
+
+	std::unordered_map <string, std::vector <handle> > idleHandles;
+
+	{
+		std::lock_guard <std::mutex> lock(m_mutex);
+		idleHandles.swap(m_idleHandles);
+	}
+
+	for (std::unordered_map <string, std::vector <handle> >::iterator it = idleHandles.begin() ;
+	     it != idleHandles.end() ; ++it) {
+
+		for (std::vector <handle>::iterator jt = it->second.begin() ; jt != it->second.end() ; ++jt) {
+			m_closeFunc(*jt);
+		}
+	}
+}
+
+
+void charsetConverterPool::setMaxIdleHandles(const size_t maxIdleHandles) {
+
+	{
+		std::lock_guard <std::mutex> lock(m_mutex);
+		m_maxIdleHandles = maxIdleHandles;
+	}
+
+	clear();
+}
+
+
+size_t charsetConverterPool::getMaxIdleHandles() const {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+	return m_maxIdleHandles;
+}
+
+
+size_t charsetConverterPool::getHitCount() const {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+	return m_hitCount;
+}
+
+
+size_t charsetConverterPool::getMissCount() const {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+	return m_missCount;
+}
+
+
+size_t charsetConverterPool::getIdleCount() const {
+
+	std::lock_guard <std::mutex> lock(m_mutex);
+
+	size_t count = 0;
+
+	for (std::unordered_map <string, std::vector <handle> >::const_iterator it = m_idleHandles.begin() ;
+	     it != m_idleHandles.end() ; ++it) {
+
+		count += it->second.size();
+	}
+
+	return count;
+}
+
+
+} // vmime
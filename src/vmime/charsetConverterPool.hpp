@@ -0,0 +1,146 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_CHARSETCONVERTERPOOL_HPP_INCLUDED
+#define VMIME_CHARSETCONVERTERPOOL_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace vmime {
+
+
+/** A thread-safe pool of charset conversion handles (iconv descriptors,
+  * ICU converters), shared by all charsetConverter and
+  * charsetFilteredOutputStream objects, so that a handle does not have
+  * to be opened and closed each time a string is converted.
+  *
+  * Handles are identified by a key, built by the conversion library
+  * backend from the charsets (and options) the handle was opened for.
+  * The backend resets a handle before returning it to the pool.
+  */
+class VMIME_EXPORT charsetConverterPool {
+
+public:
+
+	typedef void* handle;
+
+	/** Function used to close a handle which is evicted from the pool.
+	  */
+	typedef void (*closeFunction)(handle h);
+
+	/** Construct a new pool.
+	  *
+	  * @param closeFunc function used to close handles
+	  * @param maxIdleHandles maximum number of idle handles kept for each key
+	  */
+	charsetConverterPool(const closeFunction closeFunc, const size_t maxIdleHandles = 8);
+
+	~charsetConverterPool();
+
+	/** Return the pool used by the charset conversion library
+	  * selected at build time.
+	  *
+	  * @return pool instance
+	  */
+	static shared_ptr <charsetConverterPool> getInstance();
+
+	/** Take an idle handle from the pool.
+	  *
+	  * @param key handle key
+	  * @return an idle handle for the specified key, or NULL if there is
+	  * none (in this case, the caller should open a new handle, and give
+	  * it back to the pool with release() when it does not need it anymore)
+	  */
+	handle acquire(const string& key);
+
+	/** Give a handle back to the pool. The handle is closed if the
+	  * maximum number of idle handles has been reached for this key.
+	  *
+	  * @param key handle key
+	  * @param h handle, which must have been reset
+	  */
+	void release(const string& key, const handle h);
+
+	/** Close all idle handles.
+	  */
+	void clear();
+
+	/** Set the maximum number of idle handles kept for each key.
+	  * Setting it to zero disables pooling.
+	  *
+	  * @param maxIdleHandles maximum number of idle handles
+	  */
+	void setMaxIdleHandles(const size_t maxIdleHandles);
+
+	/** Return the maximum number of idle handles kept for each key.
+	  *
+	  * @return maximum number of idle handles
+	  */
+	size_t getMaxIdleHandles() const;
+
+	/** Return the number of times acquire() returned an idle handle.
+	  *
+	  * @return number of hits
+	  */
+	size_t getHitCount() const;
+
+	/** Return the number of times acquire() found no idle handle.
+	  *
+	  * @return number of misses
+	  */
+	size_t getMissCount() const;
+
+	/** Return the total number of idle handles in the pool.
+	  *
+	  * @return number of idle handles
+	  */
+	size_t getIdleCount() const;
+
+private:
+
+	charsetConverterPool(const charsetConverterPool&);
+	charsetConverterPool& operator=(const charsetConverterPool&);
+
+	const closeFunction m_closeFunc;
+	size_t m_maxIdleHandles;
+
+	std::unordered_map <string, std::vector <handle> > m_idleHandles;
+
+	size_t m_hitCount;
+	size_t m_missCount;
+
+	mutable std::mutex m_mutex;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_CHARSETCONVERTERPOOL_HPP_INCLUDED
@@ -28,8 +28,10 @@
 
 
 #include "vmime/charsetConverter_iconv.hpp"
+#include "vmime/charsetConverterPool.hpp"
 
 #include "vmime/exception.hpp"
+#include "vmime/utility/stringUtils.hpp"
 #include "vmime/utility/inputStreamStringAdapter.hpp"
 #include "vmime/utility/outputStreamStringAdapter.hpp"
 
@@ -110,6 +112,76 @@ void outputInvalidChar(
 namespace vmime {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+void closeIconvDescriptor(void* desc) {
+
+	iconv_close(*static_cast <iconv_t*>(desc));
+
+	delete static_cast <iconv_t*>(desc);
+}
+
+
+const string getIconvDescriptorKey(const charset& source, const charset& dest) {
+
+	string key = utility::stringUtils::toLower(source.getName());
+
+	key += '\0';
+	key += utility::stringUtils::toLower(dest.getName());
+
+	return key;
+}
+
+
+// Get an iconv descriptor from the pool, or open a new one
+void* openIconvDescriptor(const charset& source, const charset& dest) {
+
+	void* desc = charsetConverterPool::getInstance()->acquire(getIconvDescriptorKey(source, dest));
+
+	if (desc) {
+		return desc;
+	}
+
+	const iconv_t cd = iconv_open(dest.getName().c_str(), source.getName().c_str());
+
+	if (cd != reinterpret_cast <iconv_t>(-1)) {
+
+		iconv_t* p = new iconv_t;
+		*p= cd;
+
+		desc = p;
+	}
+
+	return desc;
+}
+
+
+// Reset an iconv descriptor to its initial state and give it back to the pool
+void releaseIconvDescriptor(const charset& source, const charset& dest, void* desc) {
+
+	iconv(*static_cast <iconv_t*>(desc), NULL, NULL, NULL, NULL);
+
+	charsetConverterPool::getInstance()->release(getIconvDescriptorKey(source, dest), desc);
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+// static
+shared_ptr <charsetConverterPool> charsetConverterPool::getInstance() {
+
+	// Never destroyed, as converters may be released during static destruction
+	static charsetConverterPool* instance = new charsetConverterPool(&closeIconvDescriptor);
+	return shared_ptr <charsetConverterPool>(instance, noop_shared_ptr_deleter <charsetConverterPool>());
+}
+
+
 // static
 shared_ptr <charsetConverter> charsetConverter::createGenericConverter(
 	const charset& source,
@@ -131,16 +203,7 @@ charsetConverter_iconv::charsetConverter_iconv(
 	  m_dest(dest),
 	  m_options(opts) {
 
-	// Get an iconv descriptor
-	const iconv_t cd = iconv_open(dest.getName().c_str(), source.getName().c_str());
-
-	if (cd != reinterpret_cast <iconv_t>(-1)) {
-
-		iconv_t* p = new iconv_t;
-		*p= cd;
-
-		m_desc = p;
-	}
+	m_desc = openIconvDescriptor(source, dest);
 }
 
 
@@ -148,10 +211,7 @@ charsetConverter_iconv::~charsetConverter_iconv() {
 
 	if (m_desc) {
 
-		// Close iconv handle
-		iconv_close(*static_cast <iconv_t*>(m_desc));
-
-		delete static_cast <iconv_t*>(m_desc);
+		releaseIconvDescriptor(m_source, m_dest, m_desc);
 		m_desc = NULL;
 	}
 }
@@ -173,6 +233,10 @@ void charsetConverter_iconv::convert(
 
 	const iconv_t cd = *static_cast <iconv_t*>(m_desc);
 
+	// Start from the initial conversion state (a previous conversion may
+	// have been interrupted by an exception)
+	iconv(cd, NULL, NULL, NULL, NULL);
+
 	byte_t inBuffer[32768];
 	byte_t outBuffer[32768];
 	size_t inPos = 0;
@@ -303,16 +367,7 @@ charsetFilteredOutputStream_iconv::charsetFilteredOutputStream_iconv(
 	  m_unconvCount(0),
 	  m_options(opts) {
 
-	// Get an iconv descriptor
-	const iconv_t cd = iconv_open(dest.getName().c_str(), source.getName().c_str());
-
-	if (cd != reinterpret_cast <iconv_t>(-1)) {
-
-		iconv_t* p = new iconv_t;
-		*p= cd;
-
-		m_desc = p;
-	}
+	m_desc = openIconvDescriptor(source, dest);
 }
 
 
@@ -320,10 +375,7 @@ charsetFilteredOutputStream_iconv::~charsetFilteredOutputStream_iconv() {
 
 	if (m_desc) {
 
-		// Close iconv handle
-		iconv_close(*static_cast <iconv_t*>(m_desc));
-
-		delete static_cast <iconv_t*>(m_desc);
+		releaseIconvDescriptor(m_sourceCharset, m_destCharset, m_desc);
 		m_desc = NULL;
 	}
 }
@@ -28,8 +28,10 @@
 
 
 #include "vmime/charsetConverter_icu.hpp"
+#include "vmime/charsetConverterPool.hpp"
 
 #include "vmime/exception.hpp"
+#include "vmime/utility/stringUtils.hpp"
 #include "vmime/utility/inputStreamStringAdapter.hpp"
 #include "vmime/utility/outputStreamStringAdapter.hpp"
 
@@ -48,6 +50,79 @@
 namespace vmime {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+void closeICUConverter(void* cnv) {
+
+	ucnv_close(static_cast <UConverter*>(cnv));
+}
+
+
+// Converters are configured according to conversion options, and
+// slightly differently by converters and filtered streams: only
+// share converters which are configured the same way
+const string getICUConverterKey(
+	const char* role,
+	const charset& cs,
+	const bool stream,
+	const charsetConverterOptions& opts
+) {
+
+	string key = role;
+
+	key += '\0';
+	key += utility::stringUtils::toLower(cs.getName());
+	key += '\0';
+	key += stream ? 's' : 'c';
+
+	if (opts.silentlyReplaceInvalidSequences) {
+		key += '\0';
+		key += opts.invalidSequence;
+	}
+
+	return key;
+}
+
+
+// Get a converter from the pool, or open a new one
+UConverter* openICUConverter(const string& key, const charset& cs, UErrorCode* err) {
+
+	UConverter* cnv = static_cast <UConverter*>(charsetConverterPool::getInstance()->acquire(key));
+
+	if (cnv) {
+		return cnv;
+	}
+
+	return ucnv_open(cs.getName().c_str(), err);
+}
+
+
+// Reset a converter to its initial state and give it back to the pool
+void releaseICUConverter(const string& key, UConverter* cnv) {
+
+	ucnv_reset(cnv);
+
+	charsetConverterPool::getInstance()->release(key, cnv);
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+// static
+shared_ptr <charsetConverterPool> charsetConverterPool::getInstance() {
+
+	// Never destroyed, as converters may be released during static destruction
+	static charsetConverterPool* instance = new charsetConverterPool(&closeICUConverter);
+	return shared_ptr <charsetConverterPool>(instance, noop_shared_ptr_deleter <charsetConverterPool>());
+}
+
+
 // static
 shared_ptr <charsetConverter> charsetConverter::createGenericConverter(
 	const charset& source,
@@ -71,7 +146,7 @@ charsetConverter_icu::charsetConverter_icu(
 	  m_options(opts) {
 
 	UErrorCode err = U_ZERO_ERROR;
-	m_from = ucnv_open(source.getName().c_str(), &err);
+	m_from = openICUConverter(getICUConverterKey("from", source, false, opts), source, &err);
 
 	if (!U_SUCCESS(err)) {
 
@@ -81,7 +156,7 @@ charsetConverter_icu::charsetConverter_icu(
 		);
 	}
 
-	m_to = ucnv_open(dest.getName().c_str(), &err);
+	m_to = openICUConverter(getICUConverterKey("to", dest, false, opts), dest, &err);
 
 	if (!U_SUCCESS(err)) {
 
@@ -95,8 +170,8 @@ charsetConverter_icu::charsetConverter_icu(
 
 charsetConverter_icu::~charsetConverter_icu() {
 
-	if (m_from) ucnv_close(m_from);
-	if (m_to) ucnv_close(m_to);
+	if (m_from) releaseICUConverter(getICUConverterKey("from", m_source, false, m_options), m_from);
+	if (m_to) releaseICUConverter(getICUConverterKey("to", m_dest, false, m_options), m_to);
 }
 
 
@@ -318,7 +393,7 @@ charsetFilteredOutputStream_icu::charsetFilteredOutputStream_icu(
 	  m_options(opts) {
 
 	UErrorCode err = U_ZERO_ERROR;
-	m_from = ucnv_open(source.getName().c_str(), &err);
+	m_from = openICUConverter(getICUConverterKey("from", source, true, opts), source, &err);
 
 	if (!U_SUCCESS(err)) {
 
@@ -328,7 +403,7 @@ charsetFilteredOutputStream_icu::charsetFilteredOutputStream_icu(
 		);
 	}
 
-	m_to = ucnv_open(dest.getName().c_str(), &err);
+	m_to = openICUConverter(getICUConverterKey("to", dest, true, opts), dest, &err);
 
 	if (!U_SUCCESS(err)) {
 
@@ -373,8 +448,8 @@ charsetFilteredOutputStream_icu::charsetFilteredOutputStream_icu(
 
 charsetFilteredOutputStream_icu::~charsetFilteredOutputStream_icu() {
 
-	if (m_from) ucnv_close(m_from);
-	if (m_to) ucnv_close(m_to);
+	if (m_from) releaseICUConverter(getICUConverterKey("from", m_sourceCharset, true, m_options), m_from);
+	if (m_to) releaseICUConverter(getICUConverterKey("to", m_destCharset, true, m_options), m_to);
 }
 
 
@@ -0,0 +1,619 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/charsetConverter_native.hpp"
+
+#include "vmime/exception.hpp"
+
+#include "vmime/utility/scanUtils.hpp"
+#include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+
+#include <cstring>
+
+
+namespace vmime {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+enum charsetType {
+
+	CHARSET_UNSUPPORTED,
+	CHARSET_UTF_8,
+	CHARSET_US_ASCII,
+	CHARSET_ISO8859_1,
+	CHARSET_WINDOWS_1252
+};
+
+
+struct charsetAlias {
+
+	const char* name;
+	charsetType type;
+};
+
+
+const charsetAlias CHARSET_ALIASES[] = {
+
+	{ "utf-8", CHARSET_UTF_8 },
+	{ "utf8", CHARSET_UTF_8 },
+	{ "us-ascii", CHARSET_US_ASCII },
+	{ "ascii", CHARSET_US_ASCII },
+	{ "ansi_x3.4-1968", CHARSET_US_ASCII },
+	{ "iso-8859-1", CHARSET_ISO8859_1 },
+	{ "iso8859-1", CHARSET_ISO8859_1 },
+	{ "iso_8859-1", CHARSET_ISO8859_1 },
+	{ "latin1", CHARSET_ISO8859_1 },
+	{ "windows-1252", CHARSET_WINDOWS_1252 },
+	{ "cp1252", CHARSET_WINDOWS_1252 }
+};
+
+
+charsetType getCharsetType(const charset& ch) {
+
+	const string name = utility::stringUtils::toLower(ch.getName());
+
+	for (size_t i = 0 ; i < sizeof(CHARSET_ALIASES) / sizeof(CHARSET_ALIASES[0]) ; ++i) {
+
+		if (name == CHARSET_ALIASES[i].name) {
+			return CHARSET_ALIASES[i].type;
+		}
+	}
+
+	return CHARSET_UNSUPPORTED;
+}
+
+
+// Windows-1252 characters 0x80 to 0x9f; the five bytes left undefined by
+// the code page (0x81, 0x8d, 0x8f, 0x90 and 0x9d) map to the C1 control
+// characters with the same value, as ICU and the Windows API do
+const unsigned int WINDOWS_1252_TO_UNICODE[32] = {
+	0x20ac, 0x0081, 0x201a, 0x0192, 0x201e, 0x2026, 0x2020, 0x2021,
+	0x02c6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008d, 0x017d, 0x008f,
+	0x0090, 0x2018, 0x2019, 0x201c, 0x201d, 0x2022, 0x2013, 0x2014,
+	0x02dc, 0x2122, 0x0161, 0x203a, 0x0153, 0x009d, 0x017e, 0x0178
+};
+
+
+const unsigned int INVALID_CHAR = 0xffffffff;
+
+
+/** Decode the next character.
+  *
+  * @param type charset
+  * @param data input bytes
+  * @param length number of input bytes (at least 1)
+  * @param c will receive the Unicode code point, or INVALID_CHAR if the
+  * sequence is not valid
+  * @return number of bytes of the character (or of the invalid sequence
+  * to skip), or 0 if the sequence is incomplete
+  */
+size_t decodeChar(const charsetType type, const byte_t* data, const size_t length, unsigned int* c) {
+
+	const byte_t b0 = data[0];
+
+	if (b0 < 0x80) {
+
+		*c = b0;
+		return 1;
+	}
+
+	switch (type) {
+
+		case CHARSET_US_ASCII:
+
+			*c = INVALID_CHAR;
+			return 1;
+
+		case CHARSET_ISO8859_1:
+
+			*c = b0;
+			return 1;
+
+		case CHARSET_WINDOWS_1252:
+
+			if (b0 >= 0xa0) {
+				*c = b0;
+			} else {
+				*c = WINDOWS_1252_TO_UNICODE[b0 - 0x80];
+			}
+
+			return 1;
+
+		case CHARSET_UTF_8:
+		default:
+
+			break;
+	}
+
+	// UTF-8: well-formed sequences as defined in RFC 3629 (no overlong
+	// forms, no surrogates, nothing above U+10FFFF)
+	size_t count;
+	unsigned int value;
+	byte_t lower = 0x80, upper = 0xbf;  // allowed range for the second byte
+
+	if (b0 >= 0xc2 && b0 <= 0xdf) {
+
+		count = 2;
+		value = b0 & 0x1f;
+
+	} else if (b0 >= 0xe0 && b0 <= 0xef) {
+
+		count = 3;
+		value = b0 & 0x0f;
+
+		if (b0 == 0xe0) {
+			lower = 0xa0;
+		} else if (b0 == 0xed) {
+			upper = 0x9f;
+		}
+
+	} else if (b0 >= 0xf0 && b0 <= 0xf4) {
+
+		count = 4;
+		value = b0 & 0x07;
+
+		if (b0 == 0xf0) {
+			lower = 0x90;
+		} else if (b0 == 0xf4) {
+			upper = 0x8f;
+		}
+
+	} else {
+
+		*c = INVALID_CHAR;
+		return 1;
+	}
+
+	for (size_t i = 1 ; i < count ; ++i) {
+
+		if (i >= length) {
+			return 0;  // incomplete
+		}
+
+		const byte_t b = data[i];
+
+		if (b < lower || b > upper) {
+
+			// Skip the maximal valid subpart of the sequence
+			*c = INVALID_CHAR;
+			return i;
+		}
+
+		value = (value << 6) | (b & 0x3f);
+
+		lower = 0x80;
+		upper = 0xbf;
+	}
+
+	*c = value;
+
+	return count;
+}
+
+
+/** Encode a character.
+  *
+  * @param type charset
+  * @param c Unicode code point
+  * @param out will receive the encoded character (at least 4 bytes)
+  * @return number of bytes written, or 0 if the character cannot be
+  * represented in the specified charset
+  */
+size_t encodeChar(const charsetType type, const unsigned int c, byte_t* out) {
+
+	if (c < 0x80) {
+
+		out[0] = static_cast <byte_t>(c);
+		return 1;
+	}
+
+	switch (type) {
+
+		case CHARSET_US_ASCII:
+
+			return 0;
+
+		case CHARSET_ISO8859_1:
+
+			if (c > 0xff) {
+				return 0;
+			}
+
+			out[0] = static_cast <byte_t>(c);
+			return 1;
+
+		case CHARSET_WINDOWS_1252:
+
+			if (c >= 0xa0 && c <= 0xff) {
+
+				out[0] = static_cast <byte_t>(c);
+				return 1;
+			}
+
+			for (size_t i = 0 ; i < 32 ; ++i) {
+
+				if (WINDOWS_1252_TO_UNICODE[i] == c) {
+
+					out[0] = static_cast <byte_t>(0x80 + i);
+					return 1;
+				}
+			}
+
+			return 0;
+
+		case CHARSET_UTF_8:
+		default:
+
+			if (c < 0x800) {
+
+				out[0] = static_cast <byte_t>(0xc0 | (c >> 6));
+				out[1] = static_cast <byte_t>(0x80 | (c & 0x3f));
+
+				return 2;
+
+			} else if (c < 0x10000) {
+
+				out[0] = static_cast <byte_t>(0xe0 | (c >> 12));
+				out[1] = static_cast <byte_t>(0x80 | ((c >> 6) & 0x3f));
+				out[2] = static_cast <byte_t>(0x80 | (c & 0x3f));
+
+				return 3;
+			}
+
+			out[0] = static_cast <byte_t>(0xf0 | (c >> 18));
+			out[1] = static_cast <byte_t>(0x80 | ((c >> 12) & 0x3f));
+			out[2] = static_cast <byte_t>(0x80 | ((c >> 6) & 0x3f));
+			out[3] = static_cast <byte_t>(0x80 | (c & 0x3f));
+
+			return 4;
+	}
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+
+charsetConverter_native::charsetConverter_native(
+	const charset& source,
+	const charset& dest,
+	const charsetConverterOptions& opts
+)
+	: m_source(source),
+	  m_dest(dest),
+	  m_sourceType(getCharsetType(source)),
+	  m_destType(getCharsetType(dest)),
+	  m_options(opts) {
+
+	// Convert the replacement string (given in the source charset),
+	// ignoring characters which cannot be represented
+	const byte_t* data = utility::stringUtils::bytesFromString(opts.invalidSequence);
+	const size_t length = opts.invalidSequence.length();
+
+	for (size_t pos = 0 ; pos < length ; ) {
+
+		unsigned int c;
+		size_t charLength = decodeChar(static_cast <charsetType>(m_sourceType), data + pos, length - pos, &c);
+
+		if (charLength == 0) {
+			break;
+		}
+
+		byte_t encoded[4];
+		size_t encodedLength = 0;
+
+		if (c != INVALID_CHAR) {
+			encodedLength = encodeChar(static_cast <charsetType>(m_destType), c, encoded);
+		}
+
+		utility::stringUtils::appendBytesToString(m_invalidSequence, encoded, encodedLength);
+
+		pos += charLength;
+	}
+}
+
+
+charsetConverter_native::~charsetConverter_native() {
+
+}
+
+
+// static
+bool charsetConverter_native::isSupported(const charset& source, const charset& dest) {
+
+	return getCharsetType(source) != CHARSET_UNSUPPORTED &&
+	       getCharsetType(dest) != CHARSET_UNSUPPORTED;
+}
+
+
+size_t charsetConverter_native::convertBytes(
+	const byte_t* data,
+	const size_t length,
+	const bool last,
+	utility::outputStream& out,
+	status* st
+) {
+
+	const charsetType sourceType = static_cast <charsetType>(m_sourceType);
+	const charsetType destType = static_cast <charsetType>(m_destType);
+
+	byte_t outBuffer[4096];
+	size_t outPos = 0;
+
+	size_t pos = 0;
+
+	while (pos < length) {
+
+		// ASCII characters are the same in all supported charsets
+		size_t asciiLength = utility::scanUtils::findFirstNonASCII(data + pos, length - pos);
+
+		if (asciiLength == npos) {
+			asciiLength = length - pos;
+		}
+
+		if (asciiLength != 0) {
+
+			const bool direct = (asciiLength > sizeof(outBuffer) / 2);
+
+			// Flush pending output first, to preserve ordering
+			if (outPos != 0 && (direct || outPos + asciiLength > sizeof(outBuffer))) {
+
+				out.write(outBuffer, outPos);
+				outPos = 0;
+			}
+
+			if (direct) {
+				out.write(data + pos, asciiLength);
+			} else {
+				std::memcpy(outBuffer + outPos, data + pos, asciiLength);
+				outPos += asciiLength;
+			}
+
+			if (st) {
+				st->inputBytesRead += asciiLength;
+				st->outputBytesWritten += asciiLength;
+			}
+
+			pos += asciiLength;
+			continue;
+		}
+
+		// Decode the next character
+		unsigned int c;
+		size_t charLength = decodeChar(sourceType, data + pos, length - pos, &c);
+
+		if (charLength == 0) {
+
+			// Incomplete sequence: wait for more data
+			if (!last) {
+				break;
+			}
+
+			c = INVALID_CHAR;
+			charLength = length - pos;
+		}
+
+		// Encode it into the destination charset
+		if (outPos + 4 > sizeof(outBuffer)) {
+
+			out.write(outBuffer, outPos);
+			outPos = 0;
+		}
+
+		size_t encodedLength = 0;
+
+		if (c != INVALID_CHAR) {
+			encodedLength = encodeChar(destType, c, outBuffer + outPos);
+		}
+
+		if (encodedLength != 0) {
+
+			outPos += encodedLength;
+
+			if (st) {
+				st->inputBytesRead += charLength;
+				st->outputBytesWritten += encodedLength;
+			}
+
+		} else {
+
+			// Illegal input sequence, or character which has no
+			// equivalent in the destination charset
+			out.write(outBuffer, outPos);
+			outPos = 0;
+
+			if (!m_options.silentlyReplaceInvalidSequences) {
+				throw exceptions::illegal_byte_sequence_for_charset();
+			}
+
+			out.write(m_invalidSequence.data(), m_invalidSequence.length());
+		}
+
+		pos += charLength;
+	}
+
+	out.write(outBuffer, outPos);
+
+	return pos;
+}
+
+
+void charsetConverter_native::convert(
+	utility::inputStream& in,
+	utility::outputStream& out,
+	status* st
+) {
+
+	if (st) {
+		new (st) status();
+	}
+
+	byte_t buffer[16384];
+	size_t bufferLength = 0;
+
+	while (!in.eof()) {
+
+		// Keep room for an incomplete sequence left by the previous block
+		const size_t read = in.read(buffer + bufferLength, sizeof(buffer) - 8);
+
+		if (read == 0) {
+			break;
+		}
+
+		bufferLength += read;
+
+		const size_t consumed = convertBytes(buffer, bufferLength, false, out, st);
+
+		bufferLength -= consumed;
+		std::memmove(buffer, buffer + consumed, bufferLength);
+	}
+
+	if (bufferLength != 0) {
+		convertBytes(buffer, bufferLength, true, out, st);
+	}
+}
+
+
+void charsetConverter_native::convert(const string& in, string& out, status* st) {
+
+	if (st) {
+		new (st) status();
+	}
+
+	out.clear();
+	out.reserve(in.length());
+
+	utility::outputStreamStringAdapter os(out);
+
+	convertBytes(utility::stringUtils::bytesFromString(in), in.length(), true, os, st);
+
+	os.flush();
+}
+
+
+shared_ptr <utility::charsetFilteredOutputStream>
+	charsetConverter_native::getFilteredOutputStream(
+		utility::outputStream& os,
+		const charsetConverterOptions& opts
+	) {
+
+	return make_shared <utility::charsetFilteredOutputStream_native>(m_source, m_dest, &os, opts);
+}
+
+
+
+// charsetFilteredOutputStream_native
+
+namespace utility {
+
+
+charsetFilteredOutputStream_native::charsetFilteredOutputStream_native(
+	const charset& source,
+	const charset& dest,
+	outputStream* os,
+	const charsetConverterOptions& opts
+)
+	: m_converter(source, dest, opts),
+	  m_stream(*os),
+	  m_unconvCount(0) {
+
+}
+
+
+outputStream& charsetFilteredOutputStream_native::getNextOutputStream() {
+
+	return m_stream;
+}
+
+
+void charsetFilteredOutputStream_native::writeImpl(
+	const byte_t* const data,
+	const size_t count
+) {
+
+	const byte_t* curData = data;
+	size_t curDataLen = count;
+
+	// Complete the sequence left from the previous write
+	if (m_unconvCount != 0) {
+
+		const size_t unconvCount = m_unconvCount;
+		const size_t added = std::min(curDataLen, sizeof(m_unconvBuffer) - m_unconvCount);
+
+		std::memcpy(m_unconvBuffer + m_unconvCount, curData, added);
+		m_unconvCount += added;
+
+		const size_t consumed = m_converter.convertBytes(
+			m_unconvBuffer, m_unconvCount, false, m_stream, NULL
+		);
+
+		if (consumed < unconvCount) {
+
+			// Still incomplete: all new data is in the buffer
+			m_unconvCount -= consumed;
+			std::memmove(m_unconvBuffer, m_unconvBuffer + consumed, m_unconvCount);
+
+			return;
+		}
+
+		curData += consumed - unconvCount;
+		curDataLen -= consumed - unconvCount;
+
+		m_unconvCount = 0;
+	}
+
+	const size_t consumed = m_converter.convertBytes(curData, curDataLen, false, m_stream, NULL);
+
+	// Keep an incomplete sequence for the next write
+	m_unconvCount = curDataLen - consumed;
+	std::memcpy(m_unconvBuffer, curData + consumed, m_unconvCount);
+}
+
+
+void charsetFilteredOutputStream_native::flush() {
+
+	// Process unconverted bytes
+	if (m_unconvCount != 0) {
+
+		const size_t unconvCount = m_unconvCount;
+		m_unconvCount = 0;
+
+		m_converter.convertBytes(m_unconvBuffer, unconvCount, true, m_stream, NULL);
+	}
+
+	m_stream.flush();
+}
+
+
+} // utility
+
+
+} // vmime
@@ -0,0 +1,161 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_CHARSETCONVERTER_NATIVE_HPP_INCLUDED
+#define VMIME_CHARSETCONVERTER_NATIVE_HPP_INCLUDED
+
+
+#include "vmime/charsetConverter.hpp"
+
+
+namespace vmime {
+
+
+/** A built-in charset converter for the most common charsets (UTF-8,
+  * US-ASCII, ISO-8859-1 and Windows-1252), which does not depend on
+  * the charset conversion library. Runs of ASCII characters (which are
+  * the same in all these charsets) are copied as-is.
+  */
+class charsetConverter_native : public charsetConverter {
+
+public:
+
+	/** Construct and initialize a native charset converter.
+	  *
+	  * @param source input charset
+	  * @param dest output charset
+	  * @param opts conversion options
+	  */
+	charsetConverter_native(
+		const charset& source,
+		const charset& dest,
+		const charsetConverterOptions& opts = charsetConverterOptions()
+	);
+
+	~charsetConverter_native();
+
+	/** Test whether a conversion between the specified charsets
+	  * is supported by this converter.
+	  *
+	  * @param source input charset
+	  * @param dest output charset
+	  * @return true if the conversion is supported, false otherwise
+	  */
+	static bool isSupported(const charset& source, const charset& dest);
+
+	void convert(const string& in, string& out, status* st = NULL);
+	void convert(utility::inputStream& in, utility::outputStream& out, status* st = NULL);
+
+	shared_ptr <utility::charsetFilteredOutputStream> getFilteredOutputStream(
+		utility::outputStream& os,
+		const charsetConverterOptions& opts = charsetConverterOptions()
+	);
+
+	/** Convert a buffer and write the result to an output stream.
+	  *
+	  * @param data input bytes
+	  * @param length number of input bytes
+	  * @param last if false, an incomplete sequence at the end of the
+	  * buffer is not converted (it may be completed by the next buffer);
+	  * if true, it is considered as invalid
+	  * @param out output stream to write the converted data
+	  * @param st will receive some extra infos when conversion is finished
+	  * or stopped by an error (can be NULL); counters are incremented
+	  * @return number of input bytes consumed
+	  */
+	size_t convertBytes(
+		const byte_t* data,
+		const size_t length,
+		const bool last,
+		utility::outputStream& out,
+		status* st
+	);
+
+private:
+
+	charset m_source;
+	charset m_dest;
+
+	int m_sourceType;
+	int m_destType;
+
+	charsetConverterOptions m_options;
+
+	// Replacement for invalid sequences, in the destination charset
+	string m_invalidSequence;
+};
+
+
+namespace utility {
+
+
+class charsetFilteredOutputStream_native : public charsetFilteredOutputStream {
+
+public:
+
+	/** Construct a new filter for the specified output stream.
+	  *
+	  * @param source input charset
+	  * @param dest output charset
+	  * @param os stream into which write filtered data
+	  * @param opts conversion options
+	  */
+	charsetFilteredOutputStream_native(
+		const charset& source,
+		const charset& dest,
+		outputStream* os,
+		const charsetConverterOptions& opts = charsetConverterOptions()
+	);
+
+	outputStream& getNextOutputStream();
+
+	void flush();
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count);
+
+private:
+
+	// Maximum length of a character in the supported charsets
+	enum { MAX_CHARACTER_WIDTH = 4 };
+
+
+	charsetConverter_native m_converter;
+
+	outputStream& m_stream;
+
+	// Incomplete sequence left from the previous write
+	byte_t m_unconvBuffer[MAX_CHARACTER_WIDTH * 2];
+	size_t m_unconvCount;
+};
+
+
+} // utility
+
+
+} // vmime
+
+
+#endif // VMIME_CHARSETCONVERTER_NATIVE_HPP_INCLUDED
@@ -28,6 +28,7 @@
 
 
 #include "vmime/charsetConverter_win.hpp"
+#include "vmime/charsetConverterPool.hpp"
 
 #include "vmime/exception.hpp"
 #include "vmime/utility/stringUtils.hpp"
@@ -52,6 +53,30 @@
 namespace vmime {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+void closeWinHandle(void* /* h */) {
+
+	// Code page conversion functions do not use any handle
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+// static
+shared_ptr <charsetConverterPool> charsetConverterPool::getInstance() {
+
+	static charsetConverterPool* instance = new charsetConverterPool(&closeWinHandle);
+	return shared_ptr <charsetConverterPool>(instance, noop_shared_ptr_deleter <charsetConverterPool>());
+}
+
+
 // static
 shared_ptr <charsetConverter> charsetConverter::createGenericConverter(
 	const charset& source,
@@ -28,12 +28,143 @@
 #include "vmime/utility/inputStreamStringAdapter.hpp"
 #include "vmime/utility/outputStreamAdapter.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 
 namespace vmime {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+// Output stream which only counts the bytes written into it
+class countingOutputStream : public utility::outputStream {
+
+public:
+
+	countingOutputStream()
+		: m_count(0) {
+
+	}
+
+	size_t getCount() const {
+
+		return m_count;
+	}
+
+	void flush() {
+
+		// Nothing to do
+	}
+
+protected:
+
+	void writeImpl(const byte_t* const /* data */, const size_t count) {
+
+		m_count += count;
+	}
+
+private:
+
+	size_t m_count;
+};
+
+
+// Return the stream which positions in parsed data are relative to
+shared_ptr <utility::seekableInputStream> getParsedDataStream(
+	const shared_ptr <utility::parserInputStreamAdapter>& parsedData
+) {
+
+	// Parsers may be stacked on the same stream: positions in the
+	// parsed data are always relative to the innermost stream
+	shared_ptr <utility::seekableInputStream> stream = parsedData->getUnderlyingStream();
+
+	for (shared_ptr <utility::parserInputStreamAdapter> parser ;
+	     (parser = dynamicCast <utility::parserInputStreamAdapter>(stream)) ; ) {
+
+		stream = parser->getUnderlyingStream();
+	}
+
+	return stream;
+}
+
+
+// Return whether each line feed in the specified range of parsed
+// data is preceded by a carriage return
+bool hasOnlyCRLFLineEndings(
+	const shared_ptr <utility::parserInputStreamAdapter>& parsedData,
+	const size_t offset,
+	const size_t length
+) {
+
+	shared_ptr <utility::inputStreamStringAdapter> stringStream =
+		dynamicCast <utility::inputStreamStringAdapter>(getParsedDataStream(parsedData));
+
+	if (stringStream) {
+
+		const char* const data = stringStream->getBuffer()->data() + stringStream->getBufferOffset();
+		const char* const end = data + offset + length;
+
+		for (const char* p = data + offset ;
+		     (p = static_cast <const char*>(std::memchr(p, '\n', end - p))) ; ++p) {
+
+			if (p == data || p[-1] != '\r') {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Read through a new adapter, so that the position of the parser
+	// (or of parsers used in other threads) is not changed
+	shared_ptr <utility::parserInputStreamAdapter> reader = parsedData->fork();
+
+	// Also read the byte before the range, for a line feed at its start
+	const size_t start = (offset != 0 ? offset - 1 : 0);
+
+	reader->seek(start);
+
+	std::vector <byte_t> buffer(16384);
+	size_t remaining = offset + length - start;
+	byte_t previous = 0;
+	bool first = (offset != 0);
+
+	while (remaining > 0 && !reader->eof()) {
+
+		const size_t read = reader->read(&buffer[0], std::min(remaining, buffer.size()));
+
+		if (read == 0) {
+			break;
+		}
+
+		for (size_t i = 0 ; i < read ; ++i) {
+
+			if (buffer[i] == '\n' && previous != '\r' && !first) {
+				return false;
+			}
+
+			previous = buffer[i];
+			first = false;
+		}
+
+		remaining -= read;
+	}
+
+	return true;
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 component::component()
 	: m_parsedOffset(0), m_parsedLength(0) {
 
@@ -73,6 +204,7 @@ void component::parse(
 ) {
 
 	m_parsedOffset = m_parsedLength = 0;
+	m_parsedData = null;
 
 	shared_ptr <utility::seekableInputStream> seekableStream =
 		dynamicCast <utility::seekableInputStream>(inputStream);
@@ -85,8 +217,7 @@ void component::parse(
 
 		utility::bufferedStreamCopyRange(*inputStream, ossAdapter, position, end - position);
 
-		const string buffer = oss.str();
-		parseImpl(ctx, buffer, 0, buffer.length(), NULL);
+		parse(ctx, make_shared <string>(oss.str()));
 
 	} else {
 
@@ -101,6 +232,7 @@ void component::parse(
 void component::parse(const string& buffer) {
 
 	m_parsedOffset = m_parsedLength = 0;
+	m_parsedData = null;
 
 	parseImpl(parsingContext::getDefaultContext(), buffer, 0, buffer.length(), NULL);
 }
@@ -109,11 +241,33 @@ void component::parse(const string& buffer) {
 void component::parse(parsingContext& ctx, const string& buffer) {
 
 	m_parsedOffset = m_parsedLength = 0;
+	m_parsedData = null;
 
 	parseImpl(ctx, buffer, 0, buffer.length(), NULL);
 }
 
 
+void component::parse(const shared_ptr <const string>& buffer) {
+
+	parse(parsingContext::getDefaultContext(), buffer);
+}
+
+
+void component::parse(parsingContext& ctx, const shared_ptr <const string>& buffer) {
+
+	m_parsedOffset = m_parsedLength = 0;
+	m_parsedData = null;
+
+	shared_ptr <utility::seekableInputStream> stream =
+		make_shared <utility::inputStreamStringAdapter>(buffer);
+
+	shared_ptr <utility::parserInputStreamAdapter> parser =
+		make_shared <utility::parserInputStreamAdapter>(stream);
+
+	parseImpl(ctx, parser, 0, buffer->length(), NULL);
+}
+
+
 void component::parse(
 	const string& buffer,
 	const size_t position,
@@ -122,6 +276,7 @@ void component::parse(
 ) {
 
 	m_parsedOffset = m_parsedLength = 0;
+	m_parsedData = null;
 
 	parseImpl(parsingContext::getDefaultContext(), buffer, position, end, newPosition);
 }
@@ -135,6 +290,7 @@ void component::parse(
 ) {
 
 	m_parsedOffset = m_parsedLength = 0;
+	m_parsedData = null;
 
 	parseImpl(ctx, buffer, position, end, newPosition);
 }
@@ -164,6 +320,17 @@ void component::parseImpl(
 	size_t* newPosition
 ) {
 
+	// If the stream reads from a buffer in memory, use the "parse from string"
+	// implementation directly on it, instead of extracting a copy of the data
+	shared_ptr <utility::inputStreamStringAdapter> stringStream =
+		dynamicCast <utility::inputStreamStringAdapter>(parser->getUnderlyingStream());
+
+	if (stringStream && stringStream->getBufferOffset() == 0) {
+
+		parseImpl(ctx, *stringStream->getBuffer(), position, end, newPosition);
+		return;
+	}
+
 	// This is the default implementation for parsing from an input stream:
 	// actually, we extract the substring and use the "parse from string" implementation
 	const string buffer = parser->extract(position, end);
@@ -257,6 +424,15 @@ void component::setParsedBounds(const size_t start, const size_t end) {
 }
 
 
+size_t component::getExactGeneratedSize(const generationContext& ctx) const {
+
+	countingOutputStream os;
+	generateImpl(ctx, os, 0, NULL);
+
+	return os.getCount();
+}
+
+
 size_t component::getGeneratedSize(const generationContext& ctx) {
 
 	std::vector <shared_ptr <component> > children = getChildComponents();
@@ -272,4 +448,134 @@ size_t component::getGeneratedSize(const generationContext& ctx) {
 }
 
 
+
+bool component::isParsedDataReusable() const {
+
+	return false;
+}
+
+
+void component::retainParsedData(const shared_ptr <utility::parserInputStreamAdapter>& source) {
+
+	// Components are generated with CRLF line endings: copying data with
+	// other line endings would mix both if an enclosing component is
+	// generated again, so such data is not reused
+	if (source && !hasOnlyCRLFLineEndings(source, m_parsedOffset, m_parsedLength)) {
+
+		m_parsedData = null;
+		return;
+	}
+
+	m_parsedData = source;
+}
+
+
+void component::discardParsedData() {
+
+	m_parsedData = null;
+}
+
+
+bool component::hasParsedData() const {
+
+	return !!m_parsedData;
+}
+
+
+void component::copyParsedDataFrom(const component& other) {
+
+	if (other.isParsedDataReusable()) {
+
+		m_parsedData = other.m_parsedData;
+		m_parsedOffset = other.m_parsedOffset;
+		m_parsedLength = other.m_parsedLength;
+
+	} else {
+
+		m_parsedData = null;
+	}
+}
+
+
+// static
+shared_ptr <parsingContext> component::createDeferredParsingContext(const parsingContext& ctx) {
+
+	shared_ptr <parsingContext> deferredCtx = make_shared <parsingContext>(ctx);
+	deferredCtx->setMemoryArena(null);
+
+	return deferredCtx;
+}
+
+
+// static
+bool component::haveSameParsedData(const component& a, const component& b) {
+
+	return a.m_parsedData && a.m_parsedData == b.m_parsedData &&
+		a.m_parsedOffset == b.m_parsedOffset && a.m_parsedLength == b.m_parsedLength;
+}
+
+
+void component::copyParsedData(utility::outputStream& os, size_t* newLinePos) const {
+
+	shared_ptr <utility::inputStreamStringAdapter> stringStream =
+		dynamicCast <utility::inputStreamStringAdapter>(getParsedDataStream(m_parsedData));
+
+	if (stringStream) {
+
+		const char* data =
+			stringStream->getBuffer()->data() + stringStream->getBufferOffset() + m_parsedOffset;
+
+		os.write(data, m_parsedLength);
+
+		if (newLinePos) {
+
+			const char* const end = data + m_parsedLength;
+			const char* p = end;
+
+			while (p != data && p[-1] != '\n') {
+				--p;
+			}
+
+			*newLinePos = end - p;
+		}
+
+	} else {
+
+		// The stream may be shared with components parsed or generated
+		// in other threads: read through a new adapter on it
+		shared_ptr <utility::parserInputStreamAdapter> stream = m_parsedData->fork();
+
+		stream->seek(m_parsedOffset);
+
+		byte_t buffer[16384];
+		size_t remaining = m_parsedLength;
+		size_t lineLength = 0;
+
+		while (remaining > 0 && !stream->eof()) {
+
+			const size_t read = stream->read(buffer, std::min(remaining, sizeof(buffer)));
+
+			if (read == 0) {
+				break;
+			}
+
+			os.write(buffer, read);
+			remaining -= read;
+
+			size_t lastLine = read;
+
+			while (lastLine != 0 && buffer[lastLine - 1] != '\n') {
+				--lastLine;
+			}
+
+			lineLength = (lastLine == 0 ? lineLength + read : read - lastLine);
+		}
+
+		if (newLinePos) {
+			*newLinePos = lineLength;
+		}
+	}
+}
+
+
 } // vmime
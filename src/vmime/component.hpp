@@ -42,6 +42,8 @@ namespace vmime {
   */
 class VMIME_EXPORT component : public object {
 
+	friend class headerField;
+
 public:
 
 	component();
@@ -61,6 +63,26 @@ public:
 	  */
 	void parse(parsingContext& ctx, const string& buffer);
 
+	/** Parse RFC-822/MIME data for this component from a shared buffer,
+	  * using the default parsing context.
+	  *
+	  * Unlike parse(const string&), the buffer is not copied: the parsed
+	  * component keeps a reference to it, and the contents of the parts
+	  * (and of any sub-component which has not been materialized) are
+	  * read from it when needed.
+	  *
+	  * @param buffer input buffer
+	  */
+	void parse(const shared_ptr <const string>& buffer);
+
+	/** Parse RFC-822/MIME data for this component from a shared buffer.
+	  * See parse(const shared_ptr <const string>&).
+	  *
+	  * @param ctx parsing context
+	  * @param buffer input buffer
+	  */
+	void parse(parsingContext& ctx, const shared_ptr <const string>& buffer);
+
 	/** Parse RFC-822/MIME data for this component. If stream is not seekable,
 	  * or if length is not specified, entire contents of the stream will
 	  * be loaded into memory before parsing.
@@ -222,10 +244,93 @@ public:
 	  */
 	virtual size_t getGeneratedSize(const generationContext& ctx);
 
+	/** Get the exact number of bytes that will be used by this component
+	  * when it is generated. Unlike getGeneratedSize(), the component is
+	  * actually generated (but the output is discarded).
+	  *
+	  * To avoid encoding body contents once here and once again when the
+	  * component is generated, set an encoded contents cache on the
+	  * generation context (see generationContext::setEncodedContentsCache())
+	  * and use the same context for both calls.
+	  *
+	  * @param ctx generation context
+	  * @return exact component size when generated
+	  */
+	size_t getExactGeneratedSize(const generationContext& ctx) const;
+
+	/** Return whether this component has not been modified since it was
+	  * parsed, and still has a reference to the data it was parsed from
+	  * (see parsingContext::setRetainParsedData()). In this case, it is
+	  * generated by copying the original data.
+	  *
+	  * Modifying a component, or obtaining a non-const reference to a
+	  * value which is not itself tracked (such as the value of a header
+	  * field or a parameter), makes it (and its parents) not reusable.
+	  *
+	  * @return true if the parsed data will be copied when this
+	  * component is generated, or false otherwise
+	  */
+	virtual bool isParsedDataReusable() const;
+
 protected:
 
 	void setParsedBounds(const size_t start, const size_t end);
 
+	/** Keep a reference to the data this component was parsed from,
+	  * to be able to copy it when it is generated.
+	  *
+	  * @param source parser on the data, or NULL to release it
+	  */
+	virtual void retainParsedData(const shared_ptr <utility::parserInputStreamAdapter>& source);
+
+	/** Release the reference to the data this component was parsed from.
+	  * This must be called each time the component is modified.
+	  */
+	void discardParsedData();
+
+	/** Return whether this component has a reference to the data
+	  * it was parsed from.
+	  *
+	  * @return true if the parsed data has been retained, false otherwise
+	  */
+	bool hasParsedData() const;
+
+	/** Copy the data this component was parsed from (the range given by
+	  * getParsedOffset() and getParsedLength()) to the specified stream.
+	  *
+	  * @param os output stream
+	  * @param newLinePos will receive the new line position (length of the last line written)
+	  */
+	void copyParsedData(utility::outputStream& os, size_t* newLinePos = NULL) const;
+
+	/** Make this component refer to the same parsed data as the
+	  * specified component, if it is reusable (this is used when
+	  * copying a component which has not been modified).
+	  *
+	  * @param other component from which the data has been copied
+	  */
+	void copyParsedDataFrom(const component& other);
+
+	/** Create the context used to parse components whose parsing is
+	  * deferred until they are accessed, which may happen in any thread.
+	  * It is a copy of the specified context, without its memory arena
+	  * as an arena must not be used by several threads at the same time.
+	  *
+	  * @param ctx context used for parsing the enclosing component
+	  * @return context for deferred parsing
+	  */
+	static shared_ptr <parsingContext> createDeferredParsingContext(const parsingContext& ctx);
+
+	/** Test whether two components refer to the same range of the
+	  * same parsed data.
+	  *
+	  * @param a first component
+	  * @param b second component
+	  * @return true if both components have a reference to the same
+	  * parsed data, at the same position
+	  */
+	static bool haveSameParsedData(const component& a, const component& b);
+
 	// AT LEAST ONE of these parseImpl() functions MUST be implemented in derived class
 	virtual void parseImpl(
 		parsingContext& ctx,
@@ -256,6 +361,8 @@ private:
 
 	size_t m_parsedOffset;
 	size_t m_parsedLength;
+
+	shared_ptr <utility::parserInputStreamAdapter> m_parsedData;
 };
 
 
@@ -31,9 +31,43 @@ namespace vmime {
 const encoding contentHandler::NO_ENCODING(encodingTypes::BINARY);
 
 
+contentHandler::contentHandler()
+	: m_modificationCount(0) {
+
+}
+
+
 contentHandler::~contentHandler() {
 
 }
 
 
+shared_ptr <const utility::textStatistics> contentHandler::getStatistics() const {
+
+	if (!m_statistics && isBuffered()) {
+
+		shared_ptr <utility::textStatistics> stats = make_shared <utility::textStatistics>();
+
+		extract(*stats);
+
+		m_statistics = stats;
+	}
+
+	return m_statistics;
+}
+
+
+unsigned int contentHandler::getModificationCount() const {
+
+	return m_modificationCount;
+}
+
+
+void contentHandler::dataChanged() {
+
+	m_statistics = null;
+	++m_modificationCount;
+}
+
+
 } // vmime
@@ -29,6 +29,7 @@
 
 #include "vmime/base.hpp"
 #include "vmime/utility/progressListener.hpp"
+#include "vmime/utility/textStatistics.hpp"
 #include "vmime/encoding.hpp"
 #include "vmime/mediaType.hpp"
 
@@ -44,6 +45,7 @@ public:
 	static const vmime::encoding NO_ENCODING;
 
 
+	contentHandler();
 	virtual ~contentHandler();
 
 	/** Return a copy of this object.
@@ -138,6 +140,37 @@ public:
 	  * @return type content media type
 	  */
 	virtual const mediaType getContentTypeHint() const = 0;
+
+	/** Returns statistics about the contents (after decoding), which
+	  * are used to choose a suitable encoding. They are computed in a
+	  * single pass over the data the first time this method is called,
+	  * and kept until the data is changed.
+	  *
+	  * @return statistics about the contents, or NULL if the data cannot
+	  * be extracted multiple times (see isBuffered())
+	  */
+	shared_ptr <const utility::textStatistics> getStatistics() const;
+
+	/** Returns a counter which is incremented each time the data
+	  * managed by this object is changed. This can be used to detect
+	  * whether information computed from the data is still valid.
+	  *
+	  * @return modification count
+	  */
+	unsigned int getModificationCount() const;
+
+protected:
+
+	/** Discards the statistics computed by getStatistics() and
+	  * increments the modification count. This must be called by
+	  * implementations when the data is changed.
+	  */
+	void dataChanged();
+
+private:
+
+	mutable shared_ptr <const utility::textStatistics> m_statistics;
+	unsigned int m_modificationCount;
 };
 
 
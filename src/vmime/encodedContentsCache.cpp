@@ -0,0 +1,113 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/encodedContentsCache.hpp"
+
+
+namespace vmime {
+
+
+encodedContentsCache::encodedContentsCache()
+	: m_dataSize(0) {
+
+}
+
+
+encodedContentsCache::~encodedContentsCache() {
+
+}
+
+
+shared_ptr <const string> encodedContentsCache::find(
+	const shared_ptr <const contentHandler>& contents,
+	const encoding& enc,
+	const size_t maxLineLength,
+	const mediaType& type
+) const {
+
+	std::map <const contentHandler*, entry>::const_iterator it = m_entries.find(contents.get());
+
+	if (it == m_entries.end()) {
+		return null;
+	}
+
+	const entry& e = it->second;
+
+	if (e.modificationCount != contents->getModificationCount() ||
+	    e.enc != enc ||
+	    e.maxLineLength != maxLineLength ||
+	    e.type != type) {
+
+		return null;
+	}
+
+	return e.data;
+}
+
+
+void encodedContentsCache::store(
+	const shared_ptr <const contentHandler>& contents,
+	const encoding& enc,
+	const size_t maxLineLength,
+	const mediaType& type,
+	const shared_ptr <const string>& data
+) {
+
+	entry& e = m_entries[contents.get()];
+
+	if (e.data) {
+		m_dataSize -= e.data->length();
+	}
+
+	e.contents = contents;
+	e.modificationCount = contents->getModificationCount();
+	e.enc = enc;
+	e.maxLineLength = maxLineLength;
+	e.type = type;
+	e.data = data;
+
+	m_dataSize += data->length();
+}
+
+
+void encodedContentsCache::clear() {
+
+	m_entries.clear();
+	m_dataSize = 0;
+}
+
+
+size_t encodedContentsCache::getEntryCount() const {
+
+	return m_entries.size();
+}
+
+
+size_t encodedContentsCache::getDataSize() const {
+
+	return m_dataSize;
+}
+
+
+} // vmime
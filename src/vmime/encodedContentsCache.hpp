@@ -0,0 +1,129 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_ENCODEDCONTENTSCACHE_HPP_INCLUDED
+#define VMIME_ENCODEDCONTENTSCACHE_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+#include "vmime/contentHandler.hpp"
+#include "vmime/encoding.hpp"
+#include "vmime/mediaType.hpp"
+
+#include <map>
+
+
+namespace vmime {
+
+
+/** Keeps the encoded form of body contents, so that contents are encoded
+  * only once when a message is generated more than once (for example, to
+  * compute its exact size before sending it).
+  *
+  * A cache is enabled by setting it on the generation context (see
+  * generationContext::setEncodedContentsCache()). The encoded contents
+  * are then kept in memory until the cache is cleared or destroyed.
+  *
+  * Entries are identified by the content handler; an entry is not used
+  * anymore if the data of the content handler is changed (see
+  * contentHandler::getModificationCount()), or if the encoding, maximum
+  * line length or content type used for generation are different.
+  */
+class VMIME_EXPORT encodedContentsCache : public object {
+
+public:
+
+	encodedContentsCache();
+	~encodedContentsCache();
+
+	/** Find the encoded form of some contents.
+	  *
+	  * @param contents content handler
+	  * @param enc encoding used for generation
+	  * @param maxLineLength maximum line length used for generation
+	  * @param type content type hint used for generation
+	  * @return encoded contents, or NULL if not in the cache
+	  */
+	shared_ptr <const string> find(
+		const shared_ptr <const contentHandler>& contents,
+		const encoding& enc,
+		const size_t maxLineLength,
+		const mediaType& type
+	) const;
+
+	/** Store the encoded form of some contents, replacing any previous
+	  * entry for the same content handler.
+	  *
+	  * @param contents content handler
+	  * @param enc encoding used for generation
+	  * @param maxLineLength maximum line length used for generation
+	  * @param type content type hint used for generation
+	  * @param data encoded contents
+	  */
+	void store(
+		const shared_ptr <const contentHandler>& contents,
+		const encoding& enc,
+		const size_t maxLineLength,
+		const mediaType& type,
+		const shared_ptr <const string>& data
+	);
+
+	/** Remove all entries from the cache.
+	  */
+	void clear();
+
+	/** Return the number of entries in the cache.
+	  *
+	  * @return number of entries
+	  */
+	size_t getEntryCount() const;
+
+	/** Return the total number of bytes of encoded contents
+	  * kept in the cache.
+	  *
+	  * @return number of bytes
+	  */
+	size_t getDataSize() const;
+
+private:
+
+	struct entry {
+
+		shared_ptr <const contentHandler> contents;  // keeps the key pointer valid
+		unsigned int modificationCount;
+		encoding enc;
+		size_t maxLineLength;
+		mediaType type;
+		shared_ptr <const string> data;
+	};
+
+	std::map <const contentHandler*, entry> m_entries;
+	size_t m_dataSize;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_ENCODEDCONTENTSCACHE_HPP_INCLUDED
@@ -24,11 +24,8 @@
 #include "vmime/encoding.hpp"
 #include "vmime/contentHandler.hpp"
 
-#include "vmime/utility/outputStreamStringAdapter.hpp"
 #include "vmime/utility/encoder/encoderFactory.hpp"
 
-#include <algorithm>
-
 
 namespace vmime {
 
@@ -150,53 +147,30 @@ bool encoding::operator!=(const encoding& value) const {
 }
 
 
-const encoding encoding::decideImpl(
-	const string::const_iterator begin,
-	const string::const_iterator end
-) {
+const encoding encoding::decideImpl(const utility::textStatistics& stats) {
 
-	const string::difference_type length = end - begin;
-	const string::difference_type count = std::count_if(
-		begin, end, [](unsigned char x) { return x <= 127; });
+	const size_t length = stats.getLength();
+	const size_t nonASCIICount = stats.getNonASCIICount();
 
 	// All is in 7-bit US-ASCII --> 7-bit (or Quoted-Printable...)
-	if (length == count) {
+	if (nonASCIICount == 0) {
 
 		// Now, we check if there is any line with more than
-		// "lineLengthLimits::convenient" characters (7-bit requires that)
-		string::const_iterator p = begin;
-
-		const size_t maxLen = lineLengthLimits::convenient;
-		size_t len = 0;
-
-		for ( ; p != end && len <= maxLen ; ) {
-
-			if (*p == '\n') {
-
-				len = 0;
-				++p;
-
-				// May or may not need to be encoded, we don't take
-				// any risk (avoid problems with SMTP)
-				if (p != end && *p == '.') {
-					len = maxLen + 1;
-				}
+		// "lineLengthLimits::convenient" characters (7-bit requires that).
+		// A dot at the beginning of a line may or may not need to be
+		// encoded, we don't take any risk (avoid problems with SMTP)
+		if (stats.getMaxLineLength() > lineLengthLimits::convenient ||
+		    stats.hasDotAtLineStart()) {
 
-			} else {
-
-				++len;
-				++p;
-			}
-		}
-
-		if (len > maxLen) {
 			return encoding(encodingTypes::QUOTED_PRINTABLE);
+
 		} else {
+
 			return encoding(encodingTypes::SEVEN_BIT);
 		}
 
 	// Less than 20% non US-ASCII --> Quoted-Printable
-	} else if ((length - count) <= length / 5) {
+	} else if (nonASCIICount <= length / 5) {
 
 		return encoding(encodingTypes::QUOTED_PRINTABLE);
 
@@ -233,17 +207,17 @@ const encoding encoding::decide(
 
 	encoding enc;
 
-	if (usage == USAGE_TEXT && data->isBuffered() &&
-	    data->getLength() > 0 && data->getLength() < 32768) {
+	// Statistics are computed in a single pass over the data, and
+	// cached by the content handler
+	shared_ptr <const utility::textStatistics> stats;
 
-		// Extract data into temporary buffer
-		string buffer;
-		utility::outputStreamStringAdapter os(buffer);
+	if (usage == USAGE_TEXT && !data->isEmpty()) {
+		stats = data->getStatistics();
+	}
 
-		data->extract(os);
-		os.flush();
+	if (stats) {
 
-		enc = decideImpl(buffer.begin(), buffer.end());
+		enc = decideImpl(*stats);
 
 	} else {
 
@@ -29,6 +29,7 @@
 #include "vmime/headerFieldValue.hpp"
 
 #include "vmime/utility/encoder/encoder.hpp"
+#include "vmime/utility/textStatistics.hpp"
 
 
 namespace vmime {
@@ -140,19 +141,12 @@ private:
 	  */
 	bool shouldReencode() const;
 
-	/** Decide which encoding to use based on the specified data.
-	  *
-	  * Please note: this will read the whole buffer, so it should be used only
-	  * for small amount of data (eg. text), and not large binary attachments.
+	/** Decide which encoding to use based on statistics about the data.
 	  *
-	  * @param begin start iterator in buffer
-	  * @param end end iterator in buffer
+	  * @param stats statistics about the data
 	  * @return suitable encoding for specified data
 	  */
-	static const encoding decideImpl(
-		const string::const_iterator begin,
-		const string::const_iterator end
-	);
+	static const encoding decideImpl(const utility::textStatistics& stats);
 
 protected:
 
@@ -44,7 +44,8 @@ generationContext::generationContext(const generationContext& ctx)
 	  m_prologText(ctx.m_prologText),
 	  m_epilogText(ctx.m_epilogText),
 	  m_wrapMessageId(ctx.m_wrapMessageId),
-	  m_paramValueMode(ctx.m_paramValueMode) {
+	  m_paramValueMode(ctx.m_paramValueMode),
+	  m_encodedContentsCache(ctx.m_encodedContentsCache) {
 
 }
 
@@ -118,6 +119,18 @@ generationContext::EncodedParameterValueModes
 }
 
 
+void generationContext::setEncodedContentsCache(const shared_ptr <encodedContentsCache>& cache) {
+
+	m_encodedContentsCache = cache;
+}
+
+
+shared_ptr <encodedContentsCache> generationContext::getEncodedContentsCache() const {
+
+	return m_encodedContentsCache;
+}
+
+
 generationContext& generationContext::operator=(const generationContext& ctx) {
 
 	copyFrom(ctx);
@@ -133,6 +146,7 @@ void generationContext::copyFrom(const generationContext& ctx) {
 	m_prologText = ctx.m_prologText;
 	m_epilogText = ctx.m_epilogText;
 	m_paramValueMode = ctx.m_paramValueMode;
+	m_encodedContentsCache = ctx.m_encodedContentsCache;
 }
 
 
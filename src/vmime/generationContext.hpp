@@ -31,6 +31,9 @@
 namespace vmime {
 
 
+class encodedContentsCache;
+
+
 /** Holds configuration parameters used for generating messages.
   */
 class VMIME_EXPORT generationContext : public context {
@@ -144,6 +147,25 @@ public:
 	  */
 	EncodedParameterValueModes getEncodedParameterValueMode() const;
 
+	/** Sets the cache used to keep the encoded form of body contents
+	  * ("encode-once" mode). When a cache is set, contents are encoded
+	  * the first time they are generated, and the encoded data is reused
+	  * each time the same contents are generated again with this context
+	  * (or a copy of it). This is useful, for example, to compute the
+	  * exact size of a message before sending it, without encoding its
+	  * contents twice (see component::getExactGeneratedSize()).
+	  *
+	  * @param cache encoded contents cache, or NULL to disable
+	  * caching (this is the default)
+	  */
+	void setEncodedContentsCache(const shared_ptr <encodedContentsCache>& cache);
+
+	/** Returns the cache used to keep the encoded form of body contents.
+	  *
+	  * @return encoded contents cache, or NULL if caching is disabled
+	  */
+	shared_ptr <encodedContentsCache> getEncodedContentsCache() const;
+
 	/** Returns the default context used for generating messages.
 	  *
 	  * @return a reference to the default generation context
@@ -162,6 +184,8 @@ protected:
 	bool m_wrapMessageId;
 
 	EncodedParameterValueModes m_paramValueMode;
+
+	shared_ptr <encodedContentsCache> m_encodedContentsCache;
 };
 
 
@@ -24,6 +24,9 @@
 #include "vmime/header.hpp"
 #include "vmime/parserHelpers.hpp"
 
+#include "vmime/utility/scanUtils.hpp"
+#include "vmime/utility/seekableInputStream.hpp"
+
 #include <algorithm>
 #include <iterator>
 
@@ -61,6 +64,34 @@ field-body-contents =
 		 specials tokens, or else consisting of texts>
 */
 
+void header::parseImpl(
+	parsingContext& ctx,
+	const shared_ptr <utility::parserInputStreamAdapter>& parser,
+	const size_t position,
+	const size_t end,
+	size_t* newPosition
+) {
+
+	component::parseImpl(ctx, parser, position, end, newPosition);
+
+	if (ctx.getRetainParsedData()) {
+		retainParsedData(parser);
+	}
+}
+
+
+void header::retainParsedData(const shared_ptr <utility::parserInputStreamAdapter>& source) {
+
+	component::retainParsedData(source);
+
+	for (std::vector <shared_ptr <headerField> >::iterator it = m_fields.begin() ;
+	     it != m_fields.end() ; ++it) {
+
+		(*it)->retainParsedData(source);
+	}
+}
+
+
 void header::parseImpl(
 	parsingContext& ctx,
 	const string& buffer,
@@ -73,12 +104,22 @@ void header::parseImpl(
 
 	removeAllFields();
 
+	// Context shared by all fields whose value parsing is deferred
+	shared_ptr <parsingContext> lazyCtx;
+
+	if (ctx.getLazyHeaderFieldParsing()) {
+		lazyCtx = createDeferredParsingContext(ctx);
+	}
+
 	while (pos < end) {
 
-		shared_ptr <headerField> field = headerField::parseNext(ctx, buffer, pos, end, &pos);
+		shared_ptr <headerField> field =
+			headerField::parseNext(ctx, lazyCtx, buffer, pos, end, &pos);
+
 		if (!field) break;
 
 		m_fields.push_back(field);
+		indexField(field);
 	}
 
 	setParsedBounds(position, pos);
@@ -89,6 +130,113 @@ void header::parseImpl(
 }
 
 
+size_t header::parseFromStream(utility::inputStream& is) {
+
+	return parseFromStream(parsingContext::getDefaultContext(), is);
+}
+
+
+size_t header::parseFromStream(parsingContext& ctx, utility::inputStream& is) {
+
+	utility::seekableInputStream* sis = dynamic_cast <utility::seekableInputStream*>(&is);
+
+	const size_t startPos = sis ? sis->getPosition() : 0;
+
+	// Without the possibility to seek back, we must not read
+	// any byte past the separator
+	byte_t buffer[4096];
+	const size_t blockSize = sis ? sizeof(buffer) : 1;
+
+	string contents;
+	contents.reserve(blockSize == 1 ? 1024 : sizeof(buffer));
+
+	size_t bodyPos = npos;
+	size_t scanPos = 0;
+
+	while (bodyPos == npos && !is.eof()) {
+
+		const size_t read = is.read(buffer, blockSize);
+
+		if (read == 0) {
+			break;
+		}
+
+		utility::stringUtils::appendBytesToString(contents, buffer, read);
+
+		const byte_t* data = reinterpret_cast <const byte_t*>(contents.data());
+		const size_t length = contents.length();
+
+		// Empty header: body starts immediately
+		if (scanPos == 0) {
+
+			if (data[0] == '\n') {
+				bodyPos = 1;
+				break;
+			} else if (data[0] == '\r') {
+
+				if (length < 2) {
+					continue;
+				} else if (data[1] == '\n') {
+					bodyPos = 2;
+					break;
+				}
+			}
+		}
+
+		// Only scan the newly-read data, plus the last end of
+		// line which may not have been complete yet
+		while (scanPos < length) {
+
+			const size_t lf = utility::scanUtils::findByte(data + scanPos, length - scanPos, '\n');
+
+			if (lf == npos) {
+				scanPos = length;
+				break;
+			}
+
+			const size_t pos = scanPos + lf;
+
+			if (pos + 1 >= length) {
+				scanPos = pos;
+				break;
+			} else if (data[pos + 1] == '\n') {
+				bodyPos = pos + 2;
+				break;
+			} else if (data[pos + 1] == '\r') {
+
+				if (pos + 2 >= length) {
+					scanPos = pos;
+					break;
+				} else if (data[pos + 2] == '\n') {
+					bodyPos = pos + 3;
+					break;
+				}
+			}
+
+			scanPos = pos + 1;
+		}
+	}
+
+	if (bodyPos == npos) {
+
+		bodyPos = contents.length();
+
+	} else if (bodyPos < contents.length()) {
+
+		// We have read too far: go back to the beginning of the body
+		contents.erase(bodyPos);
+
+		if (sis) {
+			sis->seek(startPos + bodyPos);
+		}
+	}
+
+	parseImpl(ctx, contents, 0, contents.length(), NULL);
+
+	return bodyPos;
+}
+
+
 void header::generateImpl(
 	const generationContext& ctx,
 	utility::outputStream& os,
@@ -100,8 +248,24 @@ void header::generateImpl(
 	for (std::vector <shared_ptr <headerField> >::const_iterator it = m_fields.begin() ;
 	     it != m_fields.end() ; ++it) {
 
-		(*it)->generate(ctx, os);
-		os << CRLF;
+		const headerField& field = **it;
+
+		if (field.isParsedDataReusable()) {
+
+			// Parsed data includes the line break(s) after the field,
+			// unless it was at the very end of the data
+			size_t pos = 0;
+			field.copyParsedData(os, &pos);
+
+			if (pos != 0) {
+				os << CRLF;
+			}
+
+		} else {
+
+			field.generate(ctx, os);
+			os << CRLF;
+		}
 	}
 
 	if (newLinePos) {
@@ -128,6 +292,8 @@ shared_ptr <component> header::clone() const {
 		hdr->m_fields.push_back(vmime::clone(*it));
 	}
 
+	hdr->rebuildIndex();
+
 	return hdr;
 }
 
@@ -146,10 +312,19 @@ void header::copyFrom(const component& other) {
 		fields.push_back(vmime::clone(*it));
 	}
 
+	for (std::vector <shared_ptr <headerField> >::const_iterator it = m_fields.begin() ;
+	     it != m_fields.end() ; ++it) {
+
+		detachField(*it);
+	}
+
 	m_fields.clear();
 	m_fields.resize(fields.size());
 
 	std::copy(fields.begin(), fields.end(), m_fields.begin());
+
+	rebuildIndex();
+	copyParsedDataFrom(h);
 }
 
 
@@ -162,82 +337,84 @@ header& header::operator=(const header& other) {
 
 bool header::hasField(const string& fieldName) const {
 
-	std::vector <shared_ptr <headerField> >::const_iterator pos =
-		std::find_if(
-			m_fields.begin(), m_fields.end(),
-			fieldHasName(utility::stringUtils::toLower(fieldName))
-		);
+	return hasField(fieldKey(fieldName));
+}
+
+
+bool header::hasField(const fieldKey& key) const {
 
-	return pos != m_fields.end();
+	return lookupFields(key) != NULL;
 }
 
 
 shared_ptr <headerField> header::findField(const string& fieldName) const {
 
-	// Find the first field that matches the specified name
-	std::vector <shared_ptr <headerField> >::const_iterator pos =
-		std::find_if(
-			m_fields.begin(), m_fields.end(),
-			fieldHasName(utility::stringUtils::toLower(fieldName))
-		);
+	return findField(fieldKey(fieldName));
+}
+
+
+shared_ptr <headerField> header::findField(const fieldKey& key) const {
+
+	const std::vector <shared_ptr <headerField> >* fields = lookupFields(key);
 
 	// No field with this name can be found
-	if (pos == m_fields.end()) {
+	if (!fields) {
 		return null;
 	}
 
-	// Else, return a reference to the existing field
-	return *pos;
+	// Else, return a reference to the first field
+	return fields->front();
 }
 
 
 std::vector <shared_ptr <headerField> > header::findAllFields(const string& fieldName) {
 
-	std::vector <shared_ptr <headerField> > result;
-	std::back_insert_iterator <std::vector <shared_ptr <headerField> > > back(result);
+	return findAllFields(fieldKey(fieldName));
+}
+
 
-	std::remove_copy_if(
-		m_fields.begin(), m_fields.end(), back,
-		fieldHasNotName(utility::stringUtils::toLower(fieldName))
-	);
+std::vector <shared_ptr <headerField> > header::findAllFields(const fieldKey& key) {
+
+	const std::vector <shared_ptr <headerField> >* fields = lookupFields(key);
+
+	if (!fields) {
+		return std::vector <shared_ptr <headerField> >();
+	}
 
-	return result;
+	return *fields;
 }
 
 
 shared_ptr <headerField> header::getField(const string& fieldName) {
 
-	const string name = utility::stringUtils::toLower(fieldName);
+	return getField(fieldKey(fieldName));
+}
 
-	// Find the first field that matches the specified name
-	std::vector <shared_ptr <headerField> >::const_iterator pos = m_fields.begin();
-	const std::vector <shared_ptr <headerField> >::const_iterator end = m_fields.end();
 
-	while (pos != end && utility::stringUtils::toLower((*pos)->getName()) != name) {
-		++pos;
-	}
+shared_ptr <headerField> header::getField(const fieldKey& key) {
+
+	shared_ptr <headerField> field = findField(key);
 
 	// If no field with this name can be found, create a new one
-	if (pos == end) {
+	if (!field) {
 
-		shared_ptr <headerField> field = headerFieldFactory::getInstance()->create(fieldName);
+		field = headerFieldFactory::getInstance()->create(key.getName());
 
 		appendField(field);
-
-		// Return a reference to the new field
-		return (field);
-
-	// Else, return a reference to the existing field
-	} else {
-
-		return *pos;
 	}
+
+	return field;
 }
 
 
 void header::appendField(const shared_ptr <headerField>& field) {
 
+	attachField(field);
+
 	m_fields.push_back(field);
+
+	indexField(field);
+	discardParsedData();
 }
 
 
@@ -253,13 +430,23 @@ void header::insertFieldBefore(
 		throw exceptions::no_such_field();
 	}
 
+	attachField(field);
+
 	m_fields.insert(it, field);
+
+	reindexFields(fieldKey(field->getName()));
+	discardParsedData();
 }
 
 
 void header::insertFieldBefore(const size_t pos, const shared_ptr <headerField>& field) {
 
+	attachField(field);
+
 	m_fields.insert(m_fields.begin() + pos, field);
+
+	reindexFields(fieldKey(field->getName()));
+	discardParsedData();
 }
 
 
@@ -275,13 +462,23 @@ void header::insertFieldAfter(
 		throw exceptions::no_such_field();
 	}
 
+	attachField(field);
+
 	m_fields.insert(it + 1, field);
+
+	reindexFields(fieldKey(field->getName()));
+	discardParsedData();
 }
 
 
 void header::insertFieldAfter(const size_t pos, const shared_ptr <headerField>& field) {
 
+	attachField(field);
+
 	m_fields.insert(m_fields.begin() + pos + 1, field);
+
+	reindexFields(fieldKey(field->getName()));
+	discardParsedData();
 }
 
 
@@ -295,14 +492,25 @@ void header::removeField(const shared_ptr <headerField>& field) {
 	}
 
 	m_fields.erase(it);
+
+	unindexField(field, fieldKey(field->getName()));
+	detachField(field);
+
+	discardParsedData();
 }
 
 
 void header::removeField(const size_t pos) {
 
 	const std::vector <shared_ptr <headerField> >::iterator it = m_fields.begin() + pos;
+	const shared_ptr <headerField> field = *it;
 
 	m_fields.erase(it);
+
+	unindexField(field, fieldKey(field->getName()));
+	detachField(field);
+
+	discardParsedData();
 }
 
 
@@ -318,7 +526,16 @@ void header::replaceField(
 
 void header::removeAllFields() {
 
+	for (std::vector <shared_ptr <headerField> >::const_iterator it = m_fields.begin() ;
+	     it != m_fields.end() ; ++it) {
+
+		detachField(*it);
+	}
+
 	m_fields.clear();
+	m_index.clear();
+
+	discardParsedData();
 }
 
 
@@ -378,6 +595,24 @@ const std::vector <shared_ptr <headerField> > header::getFieldList() {
 }
 
 
+bool header::isParsedDataReusable() const {
+
+	if (!hasParsedData()) {
+		return false;
+	}
+
+	for (std::vector <shared_ptr <headerField> >::const_iterator it = m_fields.begin() ;
+	     it != m_fields.end() ; ++it) {
+
+		if (!(*it)->isParsedDataReusable()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 const std::vector <shared_ptr <component> > header::getChildComponents() {
 
 	std::vector <shared_ptr <component> > list;
@@ -389,28 +624,151 @@ const std::vector <shared_ptr <component> > header::getChildComponents() {
 
 
 
-// Field search
+// Field index
+
+
+header::fieldKey::fieldKey(const string& name)
+	: m_name(name),
+	  m_foldedName(utility::stringUtils::toLower(name)),
+	  m_hash(std::hash <string>()(m_foldedName)) {
+
+}
+
+
+const string& header::fieldKey::getName() const {
+
+	return m_name;
+}
+
+
+const string& header::fieldKey::getFoldedName() const {
+
+	return m_foldedName;
+}
 
 
-header::fieldHasName::fieldHasName(const string& name)
-	: m_name(name) {
+size_t header::fieldKey::getHash() const {
 
+	return m_hash;
 }
 
-bool header::fieldHasName::operator() (const shared_ptr <const headerField>& field) {
 
-	return utility::stringUtils::toLower(field->getName()) == m_name;
+bool header::fieldKey::operator==(const fieldKey& other) const {
+
+	return m_hash == other.m_hash && m_foldedName == other.m_foldedName;
 }
 
 
-header::fieldHasNotName::fieldHasNotName(const string& name)
-	: m_name(name) {
+const std::vector <shared_ptr <headerField> >* header::lookupFields(const fieldKey& key) const {
+
+	FieldIndex::const_iterator it = m_index.find(key);
+
+	if (it == m_index.end()) {
+		return NULL;
+	}
 
+	return &it->second;
 }
 
-bool header::fieldHasNotName::operator() (const shared_ptr <const headerField>& field) {
 
-	return utility::stringUtils::toLower(field->getName()) != m_name;
+void header::rebuildIndex() {
+
+	m_index.clear();
+
+	for (std::vector <shared_ptr <headerField> >::const_iterator it = m_fields.begin() ;
+	     it != m_fields.end() ; ++it) {
+
+		indexField(*it);
+	}
+}
+
+
+void header::reindexFields(const fieldKey& key) {
+
+	// Collect the fields with this name, in document order
+	std::vector <shared_ptr <headerField> > fields;
+
+	for (std::vector <shared_ptr <headerField> >::const_iterator it = m_fields.begin() ;
+	     it != m_fields.end() ; ++it) {
+
+		if (fieldKey((*it)->getName()) == key) {
+			fields.push_back(*it);
+		}
+	}
+
+	if (fields.empty()) {
+		m_index.erase(key);
+	} else {
+		m_index[key].swap(fields);
+	}
+}
+
+
+void header::indexField(const shared_ptr <headerField>& field) {
+
+	field->m_header = this;
+
+	m_index[fieldKey(field->getName())].push_back(field);
+}
+
+
+void header::unindexField(const shared_ptr <headerField>& field, const fieldKey& key) {
+
+	FieldIndex::iterator it = m_index.find(key);
+
+	if (it == m_index.end()) {
+		return;
+	}
+
+	std::vector <shared_ptr <headerField> >& fields = it->second;
+	std::vector <shared_ptr <headerField> >::iterator pos =
+		std::find(fields.begin(), fields.end(), field);
+
+	if (pos != fields.end()) {
+
+		fields.erase(pos);
+
+		if (fields.empty()) {
+			m_index.erase(it);
+		}
+	}
+}
+
+
+void header::attachField(const shared_ptr <headerField>& field) {
+
+	// A field belongs to one header only: remove it from the header it
+	// was previously added to, so that its index stays consistent
+	if (field->m_header && field->m_header != this) {
+		field->m_header->removeField(field);
+	}
+
+	field->m_header = this;
+}
+
+
+void header::detachField(const shared_ptr <headerField>& field) {
+
+	// The field may still be in this header, if it was added several times
+	if (field->m_header == this &&
+	    std::find(m_fields.begin(), m_fields.end(), field) == m_fields.end()) {
+
+		field->m_header = NULL;
+	}
+}
+
+
+void header::renameField(const headerField& field, const string& oldName) {
+
+	const fieldKey oldKey(oldName);
+	const fieldKey newKey(field.getName());
+
+	if (oldKey == newKey) {
+		return;
+	}
+
+	reindexFields(oldKey);
+	reindexFields(newKey);
 }
 
 
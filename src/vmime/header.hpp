@@ -32,6 +32,8 @@
 #include "vmime/headerField.hpp"
 #include "vmime/headerFieldFactory.hpp"
 
+#include <unordered_map>
+
 
 namespace vmime {
 
@@ -46,15 +48,74 @@ class VMIME_EXPORT header : public component {
 	friend class bodyPart;
 	friend class body;
 	friend class message;
+	friend class headerField;
 
 public:
 
 	header();
 	~header();
 
+
+	/** A field name used as a lookup key. The name is case-folded and
+	  * hashed once, so that a key for a frequently used name (such as
+	  * the ones in the vmime::fields namespace) can be reused for
+	  * any number of lookups.
+	  */
+	class VMIME_EXPORT fieldKey {
+
+	public:
+
+		/** Construct a key for the specified field name.
+		  *
+		  * @param name field name (eg: "X-Mailer" or "From")
+		  */
+		explicit fieldKey(const string& name);
+
+		/** Return the field name, as specified when the key was created.
+		  *
+		  * @return field name
+		  */
+		const string& getName() const;
+
+		/** Return the case-folded field name.
+		  *
+		  * @return field name, in lower case
+		  */
+		const string& getFoldedName() const;
+
+		/** Return the hash of the case-folded field name.
+		  *
+		  * @return hash value
+		  */
+		size_t getHash() const;
+
+		bool operator==(const fieldKey& other) const;
+
+		struct hasher {
+
+			size_t operator()(const fieldKey& key) const {
+
+				return key.getHash();
+			}
+		};
+
+	private:
+
+		string m_name;
+		string m_foldedName;
+		size_t m_hash;
+	};
+
+
 #define FIELD_ACCESS(methodName, fieldName) \
-	shared_ptr <headerField> methodName() { return getField(fields::fieldName); } \
-	shared_ptr <const headerField> methodName() const { return findField(fields::fieldName); }
+	shared_ptr <headerField> methodName() { \
+		static const fieldKey key(fields::fieldName); \
+		return getField(key); \
+	} \
+	shared_ptr <const headerField> methodName() const { \
+		static const fieldKey key(fields::fieldName); \
+		return findField(key); \
+	}
 
 	FIELD_ACCESS(From,                         FROM)
 	FIELD_ACCESS(Sender,                       SENDER)
@@ -95,6 +156,14 @@ public:
 	  */
 	bool hasField(const string& fieldName) const;
 
+	/** Checks whether (at least) one field with this name exists.
+	  *
+	  * @param key key for the field name
+	  * @return true if at least one field with the specified name
+	  * exists, or false otherwise
+	  */
+	bool hasField(const fieldKey& key) const;
+
 	/** Find the first field that matches the specified name.
 	  * Field name is case-insensitive.
 	  * If no field is found, NULL is returned.
@@ -106,6 +175,15 @@ public:
 	  */
 	shared_ptr <headerField> findField(const string& fieldName) const;
 
+	/** Find the first field that matches the specified name.
+	  * If no field is found, NULL is returned.
+	  *
+	  * @param key key for the name of the field to return
+	  * @return first field with the specified name, or NULL if no field
+	  * with this name was found
+	  */
+	shared_ptr <headerField> findField(const fieldKey& key) const;
+
 	/** Find the first field that matches the specified name,
 	  * casted to the specified field type. Field name is case-insensitive.
 	  * If no field is found, or the field is not of the specified type,
@@ -155,6 +233,14 @@ public:
 	  */
 	std::vector <shared_ptr <headerField> > findAllFields(const string& fieldName);
 
+	/** Find all fields that match the specified name.
+	  * If no field is found, an empty vector is returned.
+	  *
+	  * @param key key for the name of the fields to return
+	  * @return list of fields with the specified name
+	  */
+	std::vector <shared_ptr <headerField> > findAllFields(const fieldKey& key);
+
 	/** Find the first field that matches the specified name.
 	  * If no field is found, one will be created and inserted into
 	  * the header.
@@ -166,6 +252,16 @@ public:
 	  */
 	shared_ptr <headerField> getField(const string& fieldName);
 
+	/** Find the first field that matches the specified name.
+	  * If no field is found, one will be created and inserted into
+	  * the header.
+	  *
+	  * @param key key for the name of the field to return
+	  * @return first field with the specified name or a new field
+	  * if no field is found
+	  */
+	shared_ptr <headerField> getField(const fieldKey& key);
+
 	/** Find the first field that matches the specified name,
 	  * casted to the specified type.
 	  * If no field is found, one will be created and inserted into
@@ -181,6 +277,9 @@ public:
 	}
 
 	/** Add a field at the end of the list.
+	  * A field belongs to only one header at a time: if it has been
+	  * added to another header, it is removed from it (this also
+	  * applies to the functions which insert a field).
 	  *
 	  * @param field field to append
 	  */
@@ -299,6 +398,31 @@ public:
 	  */
 	const std::vector <shared_ptr <headerField> > getFieldList();
 
+	/** Parse the header from a stream, stopping at the blank line
+	  * which separates the header from the body. Nothing after the
+	  * separator is consumed: if the stream is seekable, it is left
+	  * positioned at the first byte of the body; otherwise, it is
+	  * read byte by byte so as not to read past the separator.
+	  *
+	  * @param ctx parsing context
+	  * @param is input stream, positioned at the beginning of the header
+	  * @return offset of the body, relative to the initial position
+	  * of the stream (ie. length of the header, including the
+	  * separator), or the number of bytes read if the stream
+	  * ended before a separator was found
+	  */
+	size_t parseFromStream(parsingContext& ctx, utility::inputStream& is);
+
+	/** Parse the header from a stream, stopping at the blank line
+	  * which separates the header from the body.
+	  * See parseFromStream(parsingContext&, utility::inputStream&).
+	  *
+	  * @param is input stream, positioned at the beginning of the header
+	  * @return offset of the body, relative to the initial position
+	  * of the stream
+	  */
+	size_t parseFromStream(utility::inputStream& is);
+
 	shared_ptr <component> clone() const;
 	void copyFrom(const component& other);
 	header& operator=(const header& other);
@@ -307,38 +431,46 @@ public:
 
 	size_t getGeneratedSize(const generationContext& ctx);
 
+	bool isParsedDataReusable() const;
+
 private:
 
 	std::vector <shared_ptr <headerField> > m_fields;
 
+	typedef std::unordered_map <
+		fieldKey,
+		std::vector <shared_ptr <headerField> >,
+		fieldKey::hasher
+	> FieldIndex;
 
-	class fieldHasName {
-
-	public:
-
-		fieldHasName(const string& name);
-		bool operator() (const shared_ptr <const headerField>& field);
-
-	private:
-
-		string m_name;
-	};
+	// Fields by case-folded name, in document order. It is updated
+	// each time the list of fields changes (or a field is renamed),
+	// so that lookups never modify the header
+	FieldIndex m_index;
 
-	class fieldHasNotName {
+	const std::vector <shared_ptr <headerField> >* lookupFields(const fieldKey& key) const;
 
-	public:
+	void rebuildIndex();
+	void reindexFields(const fieldKey& key);
 
-		fieldHasNotName(const string& name);
-		bool operator() (const shared_ptr <const headerField>& field);
+	void indexField(const shared_ptr <headerField>& field);
+	void unindexField(const shared_ptr <headerField>& field, const fieldKey& key);
 
-	private:
-
-		string m_name;
-	};
+	void attachField(const shared_ptr <headerField>& field);
+	void detachField(const shared_ptr <headerField>& field);
+	void renameField(const headerField& field, const string& oldName);
 
 protected:
 
 	// Component parsing & assembling
+	void parseImpl(
+		parsingContext& ctx,
+		const shared_ptr <utility::parserInputStreamAdapter>& parser,
+		const size_t position,
+		const size_t end,
+		size_t* newPosition = NULL
+	);
+
 	void parseImpl(
 		parsingContext& ctx,
 		const string& buffer,
@@ -353,6 +485,8 @@ protected:
 		const size_t curLinePos = 0,
 		size_t* newLinePos = NULL
 	) const;
+
+	void retainParsedData(const shared_ptr <utility::parserInputStreamAdapter>& source);
 };
 
 
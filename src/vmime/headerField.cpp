@@ -21,10 +21,13 @@
 // the GNU General Public License cover the whole combination.
 //
 
+#include "vmime/header.hpp"
 #include "vmime/headerField.hpp"
 #include "vmime/headerFieldFactory.hpp"
+#include "vmime/parameterizedHeaderField.hpp"
 
 #include "vmime/parserHelpers.hpp"
+#include "vmime/utility/stringUtils.hpp"
 
 #include "vmime/exception.hpp"
 
@@ -33,13 +36,19 @@ namespace vmime {
 
 
 headerField::headerField()
-	: m_name("X-Undefined") {
+	: m_name("X-Undefined"),
+	  m_header(NULL),
+	  m_deferredValuePending(false),
+	  m_deferredValueOffset(0) {
 
 }
 
 
 headerField::headerField(const string& fieldName)
-	: m_name(fieldName) {
+	: m_name(fieldName),
+	  m_header(NULL),
+	  m_deferredValuePending(false),
+	  m_deferredValueOffset(0) {
 
 }
 
@@ -63,7 +72,12 @@ void headerField::copyFrom(const component& other) {
 
 	const headerField& hf = dynamic_cast <const headerField&>(other);
 
+	hf.parseDeferredValue();
+	discardDeferredValue();
+
 	m_value->copyFrom(*hf.m_value);
+
+	copyParsedDataFrom(hf);
 }
 
 
@@ -82,6 +96,26 @@ shared_ptr <headerField> headerField::parseNext(
 	size_t* newPosition
 ) {
 
+	shared_ptr <parsingContext> lazyCtx;
+
+	if (ctx.getLazyHeaderFieldParsing()) {
+		lazyCtx = createDeferredParsingContext(ctx);
+	}
+
+	return parseNext(ctx, lazyCtx, buffer, position, end, newPosition);
+}
+
+
+// static
+shared_ptr <headerField> headerField::parseNext(
+	parsingContext& ctx,
+	const shared_ptr <parsingContext>& lazyCtx,
+	const string& buffer,
+	const size_t position,
+	const size_t end,
+	size_t* newPosition
+) {
+
 	size_t pos = position;
 
 	while (pos < end) {
@@ -113,17 +147,20 @@ shared_ptr <headerField> headerField::parseNext(
 
 			const size_t nameStart = pos;  // remember the start position of the line
 
-			while (pos < end && (buffer[pos] != ':' && !parserHelpers::isSpace(buffer[pos]))) {
-				++pos;
-			}
+			static const byte_t nameDelimiters[] = { ':', ' ', '\t', '\r', '\n' };
+
+			const size_t delim = utility::scanUtils::findFirstOf(
+				utility::stringUtils::bytesFromString(buffer) + pos, end - pos,
+				nameDelimiters, sizeof(nameDelimiters)
+			);
+
+			pos = (delim == npos ? end : pos + delim);
 
 			const size_t nameEnd = pos;
 
-			while (pos < end && (buffer[pos] == ' ' || buffer[pos] == '\t')) {
-				++pos;
-			}
+			pos = parserHelpers::skipSpaceOrTab(buffer, pos, end);
 
-			if (buffer[pos] != ':') {
+			if (pos >= end || buffer[pos] != ':') {
 
 				// header field recovery is necessary, update flag in parsing context
 				ctx.setHeaderRecoveryNeeded(true);
@@ -169,9 +206,7 @@ shared_ptr <headerField> headerField::parseNext(
 				}
 
 				// Skip spaces between ':' and the field contents
-				while (pos < end && (buffer[pos] == ' ' || buffer[pos] == '\t')) {
-					++pos;
-				}
+				pos = parserHelpers::skipSpaceOrTab(buffer, pos, end);
 
 				const size_t contentsStart = pos;
 				size_t contentsEnd = 0;
@@ -206,9 +241,24 @@ shared_ptr <headerField> headerField::parseNext(
 				}
 
 				// Return a new field
-				shared_ptr <headerField> field = headerFieldFactory::getInstance()->create(name);
+				shared_ptr <headerField> field = headerFieldFactory::getInstance()->create(ctx, name);
+
+				// Parameterized fields (eg. "Content-Type") and the encoding
+				// are always parsed immediately, as they are needed to parse
+				// the body anyway
+				if (lazyCtx && !dynamicCast <parameterizedHeaderField>(field) &&
+				    !utility::stringUtils::isStringEqualNoCase(name, fields::CONTENT_TRANSFER_ENCODING)) {
+
+					field->m_deferredValue.assign(buffer, contentsStart, contentsEnd - contentsStart);
+					field->m_deferredValueOffset = contentsStart;
+					field->m_deferredValueCtx = lazyCtx;
+					field->m_deferredValuePending = true;
+
+				} else {
+
+					field->parse(ctx, buffer, contentsStart, contentsEnd, NULL);
+				}
 
-				field->parse(ctx, buffer, contentsStart, contentsEnd, NULL);
 				field->setParsedBounds(nameStart, pos);
 
 				if (newPosition) {
@@ -222,9 +272,7 @@ shared_ptr <headerField> headerField::parseNext(
 
 			// If the line contains only space characters, we assume it is
 			// the end of the headers.
-			while (pos < end && (buffer[pos] == ' ' || buffer[pos] == '\t')) {
-				++pos;
-			}
+			pos = parserHelpers::skipSpaceOrTab(buffer, pos, end);
 
 			if (pos < end && buffer[pos] == '\n') {
 
@@ -248,7 +296,7 @@ shared_ptr <headerField> headerField::parseNext(
 				++pos;
 			}
 
-			if (buffer[pos] == '\n') {
+			if (pos < end && buffer[pos] == '\n') {
 				++pos;
 			}
 		}
@@ -270,10 +318,54 @@ void headerField::parseImpl(
 	size_t* newPosition
 ) {
 
+	discardDeferredValue();
+
 	m_value->parse(ctx, buffer, position, end, newPosition);
 }
 
 
+void headerField::parseDeferredValue() const {
+
+	if (!m_deferredValuePending.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	// The value may be accessed by several threads at the same time
+	std::lock_guard <std::mutex> lock(m_deferredValueMutex);
+
+	if (!m_deferredValueCtx) {
+		return;  // already parsed
+	}
+
+	shared_ptr <parsingContext> ctx;
+	ctx.swap(m_deferredValueCtx);
+
+	string value;
+	value.swap(m_deferredValue);
+
+	const_cast <headerField*>(this)->parseImpl(*ctx, value, 0, value.length(), NULL);
+
+	// Make value bounds relative to the buffer the field was parsed from
+	m_value->offsetParsedBounds(m_deferredValueOffset);
+
+	m_deferredValuePending.store(false, std::memory_order_release);
+}
+
+
+void headerField::discardDeferredValue() {
+
+	// Not called while the deferred value is being parsed, as
+	// the context has already been released at this point
+	if (m_deferredValueCtx) {
+
+		m_deferredValueCtx = null;
+		m_deferredValue.clear();
+
+		m_deferredValuePending = false;
+	}
+}
+
+
 void headerField::generateImpl(
 	const generationContext& ctx,
 	utility::outputStream& os,
@@ -281,6 +373,8 @@ void headerField::generateImpl(
 	size_t* newLinePos
 ) const {
 
+	parseDeferredValue();
+
 	os << m_name + ": ";
 
 	m_value->generate(ctx, os, curLinePos + m_name.length() + 2, newLinePos);
@@ -289,6 +383,8 @@ void headerField::generateImpl(
 
 size_t headerField::getGeneratedSize(const generationContext& ctx) {
 
+	parseDeferredValue();
+
 	return m_name.length() + 2 /* ": " */ + m_value->getGeneratedSize(ctx);
 }
 
@@ -301,7 +397,21 @@ const string headerField::getName() const {
 
 void headerField::setName(const string& name) {
 
+	const string oldName = m_name;
+
 	m_name = name;
+
+	discardParsedData();
+
+	if (m_header) {
+		m_header->renameField(*this, oldName);
+	}
+}
+
+
+bool headerField::isParsedDataReusable() const {
+
+	return hasParsedData();
 }
 
 
@@ -315,6 +425,11 @@ const std::vector <shared_ptr <component> > headerField::getChildComponents() {
 
 	std::vector <shared_ptr <component> > list;
 
+	parseDeferredValue();
+
+	// The value may be modified through the returned list
+	discardParsedData();
+
 	if (m_value) {
 		list.push_back(m_value);
 	}
@@ -325,12 +440,19 @@ const std::vector <shared_ptr <component> > headerField::getChildComponents() {
 
 shared_ptr <const headerFieldValue> headerField::getValue() const {
 
+	parseDeferredValue();
+
 	return m_value;
 }
 
 
 shared_ptr <headerFieldValue> headerField::getValue() {
 
+	parseDeferredValue();
+
+	// The value may be modified through the returned reference
+	discardParsedData();
+
 	return m_value;
 }
 
@@ -342,6 +464,8 @@ void headerField::setValue(const shared_ptr <headerFieldValue>& value) {
 	}
 
 	if (value != NULL) {
+		discardDeferredValue();
+		discardParsedData();
 		m_value = value;
 	}
 }
@@ -353,6 +477,9 @@ void headerField::setValueConst(const shared_ptr <const headerFieldValue>& value
 		throw exceptions::bad_field_value_type(getName());
 	}
 
+	discardDeferredValue();
+	discardParsedData();
+
 	m_value = vmime::clone(value);
 }
 
@@ -363,6 +490,9 @@ void headerField::setValue(const headerFieldValue& value) {
 		throw exceptions::bad_field_value_type(getName());
 	}
 
+	discardDeferredValue();
+	discardParsedData();
+
 	m_value = vmime::clone(value);
 }
 
@@ -29,10 +29,16 @@
 #include "vmime/component.hpp"
 #include "vmime/headerFieldValue.hpp"
 
+#include <atomic>
+#include <mutex>
+
 
 namespace vmime {
 
 
+class header;
+
+
 /** Base class for header fields.
   */
 class VMIME_EXPORT headerField : public component {
@@ -90,7 +96,7 @@ public:
 	template <typename T>
 	shared_ptr <const T> getValue() const {
 
-		return dynamicCast <const T>(m_value);
+		return dynamicCast <const T>(getValue());
 	}
 
 	/** Return the value object attached to this field.
@@ -107,7 +113,7 @@ public:
 	template <typename T>
 	shared_ptr <T> getValue() {
 
-		return dynamicCast <T>(m_value);
+		return dynamicCast <T>(getValue());
 	}
 
 	/** Set the value of this field.
@@ -143,6 +149,10 @@ public:
 
 
 	/** Parse a header field from a buffer.
+	  *
+	  * If lazy header field parsing is enabled in the parsing context (see
+	  * parsingContext::setLazyHeaderFieldParsing()), the value of the field
+	  * is not parsed immediately, but the first time it is accessed.
 	  *
 	  * @param ctx parsing context
 	  * @param buffer input buffer
@@ -162,6 +172,8 @@ public:
 
 	size_t getGeneratedSize(const generationContext& ctx);
 
+	bool isParsedDataReusable() const;
+
 protected:
 
 	void parseImpl(
@@ -182,6 +194,38 @@ protected:
 
 	string m_name;
 	shared_ptr <headerFieldValue> m_value;
+
+private:
+
+	// Header to which this field belongs, if any: it is notified
+	// when the field is renamed, to keep its name index up to date
+	header* m_header;
+
+	static shared_ptr <headerField> parseNext(
+		parsingContext& ctx,
+		const shared_ptr <parsingContext>& lazyCtx,
+		const string& buffer,
+		const size_t position,
+		const size_t end,
+		size_t* newPosition
+	);
+
+	/** Parse the value of this field, if its parsing has been deferred.
+	  */
+	void parseDeferredValue() const;
+
+	/** Forget about the value of this field, if its parsing has been deferred.
+	  */
+	void discardDeferredValue();
+
+	// Raw value and context used for lazy parsing (NULL context if parsed).
+	// The flag is cleared once the value has been parsed, so that it can
+	// be tested without locking
+	mutable std::atomic <bool> m_deferredValuePending;
+	mutable std::mutex m_deferredValueMutex;
+	mutable string m_deferredValue;
+	mutable size_t m_deferredValueOffset;
+	mutable shared_ptr <parsingContext> m_deferredValueCtx;
 };
 
 
@@ -41,7 +41,9 @@
 namespace vmime {
 
 
-headerFieldFactory::headerFieldFactory() {
+headerFieldFactory::headerFieldFactory()
+	: m_nameMap(make_shared <NameMap>()),
+	  m_valueMap(make_shared <ValueMap>()) {
 
 	// Register parameterized fields
 	registerField <contentTypeField>(vmime::fields::CONTENT_TYPE);
@@ -95,26 +97,70 @@ shared_ptr <headerFieldFactory> headerFieldFactory::getInstance() {
 }
 
 
+void headerFieldFactory::registerFieldAlloc(const string& name, AllocFunc allocFunc) {
+
+	std::lock_guard <std::mutex> lock(m_registerMutex);
+
+	shared_ptr <NameMap> nameMap = make_shared <NameMap>(*m_nameMap);
+	nameMap->insert(NameMap::value_type(utility::stringUtils::toLower(name), allocFunc));
+
+	std::atomic_store(&m_nameMap, shared_ptr <const NameMap>(nameMap));
+}
+
+
+void headerFieldFactory::registerFieldValueInfo(const string& name, const ValueInfo& vi) {
+
+	std::lock_guard <std::mutex> lock(m_registerMutex);
+
+	shared_ptr <ValueMap> valueMap = make_shared <ValueMap>(*m_valueMap);
+	valueMap->insert(ValueMap::value_type(utility::stringUtils::toLower(name), vi));
+
+	std::atomic_store(&m_valueMap, shared_ptr <const ValueMap>(valueMap));
+}
+
+
 shared_ptr <headerField> headerFieldFactory::create(
 	const string& name,
 	const string& body
 ) {
 
-	NameMap::const_iterator pos = m_nameMap.find(utility::stringUtils::toLower(name));
+	shared_ptr <headerField> field = createField(name, null);
+
+	if (body != NULL_STRING) {
+		field->parse(body);
+	}
+
+	return field;
+}
+
+
+shared_ptr <headerField> headerFieldFactory::create(
+	const parsingContext& ctx,
+	const string& name
+) {
+
+	return createField(name, ctx.getMemoryArena());
+}
+
+
+shared_ptr <headerField> headerFieldFactory::createField(
+	const string& name,
+	const shared_ptr <utility::memoryArena>& arena
+) {
+
+	const shared_ptr <const NameMap> nameMap = std::atomic_load(&m_nameMap);
+
+	NameMap::const_iterator pos = nameMap->find(utility::stringUtils::toLower(name));
 	shared_ptr <headerField> field;
 
-	if (pos != m_nameMap.end()) {
-		field = ((*pos).second)();
+	if (pos != nameMap->end()) {
+		field = ((*pos).second)(arena);
 	} else {
-		field = registerer <headerField, headerField>::creator();
+		field = registerer <headerField, headerField>::creator(arena);
 	}
 
 	field->setName(name);
-	field->setValue(createValue(name));
-
-	if (body != NULL_STRING) {
-		field->parse(body);
-	}
+	field->setValue(createValue(name, arena));
 
 	return field;
 }
@@ -122,16 +168,27 @@ shared_ptr <headerField> headerFieldFactory::create(
 
 shared_ptr <headerFieldValue> headerFieldFactory::createValue(const string& fieldName) {
 
-	ValueMap::const_iterator pos = m_valueMap.find(
+	return createValue(fieldName, null);
+}
+
+
+shared_ptr <headerFieldValue> headerFieldFactory::createValue(
+	const string& fieldName,
+	const shared_ptr <utility::memoryArena>& arena
+) {
+
+	const shared_ptr <const ValueMap> valueMap = std::atomic_load(&m_valueMap);
+
+	ValueMap::const_iterator pos = valueMap->find(
 		utility::stringUtils::toLower(fieldName)
 	);
 
 	shared_ptr <headerFieldValue> value;
 
-	if (pos != m_valueMap.end()) {
-		value = ((*pos).second.allocFunc)();
+	if (pos != valueMap->end()) {
+		value = ((*pos).second.allocFunc)(arena);
 	} else {
-		value = registerer <headerFieldValue, text>::creator();
+		value = registerer <headerFieldValue, text>::creator(arena);
 	}
 
 	return value;
@@ -143,10 +200,12 @@ bool headerFieldFactory::isValueTypeValid(
 	const headerFieldValue& value
 ) const {
 
-	ValueMap::const_iterator pos = m_valueMap.find
+	const shared_ptr <const ValueMap> valueMap = std::atomic_load(&m_valueMap);
+
+	ValueMap::const_iterator pos = valueMap->find
 		(utility::stringUtils::toLower(field.getName()));
 
-	if (pos != m_valueMap.end()) {
+	if (pos != valueMap->end()) {
 		return ((*pos).second.checkTypeFunc)(value);
 	}
 
@@ -28,11 +28,19 @@
 #include "vmime/headerField.hpp"
 #include "vmime/utility/stringUtils.hpp"
 
+#include <mutex>
+#include <new>
+
 
 namespace vmime {
 
 
 /** Creates header field and header field value objects.
+  *
+  * The factory can be used concurrently from several threads. Lookups
+  * do not take any lock: registrations replace the maps by updated
+  * copies, so registering a field while other threads are parsing
+  * is safe, but it is cheaper to register custom fields at startup.
   */
 class VMIME_EXPORT headerFieldFactory {
 
@@ -41,15 +49,15 @@ protected:
 	headerFieldFactory();
 	~headerFieldFactory();
 
-	typedef shared_ptr <headerField> (*AllocFunc)(void);
+	typedef shared_ptr <headerField> (*AllocFunc)(const shared_ptr <utility::memoryArena>&);
 	typedef std::map <string, AllocFunc> NameMap;
 
-	NameMap m_nameMap;
+	shared_ptr <const NameMap> m_nameMap;
 
 
 	struct ValueInfo {
 
-		typedef shared_ptr <headerFieldValue> (*ValueAllocFunc)(void);
+		typedef shared_ptr <headerFieldValue> (*ValueAllocFunc)(const shared_ptr <utility::memoryArena>&);
 		typedef bool (*ValueTypeCheckFunc)(const object&);
 
 		ValueAllocFunc allocFunc;
@@ -58,7 +66,13 @@ protected:
 
 	typedef std::map <string, ValueInfo> ValueMap;
 
-	ValueMap m_valueMap;
+	shared_ptr <const ValueMap> m_valueMap;
+
+	// Serializes registrations (readers use atomic loads of the maps)
+	std::mutex m_registerMutex;
+
+	void registerFieldAlloc(const string& name, AllocFunc allocFunc);
+	void registerFieldValueInfo(const string& name, const ValueInfo& vi);
 
 public:
 
@@ -78,9 +92,18 @@ public:
 			return typedObj != NULL;
 		}
 
-		static shared_ptr <BASE_TYPE> creator() {
+		static shared_ptr <BASE_TYPE> creator(const shared_ptr <utility::memoryArena>& arena) {
+
+			// Allocate a new object, in the arena if there is one
+			if (arena) {
+
+				TYPE* obj = new (arena->allocate(sizeof(TYPE), alignof(TYPE))) TYPE();
+
+				return shared_ptr <BASE_TYPE>(
+					obj, utility::arenaDeleter <TYPE>(), utility::arenaAllocator <TYPE>(arena)
+				);
+			}
 
-			// Allocate a new object
 			return shared_ptr <BASE_TYPE>(new TYPE());
 		}
 	};
@@ -96,12 +119,7 @@ public:
 	template <class T>
 	void registerField(const string& name) {
 
-		m_nameMap.insert(
-			NameMap::value_type(
-				utility::stringUtils::toLower(name),
-				&registerer <headerField, T>::creator
-			)
-		);
+		registerFieldAlloc(name, &registerer <headerField, T>::creator);
 	}
 
 	/** Register a field value type.
@@ -116,12 +134,7 @@ public:
 		vi.allocFunc = &registerer <headerFieldValue, T>::creator;
 		vi.checkTypeFunc = &registerer <headerField, T>::checkType;
 
-		m_valueMap.insert(
-			ValueMap::value_type(
-				utility::stringUtils::toLower(name),
-				vi
-			)
-		);
+		registerFieldValueInfo(name, vi);
 	}
 
 	/** Create a new field object for the specified field name.
@@ -135,6 +148,16 @@ public:
 	  */
 	shared_ptr <headerField> create(const string& name, const string& body = NULL_STRING);
 
+	/** Create a new field object for the specified field name, to be
+	  * parsed with the specified context. The field and its value are
+	  * allocated from the memory arena of the context, if any.
+	  *
+	  * @param ctx parsing context
+	  * @param name field name
+	  * @return a new field object
+	  */
+	shared_ptr <headerField> create(const parsingContext& ctx, const string& name);
+
 	/** Create a new field value for the specified field.
 	  *
 	  * @param fieldName name of the field for which to create value
@@ -150,6 +173,18 @@ public:
 	  * false otherwise
 	  */
 	bool isValueTypeValid(const headerField& field, const headerFieldValue& value) const;
+
+private:
+
+	shared_ptr <headerField> createField(
+		const string& name,
+		const shared_ptr <utility::memoryArena>& arena
+	);
+
+	shared_ptr <headerFieldValue> createValue(
+		const string& fieldName,
+		const shared_ptr <utility::memoryArena>& arena
+	);
 };
 
 
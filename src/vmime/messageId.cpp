@@ -179,7 +179,7 @@ shared_ptr <messageId> messageId::parseNext(
 			++pos;
 		}
 
-		shared_ptr <messageId> mid = make_shared <messageId>();
+		shared_ptr <messageId> mid = utility::makeShared <messageId>(ctx.getMemoryArena());
 		mid->parse(ctx, buffer, begin, pos, NULL);
 
 		if (newPosition) {
@@ -0,0 +1,94 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_MIMEEVENTHANDLER_HPP_INCLUDED
+#define VMIME_MIMEEVENTHANDLER_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+
+#include "vmime/mediaType.hpp"
+#include "vmime/encoding.hpp"
+
+
+namespace vmime {
+
+
+/** Receives the events emitted by a mimeEventParser.
+  *
+  * For each entity (the message itself, each body part and each
+  * encapsulated message), events are emitted in this order:
+  * onPartBegin(), onHeaderField() for each field, onBodyBegin(),
+  * then either onBodyChunk() for the contents of a leaf part, or
+  * the events of the child entities, and finally onPartEnd().
+  *
+  * The default implementation of each function does nothing.
+  */
+class VMIME_EXPORT mimeEventHandler {
+
+public:
+
+	virtual ~mimeEventHandler();
+
+	/** Called at the beginning of an entity.
+	  *
+	  * @param depth nesting level of the entity (0 for the message)
+	  */
+	virtual void onPartBegin(const size_t depth);
+
+	/** Called for each field in the header of the current entity.
+	  *
+	  * @param name field name
+	  * @param value raw field value, unfolded (line breaks removed)
+	  */
+	virtual void onHeaderField(const string& name, const string& value);
+
+	/** Called after the header of the current entity has been parsed.
+	  *
+	  * @param type content type of the entity (from "Content-Type"
+	  * field, or default type if there is none)
+	  * @param enc transfer encoding of the entity
+	  */
+	virtual void onBodyBegin(const mediaType& type, const encoding& enc);
+
+	/** Called for each chunk of data in the body of the current
+	  * entity, if it is not a multipart or an encapsulated message.
+	  *
+	  * @param data chunk data (only valid during the call)
+	  * @param length number of bytes in the chunk
+	  */
+	virtual void onBodyChunk(const byte_t* data, const size_t length);
+
+	/** Called at the end of an entity.
+	  *
+	  * @param depth nesting level of the entity (0 for the message)
+	  */
+	virtual void onPartEnd(const size_t depth);
+};
+
+
+} // vmime
+
+
+#endif // VMIME_MIMEEVENTHANDLER_HPP_INCLUDED
@@ -0,0 +1,884 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/mimeEventParser.hpp"
+
+#include "vmime/contentTypeField.hpp"
+#include "vmime/headerFieldFactory.hpp"
+#include "vmime/parserHelpers.hpp"
+
+#include "vmime/utility/inputStreamByteBufferAdapter.hpp"
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+#include "vmime/utility/scanUtils.hpp"
+#include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/encoder/encoderFactory.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace vmime {
+
+
+mimeEventParser::entity::entity()
+	: closed(false),
+	  digest(false) {
+
+}
+
+
+mimeEventParser::mimeEventParser(const shared_ptr <mimeEventHandler>& handler)
+	: m_handler(handler),
+	  m_started(false),
+	  m_chunkSize(65536),
+	  m_decodeBodies(false),
+	  m_maxHeaderFieldSize(65536),
+	  m_state(STATE_HEADER),
+	  m_lineStart(true),
+	  m_inHeaderLine(false),
+	  m_hasField(false),
+	  m_delimiterClose(false),
+	  m_decoderIsBase64(false) {
+
+}
+
+
+mimeEventParser::~mimeEventParser() {
+
+}
+
+
+void mimeEventParser::setChunkSize(const size_t size) {
+
+	m_chunkSize = (size == 0 ? 1 : size);
+}
+
+
+size_t mimeEventParser::getChunkSize() const {
+
+	return m_chunkSize;
+}
+
+
+void mimeEventParser::setDecodeBodies(const bool decode) {
+
+	m_decodeBodies = decode;
+}
+
+
+bool mimeEventParser::getDecodeBodies() const {
+
+	return m_decodeBodies;
+}
+
+
+void mimeEventParser::setMaxHeaderFieldSize(const size_t size) {
+
+	m_maxHeaderFieldSize = size;
+}
+
+
+size_t mimeEventParser::getMaxHeaderFieldSize() const {
+
+	return m_maxHeaderFieldSize;
+}
+
+
+void mimeEventParser::parse(utility::inputStream& is) {
+
+	reset();
+
+	std::vector <byte_t> chunk(m_chunkSize);
+
+	while (!is.eof()) {
+
+		const size_t read = is.read(&chunk[0], chunk.size());
+
+		if (read != 0) {
+			feed(&chunk[0], read);
+		}
+	}
+
+	finish();
+}
+
+
+void mimeEventParser::feed(const byte_t* data, const size_t length) {
+
+	if (!m_started) {
+		begin();
+	}
+
+	// Process data one chunk at a time, so that the
+	// buffer does not grow with the size of the data
+	for (size_t pos = 0 ; pos < length ; pos += m_chunkSize) {
+
+		m_buffer.append(
+			reinterpret_cast <const char*>(data + pos),
+			std::min(m_chunkSize, length - pos)
+		);
+
+		process(false);
+	}
+}
+
+
+void mimeEventParser::feed(const string& data) {
+
+	feed(utility::stringUtils::bytesFromString(data), data.length());
+}
+
+
+void mimeEventParser::finish() {
+
+	if (!m_started) {
+		begin();
+	}
+
+	end();
+}
+
+
+void mimeEventParser::reset() {
+
+	m_started = false;
+
+	m_entities.clear();
+	m_buffer.clear();
+
+	m_decoder = null;
+	m_decoderBuffer.clear();
+}
+
+
+void mimeEventParser::begin() {
+
+	reset();
+
+	m_contentType.clear();
+	m_transferEncoding.clear();
+
+	m_started = true;
+
+	beginPart();
+}
+
+
+void mimeEventParser::end() {
+
+	process(true);
+
+	// Unterminated header: the entity has no body
+	while (m_state == STATE_HEADER && !m_entities.empty()) {
+
+		flushField();
+		endHeader();
+	}
+
+	while (!m_entities.empty()) {
+		endPart();
+	}
+
+	m_buffer.clear();
+	m_started = false;
+}
+
+
+void mimeEventParser::process(const bool eof) {
+
+	size_t pos = 0;
+	bool more = true;
+
+	while (more && !m_entities.empty()) {
+
+		switch (m_state) {
+
+			case STATE_HEADER:
+
+				more = processHeader(pos, eof);
+				break;
+
+			case STATE_DELIMITER_LINE:
+
+				more = processDelimiterLine(pos, eof);
+				break;
+
+			case STATE_BODY:
+			case STATE_PREAMBLE:
+			case STATE_EPILOGUE:
+
+				more = processBody(pos, eof);
+				break;
+		}
+	}
+
+	m_buffer.erase(0, pos);
+}
+
+
+bool mimeEventParser::processHeader(size_t& pos, const bool eof) {
+
+	static const size_t MAX_LINE_LENGTH = 1000;
+
+	const byte_t* data = utility::stringUtils::bytesFromString(m_buffer);
+
+	while (m_state == STATE_HEADER) {
+
+		const size_t avail = m_buffer.length() - pos;
+
+		if (avail == 0) {
+			return false;
+		}
+
+		const char* line = m_buffer.data() + pos;
+		const size_t lf = utility::scanUtils::findByte(data + pos, avail, '\n');
+
+		// Rest of a line which was too long to be buffered
+		if (m_inHeaderLine) {
+
+			const size_t length = (lf == npos ? avail : lf + 1);
+
+			if (m_hasField) {
+				appendFieldValue(line, length);
+			}
+
+			m_inHeaderLine = (lf == npos);
+			pos += length;
+
+			continue;
+		}
+
+		// Wait for the end of the line, unless it is too long
+		// (RFC-5322 limits lines to 998 characters)
+		if (lf == npos && !eof && avail < std::max(m_chunkSize, MAX_LINE_LENGTH)) {
+			return false;
+		}
+
+		const size_t length = (lf == npos ? avail : lf + 1);
+		const bool complete = (lf != npos || eof);
+
+		if (!processHeaderLine(line, length, complete)) {
+
+			// A delimiter was found instead of a header line:
+			// it will be processed in the new state
+			return true;
+		}
+
+		m_inHeaderLine = !complete;
+		pos += length;
+	}
+
+	return true;
+}
+
+
+bool mimeEventParser::processHeaderLine(const char* line, const size_t length, const bool complete) {
+
+	size_t n = length;
+
+	if (complete && n > 0 && line[n - 1] == '\n') {
+		--n;
+	}
+
+	if (complete && n > 0 && line[n - 1] == '\r') {
+		--n;
+	}
+
+	// Empty line: end of header
+	if (n == 0) {
+
+		flushField();
+		endHeader();
+
+		return true;
+	}
+
+	// Folded line: continuation of the current field
+	if (line[0] == ' ' || line[0] == '\t') {
+
+		if (m_hasField) {
+			appendFieldValue(line, n);
+		}
+
+		return true;
+	}
+
+	// Boundary delimiter: this entity has no header and no body
+	if (n >= 2 && line[0] == '-' && line[1] == '-') {
+
+		size_t level, delimiterLength;
+		bool close;
+
+		if (matchDelimiter(
+				reinterpret_cast <const byte_t*>(line), n, /* eof */ true,
+				&level, &delimiterLength, &close) == DELIMITER_MATCH) {
+
+			flushField();
+			endHeader();
+
+			return false;
+		}
+	}
+
+	flushField();
+
+	const char* colon = static_cast <const char*>(std::memchr(line, ':', n));
+
+	// Not a header field: skip this line
+	if (!colon) {
+		return true;
+	}
+
+	const char* nameEnd = colon;
+
+	while (nameEnd > line && parserHelpers::isSpaceOrTab(nameEnd[-1])) {
+		--nameEnd;
+	}
+
+	if (nameEnd == line) {
+		return true;
+	}
+
+	const char* value = colon + 1;
+	const char* end = line + n;
+
+	while (value < end && parserHelpers::isSpaceOrTab(*value)) {
+		++value;
+	}
+
+	m_fieldName.assign(line, nameEnd);
+	m_fieldValue.clear();
+	m_hasField = true;
+
+	appendFieldValue(value, end - value);
+
+	return true;
+}
+
+
+bool mimeEventParser::processBody(size_t& pos, const bool eof) {
+
+	const byte_t* data = utility::stringUtils::bytesFromString(m_buffer) + pos;
+	const size_t avail = m_buffer.length() - pos;
+
+	size_t searchFrom = 0;
+
+	while (true) {
+
+		// Find the next "--" at the beginning of a line
+		size_t dashes = npos;
+
+		if (m_lineStart && searchFrom == 0) {
+
+			if (avail < 2 && !eof && (avail == 0 || data[0] == '-')) {
+				return false;  // wait for more data
+			}
+
+			if (avail >= 2 && data[0] == '-' && data[1] == '-') {
+				dashes = 0;
+			}
+		}
+
+		if (dashes == npos) {
+
+			const size_t from = (searchFrom > 0 ? searchFrom - 1 : 0);
+			const size_t lf = (from < avail)
+				? utility::scanUtils::find(data + from, avail - from, utility::stringUtils::bytesFromString("\n--"), 3)
+				: npos;
+
+			if (lf != npos) {
+				dashes = from + lf + 1;
+			}
+		}
+
+		// No delimiter: the whole data is content, except the
+		// end of the data, which may be the beginning of a delimiter
+		if (dashes == npos) {
+
+			size_t contentEnd = avail;
+
+			if (!eof) {
+
+				for (size_t i = avail ; i > 0 && avail - i < 3 ; --i) {
+
+					if (data[i - 1] == '\n' || data[i - 1] == '\r') {
+						contentEnd = i - 1;
+					}
+				}
+			}
+
+			emitContent(data, contentEnd);
+
+			if (contentEnd != 0) {
+				m_lineStart = false;
+			}
+
+			pos += contentEnd;
+
+			return false;
+		}
+
+		// The line break before the delimiter is part of the delimiter
+		size_t contentEnd = dashes;
+
+		if (contentEnd > 0) {
+
+			--contentEnd;  // LF
+
+			if (contentEnd > 0 && data[contentEnd - 1] == '\r') {
+				--contentEnd;
+			}
+		}
+
+		size_t level, delimiterLength;
+		bool close;
+
+		switch (matchDelimiter(data + dashes, avail - dashes, eof, &level, &delimiterLength, &close)) {
+
+			case DELIMITER_NO_MATCH:
+
+				searchFrom = dashes + 1;
+				break;
+
+			case DELIMITER_NEED_MORE_DATA:
+
+				emitContent(data, contentEnd);
+
+				if (contentEnd != 0) {
+					m_lineStart = false;
+				}
+
+				pos += contentEnd;
+
+				return false;
+
+			case DELIMITER_MATCH:
+
+				emitContent(data, contentEnd);
+
+				pos += dashes + delimiterLength;
+
+				// End the entities enclosed in the multipart
+				while (m_entities.size() > level + 1) {
+					endPart();
+				}
+
+				if (close) {
+					m_entities[level].closed = true;
+				}
+
+				m_delimiterClose = close;
+				m_state = STATE_DELIMITER_LINE;
+
+				return true;
+		}
+	}
+}
+
+
+bool mimeEventParser::processDelimiterLine(size_t& pos, const bool eof) {
+
+	const size_t avail = m_buffer.length() - pos;
+	const size_t lf = utility::scanUtils::findByte(
+		utility::stringUtils::bytesFromString(m_buffer) + pos, avail, '\n'
+	);
+
+	// Skip the rest of the line (transport padding)
+	if (lf == npos) {
+
+		pos += avail;
+
+		if (!eof) {
+			return false;
+		}
+
+	} else {
+
+		pos += lf + 1;
+	}
+
+	m_lineStart = true;
+
+	if (m_delimiterClose) {
+		m_state = STATE_EPILOGUE;
+	} else {
+		beginPart();
+	}
+
+	return true;
+}
+
+
+mimeEventParser::DelimiterMatch mimeEventParser::matchDelimiter(
+	const byte_t* data,
+	const size_t length,
+	const bool eof,
+	size_t* level,
+	size_t* delimiterLength,
+	bool* close
+) const {
+
+	// 'data' starts with "--": check whether it is followed by the
+	// boundary of one of the enclosing multiparts
+	for (size_t i = m_entities.size() ; i > 0 ; --i) {
+
+		const entity& e = m_entities[i - 1];
+
+		if (e.boundary.empty() || e.closed) {
+			continue;
+		}
+
+		const size_t boundaryLength = e.boundary.length();
+		const size_t compareLength = std::min(length - 2, boundaryLength);
+
+		if (std::memcmp(data + 2, e.boundary.data(), compareLength) != 0) {
+			continue;
+		}
+
+		// We need the boundary and 2 more bytes to decide
+		if (length < 2 + boundaryLength + 2 && !eof) {
+			return DELIMITER_NEED_MORE_DATA;
+		}
+
+		if (compareLength < boundaryLength) {
+			continue;
+		}
+
+		*close = false;
+
+		if (length > 2 + boundaryLength) {
+
+			const byte_t next = data[2 + boundaryLength];
+
+			// Boundary should be followed by "--", a new line or a space
+			if (next == '-') {
+
+				if (length > 3 + boundaryLength && data[3 + boundaryLength] == '-') {
+					*close = true;
+				} else {
+					continue;
+				}
+
+			} else if (!parserHelpers::isSpace(next)) {
+
+				continue;
+			}
+		}
+
+		*level = i - 1;
+		*delimiterLength = 2 + boundaryLength + (*close ? 2 : 0);
+
+		return DELIMITER_MATCH;
+	}
+
+	return DELIMITER_NO_MATCH;
+}
+
+
+void mimeEventParser::beginPart() {
+
+	m_entities.push_back(entity());
+
+	m_state = STATE_HEADER;
+	m_lineStart = true;
+	m_inHeaderLine = false;
+	m_hasField = false;
+
+	m_handler->onPartBegin(m_entities.size() - 1);
+}
+
+
+void mimeEventParser::endPart() {
+
+	// Flush the data left in the decoder
+	if (m_decoder) {
+
+		if (!m_decoderBuffer.empty()) {
+
+			decodeContent(
+				utility::stringUtils::bytesFromString(m_decoderBuffer),
+				m_decoderBuffer.length()
+			);
+		}
+
+		m_decoder = null;
+		m_decoderBuffer.clear();
+	}
+
+	m_handler->onPartEnd(m_entities.size() - 1);
+
+	m_entities.pop_back();
+
+	// Content after this entity belongs to the parent multipart,
+	// until the next delimiter
+	m_state = STATE_EPILOGUE;
+}
+
+
+void mimeEventParser::endHeader() {
+
+	// Default content type
+	mediaType type(mediaTypes::TEXT, mediaTypes::TEXT_PLAIN);
+
+	if (m_entities.size() >= 2 && m_entities[m_entities.size() - 2].digest) {
+		type = mediaType(mediaTypes::MESSAGE, mediaTypes::MESSAGE_RFC822);
+	}
+
+	string boundary;
+
+	if (!m_contentType.empty()) {
+
+		shared_ptr <contentTypeField> field = dynamicCast <contentTypeField>(
+			headerFieldFactory::getInstance()->create(fields::CONTENT_TYPE, m_contentType)
+		);
+
+		if (field) {
+
+			type = *field->getValue <mediaType>();
+
+			if (field->hasBoundary()) {
+				boundary = field->getBoundary();
+			}
+		}
+	}
+
+	encoding enc;
+
+	if (!m_transferEncoding.empty()) {
+		enc.parse(m_transferEncoding);
+	}
+
+	m_contentType.clear();
+	m_transferEncoding.clear();
+
+	m_handler->onBodyBegin(type, enc);
+
+	m_lineStart = true;
+
+	const bool isEncoded =
+		utility::stringUtils::isStringEqualNoCase(enc.getName(), encodingTypes::BASE64) ||
+		utility::stringUtils::isStringEqualNoCase(enc.getName(), encodingTypes::QUOTED_PRINTABLE);
+
+	if (utility::stringUtils::isStringEqualNoCase(type.getType(), mediaTypes::MULTIPART) &&
+	    !boundary.empty()) {
+
+		entity& e = m_entities.back();
+
+		e.boundary = boundary;
+		e.digest = utility::stringUtils::isStringEqualNoCase(
+			type.getSubType(), mediaTypes::MULTIPART_DIGEST
+		);
+
+		m_state = STATE_PREAMBLE;
+
+	} else if (utility::stringUtils::isStringEqualNoCase(type.getType(), mediaTypes::MESSAGE) &&
+	           utility::stringUtils::isStringEqualNoCase(type.getSubType(), mediaTypes::MESSAGE_RFC822) &&
+	           !isEncoded) {
+
+		// Encapsulated message
+		beginPart();
+
+	} else {
+
+		m_state = STATE_BODY;
+
+		if (m_decodeBodies && isEncoded) {
+
+			m_decoder = utility::encoder::encoderFactory::getInstance()->create(enc.getName());
+			m_decoderIsBase64 = utility::stringUtils::isStringEqualNoCase(enc.getName(), encodingTypes::BASE64);
+			m_decoderBuffer.clear();
+		}
+	}
+}
+
+
+void mimeEventParser::appendFieldValue(const char* data, const size_t length) {
+
+	size_t n = length;
+
+	while (n > 0 && (data[n - 1] == '\r' || data[n - 1] == '\n')) {
+		--n;
+	}
+
+	if (m_fieldValue.length() < m_maxHeaderFieldSize) {
+		m_fieldValue.append(data, std::min(n, m_maxHeaderFieldSize - m_fieldValue.length()));
+	}
+}
+
+
+void mimeEventParser::flushField() {
+
+	if (!m_hasField) {
+		return;
+	}
+
+	m_hasField = false;
+
+	size_t n = m_fieldValue.length();
+
+	while (n > 0 && parserHelpers::isSpace(m_fieldValue[n - 1])) {
+		--n;
+	}
+
+	m_fieldValue.resize(n);
+
+	if (utility::stringUtils::isStringEqualNoCase(m_fieldName, fields::CONTENT_TYPE)) {
+		m_contentType = m_fieldValue;
+	} else if (utility::stringUtils::isStringEqualNoCase(m_fieldName, fields::CONTENT_TRANSFER_ENCODING)) {
+		m_transferEncoding = m_fieldValue;
+	}
+
+	m_handler->onHeaderField(m_fieldName, m_fieldValue);
+}
+
+
+void mimeEventParser::emitContent(const byte_t* data, const size_t length) {
+
+	if (m_state != STATE_BODY || length == 0) {
+		return;
+	}
+
+	if (!m_decoder) {
+
+		m_handler->onBodyChunk(data, length);
+		return;
+	}
+
+	// Only decode complete groups/lines: the rest is kept until more data
+	// is available, so that the result does not depend on chunk boundaries
+	m_decoderBuffer.append(reinterpret_cast <const char*>(data), length);
+
+	const size_t decodable = getDecodableLength();
+
+	if (decodable != 0) {
+
+		decodeContent(utility::stringUtils::bytesFromString(m_decoderBuffer), decodable);
+		m_decoderBuffer.erase(0, decodable);
+	}
+}
+
+
+void mimeEventParser::decodeContent(const byte_t* data, const size_t length) {
+
+	utility::inputStreamByteBufferAdapter in(data, length);
+
+	string decoded;
+	utility::outputStreamStringAdapter out(decoded);
+
+	m_decoder->decode(in, out);
+
+	if (!decoded.empty()) {
+		m_handler->onBodyChunk(utility::stringUtils::bytesFromString(decoded), decoded.length());
+	}
+}
+
+
+namespace {
+
+
+// Output stream which feeds a mimeEventParser
+class mimeEventParserFeedStream : public utility::outputStream {
+
+public:
+
+	mimeEventParserFeedStream(mimeEventParser& parser)
+		: m_parser(parser) {
+
+	}
+
+	void flush() {
+
+		// Nothing to do: data is parsed as soon as it is written
+	}
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count) {
+
+		m_parser.feed(data, count);
+	}
+
+private:
+
+	mimeEventParser& m_parser;
+};
+
+
+} // namespace
+
+
+shared_ptr <utility::outputStream> mimeEventParser::getFeedStream() {
+
+	return make_shared <mimeEventParserFeedStream>(*this);
+}
+
+
+size_t mimeEventParser::getDecodableLength() const {
+
+	const string& buffer = m_decoderBuffer;
+
+	if (m_decoderIsBase64) {
+
+		// Up to the last complete group of 4 base64 characters
+		size_t count = 0, groupEnd = 0;
+
+		for (size_t i = 0 ; i < buffer.length() ; ++i) {
+
+			const unsigned char c = static_cast <unsigned char>(buffer[i]);
+
+			if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+			    (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '=') {
+
+				if (++count % 4 == 0) {
+					groupEnd = i + 1;
+				}
+			}
+		}
+
+		return groupEnd;
+	}
+
+	// Quoted-printable: up to the end of the last complete line (lines
+	// should not be longer than 76 characters)...
+	const size_t lf = buffer.rfind('\n');
+
+	if (lf != string::npos && buffer.length() - (lf + 1) <= 1000) {
+		return lf + 1;
+	}
+
+	// ...or, if there is no line break, before a possibly incomplete
+	// "=XX" sequence or soft line break
+	const size_t n = buffer.length();
+
+	if (n >= 1 && buffer[n - 1] == '=') {
+		return n - 1;
+	} else if (n >= 2 && buffer[n - 2] == '=') {
+		return n - 2;
+	}
+
+	return n;
+}
+
+
+} // vmime
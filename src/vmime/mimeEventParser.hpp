@@ -0,0 +1,251 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_MIMEEVENTPARSER_HPP_INCLUDED
+#define VMIME_MIMEEVENTPARSER_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+
+#include "vmime/mimeEventHandler.hpp"
+
+#include "vmime/utility/inputStream.hpp"
+#include "vmime/utility/outputStream.hpp"
+#include "vmime/utility/encoder/encoder.hpp"
+
+#include <vector>
+
+
+namespace vmime {
+
+
+/** A streaming MIME parser, which emits events for the structure
+  * and the contents of a message (see mimeEventHandler), instead of
+  * building a tree of components.
+  *
+  * Data is read and processed in chunks: the memory used does not
+  * depend on the size of the message, but only on the chunk size,
+  * the maximum size of header fields and the nesting depth.
+  *
+  * Data can either be read from a stream with parse(), or be pushed
+  * as it arrives (eg. from the network) with feed() and finish():
+  * events are emitted as soon as enough data has been received.
+  */
+class VMIME_EXPORT mimeEventParser {
+
+public:
+
+	/** Construct a new parser.
+	  *
+	  * @param handler handler which will receive the events
+	  */
+	mimeEventParser(const shared_ptr <mimeEventHandler>& handler);
+
+	~mimeEventParser();
+
+	/** Sets the number of bytes read from the input stream
+	  * at a time. The default is 64 KB.
+	  *
+	  * @param size chunk size, in bytes
+	  */
+	void setChunkSize(const size_t size);
+
+	/** Return the number of bytes read from the input stream
+	  * at a time.
+	  *
+	  * @return chunk size, in bytes
+	  */
+	size_t getChunkSize() const;
+
+	/** Enables/disables the decoding of body contents. When enabled,
+	  * contents encoded in base64 or quoted-printable are decoded before
+	  * being passed to mimeEventHandler::onBodyChunk(). The default is
+	  * to pass the contents as-is.
+	  *
+	  * @param decode true to decode body contents, false otherwise
+	  */
+	void setDecodeBodies(const bool decode);
+
+	/** Return whether body contents are decoded.
+	  *
+	  * @return true if body contents are decoded, false otherwise
+	  */
+	bool getDecodeBodies() const;
+
+	/** Sets the maximum size of header field values. Longer values
+	  * are truncated. The default is 64 KB.
+	  *
+	  * @param size maximum size, in bytes
+	  */
+	void setMaxHeaderFieldSize(const size_t size);
+
+	/** Return the maximum size of header field values.
+	  *
+	  * @return maximum size, in bytes
+	  */
+	size_t getMaxHeaderFieldSize() const;
+
+	/** Parse a message from the specified stream, until the end
+	  * of the stream is reached.
+	  *
+	  * @param is input stream
+	  */
+	void parse(utility::inputStream& is);
+
+	/** Parse the next bytes of a message. Events are emitted for all
+	  * the data which can be parsed so far; the rest is kept until
+	  * more data is fed. Data may be split at any position.
+	  *
+	  * @param data message data
+	  * @param length number of bytes
+	  */
+	void feed(const byte_t* data, const size_t length);
+
+	/** Parse the next bytes of a message.
+	  *
+	  * @param data message data
+	  */
+	void feed(const string& data);
+
+	/** Signal the end of the message: remaining data is parsed, and
+	  * all the entities which are still open are ended. The parser
+	  * can then be used to parse another message.
+	  */
+	void finish();
+
+	/** Abandon the message being parsed, without emitting any
+	  * more events. The parser can then be used to parse another
+	  * message.
+	  */
+	void reset();
+
+	/** Return an output stream which feeds the data written to it
+	  * to this parser. This can be used with the functions that write
+	  * a message to an output stream (eg. net::message::extract()).
+	  * finish() must still be called when all the data has been written,
+	  * and the stream must not be used after the parser is destroyed.
+	  *
+	  * @return output stream for feeding the parser
+	  */
+	shared_ptr <utility::outputStream> getFeedStream();
+
+private:
+
+	enum State {
+		STATE_HEADER,              /**< Parsing the header of an entity. */
+		STATE_BODY,                /**< Contents of a leaf entity. */
+		STATE_PREAMBLE,            /**< Before the first part of a multipart. */
+		STATE_EPILOGUE,            /**< After the last part of a multipart. */
+		STATE_DELIMITER_LINE       /**< Rest of a boundary delimiter line. */
+	};
+
+	enum DelimiterMatch {
+		DELIMITER_NO_MATCH,
+		DELIMITER_MATCH,
+		DELIMITER_NEED_MORE_DATA
+	};
+
+	struct entity {
+
+		entity();
+
+		string boundary;           // if this is a multipart entity
+		bool closed;               // the close delimiter has been found
+		bool digest;               // multipart/digest
+	};
+
+
+	void begin();
+	void end();
+
+	void process(const bool eof);
+
+	bool processHeader(size_t& pos, const bool eof);
+	bool processHeaderLine(const char* line, const size_t length, const bool complete);
+	bool processBody(size_t& pos, const bool eof);
+	bool processDelimiterLine(size_t& pos, const bool eof);
+
+	DelimiterMatch matchDelimiter(
+		const byte_t* data,
+		const size_t length,
+		const bool eof,
+		size_t* level,
+		size_t* delimiterLength,
+		bool* close
+	) const;
+
+	void beginPart();
+	void endPart();
+	void endHeader();
+
+	void appendFieldValue(const char* data, const size_t length);
+	void flushField();
+
+	void emitContent(const byte_t* data, const size_t length);
+	void decodeContent(const byte_t* data, const size_t length);
+	size_t getDecodableLength() const;
+
+
+	shared_ptr <mimeEventHandler> m_handler;
+
+	// Whether a message is being parsed
+	bool m_started;
+
+	size_t m_chunkSize;
+	bool m_decodeBodies;
+	size_t m_maxHeaderFieldSize;
+
+	State m_state;
+	std::vector <entity> m_entities;
+
+	// Data received but not processed yet
+	string m_buffer;
+
+	// Whether the beginning of the buffer is at the beginning of a line
+	bool m_lineStart;
+
+	// Header field being parsed
+	bool m_inHeaderLine;
+	bool m_hasField;
+	string m_fieldName;
+	string m_fieldValue;
+
+	// Header fields of the current entity needed to parse its body
+	string m_contentType;
+	string m_transferEncoding;
+
+	// Whether the last delimiter was a close delimiter
+	bool m_delimiterClose;
+
+	// Decoding of body contents
+	shared_ptr <utility::encoder::encoder> m_decoder;
+	bool m_decoderIsBase64;
+	string m_decoderBuffer;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_MIMEEVENTPARSER_HPP_INCLUDED
@@ -0,0 +1,142 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/mimeTreeBuilder.hpp"
+#include "vmime/headerFieldFactory.hpp"
+#include "vmime/stringContentHandler.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+
+namespace vmime {
+
+
+mimeTreeBuilder::entity::entity()
+	: multipart(false),
+	  encapsulated(false),
+	  hasChildren(false) {
+
+}
+
+
+mimeTreeBuilder::mimeTreeBuilder() {
+
+}
+
+
+shared_ptr <message> mimeTreeBuilder::getMessage() const {
+
+	return m_message;
+}
+
+
+bool mimeTreeBuilder::isComplete() const {
+
+	return m_message && m_entities.empty();
+}
+
+
+void mimeTreeBuilder::onPartBegin(const size_t depth) {
+
+	entity e;
+
+	if (depth == 0) {
+
+		m_entities.clear();
+
+		m_message = make_shared <message>();
+		e.part = m_message;
+
+	} else {
+
+		entity& parent = m_entities.back();
+		parent.hasChildren = true;
+
+		if (parent.multipart) {
+
+			e.part = make_shared <bodyPart>();
+			parent.part->getBody()->appendPart(e.part);
+
+		} else {
+
+			// Encapsulated message: built separately, then stored
+			// as the contents of the parent part
+			e.part = make_shared <message>();
+			e.encapsulated = true;
+		}
+	}
+
+	m_entities.push_back(e);
+}
+
+
+void mimeTreeBuilder::onHeaderField(const string& name, const string& value) {
+
+	m_entities.back().part->getHeader()->appendField(
+		headerFieldFactory::getInstance()->create(name, value)
+	);
+}
+
+
+void mimeTreeBuilder::onBodyBegin(const mediaType& type, const encoding& enc) {
+
+	entity& e = m_entities.back();
+
+	e.enc = enc;
+	e.multipart = utility::stringUtils::isStringEqualNoCase(type.getType(), mediaTypes::MULTIPART);
+}
+
+
+void mimeTreeBuilder::onBodyChunk(const byte_t* data, const size_t length) {
+
+	m_entities.back().contents.append(reinterpret_cast <const char*>(data), length);
+}
+
+
+void mimeTreeBuilder::onPartEnd(const size_t /* depth */) {
+
+	const entity& e = m_entities.back();
+
+	// Leaf part (a multipart without a boundary is also a leaf)
+	if (!e.hasChildren) {
+
+		e.part->getBody()->setContents(
+			make_shared <stringContentHandler>(e.contents, e.enc)
+		);
+	}
+
+	if (e.encapsulated) {
+
+		const entity& parent = m_entities[m_entities.size() - 2];
+
+		parent.part->getBody()->setContents(
+			make_shared <stringContentHandler>(e.part->generate(), parent.enc)
+		);
+	}
+
+	m_entities.pop_back();
+}
+
+
+} // vmime
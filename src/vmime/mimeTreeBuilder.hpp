@@ -0,0 +1,101 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_MIMETREEBUILDER_HPP_INCLUDED
+#define VMIME_MIMETREEBUILDER_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+
+#include "vmime/mimeEventHandler.hpp"
+#include "vmime/message.hpp"
+
+#include <vector>
+
+
+namespace vmime {
+
+
+/** A mimeEventHandler which builds a message from the events emitted
+  * by a mimeEventParser. When data is pushed to the parser with feed(),
+  * the message is built as data arrives: the parts which have ended
+  * can be used before the rest of the message has been received.
+  *
+  * The parser must not decode body contents (see
+  * mimeEventParser::setDecodeBodies()), as the contents are stored
+  * with the transfer encoding of their part. The prolog and epilog
+  * texts of multiparts are not reported by the parser, so they are
+  * not part of the message. An encapsulated message is built like
+  * the message itself, and then stored as the contents of its part.
+  */
+class VMIME_EXPORT mimeTreeBuilder : public mimeEventHandler {
+
+public:
+
+	mimeTreeBuilder();
+
+	/** Return the message which is being built, or which has been
+	  * built. A new message is created each time the parser begins
+	  * a new message.
+	  *
+	  * @return message, or NULL if no message has been parsed yet
+	  */
+	shared_ptr <message> getMessage() const;
+
+	/** Return whether the message has been completely built.
+	  *
+	  * @return true if the end of the message has been reached,
+	  * false otherwise
+	  */
+	bool isComplete() const;
+
+	void onPartBegin(const size_t depth);
+	void onHeaderField(const string& name, const string& value);
+	void onBodyBegin(const mediaType& type, const encoding& enc);
+	void onBodyChunk(const byte_t* data, const size_t length);
+	void onPartEnd(const size_t depth);
+
+private:
+
+	struct entity {
+
+		entity();
+
+		shared_ptr <bodyPart> part;
+		encoding enc;
+		bool multipart;       // children are body parts
+		bool encapsulated;    // this is an encapsulated message
+		bool hasChildren;
+		string contents;
+	};
+
+
+	shared_ptr <message> m_message;
+	std::vector <entity> m_entities;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_MIMETREEBUILDER_HPP_INCLUDED
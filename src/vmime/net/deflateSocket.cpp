@@ -0,0 +1,298 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_COMPRESSION_SUPPORT
+
+
+#include "vmime/net/deflateSocket.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+#include "vmime/exception.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+
+namespace vmime {
+namespace net {
+
+
+struct deflateSocket::zlibStreams {
+
+	z_stream deflater;
+	z_stream inflater;
+
+	bool inflatePending;  // the inflater may hold more output
+};
+
+
+deflateSocket::deflateSocket(const shared_ptr <socket>& wrapped)
+	: m_wrapped(wrapped),
+	  m_streams(new zlibStreams),
+	  m_uncompressedBytesSent(0),
+	  m_compressedBytesSent(0) {
+
+	std::memset(&m_streams->deflater, 0, sizeof(m_streams->deflater));
+	std::memset(&m_streams->inflater, 0, sizeof(m_streams->inflater));
+
+	m_streams->inflatePending = false;
+
+	// Negative window bits: raw DEFLATE data, without zlib header
+	if (deflateInit2(&m_streams->deflater, Z_DEFAULT_COMPRESSION,
+			Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+
+		throw exceptions::socket_exception("Cannot initialize compression");
+	}
+
+	if (inflateInit2(&m_streams->inflater, -15) != Z_OK) {
+
+		deflateEnd(&m_streams->deflater);
+		throw exceptions::socket_exception("Cannot initialize decompression");
+	}
+}
+
+
+deflateSocket::~deflateSocket() {
+
+	deflateEnd(&m_streams->deflater);
+	inflateEnd(&m_streams->inflater);
+}
+
+
+void deflateSocket::connect(const string& address, const port_t port) {
+
+	m_wrapped->connect(address, port);
+}
+
+
+void deflateSocket::disconnect() {
+
+	m_wrapped->disconnect();
+}
+
+
+bool deflateSocket::isConnected() const {
+
+	return m_wrapped->isConnected();
+}
+
+
+size_t deflateSocket::getBlockSize() const {
+
+	return m_wrapped->getBlockSize();
+}
+
+
+const string deflateSocket::getPeerName() const {
+
+	return m_wrapped->getPeerName();
+}
+
+
+const string deflateSocket::getPeerAddress() const {
+
+	return m_wrapped->getPeerAddress();
+}
+
+
+shared_ptr <timeoutHandler> deflateSocket::getTimeoutHandler() {
+
+	return m_wrapped->getTimeoutHandler();
+}
+
+
+void deflateSocket::setTracer(const shared_ptr <tracer>& tracer) {
+
+	m_wrapped->setTracer(tracer);
+}
+
+
+shared_ptr <tracer> deflateSocket::getTracer() {
+
+	return m_wrapped->getTracer();
+}
+
+
+size_t deflateSocket::getUncompressedBytesSent() const {
+
+	return m_uncompressedBytesSent;
+}
+
+
+size_t deflateSocket::getCompressedBytesSent() const {
+
+	return m_compressedBytesSent;
+}
+
+
+bool deflateSocket::hasPendingInput() const {
+
+	return m_streams->inflater.avail_in != 0 || m_streams->inflatePending;
+}
+
+
+bool deflateSocket::waitForRead(const int msecs) {
+
+	// Data already received may not have been decompressed yet
+	if (hasPendingInput()) {
+		return true;
+	}
+
+	return m_wrapped->waitForRead(msecs);
+}
+
+
+bool deflateSocket::waitForWrite(const int msecs) {
+
+	return m_wrapped->waitForWrite(msecs);
+}
+
+
+void deflateSocket::receive(string& buffer) {
+
+	const size_t n = receiveRaw(m_recvBuffer, sizeof(m_recvBuffer));
+
+	buffer = utility::stringUtils::makeStringFromBytes(m_recvBuffer, n);
+}
+
+
+size_t deflateSocket::receiveRaw(byte_t* buffer, const size_t count) {
+
+	z_stream& strm = m_streams->inflater;
+
+	if (!hasPendingInput()) {
+
+		const size_t n = m_wrapped->receiveRaw(m_inputBuffer, sizeof(m_inputBuffer));
+
+		if (n == 0) {
+			return 0;
+		}
+
+		strm.next_in = m_inputBuffer;
+		strm.avail_in = static_cast <uInt>(n);
+	}
+
+	const uInt outputLen = static_cast <uInt>(std::min <size_t>(count, 0x7fffffff));
+
+	strm.next_out = buffer;
+	strm.avail_out = outputLen;
+
+	const int ret = inflate(&strm, Z_SYNC_FLUSH);
+
+	if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+		throw exceptions::socket_exception("Invalid compressed data");
+	}
+
+	// If the output buffer is full, there may be more data to
+	// decompress even if all the input has been consumed
+	m_streams->inflatePending = (strm.avail_out == 0);
+
+	return outputLen - strm.avail_out;
+}
+
+
+void deflateSocket::compress(const byte_t* buffer, const size_t count, const bool flush) {
+
+	z_stream& strm = m_streams->deflater;
+
+	strm.next_in = const_cast <byte_t*>(buffer);
+	strm.avail_in = static_cast <uInt>(count);
+
+	do {
+
+		strm.next_out = m_outputBuffer;
+		strm.avail_out = sizeof(m_outputBuffer);
+
+		deflate(&strm, flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+
+		const size_t n = sizeof(m_outputBuffer) - strm.avail_out;
+
+		if (n != 0) {
+
+			m_wrapped->sendRaw(m_outputBuffer, n);
+			m_compressedBytesSent += n;
+		}
+
+	} while (strm.avail_out == 0);
+
+	m_uncompressedBytesSent += count;
+}
+
+
+void deflateSocket::send(const string& buffer) {
+
+	sendRaw(reinterpret_cast <const byte_t*>(buffer.data()), buffer.length());
+}
+
+
+void deflateSocket::send(const char* str) {
+
+	sendRaw(reinterpret_cast <const byte_t*>(str), strlen(str));
+}
+
+
+void deflateSocket::sendRaw(const byte_t* buffer, const size_t count) {
+
+	// Flush after each write, so that the server receives complete commands
+	compress(buffer, count, true);
+}
+
+
+size_t deflateSocket::sendRawNonBlocking(const byte_t* buffer, const size_t count) {
+
+	// Data given to the compressor cannot be taken back, so it is
+	// always sent entirely
+	sendRaw(buffer, count);
+
+	return count;
+}
+
+
+void deflateSocket::sendRawBlocks(const block* blocks, const size_t count) {
+
+	// Flush only once, so that the blocks share the same compressed output
+	for (size_t i = 0 ; i < count ; ++i) {
+		compress(blocks[i].data, blocks[i].count, false);
+	}
+
+	compress(NULL, 0, true);
+}
+
+
+unsigned int deflateSocket::getStatus() const {
+
+	return m_wrapped->getStatus();
+}
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_COMPRESSION_SUPPORT
@@ -0,0 +1,123 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_DEFLATESOCKET_HPP_INCLUDED
+#define VMIME_NET_DEFLATESOCKET_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_COMPRESSION_SUPPORT
+
+
+#include "vmime/types.hpp"
+
+#include "vmime/net/socket.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+/** A socket which compresses the data sent and decompresses the data
+  * received on the wrapped socket, using the raw DEFLATE format
+  * (RFC-1951), as required by the IMAP COMPRESS extension (RFC-4978).
+  */
+class VMIME_EXPORT deflateSocket : public socket {
+
+public:
+
+	deflateSocket(const shared_ptr <socket>& wrapped);
+	~deflateSocket();
+
+	void connect(const string& address, const port_t port);
+	void disconnect();
+
+	bool isConnected() const;
+
+	bool waitForRead(const int msecs = 30000);
+	bool waitForWrite(const int msecs = 30000);
+
+	void receive(string& buffer);
+	size_t receiveRaw(byte_t* buffer, const size_t count);
+
+	void send(const string& buffer);
+	void send(const char* str);
+	void sendRaw(const byte_t* buffer, const size_t count);
+	size_t sendRawNonBlocking(const byte_t* buffer, const size_t count);
+	void sendRawBlocks(const block* blocks, const size_t count);
+
+	size_t getBlockSize() const;
+
+	unsigned int getStatus() const;
+
+	const string getPeerName() const;
+	const string getPeerAddress() const;
+
+	shared_ptr <timeoutHandler> getTimeoutHandler();
+
+	void setTracer(const shared_ptr <tracer>& tracer);
+	shared_ptr <tracer> getTracer();
+
+	/** Return the number of bytes given to send() before compression.
+	  *
+	  * @return number of uncompressed bytes sent
+	  */
+	size_t getUncompressedBytesSent() const;
+
+	/** Return the number of bytes actually sent on the wrapped socket.
+	  *
+	  * @return number of compressed bytes sent
+	  */
+	size_t getCompressedBytesSent() const;
+
+private:
+
+	void compress(const byte_t* buffer, const size_t count, const bool flush);
+
+	bool hasPendingInput() const;
+
+
+	struct zlibStreams;
+
+	shared_ptr <socket> m_wrapped;
+
+	scoped_ptr <zlibStreams> m_streams;
+
+	size_t m_uncompressedBytesSent;
+	size_t m_compressedBytesSent;
+
+	byte_t m_recvBuffer[65536];
+	byte_t m_inputBuffer[16384];
+	byte_t m_outputBuffer[16384];
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_COMPRESSION_SUPPORT
+
+#endif // VMIME_NET_DEFLATESOCKET_HPP_INCLUDED
@@ -212,6 +212,17 @@ shared_ptr <IMAPCommand> IMAPCommand::FETCH(
 	const std::vector <string>& params
 ) {
 
+	return FETCH(msgs, params, std::vector <string>());
+}
+
+
+// static
+shared_ptr <IMAPCommand> IMAPCommand::FETCH(
+	const messageSet& msgs,
+	const std::vector <string>& params,
+	const std::vector <string>& modifiers
+) {
+
 	std::ostringstream cmd;
 	cmd.imbue(std::locale::classic());
 
@@ -237,6 +248,19 @@ shared_ptr <IMAPCommand> IMAPCommand::FETCH(
 		cmd << ")";
 	}
 
+	// Fetch modifiers (eg. CHANGEDSINCE, RFC-7162)
+	if (!modifiers.empty()) {
+
+		cmd << " (";
+
+		for (size_t i = 0, n = modifiers.size() ; i < n ; ++i) {
+			if (i != 0) cmd << " ";
+			cmd << modifiers[i];
+		}
+
+		cmd << ")";
+	}
+
 	return createCommand(cmd.str());
 }
 
@@ -381,6 +405,32 @@ shared_ptr <IMAPCommand> IMAPCommand::STARTTLS() {
 }
 
 
+// static
+shared_ptr <IMAPCommand> IMAPCommand::COMPRESS(const string& mechanism) {
+
+	std::ostringstream cmd;
+	cmd.imbue(std::locale::classic());
+	cmd << "COMPRESS " << mechanism;
+
+	return createCommand(cmd.str());
+}
+
+
+// static
+shared_ptr <IMAPCommand> IMAPCommand::ENABLE(const std::vector <string>& extensions) {
+
+	std::ostringstream cmd;
+	cmd.imbue(std::locale::classic());
+	cmd << "ENABLE";
+
+	for (size_t i = 0, n = extensions.size() ; i < n ; ++i) {
+		cmd << " " << extensions[i];
+	}
+
+	return createCommand(cmd.str());
+}
+
+
 // static
 shared_ptr <IMAPCommand> IMAPCommand::CAPABILITY() {
 
@@ -395,6 +445,13 @@ shared_ptr <IMAPCommand> IMAPCommand::NOOP() {
 }
 
 
+// static
+shared_ptr <IMAPCommand> IMAPCommand::IDLE() {
+
+	return createCommand("IDLE");
+}
+
+
 // static
 shared_ptr <IMAPCommand> IMAPCommand::EXPUNGE() {
 
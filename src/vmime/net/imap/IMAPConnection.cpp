@@ -31,6 +31,7 @@
 #include "vmime/net/imap/IMAPConnection.hpp"
 #include "vmime/net/imap/IMAPUtils.hpp"
 #include "vmime/net/imap/IMAPStore.hpp"
+#include "vmime/net/imap/IMAPFolder.hpp"
 #include "vmime/net/imap/IMAPCommand.hpp"
 
 #include "vmime/exception.hpp"
@@ -49,6 +50,11 @@
 	#include "vmime/net/tls/TLSSecuredConnectionInfos.hpp"
 #endif // VMIME_HAVE_TLS_SUPPORT
 
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+	#include "vmime/net/deflateSocket.hpp"
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
+
+#include <algorithm>
 #include <sstream>
 
 // Helpers for service properties
@@ -80,7 +86,8 @@ IMAPConnection::IMAPConnection(
 	  m_secured(false),
 	  m_firstTag(true),
 	  m_capabilitiesFetched(false),
-	  m_noModSeq(false) {
+	  m_noModSeq(false),
+	  m_idleFolder(NULL) {
 
 	static int connectionId = 0;
 
@@ -120,6 +127,7 @@ void IMAPConnection::connect() {
 
 	m_state = STATE_NONE;
 	m_hierarchySeparator = '\0';
+	m_enabledExtensions.clear();
 
 	const string address = GET_PROPERTY(string, PROPERTY_SERVER_ADDRESS);
 	const port_t port = GET_PROPERTY(port_t, PROPERTY_SERVER_PORT);
@@ -240,6 +248,25 @@ void IMAPConnection::connect() {
 		}
 	}
 
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+	// Enable compression (COMPRESS extension), if requested
+	const bool compress = HAS_PROPERTY(PROPERTY_OPTIONS_COMPRESS)
+		&& GET_PROPERTY(bool, PROPERTY_OPTIONS_COMPRESS);
+
+	if (compress && hasCapability("COMPRESS=DEFLATE")) {
+
+		try {
+
+			startCompression();
+
+		// Non-fatal error
+		} catch (exceptions::command_error&) {
+
+			// Continue without compression
+		}
+	}
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
+
 	// Get the hierarchy separator character
 	initHierarchySeparator();
 
@@ -589,6 +616,28 @@ void IMAPConnection::startTLS() {
 #endif // VMIME_HAVE_TLS_SUPPORT
 
 
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+
+void IMAPConnection::startCompression() {
+
+	IMAPCommand::COMPRESS("DEFLATE")->send(dynamicCast <IMAPConnection>(shared_from_this()));
+
+	scoped_ptr <IMAPParser::response> resp(m_parser->readResponse(*m_tag));
+
+	if (resp->isBad() || resp->response_done->response_tagged->
+		resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
+
+		throw exceptions::command_error("COMPRESS", resp->getErrorLog(), "bad response");
+	}
+
+	// Compression starts right after the CRLF of the tagged OK response (RFC-4978)
+	m_socket = make_shared <deflateSocket>(m_socket);
+	m_parser->setSocket(m_socket);
+}
+
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
+
+
 const std::vector <string> IMAPConnection::getCapabilities() {
 
 	if (!m_capabilitiesFetched) {
@@ -747,6 +796,8 @@ void IMAPConnection::internalDisconnect() {
 
 	m_secured = false;
 	m_cntInfos = null;
+
+	m_idleFolder = NULL;
 }
 
 
@@ -791,16 +842,30 @@ void IMAPConnection::initHierarchySeparator() {
 }
 
 
-void IMAPConnection::sendCommand(const shared_ptr <IMAPCommand>& cmd) {
+IMAPTag IMAPConnection::sendCommand(const shared_ptr <IMAPCommand>& cmd) {
+
+	// Any command terminates the IDLE command
+	if (m_idleFolder) {
+		m_idleFolder->stopIdle();
+	}
 
 	if (!m_firstTag) {
 		++(*m_tag);
 	}
 
-	m_socket->send(*m_tag);
-	m_socket->send(" ");
-	m_socket->send(cmd->getText());
-	m_socket->send("\r\n");
+	// Send the whole line at once, so that pipelined commands
+	// are not split into many small packets
+	const string text = cmd->getText();
+	const string tag = *m_tag;
+
+	string line;
+	line.reserve(tag.length() + 1 + text.length() + 2);
+	line += tag;
+	line += ' ';
+	line += text;
+	line += "\r\n";
+
+	m_socket->send(line);
 
 	m_firstTag = false;
 
@@ -811,6 +876,8 @@ void IMAPConnection::sendCommand(const shared_ptr <IMAPCommand>& cmd) {
 
 		m_tracer->traceSend(oss.str());
 	}
+
+	return *m_tag;
 }
 
 
@@ -820,9 +887,110 @@ void IMAPConnection::sendRaw(const byte_t* buffer, const size_t count) {
 }
 
 
-IMAPParser::response* IMAPConnection::readResponse(IMAPParser::literalHandler* lh) {
+IMAPParser::response* IMAPConnection::startIdle(IMAPFolder* folder) {
+
+	if (!hasCapability("IDLE")) {
+		throw exceptions::operation_not_supported();
+	}
+
+	IMAPCommand::IDLE()->send(dynamicCast <IMAPConnection>(shared_from_this()));
+
+	scoped_ptr <IMAPParser::response> resp(m_parser->readResponse(*m_tag));
+
+	// The server must answer with a continuation request
+	bool idling = false;
+
+	for (auto &respData : resp->continue_req_or_response_data) {
+
+		if (respData->continue_req) {
+			idling = true;
+			break;
+		}
+	}
+
+	if (!idling) {
+		throw exceptions::command_error("IDLE", resp->getErrorLog(), "bad response");
+	}
+
+	m_idleFolder = folder;
+
+	return resp.release();
+}
+
+
+IMAPParser::response* IMAPConnection::stopIdle() {
+
+	m_idleFolder = NULL;
 
-	return m_parser->readResponse(*m_tag, lh);
+	m_socket->send("DONE\r\n");
+
+	if (m_tracer) {
+		m_tracer->traceSend("DONE");
+	}
+
+	return m_parser->readResponse(*m_tag);
+}
+
+
+IMAPFolder* IMAPConnection::getIdleFolder() const {
+
+	return m_idleFolder;
+}
+
+
+bool IMAPConnection::waitForData(const int msecs) {
+
+	return m_parser->waitForData(msecs);
+}
+
+
+IMAPParser::response* IMAPConnection::readIdleResponse() {
+
+	scoped_ptr <IMAPParser::response> resp(m_parser->readNextResponse());
+
+	bool bye = (resp->response_done && resp->response_done->response_fatal);
+
+	for (auto &respData : resp->continue_req_or_response_data) {
+
+		if (respData->response_data && respData->response_data->resp_cond_bye) {
+			bye = true;
+		}
+	}
+
+	if (bye) {
+
+		// The server is closing the connection: do not send DONE or LOGOUT
+		m_idleFolder = NULL;
+		m_state = STATE_LOGOUT;
+
+		internalDisconnect();
+
+	} else if (resp->response_done) {
+
+		// The server terminated the IDLE command
+		m_idleFolder = NULL;
+	}
+
+	return resp.release();
+}
+
+
+IMAPParser::response* IMAPConnection::readResponse(
+	IMAPParser::literalHandler* lh,
+	IMAPParser::responseDataHandler* rdh
+) {
+
+	return m_parser->readResponse(*m_tag, lh, rdh);
+}
+
+
+IMAPParser::response* IMAPConnection::readTaggedResponse(
+	const IMAPTag& tag,
+	IMAPParser::literalHandler* lh,
+	IMAPParser::responseDataHandler* rdh
+) {
+
+	return m_parser->readResponse(tag, lh, rdh);
 }
 
 
@@ -905,6 +1073,53 @@ void IMAPConnection::disableMODSEQ() {
 }
 
 
+bool IMAPConnection::enableExtension(const string& extension) {
+
+	if (isExtensionEnabled(extension)) {
+		return true;
+	}
+
+	if (!hasCapability("ENABLE") || !hasCapability(extension)) {
+		return false;
+	}
+
+	IMAPCommand::ENABLE(std::vector <string>(1, extension))
+		->send(dynamicCast <IMAPConnection>(shared_from_this()));
+
+	scoped_ptr <IMAPParser::response> resp(m_parser->readResponse(*m_tag));
+
+	if (resp->isBad() || resp->response_done->response_tagged->
+		resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
+
+		throw exceptions::command_error("ENABLE", resp->getErrorLog(), "bad response");
+	}
+
+	// Extensions actually enabled are listed in the untagged ENABLED response
+	for (auto &respData : resp->continue_req_or_response_data) {
+
+		if (!respData->response_data || !respData->response_data->enable_data) {
+			continue;
+		}
+
+		for (auto &cap : respData->response_data->enable_data->capabilities) {
+
+			if (cap->atom) {
+				m_enabledExtensions.push_back(utility::stringUtils::toUpper(cap->atom->value));
+			}
+		}
+	}
+
+	return isExtensionEnabled(extension);
+}
+
+
+bool IMAPConnection::isExtensionEnabled(const string& extension) const {
+
+	return std::find(m_enabledExtensions.begin(), m_enabledExtensions.end(),
+		utility::stringUtils::toUpper(extension)) != m_enabledExtensions.end();
+}
+
+
 } // imap
 } // net
 } // vmime
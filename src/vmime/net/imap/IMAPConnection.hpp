@@ -49,6 +49,7 @@ namespace imap {
 
 class IMAPTag;
 class IMAPStore;
+class IMAPFolder;
 class IMAPCommand;
 
 
@@ -80,10 +81,74 @@ public:
 	char hierarchySeparator() const;
 
 
-	void sendCommand(const shared_ptr <IMAPCommand>& cmd);
+	IMAPTag sendCommand(const shared_ptr <IMAPCommand>& cmd);
 	void sendRaw(const byte_t* buffer, const size_t count);
 
-	IMAPParser::response* readResponse(IMAPParser::literalHandler* lh = NULL);
+	IMAPParser::response* readResponse(
+		IMAPParser::literalHandler* lh = NULL,
+		IMAPParser::responseDataHandler* rdh = NULL
+	);
+
+	/** Read the response to the command which was sent with the specified
+	  * tag. This allows sending several commands before reading their
+	  * responses (pipelining): responses to other commands which are
+	  * received first are kept until they are requested. Commands which
+	  * need a continuation request (eg. APPEND) must not be pipelined.
+	  *
+	  * @param tag tag returned by sendCommand()
+	  * @param lh handler for literals, or NULL
+	  * @param rdh handler for untagged data, or NULL
+	  * @return response (the caller is responsible to free the memory)
+	  */
+	IMAPParser::response* readTaggedResponse(
+		const IMAPTag& tag,
+		IMAPParser::literalHandler* lh = NULL,
+		IMAPParser::responseDataHandler* rdh = NULL
+	);
+
+
+	/** Send the IDLE command (RFC-2177) on behalf of the specified folder.
+	  * While the connection is idling, any call to sendCommand() first
+	  * asks the folder to terminate the IDLE command.
+	  *
+	  * @param folder folder which is notified of changes
+	  * @return response up to the continuation request (the caller is
+	  * responsible to free the memory)
+	  * @throw exceptions::operation_not_supported if the server does not
+	  * support the IDLE extension
+	  * @throw exceptions::command_error if the server refused the command
+	  */
+	IMAPParser::response* startIdle(IMAPFolder* folder);
+
+	/** Terminate the IDLE command by sending "DONE".
+	  *
+	  * @return tagged response to the IDLE command (the caller is
+	  * responsible to free the memory)
+	  */
+	IMAPParser::response* stopIdle();
+
+	/** Return the folder for which the connection is idling.
+	  *
+	  * @return idling folder, or NULL if the connection is not idling
+	  */
+	IMAPFolder* getIdleFolder() const;
+
+	/** Wait until the server sends some data.
+	  *
+	  * @param msecs maximum time to wait, in milliseconds
+	  * @return true if data is available, or false if the delay elapsed
+	  */
+	bool waitForData(const int msecs);
+
+	/** Read a single response line while idling. If the server ended
+	  * the IDLE command (completion result) or is closing the connection
+	  * (BYE response), the connection is not idling anymore; in the
+	  * latter case, it is also disconnected.
+	  *
+	  * @return response holding either a single untagged data, or only
+	  * the completion result (the caller is responsible to free the memory)
+	  */
+	IMAPParser::response* readIdleResponse();
 
 
 	shared_ptr <const IMAPStore> getStore() const;
@@ -112,6 +177,24 @@ public:
 	bool isMODSEQDisabled() const;
 	void disableMODSEQ();
 
+	/** Enable an extension on this connection, using the ENABLE
+	  * command (RFC-5161). This must be done before a folder is
+	  * selected.
+	  *
+	  * @param extension name of the extension (eg. "QRESYNC")
+	  * @return true if the server enabled the extension, or false
+	  * if it does not support it
+	  * @throw exceptions::command_error if the server refused the command
+	  */
+	bool enableExtension(const string& extension);
+
+	/** Tests whether an extension has been enabled on this connection.
+	  *
+	  * @param extension name of the extension (eg. "QRESYNC")
+	  * @return true if the extension is enabled, false otherwise
+	  */
+	bool isExtensionEnabled(const string& extension) const;
+
 private:
 
 	shared_ptr <IMAPStore> getStoreOrThrow();
@@ -125,6 +208,10 @@ private:
 	void startTLS();
 #endif // VMIME_HAVE_TLS_SUPPORT
 
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+	void startCompression();
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
+
 	bool processCapabilityResponseData(const IMAPParser::response* resp);
 	void processCapabilityResponseData(const IMAPParser::capability_data* capaData);
 
@@ -155,6 +242,10 @@ private:
 
 	bool m_noModSeq;
 
+	std::vector <string> m_enabledExtensions;
+
+	IMAPFolder* m_idleFolder;
+
 	shared_ptr <tracer> m_tracer;
 
 
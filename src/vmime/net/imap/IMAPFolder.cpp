@@ -44,6 +44,8 @@
 #include "vmime/utility/outputStreamAdapter.hpp"
 
 #include <algorithm>
+#include <cstdlib>
+#include <exception>
 #include <sstream>
 
 
@@ -75,6 +77,17 @@ IMAPFolder::~IMAPFolder() {
 
 	try {
 
+		// Events cannot be sent from the destructor: just terminate
+		// the IDLE command without processing the response
+		if (isIdling()) {
+
+			try {
+				scoped_ptr <IMAPParser::response> resp(m_connection->stopIdle());
+			} catch (...) {
+				// Ignore
+			}
+		}
+
 		shared_ptr <IMAPStore> store = m_store.lock();
 
 		if (store) {
@@ -148,6 +161,26 @@ const folder::path IMAPFolder::getFullPath() const {
 
 void IMAPFolder::open(const int mode, bool failIfModeIsNotAvailable) {
 
+	std::vector <string> selectParams;
+
+	if (m_connection->hasCapability("CONDSTORE")) {
+		selectParams.push_back("CONDSTORE");
+	}
+
+	scoped_ptr <IMAPParser::response> resp(
+		openImpl(mode, failIfModeIsNotAvailable, /* qresync */ false, selectParams, NULL)
+	);
+}
+
+
+IMAPParser::response* IMAPFolder::openImpl(
+	const int mode,
+	const bool failIfModeIsNotAvailable,
+	const bool qresync,
+	const std::vector <string>& selectParams,
+	IMAPParser::responseDataHandler* rdh
+) {
+
 	shared_ptr <IMAPStore> store = m_store.lock();
 
 	if (!store) {
@@ -171,6 +204,11 @@ void IMAPFolder::open(const int mode, bool failIfModeIsNotAvailable) {
 
 		connection->connect();
 
+		// QRESYNC must be enabled before the folder is selected
+		if (qresync && !connection->enableExtension("QRESYNC")) {
+			throw exceptions::operation_not_supported();
+		}
+
 		// Emit the "SELECT" command
 		//
 		// Example:  C: A142 SELECT INBOX
@@ -182,12 +220,6 @@ void IMAPFolder::open(const int mode, bool failIfModeIsNotAvailable) {
 		//           S: * OK [PERMANENTFLAGS (\Deleted \Seen \*)] Limited
 		//           S: A142 OK [READ-WRITE] SELECT completed
 
-		std::vector <string> selectParams;
-
-		if (m_connection->hasCapability("CONDSTORE")) {
-			selectParams.push_back("CONDSTORE");
-		}
-
 		IMAPCommand::SELECT(
 			mode == MODE_READ_ONLY,
 			IMAPUtils::pathToString(connection->hierarchySeparator(), getFullPath()),
@@ -195,7 +227,7 @@ void IMAPFolder::open(const int mode, bool failIfModeIsNotAvailable) {
 		)->send(connection);
 
 		// Read the response
-		scoped_ptr <IMAPParser::response> resp(connection->readResponse());
+		scoped_ptr <IMAPParser::response> resp(connection->readResponse(NULL, rdh));
 
 		if (resp->isBad() || resp->response_done->response_tagged->
 				resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
@@ -282,6 +314,8 @@ void IMAPFolder::open(const int mode, bool failIfModeIsNotAvailable) {
 		m_open = true;
 		m_mode = mode;
 
+		return resp.release();
+
 	} catch (std::exception&) {
 
 		throw;
@@ -781,6 +815,122 @@ std::vector <shared_ptr <folder> > IMAPFolder::getFolders(const bool recursive)
 }
 
 
+// Processes the data of each untagged FETCH response as soon as it has
+// been parsed, so that the whole response does not have to be kept in
+// memory until the command completes
+class IMAPFolder::fetchResponseHandler : public IMAPParser::responseDataHandler {
+
+public:
+
+	fetchResponseHandler(
+		IMAPFolder& folder,
+		const fetchAttributes& options,
+		std::map <size_t, shared_ptr <IMAPMessage> >* numberToMsg,
+		fetchListener* listener,
+		utility::progressListener* progress
+	)
+		: m_folder(folder),
+		  m_options(options),
+		  m_numberToMsg(numberToMsg),
+		  m_listener(listener),
+		  m_progress(progress),
+		  m_current(0) {
+
+	}
+
+	bool handleResponseData(const IMAPParser::response_data& data) {
+
+		const IMAPParser::message_data* messageData = data.message_data.get();
+
+		// We are only interested in responses of type "FETCH": other
+		// data (status updates) is kept in the response
+		if (!messageData || messageData->type != IMAPParser::message_data::FETCH) {
+			return false;
+		}
+
+		// Do not throw while the response is being read: report the
+		// error once it has been read completely
+		if (!m_error) {
+
+			try {
+
+				processFetch(*messageData);
+
+			} catch (...) {
+
+				m_error = std::current_exception();
+			}
+		}
+
+		return true;
+	}
+
+	void rethrowError() const {
+
+		if (m_error) {
+			std::rethrow_exception(m_error);
+		}
+	}
+
+private:
+
+	void processFetch(const IMAPParser::message_data& messageData) {
+
+		const size_t num = messageData.number;
+
+		if (m_numberToMsg) {
+
+			// Process fetch response for a known message
+			std::map <size_t, shared_ptr <IMAPMessage> >::iterator it = m_numberToMsg->find(num);
+
+			if (it == m_numberToMsg->end()) {
+				return;
+			}
+
+			(*it).second->processFetchResponse(m_options, messageData);
+
+			if (m_progress) {
+				m_progress->progress(++m_current, m_numberToMsg->size());
+			}
+
+		} else {
+
+			// Get message UID
+			message::uid msgUID;
+
+			for (auto &att : messageData.msg_att->items) {
+
+				if (att->type == IMAPParser::msg_att_item::UID) {
+					msgUID = att->uniqueid->value;
+					break;
+				}
+			}
+
+			// Create a new message reference
+			shared_ptr <IMAPFolder> thisFolder = dynamicCast <IMAPFolder>(m_folder.shared_from_this());
+			shared_ptr <IMAPMessage> msg = make_shared <IMAPMessage>(thisFolder, num, msgUID);
+
+			// Process fetch response for this message
+			msg->processFetchResponse(m_options, messageData);
+
+			m_listener->messageFetched(msg);
+		}
+	}
+
+
+	IMAPFolder& m_folder;
+	const fetchAttributes& m_options;
+
+	std::map <size_t, shared_ptr <IMAPMessage> >* m_numberToMsg;
+	fetchListener* m_listener;
+
+	utility::progressListener* m_progress;
+	size_t m_current;
+
+	std::exception_ptr m_error;
+};
+
+
 void IMAPFolder::fetchMessages(
 	std::vector <shared_ptr <message> >& msg,
 	const fetchAttributes& options,
@@ -816,51 +966,34 @@ void IMAPFolder::fetchMessages(
 		m_connection, messageSet::byNumber(list), options
 	)->send(m_connection);
 
-	// Get the response
-	scoped_ptr <IMAPParser::response> resp(m_connection->readResponse());
-
-	if (resp->isBad() || resp->response_done->response_tagged->
-		resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
-
-		throw exceptions::command_error("FETCH", resp->getErrorLog(), "bad response");
-	}
-
-	auto &respDataList = resp->continue_req_or_response_data;
-
 	const size_t total = msg.size();
-	size_t current = 0;
 
 	if (progress) {
 		progress->start(total);
 	}
 
-	try {
-
-		for (auto it = respDataList.begin() ; it != respDataList.end() ; ++it) {
-
-			if (!(*it)->response_data) {
-				throw exceptions::command_error("FETCH", resp->getErrorLog(), "invalid response");
-			}
+	// Get the response: messages are updated as soon as their data
+	// is received
+	fetchResponseHandler handler(*this, options, &numberToMsg, NULL, progress);
+	scoped_ptr <IMAPParser::response> resp;
 
-			auto *messageData = (*it)->response_data->message_data.get();
+	try {
 
-			// We are only interested in responses of type "FETCH"
-			if (!messageData || messageData->type != IMAPParser::message_data::FETCH) {
-				continue;
-			}
+		resp.reset(m_connection->readResponse(NULL, &handler));
 
-			// Process fetch response for this message
-			const size_t num = messageData->number;
+		if (resp->isBad() || resp->response_done->response_tagged->
+			resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
 
-			std::map <size_t, shared_ptr <IMAPMessage> >::iterator msg = numberToMsg.find(num);
+			throw exceptions::command_error("FETCH", resp->getErrorLog(), "bad response");
+		}
 
-			if (msg != numberToMsg.end()) {
+		handler.rethrowError();
 
-				(*msg).second->processFetchResponse(options, *messageData);
+		for (auto it = resp->continue_req_or_response_data.begin() ;
+		     it != resp->continue_req_or_response_data.end() ; ++it) {
 
-				if (progress) {
-					progress->progress(++current, total);
-				}
+			if (!(*it)->response_data) {
+				throw exceptions::command_error("FETCH", resp->getErrorLog(), "invalid response");
 			}
 		}
 
@@ -890,11 +1023,109 @@ void IMAPFolder::fetchMessage(const shared_ptr <message>& msg, const fetchAttrib
 }
 
 
+namespace {
+
+
+// Tests whether a message UID belongs to a set of UIDs sent by the server
+bool isUIDInSet(const message::uid& msgUID, const IMAPParser::uid_set& uidSetRef) {
+
+	const string uidStr = msgUID;
+
+	if (uidStr.empty()) {
+		return false;
+	}
+
+	const unsigned long uid = std::strtoul(uidStr.c_str(), NULL, 10);
+
+	for (const IMAPParser::uid_set* uidSet = &uidSetRef ; uidSet ; uidSet = uidSet->next_uid_set.get()) {
+
+		if (uidSet->uid_range) {
+
+			const unsigned long first = uidSet->uid_range->uniqueid1->value;
+			const unsigned long last = uidSet->uid_range->uniqueid2->value;
+
+			if (uid >= std::min(first, last) && uid <= std::max(first, last)) {
+				return true;
+			}
+
+		} else if (uidSet->uniqueid->value == uid) {
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+// Returns the number of UIDs in a set of UIDs sent by the server
+size_t getUIDCount(const IMAPParser::uid_set& uidSetRef) {
+
+	size_t count = 0;
+
+	for (const IMAPParser::uid_set* uidSet = &uidSetRef ; uidSet ; uidSet = uidSet->next_uid_set.get()) {
+
+		if (uidSet->uid_range) {
+
+			const unsigned long first = uidSet->uid_range->uniqueid1->value;
+			const unsigned long last = uidSet->uid_range->uniqueid2->value;
+
+			count += std::max(first, last) - std::min(first, last) + 1;
+
+		} else {
+
+			++count;
+		}
+	}
+
+	return count;
+}
+
+
+// Collects the messages returned by getAndFetchMessages()
+class messageCollector : public IMAPFolder::fetchListener {
+
+public:
+
+	messageCollector(std::vector <shared_ptr <message> >& messages)
+		: m_messages(messages) {
+
+	}
+
+	void messageFetched(const shared_ptr <message>& msg) {
+
+		m_messages.push_back(msg);
+	}
+
+private:
+
+	std::vector <shared_ptr <message> >& m_messages;
+};
+
+
+} // anonymous namespace
+
+
 std::vector <shared_ptr <message> > IMAPFolder::getAndFetchMessages(
 	const messageSet& msgs,
 	const fetchAttributes& attribs
 ) {
 
+	std::vector <shared_ptr <message> > messages;
+
+	messageCollector collector(messages);
+	getAndFetchMessages(msgs, attribs, collector);
+
+	return messages;
+}
+
+
+void IMAPFolder::getAndFetchMessages(
+	const messageSet& msgs,
+	const fetchAttributes& attribs,
+	fetchListener& listener
+) {
+
 	shared_ptr <IMAPStore> store = m_store.lock();
 
 	if (!store) {
@@ -904,7 +1135,7 @@ std::vector <shared_ptr <message> > IMAPFolder::getAndFetchMessages(
 	}
 
 	if (msgs.isEmpty()) {
-		return std::vector <shared_ptr <message> >();
+		return;
 	}
 
 	// Ensure we also get the UID for each message
@@ -914,8 +1145,10 @@ std::vector <shared_ptr <message> > IMAPFolder::getAndFetchMessages(
 	// Send the request
 	IMAPUtils::buildFetchCommand(m_connection, msgs, attribsWithUID)->send(m_connection);
 
-	// Get the response
-	scoped_ptr <IMAPParser::response> resp(m_connection->readResponse());
+	// Get the response: messages are given to the listener as soon
+	// as their data is received
+	fetchResponseHandler handler(*this, attribsWithUID, NULL, &listener, NULL);
+	scoped_ptr <IMAPParser::response> resp(m_connection->readResponse(NULL, &handler));
 
 	if (resp->isBad() || resp->response_done->response_tagged->
 		resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
@@ -923,50 +1156,176 @@ std::vector <shared_ptr <message> > IMAPFolder::getAndFetchMessages(
 		throw exceptions::command_error("FETCH", resp->getErrorLog(), "bad response");
 	}
 
-	auto &respDataList = resp->continue_req_or_response_data;
-
-	std::vector <shared_ptr <message> > messages;
+	handler.rethrowError();
 
-	for (auto it = respDataList.begin() ; it != respDataList.end() ; ++it) {
+	for (auto it = resp->continue_req_or_response_data.begin() ;
+	     it != resp->continue_req_or_response_data.end() ; ++it) {
 
 		if (!(*it)->response_data) {
 			throw exceptions::command_error("FETCH", resp->getErrorLog(), "invalid response");
 		}
+	}
 
-		auto *messageData = (*it)->response_data->message_data.get();
+	processStatusUpdate(resp.get());
+}
 
-		// We are only interested in responses of type "FETCH"
-		if (!messageData || messageData->type != IMAPParser::message_data::FETCH) {
+
+shared_ptr <IMAPFolderChanges> IMAPFolder::openAndResync(
+	const int mode,
+	const vmime_uint32 uidValidity,
+	const vmime_uint64 modSeq
+) {
+
+	shared_ptr <IMAPFolderChanges> changes = make_shared <IMAPFolderChanges>();
+
+	// Example:  C: A02 SELECT INBOX (QRESYNC (67890007 90060115194045000))
+	//           S: * OK [CLOSED]
+	//           S: * 100 EXISTS
+	//           S: * OK [UIDVALIDITY 67890007]
+	//           S: * OK [HIGHESTMODSEQ 90060115205545359]
+	//           S: * VANISHED (EARLIER) 41,43:116,118,120:211,214:540
+	//           S: * 49 FETCH (UID 117 FLAGS (\Seen \Answered) MODSEQ (90060115194045001))
+	//           S: A02 OK [READ-WRITE] mailbox selected
+	std::vector <string> selectParams;
+
+	if (uidValidity != 0 && modSeq != 0) {
+
+		std::ostringstream qresync;
+		qresync.imbue(std::locale::classic());
+		qresync << "QRESYNC (" << uidValidity << " " << modSeq << ")";
+
+		selectParams.push_back(qresync.str());
+
+	} else {
+
+		// No previous state: the caller has to fetch all the messages
+		selectParams.push_back("CONDSTORE");
+	}
+
+	// Changed messages are created as soon as their data is received
+	const fetchAttributes attribs(fetchAttributes::FLAGS | fetchAttributes::UID);
+
+	messageCollector collector(changes->m_changedMessages);
+	fetchResponseHandler handler(*this, attribs, NULL, &collector, NULL);
+
+	scoped_ptr <IMAPParser::response> resp(
+		openImpl(mode, /* failIfModeIsNotAvailable */ false, /* qresync */ true, selectParams, &handler)
+	);
+
+	handler.rethrowError();
+
+	// If the UID validity changed, the server ignores the QRESYNC parameter
+	if (uidValidity == 0 || modSeq == 0 || m_status->getUIDValidity() != uidValidity) {
+
+		changes->m_fullSyncRequired = true;
+		changes->m_changedMessages.clear();
+	}
+
+	fillChanges(*resp, modSeq, *changes);
+
+	return changes;
+}
+
+
+shared_ptr <IMAPFolderChanges> IMAPFolder::getChangesSince(const vmime_uint64 modSeq) {
+
+	shared_ptr <IMAPStore> store = m_store.lock();
+
+	if (!store) {
+		throw exceptions::illegal_state("Store disconnected");
+	} else if (!isOpen()) {
+		throw exceptions::illegal_state("Folder not open");
+	} else if (!m_connection->isExtensionEnabled("QRESYNC")) {
+		throw exceptions::illegal_state("QRESYNC not enabled");
+	}
+
+	shared_ptr <IMAPFolderChanges> changes = make_shared <IMAPFolderChanges>();
+
+	// Example:  C: A03 UID FETCH 1:* (UID FLAGS MODSEQ) (CHANGEDSINCE 12345 VANISHED)
+	//           S: * VANISHED (EARLIER) 300:310,405,411
+	//           S: * 1 FETCH (UID 404 FLAGS (\Seen) MODSEQ (65402))
+	//           S: A03 OK Fetch completed
+	std::vector <string> params;
+	params.push_back("UID");
+	params.push_back("FLAGS");
+	params.push_back("MODSEQ");
+
+	std::ostringstream changedSince;
+	changedSince.imbue(std::locale::classic());
+	changedSince << "CHANGEDSINCE " << modSeq;
+
+	std::vector <string> modifiers;
+	modifiers.push_back(changedSince.str());
+	modifiers.push_back("VANISHED");
+
+	IMAPCommand::FETCH(messageSet::byUID(1, "*"), params, modifiers)->send(m_connection);
+
+	const fetchAttributes attribs(fetchAttributes::FLAGS | fetchAttributes::UID);
+
+	messageCollector collector(changes->m_changedMessages);
+	fetchResponseHandler handler(*this, attribs, NULL, &collector, NULL);
+
+	scoped_ptr <IMAPParser::response> resp(m_connection->readResponse(NULL, &handler));
+
+	if (resp->isBad() || resp->response_done->response_tagged->
+		resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
+
+		throw exceptions::command_error("FETCH", resp->getErrorLog(), "bad response");
+	}
+
+	handler.rethrowError();
+
+	processStatusUpdate(resp.get());
+
+	fillChanges(*resp, modSeq, *changes);
+
+	return changes;
+}
+
+
+void IMAPFolder::fillChanges(
+	const IMAPParser::response& resp,
+	const vmime_uint64 modSeq,
+	IMAPFolderChanges& changes
+) {
+
+	changes.m_uidValidity = m_status->getUIDValidity();
+	changes.m_uidNext = m_status->getUIDNext();
+
+	if (changes.m_fullSyncRequired) {
+
+		changes.m_highestModSeq = m_status->getHighestModSeq();
+		return;
+	}
+
+	// Expunged messages, reported with VANISHED responses
+	for (auto &respData : resp.continue_req_or_response_data) {
+
+		if (!respData->response_data || !respData->response_data->message_data) {
 			continue;
 		}
 
-		// Get message number
-		const size_t msgNum = messageData->number;
+		const IMAPParser::message_data& msgData = *respData->response_data->message_data;
 
-		// Get message UID
-		message::uid msgUID;
+		if (msgData.type == IMAPParser::message_data::VANISHED) {
 
-		for (auto &att : messageData->msg_att->items) {
+			const messageSet uids = IMAPUtils::buildMessageSet(*msgData.uid_set);
 
-			if (att->type == IMAPParser::msg_att_item::UID) {
-				msgUID = att->uniqueid->value;
-				break;
+			for (size_t i = 0, n = uids.getRangeCount() ; i < n ; ++i) {
+				changes.m_expungedMessages.addRange(uids.getRangeAt(i));
 			}
 		}
+	}
 
-		// Create a new message reference
-		shared_ptr <IMAPFolder> thisFolder = dynamicCast <IMAPFolder>(shared_from_this());
-		shared_ptr <IMAPMessage> msg = make_shared <IMAPMessage>(thisFolder, msgNum, msgUID);
-
-		messages.push_back(msg);
+	// The highest modification sequence is not always sent again by the
+	// server: use the ones of the changed messages
+	vmime_uint64 highestModSeq = std::max(modSeq, m_status->getHighestModSeq());
 
-		// Process fetch response for this message
-		msg->processFetchResponse(attribsWithUID, *messageData);
+	for (auto &msg : changes.m_changedMessages) {
+		highestModSeq = std::max(highestModSeq, dynamicCast <IMAPMessage>(msg)->getModSequence());
 	}
 
-	processStatusUpdate(resp.get());
-
-	return messages;
+	changes.m_highestModSeq = highestModSeq;
 }
 
 
@@ -1373,7 +1732,40 @@ shared_ptr <folderStatus> IMAPFolder::getStatus() {
 		throw exceptions::illegal_state("Store disconnected");
 	}
 
-	// Build the attributes list
+	const string mailboxName =
+		IMAPUtils::pathToString(m_connection->hierarchySeparator(), getFullPath());
+
+	// Send the request
+	IMAPCommand::STATUS(mailboxName, getStatusAttributes(m_connection))->send(m_connection);
+
+	// Get the response
+	scoped_ptr <IMAPParser::response> resp(m_connection->readResponse());
+
+	if (resp->isBad() || resp->response_done->response_tagged->
+			resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
+
+		throw exceptions::command_error("STATUS", resp->getErrorLog(), "bad response");
+	}
+
+	const IMAPParser::mailbox_data* mailboxData =
+		findStatusData(*resp, m_connection->hierarchySeparator(), mailboxName);
+
+	if (!mailboxData) {
+		throw exceptions::command_error("STATUS", resp->getErrorLog(), "invalid response");
+	}
+
+	shared_ptr <IMAPFolderStatus> status = make_shared <IMAPFolderStatus>();
+	status->updateFromResponse(*mailboxData);
+
+	m_status->updateFromResponse(*mailboxData);
+
+	return status;
+}
+
+
+// static
+const std::vector <string> IMAPFolder::getStatusAttributes(const shared_ptr <IMAPConnection>& cnt) {
+
 	std::vector <string> attribs;
 
 	attribs.push_back("MESSAGES");
@@ -1381,26 +1773,21 @@ shared_ptr <folderStatus> IMAPFolder::getStatus() {
 	attribs.push_back("UIDNEXT");
 	attribs.push_back("UIDVALIDITY");
 
-	if (m_connection->hasCapability("CONDSTORE")) {
+	if (cnt->hasCapability("CONDSTORE")) {
 		attribs.push_back("HIGHESTMODSEQ");
 	}
 
-	// Send the request
-	IMAPCommand::STATUS(
-		IMAPUtils::pathToString(m_connection->hierarchySeparator(), getFullPath()),
-		attribs
-	)->send(m_connection);
-
-	// Get the response
-	scoped_ptr <IMAPParser::response> resp(m_connection->readResponse());
+	return attribs;
+}
 
-	if (resp->isBad() || resp->response_done->response_tagged->
-			resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
 
-		throw exceptions::command_error("STATUS", resp->getErrorLog(), "bad response");
-	}
+// static
+void IMAPFolder::findStatusData(
+	const IMAPParser::response& resp,
+	std::vector <const IMAPParser::mailbox_data*>& data
+) {
 
-	auto &respDataList = resp->continue_req_or_response_data;
+	auto &respDataList = resp.continue_req_or_response_data;
 
 	for (auto it = respDataList.begin() ; it != respDataList.end() ; ++it) {
 
@@ -1411,17 +1798,65 @@ shared_ptr <folderStatus> IMAPFolder::getStatus() {
 			if (responseData->mailbox_data &&
 				responseData->mailbox_data->type == IMAPParser::mailbox_data::STATUS) {
 
-				shared_ptr <IMAPFolderStatus> status = make_shared <IMAPFolderStatus>();
-				status->updateFromResponse(*responseData->mailbox_data);
+				data.push_back(responseData->mailbox_data.get());
+			}
+		}
+	}
+}
+
 
-				m_status->updateFromResponse(*responseData->mailbox_data);
+// static
+const IMAPParser::mailbox_data* IMAPFolder::findStatusData(
+	const IMAPParser::response& resp,
+	const char hierarchySeparator,
+	const string& mailboxName
+) {
 
-				return status;
-			}
+	std::vector <const IMAPParser::mailbox_data*> data;
+	findStatusData(resp, data);
+
+	for (size_t i = 0 ; i < data.size() ; ++i) {
+
+		if (isStatusDataFor(*data[i], hierarchySeparator, mailboxName)) {
+			return data[i];
 		}
 	}
 
-	throw exceptions::command_error("STATUS", resp->getErrorLog(), "invalid response");
+	// Name not recognized: as only one mailbox has been requested,
+	// a single STATUS data can only be about this one
+	if (data.size() == 1) {
+		return data[0];
+	}
+
+	return NULL;
+}
+
+
+// static
+bool IMAPFolder::isStatusDataFor(
+	const IMAPParser::mailbox_data& data,
+	const char hierarchySeparator,
+	const string& mailboxName
+) {
+
+	if (!data.mailbox) {
+		return false;
+	}
+
+	// INBOX is case-insensitive
+	if (data.mailbox->type == IMAPParser::mailbox::INBOX) {
+		return utility::stringUtils::isStringEqualNoCase(mailboxName, string("INBOX"));
+	}
+
+	if (data.mailbox->name == mailboxName) {
+		return true;
+	}
+
+	// Compare the decoded paths, encoded again in the same way
+	return IMAPUtils::pathToString(hierarchySeparator,
+			IMAPUtils::stringToPath(hierarchySeparator, data.mailbox->name)) ==
+		IMAPUtils::pathToString(hierarchySeparator,
+			IMAPUtils::stringToPath(hierarchySeparator, mailboxName));
 }
 
 
@@ -1451,6 +1886,99 @@ void IMAPFolder::noop() {
 }
 
 
+void IMAPFolder::startIdle() {
+
+	shared_ptr <IMAPStore> store = m_store.lock();
+
+	if (!store) {
+		throw exceptions::illegal_state("Store disconnected");
+	} else if (!isOpen()) {
+		throw exceptions::illegal_state("Folder not open");
+	}
+
+	if (isIdling()) {
+		return;
+	}
+
+	scoped_ptr <IMAPParser::response> resp(m_connection->startIdle(this));
+
+	processStatusUpdate(resp.get());
+}
+
+
+bool IMAPFolder::waitForChanges(const int msecs) {
+
+	if (!isIdling()) {
+		throw exceptions::illegal_state("Folder not idling");
+	}
+
+	if (!m_connection->waitForData(msecs)) {
+		return false;
+	}
+
+	// Process untagged data one response at a time, so that events
+	// are sent as soon as the server notifies a change
+	do {
+
+		scoped_ptr <IMAPParser::response> resp(m_connection->readIdleResponse());
+
+		// The server closed the folder connection (BYE): the folder
+		// is closed, and uses the store connection again
+		if (!m_connection->isConnected()) {
+
+			shared_ptr <IMAPStore> store = m_store.lock();
+
+			m_connection = store ? store->connection() : null;
+
+			m_open = false;
+			m_mode = -1;
+
+			m_status = make_shared <IMAPFolderStatus>();
+
+			onClose();
+
+			throw exceptions::command_error("IDLE", resp->getErrorLog(), "connection closed by server");
+		}
+
+		processStatusUpdate(resp.get());
+
+		// The server may terminate the IDLE command by itself
+		if (resp->response_done && (resp->isBad() || resp->response_done->response_tagged->
+				resp_cond_state->status != IMAPParser::resp_cond_state::OK)) {
+
+			throw exceptions::command_error("IDLE", resp->getErrorLog(), "bad response");
+		}
+
+	} while (isIdling() && m_connection->waitForData(0));
+
+	return true;
+}
+
+
+void IMAPFolder::stopIdle() {
+
+	if (!isIdling()) {
+		return;
+	}
+
+	scoped_ptr <IMAPParser::response> resp(m_connection->stopIdle());
+
+	if (resp->isBad() || resp->response_done->response_tagged->
+			resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
+
+		throw exceptions::command_error("IDLE", resp->getErrorLog(), "bad response");
+	}
+
+	processStatusUpdate(resp.get());
+}
+
+
+bool IMAPFolder::isIdling() const {
+
+	return m_connection && m_connection->getIdleFolder() == this;
+}
+
+
 std::vector <size_t> IMAPFolder::getMessageNumbersStartingOnUID(const message::uid& uid) {
 
 	// Send the request
@@ -1692,6 +2220,55 @@ void IMAPFolder::processStatusUpdate(const IMAPParser::response* resp) {
 				);
 
 				expungedMessageCount++;
+
+			} else if (msgData->type == IMAPParser::message_data::VANISHED && !msgData->earlier) {
+
+				// Messages have been expunged (QRESYNC): they are identified by
+				// their UID, so only the messages known by this folder can be
+				// reported and renumbered
+				std::vector <size_t> expungedNumbers;
+
+				for (std::vector <IMAPMessage*>::iterator jt =
+				     m_messages.begin() ; jt != m_messages.end() ; ++jt) {
+
+					if (!(*jt)->isExpunged() && isUIDInSet((*jt)->getUID(), *msgData->uid_set)) {
+						expungedNumbers.push_back((*jt)->getNumber());
+					}
+				}
+
+				std::sort(expungedNumbers.begin(), expungedNumbers.end());
+				expungedNumbers.erase(
+					std::unique(expungedNumbers.begin(), expungedNumbers.end()),
+					expungedNumbers.end()
+				);
+
+				// Renumber from the highest number, so that lower numbers stay valid
+				for (std::vector <size_t>::const_reverse_iterator nit =
+				     expungedNumbers.rbegin() ; nit != expungedNumbers.rend() ; ++nit) {
+
+					for (std::vector <IMAPMessage*>::iterator jt =
+					     m_messages.begin() ; jt != m_messages.end() ; ++jt) {
+
+						if ((*jt)->getNumber() == *nit) {
+							(*jt)->setExpunged();
+						} else if ((*jt)->getNumber() > *nit) {
+							(*jt)->renumber((*jt)->getNumber() - 1);
+						}
+					}
+				}
+
+				if (!expungedNumbers.empty()) {
+
+					events.push_back(
+						make_shared <events::messageCountEvent>(
+							dynamicCast <folder>(shared_from_this()),
+							events::messageCountEvent::TYPE_REMOVED,
+							expungedNumbers
+						)
+					);
+				}
+
+				expungedMessageCount += static_cast <int>(getUIDCount(*msgData->uid_set));
 			}
 		}
 	}
@@ -40,6 +40,7 @@
 
 #include "vmime/net/imap/IMAPParser.hpp"
 #include "vmime/net/imap/IMAPSearchAttributes.hpp"
+#include "vmime/net/imap/IMAPFolderChanges.hpp"
 
 
 namespace vmime {
@@ -163,6 +164,47 @@ public:
 
 	void noop();
 
+	/** Start listening for changes in this folder, using the IMAP IDLE
+	  * command (RFC-2177). Changes sent by the server are processed by
+	  * waitForChanges() and reported with the usual events. Sending any
+	  * other command on the connection terminates idling first.
+	  *
+	  * Servers may drop idling connections after 30 minutes: idling
+	  * should be restarted before that delay elapses.
+	  *
+	  * @throw exceptions::operation_not_supported if the server does not
+	  * support the IDLE extension
+	  * @throw exceptions::net_exception if an error occurs
+	  */
+	void startIdle();
+
+	/** Wait for changes while idling, and notify the listeners of this
+	  * folder about them (message count and message changed events).
+	  *
+	  * @param msecs maximum time to wait, in milliseconds
+	  * @return true if some data has been received from the server,
+	  * or false if the delay elapsed
+	  * @throw exceptions::illegal_state if the folder is not idling
+	  * @throw exceptions::command_error if the server closed the
+	  * connection (the folder is then closed), or ended the IDLE
+	  * command with an error
+	  * @throw exceptions::net_exception if an error occurs
+	  */
+	bool waitForChanges(const int msecs);
+
+	/** Stop listening for changes in this folder. This does nothing
+	  * if the folder is not idling.
+	  *
+	  * @throw exceptions::net_exception if an error occurs
+	  */
+	void stopIdle();
+
+	/** Tests whether the connection is idling for this folder.
+	  *
+	  * @return true if the folder is idling, false otherwise
+	  */
+	bool isIdling() const;
+
 	void expunge();
 
 	shared_ptr <folder> getParent();
@@ -184,6 +226,44 @@ public:
 		const fetchAttributes& attribs
 	);
 
+	/** Receives the messages fetched by getAndFetchMessages(), one
+	  * at a time, as soon as their data has been received.
+	  */
+	class VMIME_EXPORT fetchListener {
+
+	public:
+
+		virtual ~fetchListener() { }
+
+		/** Called when the data of a message has been received
+		  * and processed.
+		  *
+		  * @param msg fetched message
+		  */
+		virtual void messageFetched(const shared_ptr <message>& msg) = 0;
+	};
+
+	/** Fetch messages and give them to a listener as soon as their data
+	  * is received, instead of returning all of them when the command
+	  * completes. The messages are not kept by the folder, so memory usage
+	  * does not grow with the number of messages fetched (eg. when
+	  * fetching ENVELOPE and FLAGS for all the messages of a big folder).
+	  *
+	  * If the listener throws an exception, no more messages are given to
+	  * it, and the exception is thrown again once the server has sent the
+	  * end of the response.
+	  *
+	  * @param msgs index set of messages to retrieve
+	  * @param attribs set of attributes to fetch
+	  * @param listener listener which receives the fetched messages
+	  * @throw exceptions::net_exception if an error occurs
+	  */
+	void getAndFetchMessages(
+		const messageSet& msgs,
+		const fetchAttributes& attribs,
+		fetchListener& listener
+	);
+
 	int getFetchCapabilities() const;
 
 	/** Returns the UID validity of the folder for the current session.
@@ -206,8 +286,61 @@ public:
 	  */
 	vmime_uint64 getHighestModSequence() const;
 
+	/** Open this folder and get the changes which occurred since a
+	  * previous synchronization, using the QRESYNC extension (RFC-7162).
+	  * The server only sends what changed, so the cost of a resync
+	  * depends on the number of changes, not on the size of the folder.
+	  *
+	  * Once QRESYNC is enabled, the server reports expunged messages by
+	  * their UID: message count events then only contain the numbers of
+	  * the expunged messages which are known by this folder.
+	  *
+	  * @param mode open mode (MODE_READ_ONLY or MODE_READ_WRITE)
+	  * @param uidValidity UID validity of the folder at the previous
+	  * synchronization, or 0 if the folder was never synchronized
+	  * @param modSeq highest modification sequence of the folder at the
+	  * previous synchronization, or 0 if the folder was never synchronized
+	  * @return changes since the previous synchronization
+	  * @throw exceptions::operation_not_supported if the server does not
+	  * support the QRESYNC extension
+	  * @throw exceptions::net_exception if an error occurs
+	  */
+	shared_ptr <IMAPFolderChanges> openAndResync(
+		const int mode,
+		const vmime_uint32 uidValidity,
+		const vmime_uint64 modSeq
+	);
+
+	/** Get the changes which occurred since the specified modification
+	  * sequence in a folder which has been opened with openAndResync().
+	  *
+	  * @param modSeq highest modification sequence already known
+	  * @return changes since this modification sequence
+	  * @throw exceptions::illegal_state if the folder has not been
+	  * opened with openAndResync()
+	  * @throw exceptions::net_exception if an error occurs
+	  */
+	shared_ptr <IMAPFolderChanges> getChangesSince(const vmime_uint64 modSeq);
+
 private:
 
+	class fetchResponseHandler;
+
+	IMAPParser::response* openImpl(
+		const int mode,
+		const bool failIfModeIsNotAvailable,
+		const bool qresync,
+		const std::vector <string>& selectParams,
+		IMAPParser::responseDataHandler* rdh
+	);
+
+	void fillChanges(
+		const IMAPParser::response& resp,
+		const vmime_uint64 modSeq,
+		IMAPFolderChanges& changes
+	);
+
+
 	void registerMessage(IMAPMessage* msg);
 	void unregisterMessage(IMAPMessage* msg);
 
@@ -233,6 +366,54 @@ private:
 	  */
 	void processStatusUpdate(const IMAPParser::response* resp);
 
+	/** Return the attributes to request with a STATUS command.
+	  *
+	  * @param cnt connection on which the command will be sent
+	  * @return STATUS attributes
+	  */
+	static const std::vector <string> getStatusAttributes(const shared_ptr <IMAPConnection>& cnt);
+
+	/** Find all the STATUS data in a response.
+	  *
+	  * @param resp parsed IMAP response
+	  * @param data STATUS data found in the response will be appended here
+	  */
+	static void findStatusData(
+		const IMAPParser::response& resp,
+		std::vector <const IMAPParser::mailbox_data*>& data
+	);
+
+	/** Find the STATUS data for the specified mailbox in a response.
+	  * If no data matches the mailbox name, but the response contains
+	  * only one STATUS data, this one is returned.
+	  *
+	  * @param resp parsed IMAP response
+	  * @param hierarchySeparator hierarchy separator of the server
+	  * @param mailboxName mailbox name, as sent in the STATUS command
+	  * @return STATUS data, or NULL if there is none
+	  */
+	static const IMAPParser::mailbox_data* findStatusData(
+		const IMAPParser::response& resp,
+		const char hierarchySeparator,
+		const string& mailboxName
+	);
+
+	/** Test whether STATUS data is about the specified mailbox.
+	  * Names are compared once decoded, so that the server may return
+	  * the name in another form than the one which was sent (eg. with
+	  * a trailing separator, or encoded differently).
+	  *
+	  * @param data STATUS data
+	  * @param hierarchySeparator hierarchy separator of the server
+	  * @param mailboxName mailbox name, as sent in the STATUS command
+	  * @return true if the data is about this mailbox, false otherwise
+	  */
+	static bool isStatusDataFor(
+		const IMAPParser::mailbox_data& data,
+		const char hierarchySeparator,
+		const string& mailboxName
+	);
+
 
 	weak_ptr <IMAPStore> m_store;
 	shared_ptr <IMAPConnection> m_connection;
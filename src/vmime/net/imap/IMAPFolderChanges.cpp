@@ -0,0 +1,89 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/imap/IMAPFolderChanges.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+IMAPFolderChanges::IMAPFolderChanges()
+	: m_fullSyncRequired(false),
+	  m_expungedMessages(messageSet::empty()),
+	  m_uidValidity(0),
+	  m_uidNext(0),
+	  m_highestModSeq(0) {
+
+}
+
+
+bool IMAPFolderChanges::isFullSyncRequired() const {
+
+	return m_fullSyncRequired;
+}
+
+
+const std::vector <shared_ptr <message> >& IMAPFolderChanges::getChangedMessages() const {
+
+	return m_changedMessages;
+}
+
+
+const messageSet& IMAPFolderChanges::getExpungedMessages() const {
+
+	return m_expungedMessages;
+}
+
+
+vmime_uint32 IMAPFolderChanges::getUIDValidity() const {
+
+	return m_uidValidity;
+}
+
+
+vmime_uint32 IMAPFolderChanges::getUIDNext() const {
+
+	return m_uidNext;
+}
+
+
+vmime_uint64 IMAPFolderChanges::getHighestModSequence() const {
+
+	return m_highestModSeq;
+}
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
@@ -0,0 +1,122 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_IMAP_IMAPFOLDERCHANGES_HPP_INCLUDED
+#define VMIME_NET_IMAP_IMAPFOLDERCHANGES_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/message.hpp"
+#include "vmime/net/messageSet.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+/** Holds the changes which occurred in an IMAP folder since a previous
+  * synchronization (see IMAPFolder::openAndResync()).
+  */
+class VMIME_EXPORT IMAPFolderChanges : public object {
+
+	friend class IMAPFolder;
+
+public:
+
+	IMAPFolderChanges();
+
+	/** Tests whether the changes could not be computed incrementally,
+	  * because the UID validity of the folder has changed since the
+	  * previous synchronization, or because no previous state was known.
+	  * In this case, no change is reported and all the messages of the
+	  * folder must be synchronized again.
+	  *
+	  * @return true if all the messages must be synchronized again
+	  */
+	bool isFullSyncRequired() const;
+
+	/** Returns the messages which have been added or whose flags have
+	  * changed since the previous synchronization. Only the UID, the
+	  * flags and the modification sequence of these messages are
+	  * available. Added messages are the ones whose UID is not lower
+	  * than the UIDNEXT value of the previous synchronization.
+	  *
+	  * @return added or changed messages
+	  */
+	const std::vector <shared_ptr <message> >& getChangedMessages() const;
+
+	/** Returns the UIDs of the messages which have been expunged since
+	  * the previous synchronization.
+	  *
+	  * @return set of expunged UIDs (may be empty)
+	  */
+	const messageSet& getExpungedMessages() const;
+
+	/** Returns the UID validity of the folder, to be kept for the
+	  * next synchronization.
+	  *
+	  * @return UID validity of the folder
+	  */
+	vmime_uint32 getUIDValidity() const;
+
+	/** Returns the UID value that will be assigned to the next message
+	  * added to the folder, or 0 if not known.
+	  *
+	  * @return UID of the next message
+	  */
+	vmime_uint32 getUIDNext() const;
+
+	/** Returns the highest modification sequence of the folder, to be
+	  * kept for the next synchronization.
+	  *
+	  * @return highest modification sequence
+	  */
+	vmime_uint64 getHighestModSequence() const;
+
+private:
+
+	bool m_fullSyncRequired;
+
+	std::vector <shared_ptr <message> > m_changedMessages;
+	messageSet m_expungedMessages;
+
+	vmime_uint32 m_uidValidity;
+	vmime_uint32 m_uidNext;
+	vmime_uint64 m_highestModSeq;
+};
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+#endif // VMIME_NET_IMAP_IMAPFOLDERCHANGES_HPP_INCLUDED
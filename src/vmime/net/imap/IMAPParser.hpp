@@ -267,7 +267,8 @@ public:
 	IMAPParser()
 		: m_progress(NULL),
 		  m_strict(false),
-		  m_literalHandler(NULL) {
+		  m_literalHandler(NULL),
+		  m_responseDataHandler(NULL) {
 
 	}
 
@@ -447,6 +448,30 @@ public:
 	};
 
 
+	//
+	// responseDataHandler : untagged response data handler
+	//
+
+	class response_data;
+
+	class responseDataHandler {
+
+	public:
+
+		virtual ~responseDataHandler() { }
+
+		// Called as soon as an untagged response has been parsed,
+		// while reading a response with readResponse()
+		//
+		// Returns :
+		//    . true if the data has been processed: it is freed immediately
+		//      and is not added to the response
+		//    . false to add the data to the response, as usual
+
+		virtual bool handleResponseData(const response_data& data) = 0;
+	};
+
+
 	//
 	// Base class for a terminal or a non-terminal
 	//
@@ -2266,6 +2291,43 @@ public:
 	};
 
 
+	//
+	// IMAP ENABLE Extension (RFC-5161):
+	//
+	//   response-data =/ "*" SP enable-data CRLF
+	//   enable-data   = "ENABLED" *(SP capability)
+	//
+
+	DECLARE_COMPONENT(enable_data)
+
+		bool parseImpl(IMAPParser& parser, string& line, size_t* currentPos) {
+
+			size_t pos = *currentPos;
+
+			VIMAP_PARSER_CHECK_WITHARG(special_atom, "enabled");
+
+			while (VIMAP_PARSER_TRY_CHECK(SPACE)) {
+
+				std::unique_ptr <capability> cap;
+				VIMAP_PARSER_TRY_GET(capability, cap);  // allow SPACE at end of line
+
+				if (!cap) {
+					break;
+				}
+
+				capabilities.push_back(std::move(cap));
+			}
+
+			*currentPos = pos;
+
+			return true;
+		}
+
+
+		std::vector <std::unique_ptr <capability>> capabilities;
+	};
+
+
 	//
 	// date_day_fixed  ::= (SPACE digit) / 2digit
 	//                    ;; Fixed-format version of date_day
@@ -3729,11 +3791,18 @@ public:
 	// message_data ::= nz_number SPACE ("EXPUNGE" /
 	//                  ("FETCH" SPACE msg_att))
 	//
+	// IMAP Extension for Quick Mailbox Resynchronization (RFC-7162):
+	//
+	//   message-data        =/ expunged-resp
+	//   expunged-resp       =  "VANISHED" [SP "(EARLIER)"] SP known-uids
+	//   known-uids          =  sequence-set
+	//
 
 	DECLARE_COMPONENT(message_data)
 
 		message_data()
-			: number(0) {
+			: number(0),
+			  earlier(false) {
 
 		}
 
@@ -3741,6 +3810,29 @@ public:
 
 			size_t pos = *currentPos;
 
+			// "VANISHED" [SP "(EARLIER)"] SP known-uids
+			if (VIMAP_PARSER_TRY_CHECK_WITHARG(special_atom, "vanished")) {
+
+				type = VANISHED;
+
+				VIMAP_PARSER_CHECK(SPACE);
+
+				if (VIMAP_PARSER_TRY_CHECK(one_char <'('>)) {
+
+					VIMAP_PARSER_CHECK_WITHARG(special_atom, "earlier");
+					VIMAP_PARSER_CHECK(one_char <')'>);
+					VIMAP_PARSER_CHECK(SPACE);
+
+					earlier = true;
+				}
+
+				VIMAP_PARSER_GET(IMAPParser::uid_set, uid_set);
+
+				*currentPos = pos;
+
+				return true;
+			}
+
 			scoped_ptr <nz_number> num;
 			VIMAP_PARSER_GET(nz_number, num);
 			number = static_cast <unsigned int>(num->value);
@@ -3768,13 +3860,17 @@ public:
 
 		enum Type {
 			EXPUNGE,
-			FETCH
+			FETCH,
+			VANISHED
 		};
 
 
 		Type type;
 		unsigned int number;
 		std::unique_ptr <IMAPParser::msg_att> msg_att;
+
+		bool earlier;   // for VANISHED: UIDs expunged before the command
+		std::unique_ptr <IMAPParser::uid_set> uid_set;   // for VANISHED
 	};
 
 
@@ -4317,7 +4413,8 @@ public:
 
 	//
 	// response_data  ::= "*" SPACE (resp_cond_state / resp_cond_bye /
-	//                    mailbox_data / message_data / capability_data) CRLF
+	//                    mailbox_data / message_data / capability_data /
+	//                    enable_data) CRLF
 	//
 
 	DECLARE_COMPONENT(response_data)
@@ -4333,7 +4430,9 @@ public:
 				if (!VIMAP_PARSER_TRY_GET(IMAPParser::resp_cond_bye, resp_cond_bye)) {
 					if (!VIMAP_PARSER_TRY_GET(IMAPParser::mailbox_data, mailbox_data)) {
 						if (!VIMAP_PARSER_TRY_GET(IMAPParser::message_data, message_data)) {
-							VIMAP_PARSER_GET(IMAPParser::capability_data, capability_data);
+							if (!VIMAP_PARSER_TRY_GET(IMAPParser::enable_data, enable_data)) {
+								VIMAP_PARSER_GET(IMAPParser::capability_data, capability_data);
+							}
 						}
 					}
 				}
@@ -4360,6 +4459,7 @@ public:
 		std::unique_ptr <IMAPParser::mailbox_data> mailbox_data;
 		std::unique_ptr <IMAPParser::message_data> message_data;
 		std::unique_ptr <IMAPParser::capability_data> capability_data;
+		std::unique_ptr <IMAPParser::enable_data> enable_data;
 	};
 
 
@@ -4496,6 +4596,19 @@ public:
 
 			while ((resp = parser.get <IMAPParser::continue_req_or_response_data>(curLine, &pos))) {
 
+				// Untagged data which is processed as soon as it has been
+				// parsed does not need to be kept in the response
+				if (resp->response_data && parser.m_responseDataHandler &&
+				    parser.m_responseDataHandler->handleResponseData(*resp->response_data)) {
+
+					delete resp;
+
+					curLine = parser.readLine();
+					pos = 0;
+
+					continue;
+				}
+
 				continue_req_or_response_data.push_back(
 					std::unique_ptr <IMAPParser::continue_req_or_response_data>(resp)
 				);
@@ -4609,7 +4722,19 @@ public:
 	// The main functions used to parse a response
 	//
 
-	response* readResponse(const IMAPTag& tag, literalHandler* lh = NULL) {
+	/** Read the response to a command.
+	  *
+	  * @param tag tag of the command
+	  * @param lh handler for literals, or NULL to put them in the response
+	  * @param rdh handler which processes untagged data as soon as it is
+	  * received, or NULL to put all untagged data in the response
+	  * @return response (the caller is responsible to free the memory)
+	  */
+	response* readResponse(
+		const IMAPTag& tag,
+		literalHandler* lh = NULL,
+		responseDataHandler* rdh = NULL
+	) {
 
 		while (true) {
 
@@ -4625,8 +4750,24 @@ public:
 			string line = readLine();
 
 			m_literalHandler = lh;
-			response* resp = get <response>(line, &pos);
+			m_responseDataHandler = rdh;
+
+			response* resp = NULL;
+
+			try {
+
+				resp = get <response>(line, &pos);
+
+			} catch (...) {
+
+				m_literalHandler = NULL;
+				m_responseDataHandler = NULL;
+
+				throw;
+			}
+
 			m_literalHandler = NULL;
+			m_responseDataHandler = NULL;
 
 			if (!resp) {
 				throw exceptions::invalid_response("", m_errorResponseLine);
@@ -4676,6 +4817,46 @@ public:
 	}
 
 
+	/** Read a single response line, for example data sent by the server
+	  * while the connection is idling. This is either untagged data (or a
+	  * continuation request), or the completion result of a command.
+	  * The function blocks until a complete line is read.
+	  *
+	  * @return response holding either a single untagged data, or only
+	  * the completion result in response_done (the caller is responsible
+	  * to free the memory)
+	  */
+	response* readNextResponse() {
+
+		size_t pos = 0;
+		string line = readLine();
+
+		std::unique_ptr <response> resp(new response);
+
+		continue_req_or_response_data* data = get <continue_req_or_response_data>(line, &pos);
+
+		if (data) {
+
+			resp->continue_req_or_response_data.push_back(
+				std::unique_ptr <continue_req_or_response_data>(data)
+			);
+
+		} else {
+
+			pos = 0;
+			resp->response_done.reset(get <response_done>(line, &pos));
+
+			if (!resp->response_done) {
+				throw exceptions::invalid_response("", m_errorResponseLine);
+			}
+		}
+
+		resp->setErrorLog(lastLine());
+
+		return resp.release();
+	}
+
+
 	/** Parse a token and advance.
 	  * If the token has been parsed successfully, a raw pointer to it
 	  * will be returned. The caller is responsible to free the memory.
@@ -4819,6 +5000,7 @@ private:
 	bool m_strict;
 
 	literalHandler* m_literalHandler;
+	responseDataHandler* m_responseDataHandler;
 
 	weak_ptr <timeoutHandler> m_timeoutHandler;
 
@@ -4916,6 +5098,54 @@ public:
 		m_buffer += receiveBuffer;
 	}
 
+	/** Wait until some data is available in the input buffer or from
+	  * the socket stream. Waiting is expected here, so the time-out
+	  * handler is not triggered while the function is blocked.
+	  *
+	  * @param msecs maximum time to wait, in milliseconds
+	  * @return true if data is available, or false if the delay elapsed
+	  */
+	bool waitForData(const int msecs) {
+
+		if (!m_buffer.empty()) {
+			return true;
+		}
+
+		shared_ptr <timeoutHandler> toh = m_timeoutHandler.lock();
+		shared_ptr <socket> sok = m_socket.lock();
+
+		if (!sok)
+			throw exceptions::illegal_state("Store disconnected");
+
+		int remaining = msecs;
+
+		while (true) {
+
+			string receiveBuffer;
+			sok->receive(receiveBuffer);
+
+			if (!receiveBuffer.empty()) {
+				m_buffer += receiveBuffer;
+				return true;
+			}
+
+			if (remaining <= 0) {
+				return false;
+			}
+
+			// Wait by small steps, so that the time-out delay never elapses
+			const int wait = std::min(remaining, 1000);
+
+			if (toh) {
+				toh->resetTimeOut();
+			}
+
+			sok->waitForRead(wait);
+
+			remaining -= wait;
+		}
+	}
+
 
 	void readLiteral(literalHandler::target& buffer, size_t count) {
 
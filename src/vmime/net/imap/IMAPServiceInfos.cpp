@@ -59,6 +59,9 @@ const IMAPServiceInfos::props& IMAPServiceInfos::getProperties() const {
 		property("options.sasl", serviceInfos::property::TYPE_BOOLEAN, "true"),
 		property("options.sasl.fallback", serviceInfos::property::TYPE_BOOLEAN, "true"),
 #endif // VMIME_HAVE_SASL_SUPPORT
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+		property("options.compress", serviceInfos::property::TYPE_BOOLEAN, "false"),
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
 
 		// Common properties
 		property(serviceInfos::property::AUTH_USERNAME, serviceInfos::property::FLAG_REQUIRED),
@@ -79,6 +82,9 @@ const IMAPServiceInfos::props& IMAPServiceInfos::getProperties() const {
 		property("options.sasl", serviceInfos::property::TYPE_BOOLEAN, "true"),
 		property("options.sasl.fallback", serviceInfos::property::TYPE_BOOLEAN, "true"),
 #endif // VMIME_HAVE_SASL_SUPPORT
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+		property("options.compress", serviceInfos::property::TYPE_BOOLEAN, "false"),
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
 
 		// Common properties
 		property(serviceInfos::property::AUTH_USERNAME, serviceInfos::property::FLAG_REQUIRED),
@@ -107,6 +113,9 @@ const std::vector <serviceInfos::property> IMAPServiceInfos::getAvailablePropert
 	list.push_back(p.PROPERTY_OPTIONS_SASL);
 	list.push_back(p.PROPERTY_OPTIONS_SASL_FALLBACK);
 #endif // VMIME_HAVE_SASL_SUPPORT
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+	list.push_back(p.PROPERTY_OPTIONS_COMPRESS);
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
 
 	// Common properties
 	list.push_back(p.PROPERTY_AUTH_USERNAME);
@@ -53,6 +53,9 @@ public:
 		serviceInfos::property PROPERTY_OPTIONS_SASL;
 		serviceInfos::property PROPERTY_OPTIONS_SASL_FALLBACK;
 #endif // VMIME_HAVE_SASL_SUPPORT
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+		serviceInfos::property PROPERTY_OPTIONS_COMPRESS;
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
 
 		// Common properties
 		serviceInfos::property PROPERTY_AUTH_USERNAME;
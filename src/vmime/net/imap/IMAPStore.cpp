@@ -32,10 +32,12 @@
 #include "vmime/net/imap/IMAPConnection.hpp"
 #include "vmime/net/imap/IMAPFolderStatus.hpp"
 #include "vmime/net/imap/IMAPCommand.hpp"
+#include "vmime/net/imap/IMAPUtils.hpp"
 
 #include "vmime/exception.hpp"
 #include "vmime/platform.hpp"
 
+#include <deque>
 #include <map>
 
 
@@ -119,6 +121,132 @@ shared_ptr <folder> IMAPStore::getFolder(const folder::path& path) {
 }
 
 
+std::vector <shared_ptr <folderStatus> > IMAPStore::getFolderStatus(
+	const std::vector <folder::path>& paths
+) {
+
+	if (!isConnected()) {
+		throw exceptions::illegal_state("Not connected");
+	}
+
+	// Maximum number of commands waiting for their response, so that
+	// the server never blocks on sending responses we do not read yet
+	static const size_t MAX_COMMANDS_IN_FLIGHT = 32;
+
+	const std::vector <string> attribs = IMAPFolder::getStatusAttributes(m_connection);
+
+	std::vector <string> mailboxNames;
+	mailboxNames.reserve(paths.size());
+
+	for (size_t i = 0 ; i < paths.size() ; ++i) {
+		mailboxNames.push_back(IMAPUtils::pathToString(m_connection->hierarchySeparator(), paths[i]));
+	}
+
+	std::vector <shared_ptr <folderStatus> > statuses(paths.size());
+	std::vector <bool> completed(paths.size(), false);
+	std::deque <IMAPTag> tags;
+
+	string errorLog;
+	size_t next = 0;  // index of the next response to read
+
+	for (size_t i = 0 ; i < paths.size() || !tags.empty() ; ) {
+
+		// Send as many commands as possible before reading a response
+		if (i < paths.size() && tags.size() < MAX_COMMANDS_IN_FLIGHT) {
+
+			tags.push_back(
+				m_connection->sendCommand(IMAPCommand::STATUS(mailboxNames[i], attribs))
+			);
+
+			++i;
+			continue;
+		}
+
+		scoped_ptr <IMAPParser::response> resp(m_connection->readTaggedResponse(tags.front()));
+		tags.pop_front();
+
+		const size_t index = next++;
+
+		// The server may send the data of several pipelined commands before
+		// their completion results (RFC-3501, section 5.5), so STATUS data is
+		// matched to its command by mailbox name instead of by position
+		std::vector <const IMAPParser::mailbox_data*> statusData;
+		IMAPFolder::findStatusData(*resp, statusData);
+
+		const IMAPParser::mailbox_data* unmatchedData = NULL;
+		size_t unmatchedCount = 0;
+
+		for (size_t j = 0 ; j < statusData.size() ; ++j) {
+
+			bool matched = false;
+
+			for (size_t k = 0 ; k < mailboxNames.size() && !matched ; ++k) {
+
+				if (!statuses[k] &&
+				    IMAPFolder::isStatusDataFor(*statusData[j], m_connection->hierarchySeparator(), mailboxNames[k])) {
+
+					shared_ptr <IMAPFolderStatus> status = make_shared <IMAPFolderStatus>();
+					status->updateFromResponse(*statusData[j]);
+
+					statuses[k] = status;
+					matched = true;
+				}
+			}
+
+			if (!matched) {
+
+				unmatchedData = statusData[j];
+				++unmatchedCount;
+			}
+		}
+
+		// Name not recognized: if the response contains a single STATUS
+		// data which is not about another mailbox, it is about this one
+		if (!statuses[index] && unmatchedCount == 1) {
+
+			shared_ptr <IMAPFolderStatus> status = make_shared <IMAPFolderStatus>();
+			status->updateFromResponse(*unmatchedData);
+
+			statuses[index] = status;
+		}
+
+		// Read all the responses before reporting an error, so that
+		// the connection is left in a consistent state
+		if (resp->isBad()) {
+
+			if (errorLog.empty()) {
+				errorLog = resp->getErrorLog();
+			}
+
+			continue;
+		}
+
+		if (resp->response_done->response_tagged->
+				resp_cond_state->status != IMAPParser::resp_cond_state::OK) {
+
+			statuses[index] = null;
+			continue;  // eg. folder does not exist
+		}
+
+		completed[index] = true;
+	}
+
+	// Every successful command must have received its data
+	for (size_t i = 0 ; i < paths.size() && errorLog.empty() ; ++i) {
+
+		if (completed[i] && !statuses[i]) {
+			errorLog = "No STATUS data for mailbox '" + mailboxNames[i] + "'";
+		}
+	}
+
+	if (!errorLog.empty()) {
+		throw exceptions::command_error("STATUS", errorLog, "bad response");
+	}
+
+	return statuses;
+}
+
+
 bool IMAPStore::isValidFolderName(const folder::path::component& /* name */) const {
 
 	return true;
@@ -73,6 +73,19 @@ public:
 	shared_ptr <folder> getRootFolder();
 	shared_ptr <folder> getFolder(const folder::path& path);
 
+	/** Return the status of several folders at once. The STATUS commands
+	  * are pipelined: they are sent without waiting for the response to
+	  * the previous one, so that the whole operation takes about one round
+	  * trip instead of one per folder.
+	  *
+	  * @param paths paths of the folders
+	  * @return status of each folder, in the same order as the paths; the
+	  * status is NULL if the server refused the command for this folder
+	  * (eg. if it does not exist)
+	  * @throw exceptions::command_error if the server sent an invalid response
+	  */
+	std::vector <shared_ptr <folderStatus> > getFolderStatus(const std::vector <folder::path>& paths);
+
 	bool isValidFolderName(const folder::path::component& name) const;
 
 	static const serviceInfos& getInfosInstance();
@@ -27,6 +27,7 @@
 
 #include "vmime/net/imap/IMAPFolder.hpp"
 #include "vmime/net/imap/IMAPFolderStatus.hpp"
+#include "vmime/net/imap/IMAPFolderChanges.hpp"
 #include "vmime/net/imap/IMAPMessage.hpp"
 #include "vmime/net/imap/IMAPStore.hpp"
 #include "vmime/net/imap/IMAPSStore.hpp"
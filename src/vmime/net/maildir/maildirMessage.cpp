@@ -315,8 +315,6 @@ void maildirMessage::fetch(const shared_ptr <maildirFolder>& msgFolder, const fe
 	                fetchAttributes::FULL_HEADER | fetchAttributes::STRUCTURE |
 	                fetchAttributes::IMPORTANCE)) {
 
-		string contents;
-
 		shared_ptr <utility::fileReader> reader = file->getFileReader();
 		shared_ptr <utility::inputStream> is = reader->getInputStream();
 
@@ -325,6 +323,7 @@ void maildirMessage::fetch(const shared_ptr <maildirFolder>& msgFolder, const fe
 
 			byte_t buffer[16384];
 
+			string contents;
 			contents.reserve(file->getLength());
 
 			while (!is->eof()) {
@@ -332,46 +331,25 @@ void maildirMessage::fetch(const shared_ptr <maildirFolder>& msgFolder, const fe
 				vmime::utility::stringUtils::appendBytesToString(contents, buffer, read);
 			}
 
-		// Need only header
-		} else {
-
-			byte_t buffer[1024];
-
-			contents.reserve(4096);
+			vmime::message msg;
+			msg.parse(contents);
 
-			while (!is->eof()) {
-
-				const size_t read = is->read(buffer, sizeof(buffer));
-				vmime::utility::stringUtils::appendBytesToString(contents, buffer, read);
+			// Extract structure
+			m_structure = make_shared <maildirMessageStructure>(shared_ptr <maildirMessagePart>(), msg);
 
-				const size_t sep1 = contents.rfind("\r\n\r\n");
-				const size_t sep2 = contents.rfind("\n\n");
+			// Extract some header fields or whole header
+			if (options.has(fetchAttributes::ENVELOPE |
+			                fetchAttributes::CONTENT_INFO |
+			                fetchAttributes::FULL_HEADER |
+			                fetchAttributes::IMPORTANCE)) {
 
-				if (sep1 != string::npos) {
-					contents.erase(contents.begin() + sep1 + 4, contents.end());
-					break;
-				} else if (sep2 != string::npos) {
-					contents.erase(contents.begin() + sep2 + 2, contents.end());
-					break;
-				}
+				getOrCreateHeader()->copyFrom(*(msg.getHeader()));
 			}
-		}
-
-		vmime::message msg;
-		msg.parse(contents);
 
-		// Extract structure
-		if (options.has(fetchAttributes::STRUCTURE)) {
-			m_structure = make_shared <maildirMessageStructure>(shared_ptr <maildirMessagePart>(), msg);
-		}
-
-		// Extract some header fields or whole header
-		if (options.has(fetchAttributes::ENVELOPE |
-		                fetchAttributes::CONTENT_INFO |
-		                fetchAttributes::FULL_HEADER |
-		                fetchAttributes::IMPORTANCE)) {
+		// Need only header
+		} else {
 
-			getOrCreateHeader()->copyFrom(*(msg.getHeader()));
+			getOrCreateHeader()->parseFromStream(*is);
 		}
 	}
 }
@@ -69,9 +69,22 @@ void SMTPChunkingOutputStreamAdapter::sendChunk(
 		return;
 	}
 
-	// Send this chunk
-	m_connection->sendRequest(SMTPCommand::BDAT(count, last));
-	m_connection->getSocket()->sendRaw(data, count);
+	// Send the BDAT command line and the chunk data in a single call
+	shared_ptr <SMTPCommand> cmd = SMTPCommand::BDAT(count, last);
+	const string line = cmd->getText() + "\r\n";
+
+	socket::block blocks[2];
+
+	blocks[0].data = reinterpret_cast <const byte_t*>(line.data());
+	blocks[0].count = line.length();
+	blocks[1].data = data;
+	blocks[1].count = count;
+
+	m_connection->getSocket()->sendRawBlocks(blocks, 2);
+
+	if (m_connection->getTracer()) {
+		m_connection->getTracer()->traceSend(cmd->getTraceText());
+	}
 
 	++m_chunkCount;
 
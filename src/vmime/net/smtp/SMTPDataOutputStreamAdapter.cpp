@@ -0,0 +1,230 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+
+#include "vmime/net/smtp/SMTPDataOutputStreamAdapter.hpp"
+
+#include "vmime/net/smtp/SMTPConnection.hpp"
+
+#include "vmime/utility/scanUtils.hpp"
+
+#include <algorithm>
+
+
+namespace vmime {
+namespace net {
+namespace smtp {
+
+
+SMTPDataOutputStreamAdapter::SMTPDataOutputStreamAdapter(
+	const shared_ptr <SMTPConnection>& conn,
+	const size_t size,
+	utility::progressListener* progress
+)
+	: m_connection(conn),
+	  m_socketStream(*conn->getSocket()),
+	  m_untracedSize(0),
+	  m_lineStart(true),
+	  m_previousCR(false),
+	  m_totalSize(size),
+	  m_totalWritten(0),
+	  m_progress(progress) {
+
+	if (progress) {
+		progress->start(size);
+	}
+}
+
+
+utility::outputStream& SMTPDataOutputStreamAdapter::getNextOutputStream() {
+
+	return m_socketStream;
+}
+
+
+void SMTPDataOutputStreamAdapter::writeImpl(
+	const byte_t* const data,
+	const size_t count
+) {
+
+	static const byte_t EOL_CHARS[] = { '\r', '\n' };
+
+	size_t pos = 0;
+	size_t runStart = 0;  // start of the data which can be sent unchanged
+
+	// Data which is already in canonical form (CRLF line endings, no dot
+	// at the beginning of a line) is passed as a single run, so that large
+	// writes reach the socket without being copied
+	while (pos < count) {
+
+		// LF of a CRLF sequence: the CR has already been converted to CRLF
+		if (m_previousCR) {
+
+			m_previousCR = false;
+
+			if (data[pos] == '\n') {
+
+				++pos;
+				runStart = pos;
+
+				continue;
+			}
+		}
+
+		// Dot-stuffing
+		if (m_lineStart) {
+
+			m_lineStart = false;
+
+			if (data[pos] == '.') {
+
+				append(data + runStart, pos - runStart);
+				append(reinterpret_cast <const byte_t*>("."), 1);
+
+				runStart = pos;
+			}
+		}
+
+		// Skip the rest of the line
+		const size_t eol = utility::scanUtils::findFirstOf(
+			data + pos, count - pos, EOL_CHARS, sizeof(EOL_CHARS)
+		);
+
+		if (eol == npos) {
+
+			pos = count;
+			break;
+		}
+
+		const size_t eolPos = pos + eol;
+
+		if (data[eolPos] == '\r' && eolPos + 1 < count && data[eolPos + 1] == '\n') {
+
+			// Already CRLF
+			pos = eolPos + 2;
+
+		} else {
+
+			// Convert CR and LF to CRLF
+			append(data + runStart, eolPos - runStart);
+			append(reinterpret_cast <const byte_t*>("\r\n"), 2);
+
+			m_previousCR = (data[eolPos] == '\r');
+
+			pos = eolPos + 1;
+			runStart = pos;
+		}
+
+		m_lineStart = true;
+	}
+
+	append(data + runStart, pos - runStart);
+
+	m_totalWritten += count;
+}
+
+
+void SMTPDataOutputStreamAdapter::append(const byte_t* const data, const size_t count) {
+
+	if (count == 0) {
+		return;
+	}
+
+	m_socketStream.write(data, count);
+	m_untracedSize += count;
+
+	if (m_untracedSize >= m_socketStream.getBlockSize()) {
+		notifyProgress();
+	}
+}
+
+
+void SMTPDataOutputStreamAdapter::notifyProgress() {
+
+	if (m_untracedSize != 0) {
+
+		if (m_connection->getTracer()) {
+			m_connection->getTracer()->traceSendBytes(m_untracedSize);
+		}
+
+		m_untracedSize = 0;
+	}
+
+	if (m_progress) {
+
+		m_totalSize = std::max(m_totalSize, m_totalWritten);
+		m_progress->progress(m_totalWritten, m_totalSize);
+	}
+}
+
+
+void SMTPDataOutputStreamAdapter::flush() {
+
+	m_socketStream.flush();
+	notifyProgress();
+}
+
+
+void SMTPDataOutputStreamAdapter::finish() {
+
+	// Data must end with a line break
+	if (!m_lineStart) {
+
+		append(reinterpret_cast <const byte_t*>("\r\n"), 2);
+		m_lineStart = true;
+	}
+
+	notifyProgress();
+
+	// Send end-of-data delimiter, along with the remaining data
+	m_socketStream.write(".\r\n", 3);
+	m_socketStream.flush();
+
+	if (m_connection->getTracer()) {
+		m_connection->getTracer()->traceSend(".");
+	}
+
+	if (m_progress) {
+		m_progress->stop(m_totalSize);
+	}
+}
+
+
+size_t SMTPDataOutputStreamAdapter::getBlockSize() {
+
+	return m_socketStream.getBlockSize();
+}
+
+
+} // smtp
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
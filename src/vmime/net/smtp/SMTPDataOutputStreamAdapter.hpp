@@ -0,0 +1,115 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_SMTP_SMTPDATAOUTPUTSTREAMADAPTER_HPP_INCLUDED
+#define VMIME_NET_SMTP_SMTPDATAOUTPUTSTREAMADAPTER_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+
+#include "vmime/utility/filteredStream.hpp"
+#include "vmime/utility/outputStreamGatherSocketAdapter.hpp"
+#include "vmime/utility/progressListener.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace smtp {
+
+
+class SMTPConnection;
+
+
+/** An output stream adapter used to send message data after the DATA
+  * command. Data is written directly to the socket, in a single pass:
+  * line endings are converted to CRLF sequences, and a dot is added at
+  * the beginning of lines which start with a dot ("dot-stuffing").
+  */
+class VMIME_EXPORT SMTPDataOutputStreamAdapter : public utility::filteredOutputStream {
+
+public:
+
+	/** Construct a new adapter.
+	  *
+	  * @param conn SMTP connection
+	  * @param size expected size of data, for progress notifications
+	  * @param progress progress listener, or NULL if you do not
+	  * want to receive progress notifications
+	  */
+	SMTPDataOutputStreamAdapter(
+		const shared_ptr <SMTPConnection>& conn,
+		const size_t size,
+		utility::progressListener* progress
+	);
+
+	/** Send the remaining data, followed by the end-of-data
+	  * indicator (a line containing only a dot).
+	  */
+	void finish();
+
+	outputStream& getNextOutputStream();
+
+	void flush();
+
+	size_t getBlockSize();
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count);
+
+private:
+
+	SMTPDataOutputStreamAdapter(const SMTPDataOutputStreamAdapter&);
+
+
+	void append(const byte_t* const data, const size_t count);
+	void notifyProgress();
+
+
+	shared_ptr <SMTPConnection> m_connection;
+	utility::outputStreamGatherSocketAdapter m_socketStream;
+
+	size_t m_untracedSize;  // bytes written but not reported to the tracer yet
+
+	bool m_lineStart;    // next byte is at the beginning of a line
+	bool m_previousCR;   // previous byte was a CR (already converted to CRLF)
+
+	size_t m_totalSize;
+	size_t m_totalWritten;
+	utility::progressListener* m_progress;
+};
+
+
+} // smtp
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+#endif // VMIME_NET_SMTP_SMTPDATAOUTPUTSTREAMADAPTER_HPP_INCLUDED
@@ -32,19 +32,17 @@
 #include "vmime/net/smtp/SMTPCommand.hpp"
 #include "vmime/net/smtp/SMTPCommandSet.hpp"
 #include "vmime/net/smtp/SMTPChunkingOutputStreamAdapter.hpp"
+#include "vmime/net/smtp/SMTPDataOutputStreamAdapter.hpp"
 #include "vmime/net/smtp/SMTPExceptions.hpp"
 #include "vmime/net/smtp/SMTPSendOptions.hpp"
 
+#include "vmime/encodedContentsCache.hpp"
 #include "vmime/exception.hpp"
 #include "vmime/mailboxList.hpp"
 #include "vmime/message.hpp"
 
-#include "vmime/utility/filteredStream.hpp"
 #include "vmime/utility/stringUtils.hpp"
-#include "vmime/utility/outputStreamSocketAdapter.hpp"
 #include "vmime/utility/streamUtils.hpp"
-#include "vmime/utility/outputStreamAdapter.hpp"
-#include "vmime/utility/inputStreamStringAdapter.hpp"
 
 
 namespace vmime {
@@ -389,6 +387,17 @@ void SMTPTransport::sendEnvelope(
 }
 
 
+void SMTPTransport::readDATAResponse() {
+
+	shared_ptr <SMTPResponse> resp = m_connection->readResponse();
+	auto code = resp->getCode();
+
+	if (code != 250) {
+		throw SMTPCommandError("DATA", resp->getText(), code, resp->getEnhancedCode());
+	}
+}
+
+
 void SMTPTransport::send(
 	const mailbox& expeditor,
 	const mailboxList& recipients,
@@ -406,29 +415,15 @@ void SMTPTransport::send(
 	// Send message envelope
 	sendEnvelope(expeditor, recipients, sender, /* sendDATACommand */ true, size, options);
 
-	// Send the message data
-	// Stream copy with "\n." to "\n.." transformation
-	utility::outputStreamSocketAdapter sos(*m_connection->getSocket());
-	utility::dotFilteredOutputStream fos(sos);
-
-	utility::bufferedStreamCopy(is, fos, size, progress);
-
-	fos.flush();
+	// Send the message data, with line endings conversion and
+	// "\n." to "\n.." transformation
+	SMTPDataOutputStreamAdapter dataStream(m_connection, size, NULL);
 
-	// Send end-of-data delimiter
-	m_connection->getSocket()->send("\r\n.\r\n");
+	utility::bufferedStreamCopy(is, dataStream, size, progress);
 
-	if (m_connection->getTracer()) {
-		m_connection->getTracer()->traceSendBytes(size);
-		m_connection->getTracer()->traceSend(".");
-	}
-
-	shared_ptr <SMTPResponse> resp = m_connection->readResponse();
-	auto code = resp->getCode();
+	dataStream.finish();
 
-	if (code != 250) {
-		throw SMTPCommandError("DATA", resp->getText(), code, resp->getEnhancedCode());
-	}
+	readDATAResponse();
 }
 
 
@@ -450,28 +445,47 @@ void SMTPTransport::send(
 	generationContext ctx(generationContext::getDefaultContext());
 	ctx.setInternationalizedEmailSupport(m_connection->hasExtension("SMTPUTF8"));
 
-	// If CHUNKING is not supported, generate the message to a temporary
-	// buffer then use the send() method which takes an inputStream
-	if (!m_connection->hasExtension("CHUNKING") ||
-	    !getInfos().getPropertyValue <bool>(getSession(),
-			dynamic_cast <const SMTPServiceInfos&>(getInfos()).getProperties().PROPERTY_OPTIONS_CHUNKING)) {
+	const bool useChunking =
+		m_connection->hasExtension("CHUNKING") &&
+		getInfos().getPropertyValue <bool>(getSession(),
+			dynamic_cast <const SMTPServiceInfos&>(getInfos()).getProperties().PROPERTY_OPTIONS_CHUNKING);
+
+	// Compute the message size. If the message is sent by chunks and the
+	// server supports the SIZE extension, the exact size is computed: the
+	// contents are encoded only once, and kept so that they do not have to
+	// be encoded again for sending. After the DATA command, the message is
+	// generated only once, so the estimated size is enough.
+	size_t msgSize;
+
+	if (useChunking && m_connection->hasExtension("SIZE")) {
 
-		std::ostringstream oss;
-		utility::outputStreamAdapter ossAdapter(oss);
+		ctx.setEncodedContentsCache(make_shared <encodedContentsCache>());
 
-		msg->generate(ctx, ossAdapter);
+		msgSize = msg->getExactGeneratedSize(ctx);
 
-		const string& str(oss.str());
+	} else {
 
-		utility::inputStreamStringAdapter isAdapter(str);
+		msgSize = msg->getGeneratedSize(ctx);
+	}
+
+	// If CHUNKING is not supported, generate the message directly
+	// to the socket, after the DATA command
+	if (!useChunking) {
+
+		sendEnvelope(expeditor, recipients, sender, /* sendDATACommand */ true, msgSize, options);
+
+		SMTPDataOutputStreamAdapter dataStream(m_connection, msgSize, progress);
+
+		msg->generate(ctx, dataStream);
+
+		dataStream.finish();
+
+		readDATAResponse();
 
-		send(expeditor, recipients, isAdapter, str.length(), progress, sender, options);
 		return;
 	}
 
 	// Send message envelope
-	const size_t msgSize = msg->getGeneratedSize(ctx);
-
 	sendEnvelope(expeditor, recipients, sender, /* sendDATACommand */ false, msgSize, options);
 
 	// Send the message by chunks
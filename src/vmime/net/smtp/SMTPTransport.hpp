@@ -121,6 +121,11 @@ private:
 		const sendOptions& options = sendOptions()
 	);
 
+	/** Read the response sent by the server after message data,
+	  * and check that the message has been accepted.
+	  */
+	void readDATAResponse();
+
 
 	shared_ptr <SMTPConnection> m_connection;
 
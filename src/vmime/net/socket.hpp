@@ -53,6 +53,15 @@ public:
 		STATUS_WANT_WRITE = 0x2     /**< The socket wants to write data, retry when data can be written. */
 	};
 
+	/** A contiguous region of memory to be sent, used for
+	  * scatter-gather output (see sendRawBlocks()).
+	  */
+	struct block {
+
+		const byte_t* data;   /**< Pointer to the first byte of the block. */
+		size_t count;         /**< Number of bytes in the block. */
+	};
+
 
 	virtual ~socket() { }
 
@@ -136,6 +145,23 @@ public:
 	  */
 	virtual size_t sendRawNonBlocking(const byte_t* buffer, const size_t count) = 0;
 
+	/** Send several blocks of raw data to the socket, in order, as
+	  * if they were a single buffer. Implementations may use this to
+	  * hand all blocks to the system in one call (eg. sendmsg() on
+	  * POSIX) instead of issuing one write per block.
+	  *
+	  * The default implementation calls sendRaw() for each block.
+	  *
+	  * @param blocks blocks to send
+	  * @param count number of blocks
+	  */
+	virtual void sendRawBlocks(const block* blocks, const size_t count) {
+
+		for (size_t i = 0 ; i < count ; ++i) {
+			sendRaw(blocks[i].data, blocks[i].count);
+		}
+	}
+
 	/** Return the preferred maximum block size when reading
 	  * from or writing to this stream.
 	  *
@@ -264,6 +264,78 @@ void TLSSocket_GnuTLS::sendRaw(const byte_t* buffer, const size_t count) {
 }
 
 
+void TLSSocket_GnuTLS::sendRawBlocks(const block* blocks, const size_t count) {
+
+#if GNUTLS_VERSION_NUMBER >= 0x030208
+
+	// Cork the session so that small blocks are packed into full
+	// TLS records instead of producing one record per block
+	gnutls_record_cork(*m_session->m_gnutlsSession);
+
+	try {
+
+		for (size_t i = 0 ; i < count ; ++i) {
+			sendRaw(blocks[i].data, blocks[i].count);
+		}
+
+	} catch (...) {
+
+		// Do not leave the session corked: send the data which has been
+		// buffered so far. If this fails too, the session cannot be used
+		// any more, and this failure is reported instead
+		uncork();
+
+		throw;
+	}
+
+	uncork();
+
+#else // GNUTLS_VERSION_NUMBER < 0x030208
+
+	socket::sendRawBlocks(blocks, count);
+
+#endif
+
+}
+
+
+#if GNUTLS_VERSION_NUMBER >= 0x030208
+
+void TLSSocket_GnuTLS::uncork() {
+
+	while (true) {
+
+		resetException();
+
+		const int ret = gnutls_record_uncork(*m_session->m_gnutlsSession, 0);
+
+		throwException();
+
+		if (ret < 0) {
+
+			if (ret == GNUTLS_E_AGAIN || ret == GNUTLS_E_INTERRUPTED) {
+
+				if (gnutls_record_get_direction(*m_session->m_gnutlsSession) == 0) {
+					m_wrapped->waitForRead();
+				} else {
+					m_wrapped->waitForWrite();
+				}
+
+				continue;
+			}
+
+			TLSSession_GnuTLS::throwTLSException("gnutls_record_uncork", ret);
+
+		} else if (gnutls_record_check_corked(*m_session->m_gnutlsSession) == 0) {
+
+			break;
+		}
+	}
+}
+
+#endif // GNUTLS_VERSION_NUMBER >= 0x030208
+
+
 size_t TLSSocket_GnuTLS::sendRawNonBlocking(const byte_t* buffer, const size_t count) {
 
 	m_status &= ~(STATUS_WANT_WRITE | STATUS_WANT_READ);
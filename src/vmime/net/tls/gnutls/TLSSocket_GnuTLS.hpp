@@ -73,6 +73,7 @@ public:
 	void send(const char* str);
 	void sendRaw(const byte_t* buffer, const size_t count);
 	size_t sendRawNonBlocking(const byte_t* buffer, const size_t count);
+	void sendRawBlocks(const block* blocks, const size_t count);
 
 	size_t getBlockSize() const;
 
@@ -91,6 +92,11 @@ private:
 	void resetException();
 	void throwException();
 
+	/** Send the data buffered while the session was corked, waiting
+	  * for the underlying socket if needed (GnuTLS 3.2.8 or later).
+	  */
+	void uncork();
+
 #ifdef LIBGNUTLS_VERSION
 	static ssize_t gnutlsPushFunc(gnutls_transport_ptr_t trspt, const void* data, size_t len);
 	static ssize_t gnutlsPullFunc(gnutls_transport_ptr_t trspt, void* data, size_t len);
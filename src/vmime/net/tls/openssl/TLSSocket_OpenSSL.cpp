@@ -40,6 +40,7 @@
 
 #include "vmime/utility/stringUtils.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <cstring>
 
@@ -368,6 +369,55 @@ void TLSSocket_OpenSSL::sendRaw(const byte_t* buffer, const size_t count) {
 }
 
 
+void TLSSocket_OpenSSL::sendRawBlocks(const block* blocks, const size_t count) {
+
+	// Coalesce small blocks into a buffer of the size of a TLS record,
+	// so that each SSL_write() produces a full record
+	static const size_t RECORD_SIZE = 16384;
+
+	if (m_recordBuffer.empty()) {
+		m_recordBuffer.resize(RECORD_SIZE);
+	}
+
+	byte_t* const buffer = &m_recordBuffer[0];
+	size_t buffered = 0;
+
+	for (size_t i = 0 ; i < count ; ++i) {
+
+		const byte_t* data = blocks[i].data;
+		size_t size = blocks[i].count;
+
+		if (buffered == 0 && size >= RECORD_SIZE) {
+
+			// Large block: send it directly
+			sendRaw(data, size);
+			continue;
+		}
+
+		while (size > 0) {
+
+			const size_t n = std::min(size, RECORD_SIZE - buffered);
+
+			std::copy(data, data + n, buffer + buffered);
+
+			buffered += n;
+			data += n;
+			size -= n;
+
+			if (buffered == RECORD_SIZE) {
+
+				sendRaw(buffer, buffered);
+				buffered = 0;
+			}
+		}
+	}
+
+	if (buffered != 0) {
+		sendRaw(buffer, buffered);
+	}
+}
+
+
 size_t TLSSocket_OpenSSL::sendRawNonBlocking(const byte_t* buffer, const size_t count) {
 
 	if (!m_ssl) {
@@ -37,6 +37,7 @@
 #include "vmime/net/tls/TLSSocket.hpp"
 
 #include <memory>
+#include <vector>
 
 #include <openssl/ssl.h>
 
@@ -81,6 +82,7 @@ public:
 	void send(const char* str);
 	void sendRaw(const byte_t* buffer, const size_t count);
 	size_t sendRawNonBlocking(const byte_t* buffer, const size_t count);
+	void sendRawBlocks(const block* blocks, const size_t count);
 
 	size_t getBlockSize() const;
 
@@ -120,6 +122,9 @@ private:
 
 	byte_t m_buffer[65536];
 
+	// Buffer for coalescing small blocks in sendRawBlocks()
+	std::vector <byte_t> m_recordBuffer;
+
 	SSL* m_ssl;
 
 	unsigned int m_status;
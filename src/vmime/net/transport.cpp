@@ -134,6 +134,24 @@ static void extractMailboxes(
 }
 
 
+// Read-only access to a field value: this does not mark the field
+// as modified, so that it can still be copied as it was parsed
+template <typename T>
+static shared_ptr <const T> findConstFieldValue(
+	const shared_ptr <const header>& hdr,
+	const string& fieldName
+) {
+
+	shared_ptr <const headerField> field = hdr->findField(fieldName);
+
+	if (field) {
+		return field->getValue <T>();
+	}
+
+	return null;
+}
+
+
 void transport::send(
 	const shared_ptr <vmime::message>& msg,
 	utility::progressListener* progress,
@@ -141,8 +159,10 @@ void transport::send(
 ) {
 
 	// Extract expeditor
-	shared_ptr <mailbox> fromMbox =
-		msg->getHeader()->findFieldValue <mailbox>(fields::FROM);
+	shared_ptr <const header> msgHeader = msg->getHeader();
+
+	shared_ptr <const mailbox> fromMbox =
+		findConstFieldValue <mailbox>(msgHeader, fields::FROM);
 
 	if (!fromMbox) {
 		throw exceptions::no_expeditor();
@@ -151,8 +171,8 @@ void transport::send(
 	mailbox expeditor = *fromMbox;
 
 	// Extract sender
-	shared_ptr <mailbox> senderMbox =
-		msg->getHeader()->findFieldValue <mailbox>(fields::SENDER);
+	shared_ptr <const mailbox> senderMbox =
+		findConstFieldValue <mailbox>(msgHeader, fields::SENDER);
 
 	mailbox sender;
 
@@ -166,22 +186,22 @@ void transport::send(
 	mailboxList recipients;
 
 	// -- "To" field
-	shared_ptr <addressList> addresses =
-		msg->getHeader()->findFieldValue <addressList>(fields::TO);
+	shared_ptr <const addressList> addresses =
+		findConstFieldValue <addressList>(msgHeader, fields::TO);
 
 	if (addresses) {
 		extractMailboxes(recipients, *addresses);
 	}
 
 	// -- "Cc" field
-	addresses = msg->getHeader()->findFieldValue <addressList>(fields::CC);
+	addresses = findConstFieldValue <addressList>(msgHeader, fields::CC);
 
 	if (addresses) {
 		extractMailboxes(recipients, *addresses);
 	}
 
 	// -- "Bcc" field
-	addresses = msg->getHeader()->findFieldValue <addressList>(fields::BCC);
+	addresses = findConstFieldValue <addressList>(msgHeader, fields::BCC);
 
 	if (addresses) {
 		extractMailboxes(recipients, *addresses);
@@ -76,6 +76,8 @@ void parameter::copyFrom(const component& other) {
 
 	m_name = param.m_name;
 	m_value->copyFrom(*param.m_value);
+
+	copyParsedDataFrom(param);
 }
 
 
@@ -112,6 +114,8 @@ void parameter::setValue(const component& value) {
 void parameter::setValue(const word& value) {
 
 	*m_value = value;
+
+	discardParsedData();
 }
 
 
@@ -652,8 +656,17 @@ size_t parameter::getGeneratedSize(const generationContext& ctx) {
 }
 
 
+bool parameter::isParsedDataReusable() const {
+
+	return hasParsedData();
+}
+
+
 const std::vector <shared_ptr <component> > parameter::getChildComponents() {
 
+	// The value may be modified through the returned list
+	discardParsedData();
+
 	std::vector <shared_ptr <component> > list;
 
 	list.push_back(m_value);
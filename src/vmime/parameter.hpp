@@ -87,6 +87,8 @@ public:
 
 	const std::vector <shared_ptr <component> > getChildComponents();
 
+	bool isParsedDataReusable() const;
+
 	/** Return the name of this parameter.
 	  *
 	  * @return name of this parameter
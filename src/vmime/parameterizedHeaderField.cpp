@@ -337,7 +337,7 @@ void parameterizedHeaderField::parseImpl(
 			const paramInfo& info = (*it).second;
 
 			// Append this parameter to the list
-			shared_ptr <parameter> param = make_shared <parameter>((*it).first);
+			shared_ptr <parameter> param = utility::makeShared <parameter>(ctx.getMemoryArena(), (*it).first);
 
 			param->parse(ctx, info.value);
 			param->setParsedBounds(info.start, info.end);
@@ -408,6 +408,8 @@ void parameterizedHeaderField::copyFrom(const component& other) {
 
 		appendParameter(vmime::clone(*i));
 	}
+
+	copyParsedDataFrom(source);
 }
 
 
@@ -482,6 +484,8 @@ shared_ptr <parameter> parameterizedHeaderField::getParameter(const string& para
 void parameterizedHeaderField::appendParameter(const shared_ptr <parameter>& param) {
 
 	m_params.push_back(param);
+
+	discardParsedData();
 }
 
 
@@ -498,6 +502,8 @@ void parameterizedHeaderField::insertParameterBefore(
 	}
 
 	m_params.insert(it, param);
+
+	discardParsedData();
 }
 
 
@@ -511,6 +517,8 @@ void parameterizedHeaderField::insertParameterBefore(
 	}
 
 	m_params.insert(m_params.begin() + pos, param);
+
+	discardParsedData();
 }
 
 
@@ -527,6 +535,8 @@ void parameterizedHeaderField::insertParameterAfter(
 	}
 
 	m_params.insert(it + 1, param);
+
+	discardParsedData();
 }
 
 
@@ -540,6 +550,8 @@ void parameterizedHeaderField::insertParameterAfter(
 	}
 
 	m_params.insert(m_params.begin() + pos + 1, param);
+
+	discardParsedData();
 }
 
 
@@ -553,6 +565,8 @@ void parameterizedHeaderField::removeParameter(const shared_ptr <parameter>& par
 	}
 
 	m_params.erase(it);
+
+	discardParsedData();
 }
 
 
@@ -561,12 +575,16 @@ void parameterizedHeaderField::removeParameter(const size_t pos) {
 	const std::vector <shared_ptr <parameter> >::iterator it = m_params.begin() + pos;
 
 	m_params.erase(it);
+
+	discardParsedData();
 }
 
 
 void parameterizedHeaderField::removeAllParameters() {
 
 	m_params.clear();
+
+	discardParsedData();
 }
 
 
@@ -616,6 +634,38 @@ const std::vector <shared_ptr <parameter> > parameterizedHeaderField::getParamet
 }
 
 
+bool parameterizedHeaderField::isParsedDataReusable() const {
+
+	if (!headerField::isParsedDataReusable()) {
+		return false;
+	}
+
+	for (std::vector <shared_ptr <parameter> >::const_iterator it = m_params.begin() ;
+	     it != m_params.end() ; ++it) {
+
+		if (!(*it)->isParsedDataReusable()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void parameterizedHeaderField::retainParsedData(
+	const shared_ptr <utility::parserInputStreamAdapter>& source
+) {
+
+	headerField::retainParsedData(source);
+
+	for (std::vector <shared_ptr <parameter> >::iterator it = m_params.begin() ;
+	     it != m_params.end() ; ++it) {
+
+		(*it)->retainParsedData(source);
+	}
+}
+
+
 const std::vector <shared_ptr <component> > parameterizedHeaderField::getChildComponents() {
 
 	std::vector <shared_ptr <component> > list = headerField::getChildComponents();
@@ -193,12 +193,16 @@ public:
 
 	const std::vector <shared_ptr <component> > getChildComponents();
 
+	bool isParsedDataReusable() const;
+
 private:
 
 	std::vector <shared_ptr <parameter> > m_params;
 
 protected:
 
+	void retainParsedData(const shared_ptr <utility::parserInputStreamAdapter>& source);
+
 	void parseImpl(
 		parsingContext& ctx,
 		const string& buffer,
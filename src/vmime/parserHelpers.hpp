@@ -27,6 +27,7 @@
 
 #include "vmime/types.hpp"
 #include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/scanUtils.hpp"
 
 #include <algorithm>
 
@@ -94,6 +95,35 @@ public:
 	}
 
 
+	/** Skips spaces and tabs in the specified buffer.
+	  *
+	  * @param buffer buffer
+	  * @param currentPos start skipping from this position
+	  * @param end stop skipping at this position
+	  * @return position of the first byte which is neither a space
+	  * nor a tab, or end if there is no such byte
+	  */
+	static size_t skipSpaceOrTab(
+		const string& buffer,
+		const size_t currentPos,
+		const size_t end
+	) {
+
+		static const byte_t spaceOrTab[] = { ' ', '\t' };
+
+		if (currentPos >= end) {
+			return end;
+		}
+
+		const size_t pos = utility::scanUtils::findFirstNotOf(
+			utility::stringUtils::bytesFromString(buffer) + currentPos,
+			end - currentPos, spaceOrTab, 2
+		);
+
+		return pos == npos ? end : currentPos + pos;
+	}
+
+
 	/** Finds the next EOL sequence in the specified buffer.
 	  * An EOL sequence may be a CR+LF sequence, or a LF sequence.
 	  *
@@ -117,20 +147,15 @@ public:
 			return false;
 		}
 
-		while (pos < end) {
-
-			if (buffer[pos] == '\r' && pos + 1 < end && buffer[pos + 1] == '\n') {
-
-				*eol = pos + 2;
-				return true;
-
-			} else if (buffer[pos] == '\n') {
+		// "[CR][LF]" and "[LF]" both end right after the "[LF]"
+		const size_t lf = utility::scanUtils::findByte(
+			utility::stringUtils::bytesFromString(buffer) + pos, end - pos, '\n'
+		);
 
-				*eol = pos + 1;
-				return true;
-			}
+		if (lf != npos) {
 
-			++pos;
+			*eol = pos + lf + 1;
+			return true;
 		}
 
 		*eol = end;
@@ -35,7 +35,12 @@ parsingContext::parsingContext()
 
 parsingContext::parsingContext(const parsingContext& ctx)
 	: context(ctx),
-	  m_headerParseErrorRecovery(vmime::headerParseRecoveryMethod::SKIP_LINE) {
+	  m_headerParseErrorRecovery(ctx.m_headerParseErrorRecovery),
+	  m_useMyHostname(ctx.m_useMyHostname),
+	  m_lazyHeaderFieldParsing(ctx.m_lazyHeaderFieldParsing),
+	  m_lazyBodyPartParsing(ctx.m_lazyBodyPartParsing),
+	  m_retainParsedData(ctx.m_retainParsedData),
+	  m_memoryArena(ctx.m_memoryArena) {
 
 }
 
@@ -85,4 +90,72 @@ void parsingContext::setUseMyHostname(bool useMyHostname) {
 }
 
 
+bool parsingContext::getLazyHeaderFieldParsing() const {
+
+	return m_lazyHeaderFieldParsing;
+}
+
+
+void parsingContext::setLazyHeaderFieldParsing(const bool lazy) {
+
+	m_lazyHeaderFieldParsing = lazy;
+}
+
+
+bool parsingContext::getLazyBodyPartParsing() const {
+
+	return m_lazyBodyPartParsing;
+}
+
+
+void parsingContext::setLazyBodyPartParsing(const bool lazy) {
+
+	m_lazyBodyPartParsing = lazy;
+}
+
+
+bool parsingContext::getRetainParsedData() const {
+
+	return m_retainParsedData;
+}
+
+
+void parsingContext::setRetainParsedData(const bool retain) {
+
+	m_retainParsedData = retain;
+}
+
+
+shared_ptr <utility::memoryArena> parsingContext::getMemoryArena() const {
+
+	return m_memoryArena;
+}
+
+
+void parsingContext::setMemoryArena(const shared_ptr <utility::memoryArena>& arena) {
+
+	m_memoryArena = arena;
+}
+
+
+parsingContext& parsingContext::operator=(const parsingContext& ctx) {
+
+	copyFrom(ctx);
+	return *this;
+}
+
+
+void parsingContext::copyFrom(const parsingContext& ctx) {
+
+	context::copyFrom(ctx);
+
+	m_headerParseErrorRecovery = ctx.m_headerParseErrorRecovery;
+	m_useMyHostname = ctx.m_useMyHostname;
+	m_lazyHeaderFieldParsing = ctx.m_lazyHeaderFieldParsing;
+	m_lazyBodyPartParsing = ctx.m_lazyBodyPartParsing;
+	m_retainParsedData = ctx.m_retainParsedData;
+	m_memoryArena = ctx.m_memoryArena;
+}
+
+
 } // vmime
@@ -26,6 +26,7 @@
 
 
 #include "vmime/context.hpp"
+#include "vmime/utility/memoryArena.hpp"
 
 
 namespace vmime {
@@ -101,6 +102,91 @@ public:
 	  */
 	void setUseMyHostname(bool useMyHostname);
 
+	/** Return whether the parsing of header field values is deferred
+	  * until they are accessed.
+	  *
+	  * @retval true Header field values are parsed on first access
+	  * @retval false Header field values are parsed along with the header
+	  */
+	bool getLazyHeaderFieldParsing() const;
+
+	/** Enables/disables lazy parsing of header field values. When enabled,
+	  * the raw value of each field is kept when the header is parsed, and is
+	  * parsed into a headerFieldValue only the first time it is accessed
+	  * (eg. with headerField::getValue()). Parameterized fields, such as
+	  * "Content-Type", are always parsed immediately. The default is
+	  * to parse all values immediately.
+	  */
+	void setLazyHeaderFieldParsing(const bool lazy);
+
+	/** Return whether the parsing of the sub-parts of multipart bodies
+	  * is deferred until they are accessed.
+	  *
+	  * @retval true Sub-parts are parsed on first access
+	  * @retval false Sub-parts are parsed along with their parent
+	  */
+	bool getLazyBodyPartParsing() const;
+
+	/** Enables/disables lazy parsing of the sub-parts of multipart bodies.
+	  * When enabled, only the positions of the boundaries are determined
+	  * when a multipart body is parsed; the header and body of each
+	  * sub-part are parsed the first time the part is accessed. The
+	  * input data must remain available until then. The default is
+	  * to parse all parts immediately.
+	  */
+	void setLazyBodyPartParsing(const bool lazy);
+
+	/** Return whether parsed components keep a reference to the data
+	  * they were parsed from, so that they can be generated again by
+	  * copying it.
+	  *
+	  * @retval true Parsed data is retained
+	  * @retval false Parsed data is not retained
+	  */
+	bool getRetainParsedData() const;
+
+	/** Enables/disables the raw-preserving round-trip mode. When enabled,
+	  * messages, body parts, bodies, headers and header fields keep a
+	  * reference to the data they were parsed from. When generated, the
+	  * ones which have not been modified since they were parsed are
+	  * emitted by copying their original bytes instead of being
+	  * re-generated, which makes the output byte-identical to the input
+	  * (eg. for DKIM-signed messages), except for modified components.
+	  * See component::isParsedDataReusable(). The input data must remain
+	  * available as long as the components exist. The default is to
+	  * always re-generate components.
+	  */
+	void setRetainParsedData(const bool retain);
+
+	/** Return the arena from which the components created while
+	  * parsing are allocated.
+	  *
+	  * @return memory arena, or NULL if components are allocated
+	  * on the heap
+	  */
+	shared_ptr <utility::memoryArena> getMemoryArena() const;
+
+	/** Sets the arena from which the components created while parsing
+	  * (header fields and their values, words, parameters, mailboxes...)
+	  * are allocated, instead of being allocated one by one on the heap.
+	  * The memory is released when the last of these components is
+	  * destroyed, typically along with the message. The default is to
+	  * allocate components on the heap.
+	  *
+	  * As an arena is not thread-safe, a new one should be set for each
+	  * message parsed, eg. setMemoryArena(make_shared <utility::memoryArena>()).
+	  * For the same reason, components whose parsing is deferred (see
+	  * setLazyHeaderFieldParsing() and setLazyBodyPartParsing()) are
+	  * allocated on the heap, as they may be parsed from any thread.
+	  *
+	  * @param arena memory arena, or NULL to allocate components
+	  * on the heap
+	  */
+	void setMemoryArena(const shared_ptr <utility::memoryArena>& arena);
+
+	parsingContext& operator=(const parsingContext& ctx);
+	void copyFrom(const parsingContext& ctx);
+
 protected:
 
 	headerParseRecoveryMethod::headerLineError m_headerParseErrorRecovery;
@@ -120,6 +206,25 @@ protected:
 	  *  for header fields when one is not present.
 	  */
 	bool m_useMyHostname{true};
+
+	/** Flag to indicate if header field values should be parsed
+	  *  on first access instead of when the header is parsed.
+	  */
+	bool m_lazyHeaderFieldParsing{false};
+
+	/** Flag to indicate if the sub-parts of multipart bodies should be
+	  *  parsed on first access instead of along with their parent.
+	  */
+	bool m_lazyBodyPartParsing{false};
+
+	/** Flag to indicate if parsed components should keep a reference
+	  *  to their original data, to generate them by copying it.
+	  */
+	bool m_retainParsedData{false};
+
+	/** Arena from which parsed components are allocated, if any.
+	  */
+	shared_ptr <utility::memoryArena> m_memoryArena;
 };
 
 
@@ -36,6 +36,7 @@
 
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <sys/types.h>
 #include <sys/time.h>
@@ -823,6 +824,87 @@ void posixSocket::sendRaw(const byte_t* buffer, const size_t count) {
 }
 
 
+void posixSocket::sendRawBlocks(const block* blocks, const size_t count) {
+
+	m_status &= ~STATUS_WOULDBLOCK;
+
+	// Maximum number of blocks handed to a single sendmsg() call;
+	// stays well below IOV_MAX on every supported system
+	static const size_t MAX_IOV = 64;
+
+	struct iovec iov[MAX_IOV];
+
+	size_t first = 0;       // first block not yet completely sent
+	size_t firstOffset = 0; // bytes of this block already sent
+
+	while (first < count) {
+
+		size_t iovCount = 0;
+
+		for (size_t i = first ; i < count && iovCount < MAX_IOV ; ++i) {
+
+			const size_t skip = (i == first ? firstOffset : 0);
+
+			if (blocks[i].count == skip) {
+				continue;
+			}
+
+			iov[iovCount].iov_base = const_cast <byte_t*>(blocks[i].data + skip);
+			iov[iovCount].iov_len = blocks[i].count - skip;
+
+			++iovCount;
+		}
+
+		if (iovCount == 0) {
+			break;
+		}
+
+		struct msghdr msg;
+		::memset(&msg, 0, sizeof(msg));
+
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iovCount;
+
+#if VMIME_HAVE_MSG_NOSIGNAL
+		const ssize_t ret = ::sendmsg(m_desc, &msg, MSG_NOSIGNAL);
+#else
+		const ssize_t ret = ::sendmsg(m_desc, &msg, 0);
+#endif
+
+		if (ret <= 0) {
+
+			if (ret < 0 && !IS_EAGAIN(errno)) {
+				throwSocketError(errno);
+			}
+
+			waitForWrite(50 /* msecs */);
+
+		} else {
+
+			// Advance past the bytes which have been sent (partial
+			// writes may stop in the middle of a block)
+			size_t sent = static_cast <size_t>(ret);
+
+			while (first < count && sent >= blocks[first].count - firstOffset) {
+
+				sent -= blocks[first].count - firstOffset;
+				firstOffset = 0;
+				++first;
+			}
+
+			if (first < count) {
+				firstOffset += sent;
+			}
+		}
+	}
+
+	// Reset timeout
+	if (m_timeoutHandler) {
+		m_timeoutHandler->resetTimeOut();
+	}
+}
+
+
 size_t posixSocket::sendRawNonBlocking(const byte_t* buffer, const size_t count) {
 
 	m_status &= ~STATUS_WOULDBLOCK;
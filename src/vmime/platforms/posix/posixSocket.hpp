@@ -63,6 +63,7 @@ public:
 	void send(const char* str);
 	void sendRaw(const byte_t* buffer, const size_t count);
 	size_t sendRawNonBlocking(const byte_t* buffer, const size_t count);
+	void sendRawBlocks(const block* blocks, const size_t count);
 
 	size_t getBlockSize() const;
 
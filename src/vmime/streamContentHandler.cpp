@@ -79,6 +79,8 @@ streamContentHandler& streamContentHandler::operator=(const streamContentHandler
 	m_stream = cts.m_stream;
 	m_length = cts.m_length;
 
+	dataChanged();
+
 	return *this;
 }
 
@@ -92,6 +94,8 @@ void streamContentHandler::setData(
 	m_encoding = enc;
 	m_length = length;
 	m_stream = is;
+
+	dataChanged();
 }
 
 
@@ -74,6 +74,8 @@ stringContentHandler& stringContentHandler::operator=(const stringContentHandler
 	m_encoding = cts.m_encoding;
 	m_string = cts.m_string;
 
+	dataChanged();
+
 	return *this;
 }
 
@@ -82,6 +84,8 @@ void stringContentHandler::setData(const string& buffer, const vmime::encoding&
 
 	m_encoding = enc;
 	m_string = buffer;
+
+	dataChanged();
 }
 
 
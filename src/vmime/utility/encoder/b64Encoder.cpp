@@ -22,7 +22,21 @@
 //
 
 #include "vmime/utility/encoder/b64Encoder.hpp"
-#include "vmime/parserHelpers.hpp"
+#include "vmime/utility/scanUtils.hpp"
+
+#include <cstring>
+#include <vector>
+
+
+// SIMD functions are compiled with a "target" attribute, so that they
+// can be selected at runtime without requiring a specific -march flag
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	define VMIME_B64_HAVE_SSSE3 1
+#	define VMIME_B64_HAVE_AVX2 1
+#	include <immintrin.h>
+#	define VMIME_B64_TARGET_SSSE3 __attribute__((target("ssse3")))
+#	define VMIME_B64_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
 
 
 namespace vmime {
@@ -73,6 +87,370 @@ const unsigned char b64Encoder::sm_decodeMap[256] = {
 #endif // VMIME_BUILDING_DOC
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+// Encoding kernels: encode 'groups' groups of 3 bytes into 4 characters each.
+//
+// Decoding kernels: decode at most 'quartets' groups of 4 characters into 3
+// bytes each, and stop at the first group which contains padding or a
+// character which is not in the alphabet (it is handled by the caller).
+// The output buffer must have at least 8 bytes of slack after the data.
+
+typedef void (*encodeFunc)(const byte_t*, const size_t, byte_t*, const unsigned char*);
+typedef size_t (*decodeFunc)(const byte_t*, const size_t, byte_t*, const unsigned char*);
+
+
+// Portable implementation
+
+void encodeScalar(
+	const byte_t* in,
+	const size_t groups,
+	byte_t* out,
+	const unsigned char* alphabet
+) {
+
+	for (size_t i = 0 ; i < groups ; ++i, in += 3, out += 4) {
+
+		out[0] = alphabet[(in[0] & 0xFC) >> 2];
+		out[1] = alphabet[((in[0] & 0x03) << 4) | ((in[1] & 0xF0) >> 4)];
+		out[2] = alphabet[((in[1] & 0x0F) << 2) | ((in[2] & 0xC0) >> 6)];
+		out[3] = alphabet[(in[2] & 0x3F)];
+	}
+}
+
+
+size_t decodeScalar(
+	const byte_t* in,
+	const size_t quartets,
+	byte_t* out,
+	const unsigned char* decodeMap
+) {
+
+	for (size_t i = 0 ; i < quartets ; ++i, in += 4, out += 3) {
+
+		const unsigned int v0 = decodeMap[in[0]];
+		const unsigned int v1 = decodeMap[in[1]];
+		const unsigned int v2 = decodeMap[in[2]];
+		const unsigned int v3 = decodeMap[in[3]];
+
+		if (((v0 | v1 | v2 | v3) & 0x80) != 0 ||
+		    in[0] == '=' || in[1] == '=' || in[2] == '=' || in[3] == '=') {
+
+			return i;
+		}
+
+		out[0] = static_cast <byte_t>((v0 << 2) | (v1 >> 4));
+		out[1] = static_cast <byte_t>((v1 << 4) | (v2 >> 2));
+		out[2] = static_cast <byte_t>((v2 << 6) | v3);
+	}
+
+	return quartets;
+}
+
+
+#ifdef VMIME_B64_HAVE_SSSE3
+
+// SSSE3 implementation (12 bytes <-> 16 characters at a time)
+// See http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+// and http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html
+
+VMIME_B64_TARGET_SSSE3
+inline __m128i encodeBlockSSSE3(const __m128i in) {
+
+	// Spread 3 bytes into 4 bytes, then extract 6-bit indices
+	const __m128i spread = _mm_shuffle_epi8(in,
+		_mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+	const __m128i t0 = _mm_and_si128(spread, _mm_set1_epi32(0x0fc0fc00));
+	const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+	const __m128i t2 = _mm_and_si128(spread, _mm_set1_epi32(0x003f03f0));
+	const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+
+	const __m128i indices = _mm_or_si128(t1, t3);
+
+	// Translate indices to characters: compute a range number for
+	// each index, then add the offset for this range
+	__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+	const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+	range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+	const __m128i offsets = _mm_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'/' - 63, 'A', 0, 0
+	);
+
+	return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+
+// Return false if the block contains a character which is not in the alphabet
+VMIME_B64_TARGET_SSSE3
+inline bool decodeBlockSSSE3(const __m128i in, __m128i* out) {
+
+	const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+	const __m128i loNibbles = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+
+	// Validate input: for each valid character, no bit is set in both lookups
+	const __m128i lutLo = _mm_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+	);
+	const __m128i lutHi = _mm_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+	);
+
+	const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+	const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+
+	if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) {
+		return false;
+	}
+
+	// Translate characters to 6-bit values
+	const __m128i lutRoll = _mm_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71,
+		0, 0, 0, 0, 0, 0, 0, 0
+	);
+
+	const __m128i eq2F = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+	const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+	const __m128i values = _mm_add_epi8(in, roll);
+
+	// Pack 4 x 6 bits into 3 bytes
+	const __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+	const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+
+	*out = _mm_shuffle_epi8(packed,
+		_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+	return true;
+}
+
+
+VMIME_B64_TARGET_SSSE3
+void encodeSSSE3(
+	const byte_t* in,
+	const size_t groups,
+	byte_t* out,
+	const unsigned char* alphabet
+) {
+
+	size_t i = 0;
+
+	// 16 bytes are loaded, only 12 are used
+	for ( ; (groups - i) * 3 >= 16 ; i += 4) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(in + i * 3));
+		_mm_storeu_si128(reinterpret_cast <__m128i*>(out + i * 4), encodeBlockSSSE3(block));
+	}
+
+	encodeScalar(in + i * 3, groups - i, out + i * 4, alphabet);
+}
+
+
+VMIME_B64_TARGET_SSSE3
+size_t decodeSSSE3(
+	const byte_t* in,
+	const size_t quartets,
+	byte_t* out,
+	const unsigned char* decodeMap
+) {
+
+	size_t i = 0;
+
+	for ( ; i + 4 <= quartets ; i += 4) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(in + i * 4));
+		__m128i result;
+
+		if (!decodeBlockSSSE3(block, &result)) {
+			break;
+		}
+
+		// 16 bytes are stored, only 12 are valid
+		_mm_storeu_si128(reinterpret_cast <__m128i*>(out + i * 3), result);
+	}
+
+	return i + decodeScalar(in + i * 4, quartets - i, out + i * 3, decodeMap);
+}
+
+#endif // VMIME_B64_HAVE_SSSE3
+
+
+#ifdef VMIME_B64_HAVE_AVX2
+
+// AVX2 implementation (24 bytes <-> 32 characters at a time): same
+// algorithm as SSSE3, on two 128-bit lanes
+
+VMIME_B64_TARGET_AVX2
+void encodeAVX2(
+	const byte_t* in,
+	const size_t groups,
+	byte_t* out,
+	const unsigned char* alphabet
+) {
+
+	const __m256i spreadShuffle = _mm256_broadcastsi128_si256(
+		_mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+	const __m256i offsets = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'/' - 63, 'A', 0, 0
+	));
+
+	size_t i = 0;
+
+	// Two overlapping 16-byte loads (at offsets 0 and 12) per iteration
+	for ( ; (groups - i) * 3 >= 28 ; i += 8) {
+
+		const __m128i lo = _mm_loadu_si128(reinterpret_cast <const __m128i*>(in + i * 3));
+		const __m128i hi = _mm_loadu_si128(reinterpret_cast <const __m128i*>(in + i * 3 + 12));
+
+		const __m256i block = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		const __m256i spread = _mm256_shuffle_epi8(block, spreadShuffle);
+
+		const __m256i t0 = _mm256_and_si256(spread, _mm256_set1_epi32(0x0fc0fc00));
+		const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+		const __m256i t2 = _mm256_and_si256(spread, _mm256_set1_epi32(0x003f03f0));
+		const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+
+		const __m256i indices = _mm256_or_si256(t1, t3);
+
+		__m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+		const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+		range = _mm256_or_si256(range, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+
+		const __m256i result = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+
+		_mm256_storeu_si256(reinterpret_cast <__m256i*>(out + i * 4), result);
+	}
+
+	encodeSSSE3(in + i * 3, groups - i, out + i * 4, alphabet);
+}
+
+
+VMIME_B64_TARGET_AVX2
+size_t decodeAVX2(
+	const byte_t* in,
+	const size_t quartets,
+	byte_t* out,
+	const unsigned char* decodeMap
+) {
+
+	const __m256i lutLo = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+	));
+	const __m256i lutHi = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+	));
+	const __m256i lutRoll = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71,
+		0, 0, 0, 0, 0, 0, 0, 0
+	));
+	const __m256i packShuffle = _mm256_broadcastsi128_si256(
+		_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+	size_t i = 0;
+
+	for ( ; i + 8 <= quartets ; i += 8) {
+
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast <const __m256i*>(in + i * 4));
+
+		const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(block, 4), _mm256_set1_epi8(0x0f));
+		const __m256i loNibbles = _mm256_and_si256(block, _mm256_set1_epi8(0x0f));
+
+		const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+		const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+
+		if (!_mm256_testz_si256(lo, hi)) {
+			break;
+		}
+
+		const __m256i eq2F = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(0x2f));
+		const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+		const __m256i values = _mm256_add_epi8(block, roll);
+
+		const __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+		const __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+		const __m256i shuffled = _mm256_shuffle_epi8(packed, packShuffle);
+
+		// Gather the 12 valid bytes of each lane; 32 bytes are stored, only 24 are valid
+		const __m256i result = _mm256_permutevar8x32_epi32(
+			shuffled, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+		_mm256_storeu_si256(reinterpret_cast <__m256i*>(out + i * 3), result);
+	}
+
+	return i + decodeSSSE3(in + i * 4, quartets - i, out + i * 3, decodeMap);
+}
+
+#endif // VMIME_B64_HAVE_AVX2
+
+
+// Runtime selection of the implementation
+
+struct b64Functions {
+
+	encodeFunc encode;
+	decodeFunc decode;
+};
+
+
+b64Functions selectB64Functions() {
+
+	b64Functions funcs;
+
+	funcs.encode = &encodeScalar;
+	funcs.decode = &decodeScalar;
+
+#ifdef VMIME_B64_HAVE_SSSE3
+
+	__builtin_cpu_init();
+
+#	ifdef VMIME_B64_HAVE_AVX2
+
+	if (__builtin_cpu_supports("avx2")) {
+
+		funcs.encode = &encodeAVX2;
+		funcs.decode = &decodeAVX2;
+
+		return funcs;
+	}
+
+#	endif // VMIME_B64_HAVE_AVX2
+
+	if (__builtin_cpu_supports("ssse3")) {
+
+		funcs.encode = &encodeSSSE3;
+		funcs.decode = &decodeSSSE3;
+	}
+
+#endif // VMIME_B64_HAVE_SSSE3
+
+	return funcs;
+}
+
+
+const b64Functions& getB64Functions() {
+
+	static const b64Functions funcs = selectB64Functions();
+	return funcs;
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 
 size_t b64Encoder::encode(
 	utility::inputStream& in,
@@ -88,107 +466,124 @@ size_t b64Encoder::encode(
 	const bool cutLines = (propMaxLineLength != static_cast <size_t>(-1));
 	const size_t maxLineLength = std::min(propMaxLineLength, static_cast <size_t>(76));
 
-	// Process data
-	byte_t buffer[65536];
+	// Number of 4-character groups per line: a line is cut as soon
+	// as there is no room left for CRLF and another group
+	const size_t groupsPerLine = (maxLineLength > 10) ? (maxLineLength - 6 + 3) / 4 : 1;
+
+	const encodeFunc encodeGroups = getB64Functions().encode;
+
+	// Process data by blocks of whole groups; lines are cut in bulk.
+	// Buffers are allocated on the heap, as the encoder may be used
+	// in threads with a small stack
+	static const size_t BLOCK_GROUPS = 4096;
+
+	std::vector <byte_t> inBuffer(BLOCK_GROUPS * 3);
+	byte_t* const buffer = &inBuffer[0];
 	size_t bufferLength = 0;
-	size_t bufferPos = 0;
 
-	byte_t bytes[3];
-	byte_t output[4];
+	std::vector <byte_t> outBuffer(BLOCK_GROUPS * 6 + 8);  // worst case: CRLF after each group
+	byte_t* const output = &outBuffer[0];
 
 	size_t total = 0;
 	size_t inTotal = 0;
 
-	size_t curCol = 0;
+	size_t lineGroups = 0;
 
 	if (progress) {
 		progress->start(0);
 	}
 
-	while (bufferPos < bufferLength || !in.eof()) {
-
-		if (bufferPos >= bufferLength) {
+	for (;;) {
 
-			bufferLength = in.read(buffer, sizeof(buffer));
-			bufferPos = 0;
+		size_t read = 0;
 
-			if (bufferLength == 0) {
-				break;
-			}
+		if (!in.eof()) {
+			read = in.read(buffer + bufferLength, inBuffer.size() - bufferLength);
 		}
 
-		// Get 3 bytes of data
-		int count = 0;
+		bufferLength += read;
+
+		const bool lastBlock = (read == 0);
 
-		while (count < 3 && bufferPos < bufferLength) {
-			bytes[count++] = buffer[bufferPos++];
+		if (!lastBlock && bufferLength < 3) {
+			continue;
 		}
 
-		while (count < 3) {
+		// Encode whole groups
+		const size_t groups = bufferLength / 3;
 
-			// There may be more data in the next chunk...
-			if (bufferPos >= bufferLength) {
+		byte_t* outPtr = output;
 
-				bufferLength = in.read(buffer, sizeof(buffer));
-				bufferPos = 0;
+		for (size_t i = 0 ; i < groups ; ) {
 
-				if (bufferLength == 0) {
-					break;
-				}
-			}
+			const size_t count = cutLines
+				? std::min(groups - i, groupsPerLine - lineGroups)
+				: groups - i;
+
+			encodeGroups(buffer + i * 3, count, outPtr, sm_alphabet);
+
+			outPtr += count * 4;
+			i += count;
+
+			if (cutLines && (lineGroups += count) == groupsPerLine) {
+
+				*outPtr++ = '\r';
+				*outPtr++ = '\n';
 
-			while (count < 3 && bufferPos < bufferLength) {
-				bytes[count++] = buffer[bufferPos++];
+				lineGroups = 0;
 			}
 		}
 
-		// Encode data
-		switch (count) {
+		total += groups * 4;
+		inTotal += groups * 3;
 
-			case 1:
+		// Remaining 1 or 2 bytes at the end of data
+		const size_t remaining = bufferLength - groups * 3;
 
-				output[0] = sm_alphabet[(bytes[0] & 0xFC) >> 2];
-				output[1] = sm_alphabet[(bytes[0] & 0x03) << 4];
-				output[2] = sm_alphabet[64]; // padding
-				output[3] = sm_alphabet[64]; // padding
+		if (lastBlock && remaining != 0) {
 
-				break;
+			const byte_t* bytes = buffer + groups * 3;
 
-			case 2:
+			outPtr[0] = sm_alphabet[(bytes[0] & 0xFC) >> 2];
 
-				output[0] = sm_alphabet[(bytes[0] & 0xFC) >> 2];
-				output[1] = sm_alphabet[((bytes[0] & 0x03) << 4) | ((bytes[1] & 0xF0) >> 4)];
-				output[2] = sm_alphabet[(bytes[1] & 0x0F) << 2];
-				output[3] = sm_alphabet[64]; // padding
+			if (remaining == 1) {
 
-				break;
+				outPtr[1] = sm_alphabet[(bytes[0] & 0x03) << 4];
+				outPtr[2] = sm_alphabet[64]; // padding
 
-			default:
-			case 3:
+			} else {
 
-				output[0] = sm_alphabet[(bytes[0] & 0xFC) >> 2];
-				output[1] = sm_alphabet[((bytes[0] & 0x03) << 4) | ((bytes[1] & 0xF0) >> 4)];
-				output[2] = sm_alphabet[((bytes[1] & 0x0F) << 2) | ((bytes[2] & 0xC0) >> 6)];
-				output[3] = sm_alphabet[(bytes[2] & 0x3F)];
+				outPtr[1] = sm_alphabet[((bytes[0] & 0x03) << 4) | ((bytes[1] & 0xF0) >> 4)];
+				outPtr[2] = sm_alphabet[(bytes[1] & 0x0F) << 2];
+			}
 
-				break;
-		}
+			outPtr[3] = sm_alphabet[64]; // padding
+			outPtr += 4;
 
-		// Write encoded data to output stream
-		B64_WRITE(out, output, 4);
+			if (cutLines && ++lineGroups == groupsPerLine) {
 
-		inTotal += count;
-		total += 4;
-		curCol += 4;
+				*outPtr++ = '\r';
+				*outPtr++ = '\n';
+			}
 
-		if (cutLines && curCol + 2 /* \r\n */ + 4 /* next bytes */ >= maxLineLength) {
-			out.write("\r\n", 2);
-			curCol = 0;
+			total += 4;
+			inTotal += remaining;
 		}
 
+		// Write encoded data to output stream
+		B64_WRITE(out, output, outPtr - output);
+
 		if (progress) {
 			progress->progress(inTotal, inTotal);
 		}
+
+		if (lastBlock) {
+			break;
+		}
+
+		// Keep incomplete group for the next block
+		std::memmove(buffer, buffer + groups * 3, remaining);
+		bufferLength = remaining;
 	}
 
 	if (progress) {
@@ -207,113 +602,131 @@ size_t b64Encoder::decode(
 
 	in.reset();  // may not work...
 
-	// Process the data
-	byte_t buffer[16384];
-	size_t bufferLength = 0;
-	size_t bufferPos = 0;
+	const decodeFunc decodeQuartets = getB64Functions().decode;
+
+	static const byte_t SPACES[] = { ' ', '\t', '\r', '\n' };
+
+	// Process the data (buffers are allocated on the heap, see encode())
+	static const size_t BUFFER_SIZE = 16384;
+
+	std::vector <byte_t> inBuffer(BUFFER_SIZE);
+	byte_t* const buffer = &inBuffer[0];
+
+	// Input data with white-spaces removed, plus an incomplete group
+	// of 4 characters from the previous block
+	std::vector <byte_t> dataBuffer(BUFFER_SIZE + 4);
+	byte_t* const data = &dataBuffer[0];
+	size_t dataLength = 0;
+
+	std::vector <byte_t> outBuffer(((BUFFER_SIZE + 4) / 4) * 3 + 8);
+	byte_t* const output = &outBuffer[0];
 
 	size_t total = 0;
 	size_t inTotal = 0;
 
-	byte_t bytes[4];
-	byte_t output[3];
+	bool end = false;
 
 	if (progress) {
 		progress->start(0);
 	}
 
-	while (bufferPos < bufferLength || !in.eof()) {
+	while (!end && !in.eof()) {
 
-		bytes[0] = '=';
-		bytes[1] = '=';
-		bytes[2] = '=';
-		bytes[3] = '=';
+		const size_t bufferLength = in.read(buffer, BUFFER_SIZE);
 
-		// Need to get more data?
-		if (bufferPos >= bufferLength) {
+		// No more data
+		if (bufferLength == 0) {
+			break;
+		}
 
-			bufferLength = in.read(buffer, sizeof(buffer));
-			bufferPos = 0;
+		// Remove white-spaces
+		for (size_t pos = 0 ; pos < bufferLength ; ) {
 
-			// No more data
-			if (bufferLength == 0) {
-				break;
+			size_t len = scanUtils::findFirstOf(
+				buffer + pos, bufferLength - pos, SPACES, sizeof(SPACES)
+			);
+
+			if (len == npos) {
+				len = bufferLength - pos;
 			}
+
+			std::memcpy(data + dataLength, buffer + pos, len);
+
+			dataLength += len;
+			pos += len + 1;
 		}
 
-		// 4 bytes of input provide 3 bytes of output, so
-		// get the next 4 bytes from the input stream.
-		int count = 0;
+		// Decode all complete groups of 4 characters
+		const size_t quartets = dataLength / 4;
 
-		while (count < 4 && bufferPos < bufferLength) {
+		size_t outLength = 0;
+		size_t i = 0;
 
-			const byte_t c = buffer[bufferPos++];
+		while (i < quartets) {
 
-			if (!parserHelpers::isSpace(c)) {
-				bytes[count++] = c;
-			}
-		}
+			const size_t count = decodeQuartets(
+				data + i * 4, quartets - i, output + outLength, sm_decodeMap
+			);
 
-		if (count != 4) {
+			outLength += count * 3;
+			i += count;
 
-			while (count < 4 && !in.eof()) {
+			if (i >= quartets) {
+				break;
+			}
 
-				// Data continues on the next chunk
-				bufferLength = in.read(buffer, sizeof(buffer));
-				bufferPos = 0;
+			// This group contains padding or invalid characters
+			const byte_t* bytes = data + i * 4;
 
-				while (count < 4 && bufferPos < bufferLength) {
+			++i;
 
-					const byte_t c = buffer[bufferPos++];
+			byte_t c1 = bytes[0];
+			byte_t c2 = bytes[1];
 
-					if (!parserHelpers::isSpace(c)) {
-						bytes[count++] = c;
-					}
-				}
+			if (c1 == '=' || c2 == '=') {  // end
+				end = true;
+				break;
 			}
-		}
 
-		if (count != 4) {  // input length is not a multiple of 4 bytes
-			break;
-		}
+			byte_t* outPtr = output + outLength;
 
-		// Decode the bytes
-		byte_t c1 = bytes[0];
-		byte_t c2 = bytes[1];
+			outPtr[0] = static_cast <byte_t>((sm_decodeMap[c1] << 2) | ((sm_decodeMap[c2] & 0x30) >> 4));
 
-		if (c1 == '=' || c2 == '=') {  // end
-			break;
-		}
+			c1 = bytes[2];
 
-		output[0] = static_cast <byte_t>((sm_decodeMap[c1] << 2) | ((sm_decodeMap[c2] & 0x30) >> 4));
+			if (c1 == '=') {  // end
+				outLength += 1;
+				end = true;
+				break;
+			}
 
-		c1 = bytes[2];
+			outPtr[1] = static_cast <byte_t>(((sm_decodeMap[c2] & 0xf) << 4) | ((sm_decodeMap[c1] & 0x3c) >> 2));
 
-		if (c1 == '=') {  // end
-			B64_WRITE(out, output, 1);
-			total += 1;
-			break;
-		}
+			c2 = bytes[3];
 
-		output[1] = static_cast <byte_t>(((sm_decodeMap[c2] & 0xf) << 4) | ((sm_decodeMap[c1] & 0x3c) >> 2));
+			if (c2 == '=') {  // end
+				outLength += 2;
+				end = true;
+				break;
+			}
 
-		c2 = bytes[3];
+			outPtr[2] = static_cast <byte_t>(((sm_decodeMap[c1] & 0x03) << 6) | sm_decodeMap[c2]);
 
-		if (c2 == '=') {  // end
-			B64_WRITE(out, output, 2);
-			total += 2;
-			break;
+			outLength += 3;
 		}
 
-		output[2] = static_cast <byte_t>(((sm_decodeMap[c1] & 0x03) << 6) | sm_decodeMap[c2]);
+		B64_WRITE(out, output, outLength);
 
-		B64_WRITE(out, output, 3);
-		total += 3;
-		inTotal += count;
+		total += outLength;
+		inTotal += i * 4;
 
 		if (progress) {
 			progress->progress(inTotal, inTotal);
 		}
+
+		// Keep incomplete group for the next block
+		dataLength -= quartets * 4;
+		std::memmove(data, data + quartets * 4, dataLength);
 	}
 
 	if (progress) {
@@ -37,7 +37,8 @@ namespace utility {
 namespace encoder {
 
 
-encoderFactory::encoderFactory() {
+encoderFactory::encoderFactory()
+	: m_encoders(make_shared <EncoderList>()) {
 
 	// Register some default encoders
 	registerName <b64Encoder>("base64");
@@ -70,6 +71,17 @@ shared_ptr <encoderFactory> encoderFactory::getInstance() {
 }
 
 
+void encoderFactory::registerEncoder(const shared_ptr <registeredEncoder>& enc) {
+
+	std::lock_guard <std::mutex> lock(m_registerMutex);
+
+	shared_ptr <EncoderList> encoders = make_shared <EncoderList>(*m_encoders);
+	encoders->push_back(enc);
+
+	std::atomic_store(&m_encoders, shared_ptr <const EncoderList>(encoders));
+}
+
+
 shared_ptr <encoder> encoderFactory::create(const string& name) {
 
 	try {
@@ -78,8 +90,10 @@ shared_ptr <encoder> encoderFactory::create(const string& name) {
 
 	} catch (exceptions::no_encoder_available &) {
 
-		if (m_defaultEncoder) {
-			return m_defaultEncoder;
+		shared_ptr <encoder> defaultEncoder = getDefaultEncoder();
+
+		if (defaultEncoder) {
+			return defaultEncoder;
 		}
 
 		throw;
@@ -91,9 +105,10 @@ const shared_ptr <const encoderFactory::registeredEncoder>
 	encoderFactory::getEncoderByName(const string& name) const {
 
 	const string lcName(utility::stringUtils::toLower(name));
+	const shared_ptr <const EncoderList> encoders = std::atomic_load(&m_encoders);
 
-	for (std::vector <shared_ptr <registeredEncoder> >::const_iterator it = m_encoders.begin() ;
-	     it != m_encoders.end() ; ++it) {
+	for (EncoderList::const_iterator it = encoders->begin() ;
+	     it != encoders->end() ; ++it) {
 
 		if ((*it)->getName() == lcName) {
 			return (*it);
@@ -106,24 +121,26 @@ const shared_ptr <const encoderFactory::registeredEncoder>
 
 size_t encoderFactory::getEncoderCount() const {
 
-	return m_encoders.size();
+	return std::atomic_load(&m_encoders)->size();
 }
 
 
 const shared_ptr <const encoderFactory::registeredEncoder>
 	encoderFactory::getEncoderAt(const size_t pos) const {
 
-	return m_encoders[pos];
+	return (*std::atomic_load(&m_encoders))[pos];
 }
 
 
 const std::vector <shared_ptr <const encoderFactory::registeredEncoder> >
 	encoderFactory::getEncoderList() const {
 
+	const shared_ptr <const EncoderList> encoders = std::atomic_load(&m_encoders);
+
 	std::vector <shared_ptr <const registeredEncoder> > res;
 
-	for (std::vector <shared_ptr <registeredEncoder> >::const_iterator it = m_encoders.begin() ;
-	     it != m_encoders.end() ; ++it) {
+	for (EncoderList::const_iterator it = encoders->begin() ;
+	     it != encoders->end() ; ++it) {
 
 		res.push_back(*it);
 	}
@@ -134,13 +151,13 @@ const std::vector <shared_ptr <const encoderFactory::registeredEncoder> >
 
 void encoderFactory::setDefaultEncoder(const shared_ptr <encoder>& enc) {
 
-	m_defaultEncoder = enc;
+	std::atomic_store(&m_defaultEncoder, enc);
 }
 
 
 shared_ptr <encoder> encoderFactory::getDefaultEncoder() const {
 
-	return m_defaultEncoder;
+	return std::atomic_load(&m_defaultEncoder);
 }
 
 
@@ -28,6 +28,8 @@
 #include "vmime/utility/encoder/encoder.hpp"
 #include "vmime/utility/stringUtils.hpp"
 
+#include <mutex>
+
 
 namespace vmime {
 namespace utility {
@@ -35,6 +37,10 @@ namespace encoder {
 
 
 /** A factory to create 'encoder' objects for the specified encoding.
+  *
+  * The factory can be used concurrently from several threads: lookups
+  * do not take any lock, and registrations replace the list of encoders
+  * by an updated copy.
   */
 class VMIME_EXPORT encoderFactory
 {
@@ -86,9 +92,16 @@ private:
 	};
 
 
-	std::vector <shared_ptr <registeredEncoder> > m_encoders;
+	typedef std::vector <shared_ptr <registeredEncoder> > EncoderList;
+
+	shared_ptr <const EncoderList> m_encoders;
 	shared_ptr <encoder> m_defaultEncoder;
 
+	// Serializes registrations (readers use atomic loads of the list)
+	std::mutex m_registerMutex;
+
+	void registerEncoder(const shared_ptr <registeredEncoder>& enc);
+
 public:
 
 	/** Register a new encoder by its encoding name.
@@ -98,7 +111,7 @@ public:
 	template <class E>
 	void registerName(const string& name) {
 
-		m_encoders.push_back(
+		registerEncoder(
 			vmime::make_shared <registeredEncoderImpl <E> >(utility::stringUtils::toLower(name))
 		);
 	}
@@ -22,8 +22,20 @@
 //
 
 #include "vmime/utility/encoder/qpEncoder.hpp"
+#include "vmime/utility/scanUtils.hpp"
 #include "vmime/parserHelpers.hpp"
 
+#include <cstring>
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define VMIME_QP_HAVE_SSE2 1
+#	include <emmintrin.h>
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	endif
+#endif
+
 
 namespace vmime {
 namespace utility {
@@ -146,6 +158,167 @@ int qpEncoder::RFC2047_getEncodedLength(const byte_t c) {
 }
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+// Safe-run finders: return the length of the longest prefix made of
+// characters which can be copied as-is by the encoder, that is:
+//  - in QP mode: printable characters (including space) except '=' and '?';
+//  - in RFC-2047 mode: characters for which the encoding table is 0.
+// Spaces and '.' are subject to additional rules, checked by the caller.
+
+size_t findSafeRunQPScalar(const byte_t* data, const size_t length) {
+
+	for (size_t i = 0 ; i < length ; ++i) {
+
+		const byte_t c = data[i];
+
+		if (c < 32 || c > 126 || c == '=' || c == '?') {
+			return i;
+		}
+	}
+
+	return length;
+}
+
+
+size_t findSafeRunRFC2047Scalar(
+	const byte_t* data,
+	const size_t length,
+	const unsigned char* encodeTable
+) {
+
+	for (size_t i = 0 ; i < length ; ++i) {
+
+		const byte_t c = data[i];
+
+		if (c >= 128 || encodeTable[c] != 0) {
+			return i;
+		}
+	}
+
+	return length;
+}
+
+
+#ifdef VMIME_QP_HAVE_SSE2
+
+inline size_t firstBitSet(const unsigned int mask) {
+
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return static_cast <size_t>(__builtin_ctz(mask));
+#endif
+}
+
+
+// Bytes >= 128 are negative when compared as signed, so they always
+// fail the range checks below
+
+size_t findSafeRunQP(const byte_t* data, const size_t length, const unsigned char* /* encodeTable */) {
+
+	const __m128i lowerBound = _mm_set1_epi8(31);
+	const __m128i upperBound = _mm_set1_epi8(127);
+	const __m128i equal = _mm_set1_epi8('=');
+	const __m128i question = _mm_set1_epi8('?');
+
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= length ; pos += 16) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+
+		const __m128i printable = _mm_and_si128(
+			_mm_cmpgt_epi8(block, lowerBound), _mm_cmplt_epi8(block, upperBound)
+		);
+		const __m128i special = _mm_or_si128(
+			_mm_cmpeq_epi8(block, equal), _mm_cmpeq_epi8(block, question)
+		);
+
+		const unsigned int unsafe = ~static_cast <unsigned int>(
+			_mm_movemask_epi8(_mm_andnot_si128(special, printable))
+		) & 0xffff;
+
+		if (unsafe != 0) {
+			return pos + firstBitSet(unsafe);
+		}
+	}
+
+	return pos + findSafeRunQPScalar(data + pos, length - pos);
+}
+
+
+size_t findSafeRunRFC2047(const byte_t* data, const size_t length, const unsigned char* encodeTable) {
+
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= length ; pos += 16) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+
+		// Letters (case-folded), digits, and "!*+-/"
+		const __m128i folded = _mm_or_si128(block, _mm_set1_epi8(0x20));
+
+		const __m128i letter = _mm_and_si128(
+			_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+			_mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1))
+		);
+		const __m128i digit = _mm_and_si128(
+			_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)),
+			_mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1))
+		);
+		const __m128i other = _mm_or_si128(
+			_mm_or_si128(
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('!')),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('*'))
+			),
+			_mm_or_si128(
+				_mm_or_si128(
+					_mm_cmpeq_epi8(block, _mm_set1_epi8('+')),
+					_mm_cmpeq_epi8(block, _mm_set1_epi8('-'))
+				),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('/'))
+			)
+		);
+
+		const unsigned int unsafe = ~static_cast <unsigned int>(
+			_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), other))
+		) & 0xffff;
+
+		if (unsafe != 0) {
+			return pos + firstBitSet(unsafe);
+		}
+	}
+
+	return pos + findSafeRunRFC2047Scalar(data + pos, length - pos, encodeTable);
+}
+
+#else // !VMIME_QP_HAVE_SSE2
+
+size_t findSafeRunQP(const byte_t* data, const size_t length, const unsigned char* /* encodeTable */) {
+
+	return findSafeRunQPScalar(data, length);
+}
+
+
+size_t findSafeRunRFC2047(const byte_t* data, const size_t length, const unsigned char* encodeTable) {
+
+	return findSafeRunRFC2047Scalar(data, length, encodeTable);
+}
+
+#endif // VMIME_QP_HAVE_SSE2
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 #ifndef VMIME_BUILDING_DOC
 
 #define QP_ENCODE_HEX(x) \
@@ -177,6 +350,9 @@ size_t qpEncoder::encode(
 	const bool cutLines = (propMaxLineLength != static_cast <size_t>(-1));
 	const size_t maxLineLength = std::min(propMaxLineLength, static_cast <size_t>(74));
 
+	size_t (*findSafeRun)(const byte_t*, const size_t, const unsigned char*) =
+		rfc2047 ? &findSafeRunRFC2047 : &findSafeRunQP;
+
 	// Process the data
 	byte_t buffer[16384];
 	size_t bufferLength = 0;
@@ -217,6 +393,56 @@ size_t qpEncoder::encode(
 			}
 		}
 
+		// Copy a run of characters which do not need to be encoded
+		size_t run = findSafeRun(buffer + bufferPos, bufferLength - bufferPos, sm_RFC2047EncodeTable);
+
+		if (!rfc2047 && run != 0) {
+
+			// A space at the end of the run may be followed by a line break,
+			// and a '.' at the beginning of a line must be encoded
+			if (buffer[bufferPos + run - 1] == ' ') {
+				--run;
+			}
+
+			if (curCol == 0 && buffer[bufferPos] == '.') {
+				run = 0;
+			}
+
+			// Stop at the next soft line break
+			if (cutLines) {
+				run = std::min(run, curCol < maxLineLength - 1 ? maxLineLength - 1 - curCol : 1);
+			}
+		}
+
+		if (run != 0) {
+
+			run = std::min(run, sizeof(outBuffer) - 6 - outBufferPos);
+
+			std::memcpy(outBuffer + outBufferPos, buffer + bufferPos, run);
+
+			outBufferPos += run;
+			bufferPos += run;
+			curCol += run;
+			inTotal += run;
+
+			// Soft line break : "=\r\n"
+			if (!rfc2047 && cutLines && curCol >= maxLineLength - 1) {
+
+				outBuffer[outBufferPos] = '=';
+				outBuffer[outBufferPos + 1] = '\r';
+				outBuffer[outBufferPos + 2] = '\n';
+
+				outBufferPos += 3;
+				curCol = 0;
+			}
+
+			if (progress) {
+				progress->progress(inTotal, inTotal);
+			}
+
+			continue;
+		}
+
 		// Get the next char and encode it
 		const byte_t c = buffer[bufferPos++];
 
@@ -388,6 +614,9 @@ size_t qpEncoder::decode(
 	// Process the data
 	const bool rfc2047 = getProperties().getProperty <bool>("rfc2047", false);
 
+	// Characters which start an encoded sequence ('_' only in RFC-2047 mode)
+	static const byte_t SPECIAL_CHARS[] = { '=', '_' };
+
 	byte_t buffer[16384];
 	size_t bufferLength = 0;
 	size_t bufferPos = 0;
@@ -421,6 +650,33 @@ size_t qpEncoder::decode(
 			}
 		}
 
+		// Copy characters up to the next encoded sequence
+		size_t run = scanUtils::findFirstOf(
+			buffer + bufferPos, bufferLength - bufferPos,
+			SPECIAL_CHARS, rfc2047 ? 2 : 1
+		);
+
+		if (run == npos) {
+			run = bufferLength - bufferPos;
+		}
+
+		if (run != 0) {
+
+			run = std::min(run, sizeof(outBuffer) - outBufferPos);
+
+			std::memcpy(outBuffer + outBufferPos, buffer + bufferPos, run);
+
+			outBufferPos += run;
+			bufferPos += run;
+			inTotal += run;
+
+			if (progress) {
+				progress->progress(inTotal, inTotal);
+			}
+
+			continue;
+		}
+
 		// Decode the next sequence (hex-encoded byte or printable character)
 		byte_t c = buffer[bufferPos++];
 
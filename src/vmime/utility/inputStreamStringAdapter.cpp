@@ -29,7 +29,7 @@ namespace utility {
 
 
 inputStreamStringAdapter::inputStreamStringAdapter(const string& buffer)
-	: m_buffer(buffer),
+	: m_buffer(make_shared <string>(buffer)),
 	  m_begin(0),
 	  m_end(buffer.length()),
 	  m_pos(0) {
@@ -41,6 +41,28 @@ inputStreamStringAdapter::inputStreamStringAdapter(
 	const string& buffer,
 	const size_t begin,
 	const size_t end
+)
+	: m_buffer(make_shared <string>(buffer)),
+	  m_begin(begin),
+	  m_end(end),
+	  m_pos(begin) {
+
+}
+
+
+inputStreamStringAdapter::inputStreamStringAdapter(const shared_ptr <const string>& buffer)
+	: m_buffer(buffer),
+	  m_begin(0),
+	  m_end(buffer->length()),
+	  m_pos(0) {
+
+}
+
+
+inputStreamStringAdapter::inputStreamStringAdapter(
+	const shared_ptr <const string>& buffer,
+	const size_t begin,
+	const size_t end
 )
 	: m_buffer(buffer),
 	  m_begin(begin),
@@ -50,6 +72,24 @@ inputStreamStringAdapter::inputStreamStringAdapter(
 }
 
 
+const shared_ptr <const string>& inputStreamStringAdapter::getBuffer() const {
+
+	return m_buffer;
+}
+
+
+size_t inputStreamStringAdapter::getBufferOffset() const {
+
+	return m_begin;
+}
+
+
+size_t inputStreamStringAdapter::getBufferEnd() const {
+
+	return m_end;
+}
+
+
 bool inputStreamStringAdapter::eof() const {
 
 	return m_pos >= m_end;
@@ -68,14 +108,14 @@ size_t inputStreamStringAdapter::read(byte_t* const data, const size_t count) {
 
 		const size_t remaining = m_end - m_pos;
 
-		std::copy(m_buffer.begin() + m_pos, m_buffer.end(), data);
+		std::copy(m_buffer->begin() + m_pos, m_buffer->begin() + m_end, data);
 		m_pos = m_end;
 
 		return remaining;
 
 	} else {
 
-		std::copy(m_buffer.begin() + m_pos, m_buffer.begin() + m_pos + count, data);
+		std::copy(m_buffer->begin() + m_pos, m_buffer->begin() + m_pos + count, data);
 		m_pos += count;
 
 		return count;
@@ -41,6 +41,48 @@ public:
 	inputStreamStringAdapter(const string& buffer);
 	inputStreamStringAdapter(const string& buffer, const size_t begin, const size_t end);
 
+	/** Construct a stream which reads from a shared buffer. The buffer
+	  * is not copied: a reference to it is held for the lifetime of the
+	  * stream.
+	  *
+	  * @param buffer shared buffer
+	  */
+	inputStreamStringAdapter(const shared_ptr <const string>& buffer);
+
+	/** Construct a stream which reads from a region of a shared buffer.
+	  * The buffer is not copied: a reference to it is held for the
+	  * lifetime of the stream.
+	  *
+	  * @param buffer shared buffer
+	  * @param begin start position in the buffer
+	  * @param end end position in the buffer
+	  */
+	inputStreamStringAdapter(
+		const shared_ptr <const string>& buffer,
+		const size_t begin,
+		const size_t end
+	);
+
+	/** Return the buffer from which this stream reads.
+	  *
+	  * @return underlying buffer
+	  */
+	const shared_ptr <const string>& getBuffer() const;
+
+	/** Return the position in the underlying buffer which
+	  * corresponds to position 0 in this stream.
+	  *
+	  * @return start position in the underlying buffer
+	  */
+	size_t getBufferOffset() const;
+
+	/** Return the position in the underlying buffer which
+	  * corresponds to the end of this stream.
+	  *
+	  * @return end position in the underlying buffer
+	  */
+	size_t getBufferEnd() const;
+
 	bool eof() const;
 	void reset();
 	size_t read(byte_t* const data, const size_t count);
@@ -52,7 +94,7 @@ private:
 
 	inputStreamStringAdapter(const inputStreamStringAdapter&);
 
-	const string m_buffer;  // do _NOT_ keep a reference...
+	const shared_ptr <const string> m_buffer;  // do _NOT_ keep a reference...
 	const size_t m_begin;
 	const size_t m_end;
 	size_t m_pos;
@@ -0,0 +1,111 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/utility/memoryArena.hpp"
+
+#include <cstdint>
+#include <new>
+
+
+namespace vmime {
+namespace utility {
+
+
+memoryArena::memoryArena(const size_t blockSize)
+	: m_blockSize(blockSize),
+	  m_current(NULL),
+	  m_end(NULL),
+	  m_allocatedSize(0) {
+
+}
+
+
+memoryArena::~memoryArena() {
+
+	for (std::vector <byte_t*>::iterator it = m_blocks.begin() ; it != m_blocks.end() ; ++it) {
+		::operator delete(*it);
+	}
+}
+
+
+byte_t* memoryArena::allocateBlock(const size_t size) {
+
+	m_blocks.reserve(m_blocks.size() + 1);
+
+	byte_t* block = static_cast <byte_t*>(::operator new(size));
+	m_blocks.push_back(block);
+
+	return block;
+}
+
+
+void* memoryArena::allocate(const size_t size, const size_t alignment) {
+
+	// Align the current position
+	const size_t misalignment = reinterpret_cast <uintptr_t>(m_current) & (alignment - 1);
+	const size_t padding = misalignment ? alignment - misalignment : 0;
+
+	if (m_current && static_cast <size_t>(m_end - m_current) >= size + padding) {
+
+		byte_t* p = m_current + padding;
+		m_current = p + size;
+		m_allocatedSize += size;
+
+		return p;
+	}
+
+	// Large objects get a block of their own, so that the space left
+	// in the current block is not wasted. Blocks returned by operator
+	// new are suitably aligned for any fundamental type.
+	if (size > m_blockSize / 4) {
+
+		m_allocatedSize += size;
+		return allocateBlock(size);
+	}
+
+	m_current = allocateBlock(m_blockSize);
+	m_end = m_current + m_blockSize;
+
+	byte_t* p = m_current;
+	m_current = p + size;
+	m_allocatedSize += size;
+
+	return p;
+}
+
+
+size_t memoryArena::getAllocatedSize() const {
+
+	return m_allocatedSize;
+}
+
+
+size_t memoryArena::getBlockCount() const {
+
+	return m_blocks.size();
+}
+
+
+} // utility
+} // vmime
@@ -0,0 +1,194 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_UTILITY_MEMORYARENA_HPP_INCLUDED
+#define VMIME_UTILITY_MEMORYARENA_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+
+#include <utility>
+#include <vector>
+
+
+namespace vmime {
+namespace utility {
+
+
+/** A monotonic memory arena: memory is taken sequentially from large
+  * blocks, and is only released when the arena is destroyed. Freeing
+  * memory allocated from the arena is a no-op.
+  *
+  * When an arena is set on a parsingContext, the components created
+  * while parsing are allocated from it. As each of these components
+  * holds a reference to the arena, the arena is released in one shot
+  * when the last of them is destroyed.
+  *
+  * An arena is not thread-safe: it must not be used by several
+  * threads at the same time (use one arena per parsed message).
+  */
+class VMIME_EXPORT memoryArena {
+
+public:
+
+	/** Construct a new arena.
+	  *
+	  * @param blockSize size of the blocks from which memory is allocated
+	  */
+	explicit memoryArena(const size_t blockSize = 16384);
+
+	~memoryArena();
+
+	/** Allocate memory from the arena.
+	  *
+	  * @param size number of bytes to allocate
+	  * @param alignment required alignment (must be a power of two)
+	  * @return pointer to the allocated memory
+	  */
+	void* allocate(const size_t size, const size_t alignment);
+
+	/** Return the number of bytes which have been allocated
+	  * from the arena.
+	  *
+	  * @return number of bytes allocated
+	  */
+	size_t getAllocatedSize() const;
+
+	/** Return the number of blocks which have been allocated
+	  * from the system.
+	  *
+	  * @return number of blocks
+	  */
+	size_t getBlockCount() const;
+
+private:
+
+	memoryArena(const memoryArena&);
+	memoryArena& operator=(const memoryArena&);
+
+	byte_t* allocateBlock(const size_t size);
+
+
+	const size_t m_blockSize;
+
+	std::vector <byte_t*> m_blocks;
+
+	byte_t* m_current;
+	byte_t* m_end;
+
+	size_t m_allocatedSize;
+};
+
+
+/** Standard allocator which allocates memory from a memoryArena.
+  * Each allocator holds a reference to the arena, so that the arena
+  * lives as long as the objects allocated with it.
+  */
+template <typename T>
+class arenaAllocator {
+
+public:
+
+	typedef T value_type;
+
+	explicit arenaAllocator(const shared_ptr <memoryArena>& arena)
+		: m_arena(arena) {
+
+	}
+
+	template <typename U>
+	arenaAllocator(const arenaAllocator <U>& other)
+		: m_arena(other.getArena()) {
+
+	}
+
+	T* allocate(const size_t n) {
+
+		return static_cast <T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* /* p */, const size_t /* n */) {
+
+		// Memory is released along with the arena
+	}
+
+	const shared_ptr <memoryArena>& getArena() const {
+
+		return m_arena;
+	}
+
+	template <typename U>
+	bool operator==(const arenaAllocator <U>& other) const {
+
+		return m_arena == other.getArena();
+	}
+
+	template <typename U>
+	bool operator!=(const arenaAllocator <U>& other) const {
+
+		return m_arena != other.getArena();
+	}
+
+private:
+
+	shared_ptr <memoryArena> m_arena;
+};
+
+
+/** Deleter for objects constructed in memory allocated from an arena:
+  * it only calls the destructor.
+  */
+template <typename T>
+struct arenaDeleter {
+
+	void operator()(T* p) const {
+
+		p->~T();
+	}
+};
+
+
+/** Create an object in the specified arena, or on the heap
+  * if no arena is specified.
+  *
+  * @param arena arena in which to allocate the object (may be NULL)
+  * @param args arguments to pass to the constructor of the object
+  * @return a new object
+  */
+template <typename T, typename... Args>
+shared_ptr <T> makeShared(const shared_ptr <memoryArena>& arena, Args&&... args) {
+
+	if (!arena) {
+		return make_shared <T>(std::forward <Args>(args)...);
+	}
+
+	return std::allocate_shared <T>(arenaAllocator <T>(arena), std::forward <Args>(args)...);
+}
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_UTILITY_MEMORYARENA_HPP_INCLUDED
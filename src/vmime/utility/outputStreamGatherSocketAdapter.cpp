@@ -0,0 +1,113 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/utility/outputStreamGatherSocketAdapter.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/net/socket.hpp"
+
+#include <cstring>
+
+
+namespace vmime {
+namespace utility {
+
+
+// Writes of at least this size are never copied into the buffer
+static const size_t LARGE_WRITE_THRESHOLD = 4096;
+
+// Size of the buffer for small writes
+static const size_t BUFFER_SIZE = 65536;
+
+
+outputStreamGatherSocketAdapter::outputStreamGatherSocketAdapter(net::socket& sok)
+	: m_socket(sok),
+	  m_buffer(BUFFER_SIZE),
+	  m_bufferSize(0) {
+
+}
+
+
+void outputStreamGatherSocketAdapter::writeImpl(const byte_t* const data, const size_t count) {
+
+	if (count < LARGE_WRITE_THRESHOLD && m_bufferSize + count <= BUFFER_SIZE) {
+
+		std::memcpy(&m_buffer[m_bufferSize], data, count);
+		m_bufferSize += count;
+
+		return;
+	}
+
+	// Send pending data and the new data in a single call
+	net::socket::block blocks[2];
+	size_t blockCount = 0;
+
+	if (m_bufferSize != 0) {
+
+		blocks[blockCount].data = &m_buffer[0];
+		blocks[blockCount].count = m_bufferSize;
+
+		++blockCount;
+	}
+
+	blocks[blockCount].data = data;
+	blocks[blockCount].count = count;
+
+	++blockCount;
+
+	m_socket.sendRawBlocks(blocks, blockCount);
+
+	m_bufferSize = 0;
+}
+
+
+void outputStreamGatherSocketAdapter::flush() {
+
+	if (m_bufferSize != 0) {
+
+		m_socket.sendRaw(&m_buffer[0], m_bufferSize);
+		m_bufferSize = 0;
+	}
+}
+
+
+size_t outputStreamGatherSocketAdapter::getBlockSize() {
+
+	return BUFFER_SIZE;
+}
+
+
+size_t outputStreamGatherSocketAdapter::getPendingSize() const {
+
+	return m_bufferSize;
+}
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
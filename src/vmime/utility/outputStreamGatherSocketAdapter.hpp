@@ -0,0 +1,97 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_UTILITY_OUTPUTSTREAMGATHERSOCKETADAPTER_HPP_INCLUDED
+#define VMIME_UTILITY_OUTPUTSTREAMGATHERSOCKETADAPTER_HPP_INCLUDED
+
+
+#include "vmime/utility/outputStream.hpp"
+
+#include <vector>
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+namespace vmime {
+namespace net {
+	class socket;  // forward reference
+} // net
+} // vmime
+
+
+namespace vmime {
+namespace utility {
+
+
+/** An output stream that is connected to a socket, and which gathers
+  * writes to reduce the number of system calls.
+  *
+  * Small writes (such as the ones produced when generating header
+  * fields) are copied into an internal buffer. Large writes are not
+  * copied: they are sent along with the pending buffered data in a
+  * single call to net::socket::sendRawBlocks().
+  *
+  * Buffered data is only sent when the buffer is full, or when
+  * flush() is called; it is NOT sent when the adapter is destroyed.
+  */
+class VMIME_EXPORT outputStreamGatherSocketAdapter : public outputStream {
+
+public:
+
+	outputStreamGatherSocketAdapter(net::socket& sok);
+
+	void flush();
+
+	size_t getBlockSize();
+
+	/** Return the number of bytes which have been written to this
+	  * stream but not sent yet to the socket.
+	  *
+	  * @return number of buffered bytes
+	  */
+	size_t getPendingSize() const;
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count);
+
+private:
+
+	outputStreamGatherSocketAdapter(const outputStreamGatherSocketAdapter&);
+
+	net::socket& m_socket;
+
+	std::vector <byte_t> m_buffer;  // on the heap, as adapters are often on the stack
+	size_t m_bufferSize;
+};
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+
+#endif // VMIME_UTILITY_OUTPUTSTREAMGATHERSOCKETADAPTER_HPP_INCLUDED
@@ -22,15 +22,133 @@
 //
 
 #include "vmime/utility/parserInputStreamAdapter.hpp"
+#include "vmime/utility/inputStreamStringAdapter.hpp"
+#include "vmime/utility/scanUtils.hpp"
+#include "vmime/utility/stringUtils.hpp"
 
 
 namespace vmime {
 namespace utility {
 
 
+namespace {
+
+
+/** A view on a stream shared with other views, each view having its
+  * own current position. Accesses to the shared stream are serialized,
+  * so that views can be read from several threads at the same time.
+  */
+class sharedStreamView : public seekableInputStream {
+
+public:
+
+	sharedStreamView(
+		const shared_ptr <seekableInputStream>& stream,
+		const shared_ptr <std::mutex>& lock
+	)
+		: m_stream(stream),
+		  m_lock(lock),
+		  m_position(0) {
+
+	}
+
+	const shared_ptr <seekableInputStream>& getStream() const {
+
+		return m_stream;
+	}
+
+	const shared_ptr <std::mutex>& getLock() const {
+
+		return m_lock;
+	}
+
+	bool eof() const {
+
+		std::lock_guard <std::mutex> lock(*m_lock);
+
+		m_stream->seek(m_position);
+		return m_stream->eof();
+	}
+
+	void reset() {
+
+		m_position = 0;
+	}
+
+	size_t read(byte_t* const data, const size_t count) {
+
+		std::lock_guard <std::mutex> lock(*m_lock);
+
+		m_stream->seek(m_position);
+
+		const size_t readBytes = m_stream->read(data, count);
+		m_position += readBytes;
+
+		return readBytes;
+	}
+
+	size_t skip(const size_t count) {
+
+		std::lock_guard <std::mutex> lock(*m_lock);
+
+		m_stream->seek(m_position);
+
+		const size_t skippedBytes = m_stream->skip(count);
+		m_position += skippedBytes;
+
+		return skippedBytes;
+	}
+
+	size_t getPosition() const {
+
+		return m_position;
+	}
+
+	void seek(const size_t pos) {
+
+		m_position = pos;
+	}
+
+private:
+
+	shared_ptr <seekableInputStream> m_stream;
+	shared_ptr <std::mutex> m_lock;
+	size_t m_position;
+};
+
+
+} // namespace
+
+
 parserInputStreamAdapter::parserInputStreamAdapter(const shared_ptr <seekableInputStream>& stream)
-	: m_stream(stream) {
+	: m_stream(stream),
+	  m_buffer(NULL),
+	  m_bufferLength(0) {
+
+	// Do not stack adapters: read directly from the underlying stream
+	shared_ptr <parserInputStreamAdapter> parser = dynamicCast <parserInputStreamAdapter>(stream);
+
+	if (parser) {
+		m_stream = parser->m_stream;
+		m_streamLock = parser->m_streamLock;
+	}
+
+	// If the stream reads from memory, access the data directly
+	shared_ptr <inputStreamStringAdapter> stringStream =
+		dynamicCast <inputStreamStringAdapter>(m_stream);
 
+	if (stringStream) {
+
+		m_buffer = stringUtils::bytesFromString(*stringStream->getBuffer())
+			+ stringStream->getBufferOffset();
+		m_bufferLength = stringStream->getBufferEnd() - stringStream->getBufferOffset();
+
+	// Otherwise, create the lock shared by forked adapters (views already
+	// share the lock of the stream they read from)
+	} else if (!m_streamLock && !dynamicCast <sharedStreamView>(m_stream)) {
+
+		m_streamLock = make_shared <std::mutex>();
+	}
 }
 
 
@@ -58,8 +176,49 @@ shared_ptr <seekableInputStream> parserInputStreamAdapter::getUnderlyingStream()
 }
 
 
+shared_ptr <parserInputStreamAdapter> parserInputStreamAdapter::fork() const {
+
+	// Data is in memory: a new stream on the same buffer is enough
+	shared_ptr <inputStreamStringAdapter> stringStream =
+		dynamicCast <inputStreamStringAdapter>(m_stream);
+
+	if (stringStream) {
+
+		return make_shared <parserInputStreamAdapter>(
+			make_shared <inputStreamStringAdapter>(
+				stringStream->getBuffer(),
+				stringStream->getBufferOffset(),
+				stringStream->getBufferEnd()
+			)
+		);
+	}
+
+	// Do not stack views: share the stream of this view
+	shared_ptr <sharedStreamView> view = dynamicCast <sharedStreamView>(m_stream);
+
+	if (view) {
+
+		return make_shared <parserInputStreamAdapter>(
+			make_shared <sharedStreamView>(view->getStream(), view->getLock())
+		);
+	}
+
+	return make_shared <parserInputStreamAdapter>(
+		make_shared <sharedStreamView>(m_stream, m_streamLock)
+	);
+}
+
+
 const string parserInputStreamAdapter::extract(const size_t begin, const size_t end) const {
 
+	if (m_buffer) {
+
+		const size_t first = std::min(begin, m_bufferLength);
+		const size_t last = std::min(end, m_bufferLength);
+
+		return string(m_buffer + first, m_buffer + last);
+	}
+
 	const size_t initialPos = m_stream->getPosition();
 
 	byte_t *buffer = NULL;
@@ -90,6 +249,38 @@ const string parserInputStreamAdapter::extract(const size_t begin, const size_t
 }
 
 
+size_t parserInputStreamAdapter::skipAnyOf(
+	const byte_t* chars,
+	const size_t count,
+	const size_t endPosition
+) {
+
+	const size_t initialPos = getPosition();
+	size_t pos = initialPos;
+
+	if (m_buffer) {
+
+		const size_t end = std::min(endPosition, m_bufferLength);
+
+		if (pos < end) {
+
+			const size_t notOf = scanUtils::findFirstNotOf(m_buffer + pos, end - pos, chars, count);
+			pos = (notOf == npos ? end : pos + notOf);
+		}
+
+	} else if (count != 0) {
+
+		while (!m_stream->eof() && pos < endPosition && ::memchr(chars, getByte(), count)) {
+			++pos;
+		}
+	}
+
+	m_stream->seek(pos);
+
+	return pos - initialPos;
+}
+
+
 size_t parserInputStreamAdapter::findNext(
 	const string& token,
 	const size_t startPosition
@@ -97,8 +288,27 @@ size_t parserInputStreamAdapter::findNext(
 
 	static const unsigned int BUFFER_SIZE = 4096;
 
+	if (token.empty()) {
+		return npos;
+	}
+
+	// If the data is in memory, search it directly
+	if (m_buffer) {
+
+		if (startPosition >= m_bufferLength) {
+			return npos;
+		}
+
+		const size_t pos = scanUtils::find(
+			m_buffer + startPosition, m_bufferLength - startPosition,
+			stringUtils::bytesFromString(token), token.length()
+		);
+
+		return pos == npos ? npos : startPosition + pos;
+	}
+
 	// Token must not be longer than BUFFER_SIZE/2
-	if (token.empty() || token.length() > BUFFER_SIZE / 2) {
+	if (token.length() > BUFFER_SIZE / 2) {
 		return npos;
 	}
 
@@ -123,19 +333,16 @@ size_t parserInputStreamAdapter::findNext(
 		while (findBufferLen != 0) {
 
 			// Find token
-			for (byte_t *begin = findBuffer, *end = findBuffer + findBufferLen - token.length() ;
-			     begin <= end ; ++begin) {
+			const size_t pos = scanUtils::find(
+				findBuffer, findBufferLen,
+				stringUtils::bytesFromString(token), token.length()
+			);
 
-				if (begin[0] == token[0] &&
-				    (token.length() == 1 ||
-				     memcmp(static_cast <const void *>(&begin[1]),
-				            static_cast <const void *>(token.data() + 1),
-				            token.length() - 1) == 0)) {
+			if (pos != npos) {
 
-					seek(initialPos);
+				seek(initialPos);
 
-					return startPosition + findBufferOffset + (begin - findBuffer);
-				}
+				return startPosition + findBufferOffset + pos;
 			}
 
 			// Rotate buffer
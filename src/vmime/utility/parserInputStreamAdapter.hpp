@@ -27,7 +27,9 @@
 
 #include "vmime/utility/seekableInputStream.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <mutex>
 
 
 namespace vmime {
@@ -46,6 +48,16 @@ public:
 
 	shared_ptr <seekableInputStream> getUnderlyingStream();
 
+	/** Create a new adapter which reads the same data as this one, but
+	  * has its own current position. Adapters created by this function
+	  * (and by the adapters it returns) can be used from several threads
+	  * at the same time; this adapter must not be used concurrently with
+	  * them, though.
+	  *
+	  * @return new adapter, positioned at the start of the data
+	  */
+	shared_ptr <parserInputStreamAdapter> fork() const;
+
 	bool eof() const;
 	void reset();
 	size_t read(byte_t* const data, const size_t count);
@@ -74,6 +86,10 @@ public:
 
 		const size_t initialPos = m_stream->getPosition();
 
+		if (m_buffer) {
+			return initialPos < m_bufferLength ? m_buffer[initialPos] : static_cast <byte_t>(0);
+		}
+
 		try {
 
 			byte_t buffer[1];
@@ -115,6 +131,11 @@ public:
 
 		const size_t initialPos = m_stream->getPosition();
 
+		if (m_buffer) {
+			return initialPos + length <= m_bufferLength &&
+			       ::memcmp(bytes, m_buffer + initialPos, length) == 0;
+		}
+
 		try {
 
 			byte_t buffer[32];
@@ -148,8 +169,19 @@ public:
 		const size_t initialPos = getPosition();
 		size_t pos = initialPos;
 
-		while (!m_stream->eof() && pos < endPosition && pred(getByte())) {
-			++pos;
+		if (m_buffer) {
+
+			const size_t end = std::min(endPosition, m_bufferLength);
+
+			while (pos < end && pred(m_buffer[pos])) {
+				++pos;
+			}
+
+		} else {
+
+			while (!m_stream->eof() && pos < endPosition && pred(getByte())) {
+				++pos;
+			}
 		}
 
 		m_stream->seek(pos);
@@ -157,11 +189,38 @@ public:
 		return pos - initialPos;
 	}
 
+	/** Skips bytes which belong to the specified set from the current
+	  * position. The current position is updated to the next following
+	  * byte which does not belong to the set.
+	  *
+	  * @param chars bytes to skip
+	  * @param count number of bytes in the set
+	  * @param endPosition stop at this position (or at end of the stream,
+	  * whichever comes first)
+	  * @return number of bytes skipped
+	  */
+	size_t skipAnyOf(const byte_t* chars, const size_t count, const size_t endPosition);
+
+	/** Finds the next occurrence of a token, from the specified position.
+	  * The current position is not updated.
+	  *
+	  * @param token token to search for
+	  * @param startPosition position from which to start searching
+	  * @return position of the token, or npos if not found
+	  */
 	size_t findNext(const string& token, const size_t startPosition = 0);
 
 private:
 
 	mutable shared_ptr <seekableInputStream> m_stream;
+
+	// Serializes accesses to the underlying stream from forked adapters
+	// (NULL if the stream reads from memory)
+	shared_ptr <std::mutex> m_streamLock;
+
+	// Direct access to the data, if the stream reads from memory
+	const byte_t* m_buffer;
+	size_t m_bufferLength;
 };
 
 
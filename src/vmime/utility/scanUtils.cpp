@@ -0,0 +1,699 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/utility/scanUtils.hpp"
+
+#include <cstring>
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define VMIME_SCAN_HAVE_SSE2 1
+#	include <emmintrin.h>
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	endif
+#endif
+
+// AVX2 functions are compiled with a "target" attribute, so that they
+// can be selected at runtime without requiring a specific -march flag
+#if defined(VMIME_SCAN_HAVE_SSE2) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#	define VMIME_SCAN_HAVE_AVX2 1
+#	include <immintrin.h>
+#	define VMIME_SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+namespace vmime {
+namespace utility {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+// Portable implementation
+
+size_t findByteScalar(const byte_t* data, const size_t length, const byte_t c) {
+
+	// memchr() requires a valid pointer, even for an empty range
+	if (length == 0) {
+		return npos;
+	}
+
+	const void* p = ::memchr(data, c, length);
+
+	return p ? static_cast <size_t>(static_cast <const byte_t*>(p) - data) : npos;
+}
+
+
+size_t findFirstOfScalar(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	for (size_t i = 0 ; i < length ; ++i) {
+
+		for (size_t j = 0 ; j < count ; ++j) {
+
+			if (data[i] == chars[j]) {
+				return i;
+			}
+		}
+	}
+
+	return npos;
+}
+
+
+size_t findFirstNotOfScalar(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	for (size_t i = 0 ; i < length ; ++i) {
+
+		size_t j = 0;
+
+		while (j < count && data[i] != chars[j]) {
+			++j;
+		}
+
+		if (j == count) {
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+
+size_t findScalar(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* token,
+	const size_t tokenLength
+) {
+
+	size_t pos = 0;
+
+	while (pos + tokenLength <= length) {
+
+		const size_t first = findByteScalar(data + pos, length - tokenLength + 1 - pos, token[0]);
+
+		if (first == npos) {
+			break;
+		}
+
+		pos += first;
+
+		if (::memcmp(data + pos + 1, token + 1, tokenLength - 1) == 0) {
+			return pos;
+		}
+
+		++pos;
+	}
+
+	return npos;
+}
+
+
+size_t findFirstNonASCIIScalar(const byte_t* data, const size_t length) {
+
+	for (size_t i = 0 ; i < length ; ++i) {
+
+		if (data[i] >= 0x80) {
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+
+size_t countNonASCIIScalar(const byte_t* data, const size_t length) {
+
+	size_t count = 0;
+
+	for (size_t i = 0 ; i < length ; ++i) {
+		count += (data[i] >> 7);
+	}
+
+	return count;
+}
+
+
+#ifdef VMIME_SCAN_HAVE_SSE2
+
+inline size_t firstBitSet(const unsigned int mask) {
+
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return static_cast <size_t>(__builtin_ctz(mask));
+#endif
+}
+
+
+inline size_t bitCount(const unsigned int mask) {
+
+#if defined(_MSC_VER)
+	return __popcnt(mask);
+#else
+	return static_cast <size_t>(__builtin_popcount(mask));
+#endif
+}
+
+
+// SSE2 implementation (16 bytes at a time)
+
+size_t findByteSSE2(const byte_t* data, const size_t length, const byte_t c) {
+
+	const __m128i needle = _mm_set1_epi8(static_cast <char>(c));
+
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= length ; pos += 16) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+		const unsigned int mask =
+			static_cast <unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findByteScalar(data + pos, length - pos, c);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+size_t findFirstOfSSE2(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= length ; pos += 16) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+		__m128i match = _mm_setzero_si128();
+
+		for (size_t j = 0 ; j < count ; ++j) {
+			match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast <char>(chars[j]))));
+		}
+
+		const unsigned int mask = static_cast <unsigned int>(_mm_movemask_epi8(match));
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findFirstOfScalar(data + pos, length - pos, chars, count);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+size_t findFirstNotOfSSE2(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= length ; pos += 16) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+		__m128i match = _mm_setzero_si128();
+
+		for (size_t j = 0 ; j < count ; ++j) {
+			match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast <char>(chars[j]))));
+		}
+
+		const unsigned int mask = ~static_cast <unsigned int>(_mm_movemask_epi8(match)) & 0xffff;
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findFirstNotOfScalar(data + pos, length - pos, chars, count);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+// Compare the first and the last bytes of the token at 16 positions at
+// a time, then check the candidate positions with memcmp()
+size_t findSSE2(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* token,
+	const size_t tokenLength
+) {
+
+	if (tokenLength > length) {
+		return npos;
+	}
+
+	const __m128i first = _mm_set1_epi8(static_cast <char>(token[0]));
+	const __m128i last = _mm_set1_epi8(static_cast <char>(token[tokenLength - 1]));
+
+	const size_t lastStart = length - tokenLength;
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= lastStart + 1 ; pos += 16) {
+
+		const __m128i blockFirst =
+			_mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+		const __m128i blockLast =
+			_mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos + tokenLength - 1));
+
+		unsigned int mask = static_cast <unsigned int>(_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))
+		));
+
+		while (mask != 0) {
+
+			const size_t candidate = pos + firstBitSet(mask);
+
+			if (::memcmp(data + candidate + 1, token + 1, tokenLength - 1) == 0) {
+				return candidate;
+			}
+
+			mask &= mask - 1;
+		}
+	}
+
+	const size_t rem = findScalar(data + pos, length - pos, token, tokenLength);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+// The most significant bit of each byte is directly given by movemask
+size_t findFirstNonASCIISSE2(const byte_t* data, const size_t length) {
+
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= length ; pos += 16) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+		const unsigned int mask = static_cast <unsigned int>(_mm_movemask_epi8(block));
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findFirstNonASCIIScalar(data + pos, length - pos);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+size_t countNonASCIISSE2(const byte_t* data, const size_t length) {
+
+	size_t count = 0;
+	size_t pos = 0;
+
+	for ( ; pos + 16 <= length ; pos += 16) {
+
+		const __m128i block = _mm_loadu_si128(reinterpret_cast <const __m128i*>(data + pos));
+		count += bitCount(static_cast <unsigned int>(_mm_movemask_epi8(block)));
+	}
+
+	return count + countNonASCIIScalar(data + pos, length - pos);
+}
+
+#endif // VMIME_SCAN_HAVE_SSE2
+
+
+#ifdef VMIME_SCAN_HAVE_AVX2
+
+// AVX2 implementation (32 bytes at a time)
+
+VMIME_SCAN_TARGET_AVX2
+size_t findByteAVX2(const byte_t* data, const size_t length, const byte_t c) {
+
+	const __m256i needle = _mm256_set1_epi8(static_cast <char>(c));
+
+	size_t pos = 0;
+
+	for ( ; pos + 32 <= length ; pos += 32) {
+
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast <const __m256i*>(data + pos));
+		const unsigned int mask =
+			static_cast <unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findByteSSE2(data + pos, length - pos, c);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+VMIME_SCAN_TARGET_AVX2
+size_t findFirstOfAVX2(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	size_t pos = 0;
+
+	for ( ; pos + 32 <= length ; pos += 32) {
+
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast <const __m256i*>(data + pos));
+		__m256i match = _mm256_setzero_si256();
+
+		for (size_t j = 0 ; j < count ; ++j) {
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(static_cast <char>(chars[j]))));
+		}
+
+		const unsigned int mask = static_cast <unsigned int>(_mm256_movemask_epi8(match));
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findFirstOfSSE2(data + pos, length - pos, chars, count);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+VMIME_SCAN_TARGET_AVX2
+size_t findFirstNotOfAVX2(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	size_t pos = 0;
+
+	for ( ; pos + 32 <= length ; pos += 32) {
+
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast <const __m256i*>(data + pos));
+		__m256i match = _mm256_setzero_si256();
+
+		for (size_t j = 0 ; j < count ; ++j) {
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(static_cast <char>(chars[j]))));
+		}
+
+		const unsigned int mask = ~static_cast <unsigned int>(_mm256_movemask_epi8(match));
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findFirstNotOfSSE2(data + pos, length - pos, chars, count);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+VMIME_SCAN_TARGET_AVX2
+size_t findAVX2(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* token,
+	const size_t tokenLength
+) {
+
+	if (tokenLength > length) {
+		return npos;
+	}
+
+	const __m256i first = _mm256_set1_epi8(static_cast <char>(token[0]));
+	const __m256i last = _mm256_set1_epi8(static_cast <char>(token[tokenLength - 1]));
+
+	const size_t lastStart = length - tokenLength;
+	size_t pos = 0;
+
+	for ( ; pos + 32 <= lastStart + 1 ; pos += 32) {
+
+		const __m256i blockFirst =
+			_mm256_loadu_si256(reinterpret_cast <const __m256i*>(data + pos));
+		const __m256i blockLast =
+			_mm256_loadu_si256(reinterpret_cast <const __m256i*>(data + pos + tokenLength - 1));
+
+		unsigned int mask = static_cast <unsigned int>(_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))
+		));
+
+		while (mask != 0) {
+
+			const size_t candidate = pos + firstBitSet(mask);
+
+			if (::memcmp(data + candidate + 1, token + 1, tokenLength - 1) == 0) {
+				return candidate;
+			}
+
+			mask &= mask - 1;
+		}
+	}
+
+	const size_t rem = findSSE2(data + pos, length - pos, token, tokenLength);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+
+VMIME_SCAN_TARGET_AVX2
+size_t findFirstNonASCIIAVX2(const byte_t* data, const size_t length) {
+
+	size_t pos = 0;
+
+	for ( ; pos + 32 <= length ; pos += 32) {
+
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast <const __m256i*>(data + pos));
+		const unsigned int mask = static_cast <unsigned int>(_mm256_movemask_epi8(block));
+
+		if (mask != 0) {
+			return pos + firstBitSet(mask);
+		}
+	}
+
+	const size_t rem = findFirstNonASCIISSE2(data + pos, length - pos);
+
+	return rem == npos ? npos : pos + rem;
+}
+
+
+VMIME_SCAN_TARGET_AVX2
+size_t countNonASCIIAVX2(const byte_t* data, const size_t length) {
+
+	size_t count = 0;
+	size_t pos = 0;
+
+	for ( ; pos + 32 <= length ; pos += 32) {
+
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast <const __m256i*>(data + pos));
+		count += bitCount(static_cast <unsigned int>(_mm256_movemask_epi8(block)));
+	}
+
+	return count + countNonASCIISSE2(data + pos, length - pos);
+}
+
+#endif // VMIME_SCAN_HAVE_AVX2
+
+
+// Runtime selection of the implementation
+
+struct scanFunctions {
+
+	size_t (*findByte)(const byte_t*, const size_t, const byte_t);
+	size_t (*findFirstOf)(const byte_t*, const size_t, const byte_t*, const size_t);
+	size_t (*findFirstNotOf)(const byte_t*, const size_t, const byte_t*, const size_t);
+	size_t (*find)(const byte_t*, const size_t, const byte_t*, const size_t);
+	size_t (*findFirstNonASCII)(const byte_t*, const size_t);
+	size_t (*countNonASCII)(const byte_t*, const size_t);
+};
+
+
+scanFunctions selectScanFunctions() {
+
+	scanFunctions funcs;
+
+#ifdef VMIME_SCAN_HAVE_AVX2
+
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2")) {
+
+		funcs.findByte = &findByteAVX2;
+		funcs.findFirstOf = &findFirstOfAVX2;
+		funcs.findFirstNotOf = &findFirstNotOfAVX2;
+		funcs.find = &findAVX2;
+		funcs.findFirstNonASCII = &findFirstNonASCIIAVX2;
+		funcs.countNonASCII = &countNonASCIIAVX2;
+
+		return funcs;
+	}
+
+#endif // VMIME_SCAN_HAVE_AVX2
+
+#ifdef VMIME_SCAN_HAVE_SSE2
+
+	funcs.findByte = &findByteSSE2;
+	funcs.findFirstOf = &findFirstOfSSE2;
+	funcs.findFirstNotOf = &findFirstNotOfSSE2;
+	funcs.find = &findSSE2;
+	funcs.findFirstNonASCII = &findFirstNonASCIISSE2;
+	funcs.countNonASCII = &countNonASCIISSE2;
+
+#else
+
+	funcs.findByte = &findByteScalar;
+	funcs.findFirstOf = &findFirstOfScalar;
+	funcs.findFirstNotOf = &findFirstNotOfScalar;
+	funcs.find = &findScalar;
+	funcs.findFirstNonASCII = &findFirstNonASCIIScalar;
+	funcs.countNonASCII = &countNonASCIIScalar;
+
+#endif // VMIME_SCAN_HAVE_SSE2
+
+	return funcs;
+}
+
+
+const scanFunctions& getScanFunctions() {
+
+	static const scanFunctions funcs = selectScanFunctions();
+	return funcs;
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+// static
+size_t scanUtils::findByte(const byte_t* data, const size_t length, const byte_t c) {
+
+	return getScanFunctions().findByte(data, length, c);
+}
+
+
+// static
+size_t scanUtils::findFirstOf(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	if (count == 0) {
+		return npos;
+	} else if (count == 1) {
+		return getScanFunctions().findByte(data, length, chars[0]);
+	}
+
+	return getScanFunctions().findFirstOf(data, length, chars, count);
+}
+
+
+// static
+size_t scanUtils::findFirstNotOf(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* chars,
+	const size_t count
+) {
+
+	// Runs of bytes to skip are often short (or empty): check the
+	// first byte before calling the vectorized implementation
+	if (length == 0) {
+		return npos;
+	} else if (count == 0 || ::memchr(chars, data[0], count) == NULL) {
+		return 0;
+	}
+
+	const size_t pos = getScanFunctions().findFirstNotOf(data + 1, length - 1, chars, count);
+
+	return pos == npos ? npos : pos + 1;
+}
+
+
+// static
+size_t scanUtils::find(
+	const byte_t* data,
+	const size_t length,
+	const byte_t* token,
+	const size_t tokenLength
+) {
+
+	if (tokenLength == 0 || tokenLength > length) {
+		return npos;
+	} else if (tokenLength == 1) {
+		return getScanFunctions().findByte(data, length, token[0]);
+	}
+
+	return getScanFunctions().find(data, length, token, tokenLength);
+}
+
+
+// static
+size_t scanUtils::findFirstNonASCII(const byte_t* data, const size_t length) {
+
+	return getScanFunctions().findFirstNonASCII(data, length);
+}
+
+
+// static
+size_t scanUtils::countNonASCII(const byte_t* data, const size_t length) {
+
+	return getScanFunctions().countNonASCII(data, length);
+}
+
+
+} // utility
+} // vmime
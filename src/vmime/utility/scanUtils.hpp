@@ -0,0 +1,130 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_UTILITY_SCANUTILS_HPP_INCLUDED
+#define VMIME_UTILITY_SCANUTILS_HPP_INCLUDED
+
+
+#include "vmime/types.hpp"
+#include "vmime/base.hpp"
+
+
+namespace vmime {
+namespace utility {
+
+
+/** Fast scanning functions for byte buffers, used by the parser.
+  *
+  * On x86 processors, these functions use SSE2 or AVX2 instructions
+  * (selected at runtime, depending on what the processor supports);
+  * a portable implementation is used on other platforms.
+  */
+class VMIME_EXPORT scanUtils {
+
+public:
+
+	/** Find the first occurrence of a byte in a buffer.
+	  *
+	  * @param data buffer to search
+	  * @param length number of bytes in the buffer
+	  * @param c byte to search for
+	  * @return position of the byte in the buffer, or npos if not found
+	  */
+	static size_t findByte(const byte_t* data, const size_t length, const byte_t c);
+
+	/** Find the first occurrence of any of the specified bytes in a buffer.
+	  *
+	  * @param data buffer to search
+	  * @param length number of bytes in the buffer
+	  * @param chars bytes to search for
+	  * @param count number of bytes to search for
+	  * @return position of the first matching byte in the buffer,
+	  * or npos if not found
+	  */
+	static size_t findFirstOf(
+		const byte_t* data,
+		const size_t length,
+		const byte_t* chars,
+		const size_t count
+	);
+
+	/** Find the first byte which is not one of the specified bytes in
+	  * a buffer. This is used to skip a run of bytes of a given class
+	  * (eg. white spaces).
+	  *
+	  * @param data buffer to search
+	  * @param length number of bytes in the buffer
+	  * @param chars bytes to skip
+	  * @param count number of bytes to skip
+	  * @return position of the first byte which is not one of the
+	  * specified bytes, or npos if all the bytes in the buffer are
+	  */
+	static size_t findFirstNotOf(
+		const byte_t* data,
+		const size_t length,
+		const byte_t* chars,
+		const size_t count
+	);
+
+	/** Find the first occurrence of a sequence of bytes in a buffer.
+	  *
+	  * @param data buffer to search
+	  * @param length number of bytes in the buffer
+	  * @param token sequence of bytes to search for
+	  * @param tokenLength length of the sequence
+	  * @return position of the sequence in the buffer, or npos if not
+	  * found (or if the sequence is empty)
+	  */
+	static size_t find(
+		const byte_t* data,
+		const size_t length,
+		const byte_t* token,
+		const size_t tokenLength
+	);
+
+	/** Find the first byte which is not a 7-bit ASCII character
+	  * (ie. which has its most significant bit set) in a buffer.
+	  *
+	  * @param data buffer to search
+	  * @param length number of bytes in the buffer
+	  * @return position of the first non-ASCII byte in the buffer,
+	  * or npos if the buffer only contains ASCII characters
+	  */
+	static size_t findFirstNonASCII(const byte_t* data, const size_t length);
+
+	/** Count the bytes which are not 7-bit ASCII characters in a buffer.
+	  *
+	  * @param data buffer to scan
+	  * @param length number of bytes in the buffer
+	  * @return number of bytes which have their most significant bit set
+	  */
+	static size_t countNonASCII(const byte_t* data, const size_t length);
+};
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_UTILITY_SCANUTILS_HPP_INCLUDED
@@ -0,0 +1,120 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/utility/textStatistics.hpp"
+#include "vmime/utility/scanUtils.hpp"
+
+#include <algorithm>
+
+
+namespace vmime {
+namespace utility {
+
+
+textStatistics::textStatistics() {
+
+	reset();
+}
+
+
+void textStatistics::reset() {
+
+	m_length = 0;
+	m_nonASCIICount = 0;
+	m_maxLineLength = 0;
+	m_lineLength = 0;
+	m_atLineStart = false;
+	m_dotAtLineStart = false;
+}
+
+
+size_t textStatistics::getLength() const {
+
+	return m_length;
+}
+
+
+size_t textStatistics::getNonASCIICount() const {
+
+	return m_nonASCIICount;
+}
+
+
+size_t textStatistics::getMaxLineLength() const {
+
+	return std::max(m_maxLineLength, m_lineLength);
+}
+
+
+bool textStatistics::hasDotAtLineStart() const {
+
+	return m_dotAtLineStart;
+}
+
+
+void textStatistics::writeImpl(const byte_t* const data, const size_t count) {
+
+	m_length += count;
+	m_nonASCIICount += scanUtils::countNonASCII(data, count);
+
+	size_t pos = 0;
+
+	while (pos < count) {
+
+		if (m_atLineStart) {
+
+			m_atLineStart = false;
+
+			if (data[pos] == '.') {
+				m_dotAtLineStart = true;
+			}
+		}
+
+		const size_t eol = scanUtils::findByte(data + pos, count - pos, '\n');
+
+		if (eol == npos) {
+
+			m_lineLength += count - pos;
+			break;
+		}
+
+		m_lineLength += eol;
+		m_maxLineLength = std::max(m_maxLineLength, m_lineLength);
+
+		m_lineLength = 0;
+		m_atLineStart = true;
+
+		pos += eol + 1;
+	}
+}
+
+
+void textStatistics::flush() {
+
+	// Nothing to do
+}
+
+
+} // utility
+} // vmime
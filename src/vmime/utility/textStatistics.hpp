@@ -0,0 +1,98 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_UTILITY_TEXTSTATISTICS_HPP_INCLUDED
+#define VMIME_UTILITY_TEXTSTATISTICS_HPP_INCLUDED
+
+
+#include "vmime/utility/outputStream.hpp"
+
+
+namespace vmime {
+namespace utility {
+
+
+/** An output stream which computes statistics about the data written
+  * into it (number of non-ASCII bytes, maximum line length), in a single
+  * pass and without keeping the data. This is used to choose a suitable
+  * encoding for a content.
+  */
+class VMIME_EXPORT textStatistics : public outputStream {
+
+public:
+
+	textStatistics();
+
+	/** Reset all counters.
+	  */
+	void reset();
+
+	/** Return the total number of bytes written.
+	  *
+	  * @return number of bytes
+	  */
+	size_t getLength() const;
+
+	/** Return the number of bytes which are not 7-bit ASCII characters.
+	  *
+	  * @return number of non-ASCII bytes
+	  */
+	size_t getNonASCIICount() const;
+
+	/** Return the length of the longest line, not including the
+	  * LF line terminator (a CR before it is counted).
+	  *
+	  * @return maximum line length
+	  */
+	size_t getMaxLineLength() const;
+
+	/** Test whether a line (other than the first one) starts with
+	  * a dot, which may need to be protected when sent over SMTP.
+	  *
+	  * @return true if a line starts with a dot, false otherwise
+	  */
+	bool hasDotAtLineStart() const;
+
+	void flush();
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count);
+
+private:
+
+	size_t m_length;
+	size_t m_nonASCIICount;
+	size_t m_maxLineLength;
+	size_t m_lineLength;
+	bool m_atLineStart;
+	bool m_dotAtLineStart;
+};
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_UTILITY_TEXTSTATISTICS_HPP_INCLUDED
@@ -59,6 +59,7 @@
 #include "streamContentHandler.hpp"
 
 #include "generationContext.hpp"
+#include "encodedContentsCache.hpp"
 #include "parsingContext.hpp"
 
 // Message components
@@ -83,6 +84,7 @@
 #include "utility/outputStream.hpp"
 #include "utility/outputStreamAdapter.hpp"
 #include "utility/outputStreamByteArrayAdapter.hpp"
+#include "utility/outputStreamGatherSocketAdapter.hpp"
 #include "utility/outputStreamSocketAdapter.hpp"
 #include "utility/outputStreamStringAdapter.hpp"
 #include "utility/streamUtils.hpp"
@@ -90,6 +92,10 @@
 // Message builder/parser
 #include "messageBuilder.hpp"
 #include "messageParser.hpp"
+#include "batchParser.hpp"
+#include "mimeEventHandler.hpp"
+#include "mimeEventParser.hpp"
+#include "mimeTreeBuilder.hpp"
 
 #include "fileAttachment.hpp"
 #include "defaultAttachment.hpp"
@@ -113,6 +119,7 @@
 #include "utility/datetimeUtils.hpp"
 #include "utility/filteredStream.hpp"
 #include "charsetConverter.hpp"
+#include "charsetConverterPool.hpp"
 
 // Security
 #include "security/authenticator.hpp"
@@ -143,6 +150,11 @@
 	#include "net/message.hpp"
 #endif // VMIME_HAVE_MESSAGING_FEATURES
 
+// Net/compression
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_COMPRESSION_SUPPORT
+	#include "net/deflateSocket.hpp"
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_COMPRESSION_SUPPORT
+
 // Net/TLS
 #if VMIME_HAVE_TLS_SUPPORT
 	#include "security/cert/certificate.hpp"
@@ -149,7 +149,7 @@ shared_ptr <word> word::parseNext(
 					unencoded = whiteSpaces + unencoded;
 				}
 
-				shared_ptr <word> w = make_shared <word>(unencoded, defaultCharset);
+				shared_ptr <word> w = utility::makeShared <word>(ctx.getMemoryArena(), unencoded, defaultCharset);
 				w->setParsedBounds(position, pos);
 
 				if (newPosition) {
@@ -209,7 +209,7 @@ shared_ptr <word> word::parseNext(
 
 			pos += 2; // ?=
 
-			shared_ptr <word> w = make_shared <word>();
+			shared_ptr <word> w = utility::makeShared <word>(ctx.getMemoryArena());
 			w->parseWithState(ctx, buffer, wordStart, pos, NULL, state);
 
 			if (newPosition) {
@@ -237,7 +237,7 @@ shared_ptr <word> word::parseNext(
 	// Treat unencoded text at the end of the buffer
 	if (!unencoded.empty()) {
 
-		shared_ptr <word> w = make_shared <word>(unencoded, defaultCharset);
+		shared_ptr <word> w = utility::makeShared <word>(ctx.getMemoryArena(), unencoded, defaultCharset);
 		w->setParsedBounds(position, end);
 
 		if (newPosition) {
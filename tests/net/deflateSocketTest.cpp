@@ -0,0 +1,144 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+
+#if VMIME_HAVE_COMPRESSION_SUPPORT
+
+
+#include "vmime/net/deflateSocket.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(deflateSocketTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testRoundTrip)
+		VMIME_TEST(testSmallReceiveBuffer)
+		VMIME_TEST(testSendRawBlocks)
+	VMIME_TEST_LIST_END
+
+
+	// Compress data with a first socket, then decompress it with another one
+	static const vmime::string transfer(const vmime::string& data, const size_t readSize) {
+
+		vmime::shared_ptr <testSocket> clientSok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <testSocket> serverSok = vmime::make_shared <testSocket>();
+
+		vmime::net::deflateSocket client(clientSok);
+		vmime::net::deflateSocket server(serverSok);
+
+		client.send(data);
+
+		vmime::string compressed;
+		clientSok->localReceive(compressed);
+
+		serverSok->localSend(compressed);
+
+		vmime::string result;
+		std::vector <vmime::byte_t> buffer(readSize);
+
+		while (server.waitForRead(0)) {
+
+			const size_t n = server.receiveRaw(&buffer[0], readSize);
+
+			if (n == 0) {
+				break;
+			}
+
+			result.append(buffer.begin(), buffer.begin() + n);
+		}
+
+		return result;
+	}
+
+	void testRoundTrip() {
+
+		vmime::string data;
+
+		for (int i = 0 ; i < 100 ; ++i) {
+			data += "* 1 FETCH (FLAGS (\\Seen) ENVELOPE (\"Mon, 1 Jan 2024 00:00:00 +0000\" \"Subject\"))\r\n";
+		}
+
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::net::deflateSocket client(sok);
+
+		client.send(data);
+
+		vmime::string compressed;
+		sok->localReceive(compressed);
+
+		VASSERT_EQ("Uncompressed", data.length(), client.getUncompressedBytesSent());
+		VASSERT_EQ("Compressed", compressed.length(), client.getCompressedBytesSent());
+		VASSERT_TRUE("Ratio", compressed.length() * 5 < data.length());
+
+		VASSERT_EQ("Data", data, transfer(data, 65536));
+	}
+
+	void testSmallReceiveBuffer() {
+
+		vmime::string data;
+
+		for (int i = 0 ; i < 1000 ; ++i) {
+			data += "A001 OK Completed\r\n";
+		}
+
+		// Decompressed data does not fit in the output buffer: the
+		// remaining data must be returned by the next calls
+		VASSERT_EQ("Data", data, transfer(data, 7));
+	}
+
+	void testSendRawBlocks() {
+
+		vmime::shared_ptr <testSocket> clientSok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <testSocket> serverSok = vmime::make_shared <testSocket>();
+
+		vmime::net::deflateSocket client(clientSok);
+		vmime::net::deflateSocket server(serverSok);
+
+		const vmime::string part1 = "A001 APPEND INBOX {5}\r\n";
+		const vmime::string part2 = "Hello";
+
+		vmime::net::socket::block blocks[2];
+		blocks[0].data = reinterpret_cast <const vmime::byte_t*>(part1.data());
+		blocks[0].count = part1.length();
+		blocks[1].data = reinterpret_cast <const vmime::byte_t*>(part2.data());
+		blocks[1].count = part2.length();
+
+		client.sendRawBlocks(blocks, 2);
+
+		vmime::string compressed;
+		clientSok->localReceive(compressed);
+
+		serverSok->localSend(compressed);
+
+		vmime::string result;
+		server.receive(result);
+
+		VASSERT_EQ("Data", part1 + part2, result);
+	}
+
+VMIME_TEST_SUITE_END
+
+
+#endif // VMIME_HAVE_COMPRESSION_SUPPORT
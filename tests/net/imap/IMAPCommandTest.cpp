@@ -52,7 +52,10 @@ VMIME_TEST_SUITE_BEGIN(IMAPCommandTest)
 		VMIME_TEST(testSEARCH)
 		VMIME_TEST(testSTARTTLS)
 		VMIME_TEST(testCAPABILITY)
+		VMIME_TEST(testCOMPRESS)
+		VMIME_TEST(testENABLE)
 		VMIME_TEST(testNOOP)
+		VMIME_TEST(testIDLE)
 		VMIME_TEST(testEXPUNGE)
 		VMIME_TEST(testCLOSE)
 		VMIME_TEST(testLOGOUT)
@@ -272,6 +275,17 @@ VMIME_TEST_SUITE_BEGIN(IMAPCommandTest)
 
 		VASSERT_NOT_NULL("Not null", cmdUIDs);
 		VASSERT_EQ("Text", "UID FETCH 42:47 (param-1 param-2)", cmdUIDs->getText());
+
+
+		std::vector <vmime::string> modifiers;
+		modifiers.push_back("CHANGEDSINCE 12345");
+		modifiers.push_back("VANISHED");
+
+		vmime::shared_ptr <IMAPCommand> cmdMod =
+			IMAPCommand::FETCH(vmime::net::messageSet::byUID(42, 47), params, modifiers);
+
+		VASSERT_NOT_NULL("Not null", cmdMod);
+		VASSERT_EQ("Text", "UID FETCH 42:47 (param-1 param-2) (CHANGEDSINCE 12345 VANISHED)", cmdMod->getText());
 	}
 
 	void testSTORE() {
@@ -433,6 +447,26 @@ VMIME_TEST_SUITE_BEGIN(IMAPCommandTest)
 		VASSERT_EQ("Text", "CAPABILITY", cmd->getText());
 	}
 
+	void testCOMPRESS() {
+
+		vmime::shared_ptr <IMAPCommand> cmd = IMAPCommand::COMPRESS("DEFLATE");
+
+		VASSERT_NOT_NULL("Not null", cmd);
+		VASSERT_EQ("Text", "COMPRESS DEFLATE", cmd->getText());
+	}
+
+	void testENABLE() {
+
+		std::vector <vmime::string> extensions;
+		extensions.push_back("QRESYNC");
+		extensions.push_back("UTF8=ACCEPT");
+
+		vmime::shared_ptr <IMAPCommand> cmd = IMAPCommand::ENABLE(extensions);
+
+		VASSERT_NOT_NULL("Not null", cmd);
+		VASSERT_EQ("Text", "ENABLE QRESYNC UTF8=ACCEPT", cmd->getText());
+	}
+
 	void testNOOP() {
 
 		vmime::shared_ptr <IMAPCommand> cmd = IMAPCommand::NOOP();
@@ -441,6 +475,14 @@ VMIME_TEST_SUITE_BEGIN(IMAPCommandTest)
 		VASSERT_EQ("Text", "NOOP", cmd->getText());
 	}
 
+	void testIDLE() {
+
+		vmime::shared_ptr <IMAPCommand> cmd = IMAPCommand::IDLE();
+
+		VASSERT_NOT_NULL("Not null", cmd);
+		VASSERT_EQ("Text", "IDLE", cmd->getText());
+	}
+
 	void testEXPUNGE() {
 
 		vmime::shared_ptr <IMAPCommand> cmd = IMAPCommand::EXPUNGE();
@@ -0,0 +1,417 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/imap/IMAPStore.hpp"
+#include "vmime/net/imap/IMAPFolder.hpp"
+#include "vmime/net/imap/IMAPUtils.hpp"
+
+#include "IMAPTestUtils.hpp"
+
+
+/** IMAP test server which supports IDLE, and notifies a new message
+  * as soon as the client starts idling.
+  */
+class idleIMAPTestSocket : public IMAPTestSocket {
+
+public:
+
+	enum IdleEnd {
+		IDLE_END_CLIENT,   /**< Client terminates the command with DONE. */
+		IDLE_END_BYE,      /**< Server closes the connection. */
+		IDLE_END_TAGGED    /**< Server terminates the command by itself. */
+	};
+
+	static std::vector <vmime::string> m_commands;
+	static IdleEnd m_idleEnd;
+
+protected:
+
+	const vmime::string getCapabilities() const {
+
+		return "IMAP4rev1 IDLE";
+	}
+
+	bool processIMAPCommand(const vmime::string& /* line */, const vmime::string& tag, const vmime::string& cmd) {
+
+		m_commands.push_back(tag == "DONE" ? tag : cmd);
+
+		if (cmd == "EXAMINE") {
+
+			localSend("* 3 EXISTS\r\n");
+			localSend("* OK [UIDVALIDITY 42] UIDs valid\r\n");
+			localSend(tag + " OK [READ-ONLY] Completed\r\n");
+
+		} else if (cmd == "IDLE") {
+
+			m_idleTag = tag;
+
+			localSend("+ idling\r\n");
+			localSend("* 5 EXISTS\r\n");
+
+			if (m_idleEnd == IDLE_END_BYE) {
+				localSend("* BYE Server shutting down\r\n");
+			} else if (m_idleEnd == IDLE_END_TAGGED) {
+				localSend(tag + " OK IDLE terminated\r\n");
+			}
+
+		} else if (tag == "DONE") {
+
+			localSend(m_idleTag + " OK Completed\r\n");
+
+		} else if (cmd == "NOOP") {
+
+			localSend(tag + " OK Completed\r\n");
+
+		} else {
+
+			return false;
+		}
+
+		return true;
+	}
+
+private:
+
+	vmime::string m_idleTag;
+};
+
+std::vector <vmime::string> idleIMAPTestSocket::m_commands;
+idleIMAPTestSocket::IdleEnd idleIMAPTestSocket::m_idleEnd = idleIMAPTestSocket::IDLE_END_CLIENT;
+
+
+/** IMAP test server which supports QRESYNC (RFC-7162).
+  */
+class qresyncIMAPTestSocket : public IMAPTestSocket {
+
+public:
+
+	static std::vector <vmime::string> m_commands;
+
+protected:
+
+	const vmime::string getCapabilities() const {
+
+		return "IMAP4rev1 ENABLE CONDSTORE QRESYNC";
+	}
+
+	bool processIMAPCommand(const vmime::string& line, const vmime::string& tag, const vmime::string& cmd) {
+
+		m_commands.push_back(cmd);
+
+		if (cmd == "ENABLE") {
+
+			localSend("* ENABLED QRESYNC\r\n");
+			localSend(tag + " OK Completed\r\n");
+
+		} else if (cmd == "SELECT") {
+
+			localSend("* 100 EXISTS\r\n");
+			localSend("* OK [UIDVALIDITY 67890007] UIDs valid\r\n");
+			localSend("* OK [UIDNEXT 600] Predicted next UID\r\n");
+			localSend("* OK [HIGHESTMODSEQ 90060115205545359] Highest\r\n");
+
+			// Changes are only sent if the client knows the current UID validity
+			if (line.find("(QRESYNC (67890007 90060115194045000))") != vmime::string::npos) {
+
+				localSend("* VANISHED (EARLIER) 41,43:116\r\n");
+				localSend("* 49 FETCH (UID 117 FLAGS (\\Seen \\Answered) MODSEQ (90060115194045001))\r\n");
+				localSend("* 50 FETCH (UID 119 FLAGS (\\Draft) MODSEQ (90060115194045308))\r\n");
+			}
+
+			localSend(tag + " OK [READ-WRITE] Completed\r\n");
+
+		} else if (cmd == "UID" && line.find("(CHANGEDSINCE 90060115205545359 VANISHED)") != vmime::string::npos) {
+
+			localSend("* VANISHED (EARLIER) 300:310\r\n");
+			localSend("* VANISHED 117\r\n");
+			localSend("* 3 FETCH (UID 404 FLAGS (\\Seen) MODSEQ (90060115205545400))\r\n");
+			localSend(tag + " OK Completed\r\n");
+
+		} else {
+
+			return false;
+		}
+
+		return true;
+	}
+};
+
+std::vector <vmime::string> qresyncIMAPTestSocket::m_commands;
+
+
+class testMessageCountListener : public vmime::net::events::messageCountListener {
+
+public:
+
+	void messagesAdded(const vmime::shared_ptr <vmime::net::events::messageCountEvent>& event) {
+
+		m_added.push_back(event);
+	}
+
+	void messagesRemoved(const vmime::shared_ptr <vmime::net::events::messageCountEvent>& event) {
+
+		m_removed.push_back(event);
+	}
+
+	std::vector <vmime::shared_ptr <vmime::net::events::messageCountEvent> > m_added;
+	std::vector <vmime::shared_ptr <vmime::net::events::messageCountEvent> > m_removed;
+};
+
+
+VMIME_TEST_SUITE_BEGIN(IMAPFolderTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testIdle)
+		VMIME_TEST(testIdleBye)
+		VMIME_TEST(testIdleTerminatedByServer)
+		VMIME_TEST(testResync)
+		VMIME_TEST(testResyncUIDValidityChanged)
+		VMIME_TEST(testGetChangesSince)
+	VMIME_TEST_LIST_END
+
+
+	void testIdle() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store = createIMAPTestStore <idleIMAPTestSocket>();
+
+		idleIMAPTestSocket::m_commands.clear();
+		idleIMAPTestSocket::m_idleEnd = idleIMAPTestSocket::IDLE_END_CLIENT;
+
+		store->connect();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolder> folder =
+			vmime::dynamicCast <vmime::net::imap::IMAPFolder>(
+				store->getFolder(vmime::net::folder::path("INBOX"))
+			);
+
+		folder->open(vmime::net::folder::MODE_READ_ONLY);
+
+		testMessageCountListener listener;
+		folder->addMessageCountListener(&listener);
+
+		VASSERT_EQ("count-before", 3, folder->getMessageCount());
+
+		folder->startIdle();
+
+		VASSERT_TRUE("idling", folder->isIdling());
+		VASSERT_TRUE("changes", folder->waitForChanges(1000));
+
+		VASSERT_EQ("event", 1, listener.m_added.size());
+		VASSERT_EQ("event-number", 5, listener.m_added[0]->getNumbers().back());
+		VASSERT_EQ("count-after", 5, folder->getMessageCount());
+
+		VASSERT_TRUE("still-idling", folder->isIdling());
+		VASSERT_FALSE("no-changes", folder->waitForChanges(0));
+
+		// Sending another command must terminate idling first
+		folder->noop();
+
+		VASSERT_FALSE("not-idling", folder->isIdling());
+
+		const std::vector <vmime::string>& cmds = idleIMAPTestSocket::m_commands;
+
+		VASSERT_TRUE("idle-sent", cmds.size() >= 3);
+		VASSERT_EQ("IDLE", "IDLE", cmds[cmds.size() - 3]);
+		VASSERT_EQ("DONE", "DONE", cmds[cmds.size() - 2]);
+		VASSERT_EQ("NOOP", "NOOP", cmds[cmds.size() - 1]);
+
+		folder->removeMessageCountListener(&listener);
+		folder->close(false);
+
+		store->disconnect();
+	}
+
+	void testIdleBye() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store = createIMAPTestStore <idleIMAPTestSocket>();
+
+		idleIMAPTestSocket::m_commands.clear();
+		idleIMAPTestSocket::m_idleEnd = idleIMAPTestSocket::IDLE_END_BYE;
+
+		store->connect();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolder> folder =
+			vmime::dynamicCast <vmime::net::imap::IMAPFolder>(
+				store->getFolder(vmime::net::folder::path("INBOX"))
+			);
+
+		folder->open(vmime::net::folder::MODE_READ_ONLY);
+		folder->startIdle();
+
+		VASSERT_THROW(
+			"bye",
+			folder->waitForChanges(1000),
+			vmime::exceptions::command_error
+		);
+
+		VASSERT_FALSE("not-idling", folder->isIdling());
+		VASSERT_FALSE("closed", folder->isOpen());
+		VASSERT_TRUE("store-connected", store->isConnected());
+
+		const std::vector <vmime::string>& cmds = idleIMAPTestSocket::m_commands;
+
+		VASSERT_EQ("last-command", "IDLE", cmds.back());
+
+		store->disconnect();
+	}
+
+	void testIdleTerminatedByServer() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store = createIMAPTestStore <idleIMAPTestSocket>();
+
+		idleIMAPTestSocket::m_commands.clear();
+		idleIMAPTestSocket::m_idleEnd = idleIMAPTestSocket::IDLE_END_TAGGED;
+
+		store->connect();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolder> folder =
+			vmime::dynamicCast <vmime::net::imap::IMAPFolder>(
+				store->getFolder(vmime::net::folder::path("INBOX"))
+			);
+
+		folder->open(vmime::net::folder::MODE_READ_ONLY);
+		folder->startIdle();
+
+		VASSERT_TRUE("changes", folder->waitForChanges(1000));
+		VASSERT_EQ("count-after", 5, folder->getMessageCount());
+		VASSERT_FALSE("not-idling", folder->isIdling());
+
+		// No DONE must be sent, as the command is already terminated
+		folder->noop();
+
+		const std::vector <vmime::string>& cmds = idleIMAPTestSocket::m_commands;
+
+		VASSERT_TRUE("idle-sent", cmds.size() >= 2);
+		VASSERT_EQ("IDLE", "IDLE", cmds[cmds.size() - 2]);
+		VASSERT_EQ("NOOP", "NOOP", cmds[cmds.size() - 1]);
+
+		folder->close(false);
+		store->disconnect();
+	}
+
+	void testResync() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store = createIMAPTestStore <qresyncIMAPTestSocket>();
+
+		qresyncIMAPTestSocket::m_commands.clear();
+
+		store->connect();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolder> folder =
+			vmime::dynamicCast <vmime::net::imap::IMAPFolder>(
+				store->getFolder(vmime::net::folder::path("INBOX"))
+			);
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolderChanges> changes =
+			folder->openAndResync(vmime::net::folder::MODE_READ_WRITE, 67890007, 90060115194045000ULL);
+
+		const std::vector <vmime::string>& cmds = qresyncIMAPTestSocket::m_commands;
+
+		VASSERT_TRUE("enable-before-select",
+			std::find(cmds.begin(), cmds.end(), "ENABLE") < std::find(cmds.begin(), cmds.end(), "SELECT"));
+
+		VASSERT_FALSE("full-sync", changes->isFullSyncRequired());
+		VASSERT_EQ("uid-validity", 67890007, changes->getUIDValidity());
+		VASSERT_EQ("uid-next", 600, changes->getUIDNext());
+		VASSERT_EQ("modseq", 90060115205545359ULL, changes->getHighestModSequence());
+
+		VASSERT_EQ("expunged", "41,43:116",
+			vmime::net::imap::IMAPUtils::messageSetToSequenceSet(changes->getExpungedMessages()));
+
+		VASSERT_EQ("changed", 2, changes->getChangedMessages().size());
+		VASSERT_EQ("changed-1-uid", "117", static_cast <vmime::string>(changes->getChangedMessages()[0]->getUID()));
+		VASSERT_EQ("changed-1-flags",
+			vmime::net::message::FLAG_SEEN | vmime::net::message::FLAG_REPLIED,
+			changes->getChangedMessages()[0]->getFlags());
+		VASSERT_EQ("changed-2-uid", "119", static_cast <vmime::string>(changes->getChangedMessages()[1]->getUID()));
+
+		folder->close(false);
+		store->disconnect();
+	}
+
+	void testResyncUIDValidityChanged() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store = createIMAPTestStore <qresyncIMAPTestSocket>();
+
+		store->connect();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolder> folder =
+			vmime::dynamicCast <vmime::net::imap::IMAPFolder>(
+				store->getFolder(vmime::net::folder::path("INBOX"))
+			);
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolderChanges> changes =
+			folder->openAndResync(vmime::net::folder::MODE_READ_WRITE, 12345, 90060115194045000ULL);
+
+		VASSERT_TRUE("full-sync", changes->isFullSyncRequired());
+		VASSERT_EQ("uid-validity", 67890007, changes->getUIDValidity());
+		VASSERT_EQ("changed", 0, changes->getChangedMessages().size());
+		VASSERT_TRUE("expunged", changes->getExpungedMessages().isEmpty());
+
+		folder->close(false);
+		store->disconnect();
+	}
+
+	void testGetChangesSince() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store = createIMAPTestStore <qresyncIMAPTestSocket>();
+
+		store->connect();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolder> folder =
+			vmime::dynamicCast <vmime::net::imap::IMAPFolder>(
+				store->getFolder(vmime::net::folder::path("INBOX"))
+			);
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolderChanges> resync =
+			folder->openAndResync(vmime::net::folder::MODE_READ_WRITE, 67890007, 90060115194045000ULL);
+
+		testMessageCountListener listener;
+		folder->addMessageCountListener(&listener);
+
+		vmime::shared_ptr <vmime::net::imap::IMAPFolderChanges> changes =
+			folder->getChangesSince(resync->getHighestModSequence());
+
+		VASSERT_FALSE("full-sync", changes->isFullSyncRequired());
+		VASSERT_EQ("modseq", 90060115205545400ULL, changes->getHighestModSequence());
+
+		VASSERT_EQ("expunged", "300:310,117",
+			vmime::net::imap::IMAPUtils::messageSetToSequenceSet(changes->getExpungedMessages()));
+
+		VASSERT_EQ("changed", 1, changes->getChangedMessages().size());
+		VASSERT_EQ("changed-uid", "404", static_cast <vmime::string>(changes->getChangedMessages()[0]->getUID()));
+
+		// Message with UID 117 is known by the folder: its removal is notified
+		VASSERT_EQ("removed-event", 1, listener.m_removed.size());
+		VASSERT_EQ("removed-count", 1, listener.m_removed[0]->getNumbers().size());
+		VASSERT_EQ("removed-number", 49, listener.m_removed[0]->getNumbers()[0]);
+		VASSERT_TRUE("expunged-flag", resync->getChangedMessages()[0]->isExpunged());
+
+		folder->removeMessageCountListener(&listener);
+		folder->close(false);
+		store->disconnect();
+	}
+
+VMIME_TEST_SUITE_END
@@ -25,6 +25,7 @@
 
 #include "vmime/net/imap/IMAPTag.hpp"
 #include "vmime/net/imap/IMAPParser.hpp"
+#include "vmime/net/imap/IMAPUtils.hpp"
 
 
 VMIME_TEST_SUITE_BEGIN(IMAPParserTest)
@@ -41,6 +42,8 @@ VMIME_TEST_SUITE_BEGIN(IMAPParserTest)
 		VMIME_TEST(testUnquotedMailboxName)
 		VMIME_TEST(testInvalidCharsInAstring)
 		VMIME_TEST(testExtraSpaceInSEARCHResponse)
+		VMIME_TEST(testResponseDataHandler)
+		VMIME_TEST(testVANISHEDAndENABLEDResponses)
 	VMIME_TEST_LIST_END
 
 
@@ -543,4 +546,112 @@ VMIME_TEST_SUITE_BEGIN(IMAPParserTest)
 		}
 	}
 
+	void testVANISHEDAndENABLEDResponses() {
+
+		const char* respText =
+			"* ENABLED QRESYNC\r\n"
+			"* VANISHED (EARLIER) 41,43:116,118\r\n"
+			"* VANISHED 405\r\n"
+			"a001 OK Completed.\r\n";
+
+		auto socket = vmime::make_shared <testSocket>();
+		auto toh = vmime::make_shared <testTimeoutHandler>();
+
+		auto tag = vmime::make_shared <vmime::net::imap::IMAPTag>();
+
+		socket->localSend(respText);
+
+		auto parser = vmime::make_shared <vmime::net::imap::IMAPParser>();
+
+		parser->setSocket(socket);
+		parser->setTimeoutHandler(toh);
+
+		std::unique_ptr <vmime::net::imap::IMAPParser::response> resp(parser->readResponse(*tag));
+
+		VASSERT_EQ("resp size", 3, resp->continue_req_or_response_data.size());
+
+		auto* enableData = resp->continue_req_or_response_data[0]->response_data->enable_data.get();
+
+		VASSERT("enable data", enableData);
+		VASSERT_EQ("enable size", 1, enableData->capabilities.size());
+		VASSERT_EQ("enable capa", "QRESYNC", enableData->capabilities[0]->atom->value);
+
+		auto* vanished1 = resp->continue_req_or_response_data[1]->response_data->message_data.get();
+
+		VASSERT("vanished 1", vanished1);
+		VASSERT_EQ("vanished 1 type", vmime::net::imap::IMAPParser::message_data::VANISHED, vanished1->type);
+		VASSERT_TRUE("vanished 1 earlier", vanished1->earlier);
+		VASSERT_EQ("vanished 1 set", "41,43:116,118",
+			vmime::net::imap::IMAPUtils::messageSetToSequenceSet(
+				vmime::net::imap::IMAPUtils::buildMessageSet(*vanished1->uid_set)));
+
+		auto* vanished2 = resp->continue_req_or_response_data[2]->response_data->message_data.get();
+
+		VASSERT("vanished 2", vanished2);
+		VASSERT_EQ("vanished 2 type", vmime::net::imap::IMAPParser::message_data::VANISHED, vanished2->type);
+		VASSERT_FALSE("vanished 2 earlier", vanished2->earlier);
+		VASSERT_EQ("vanished 2 set", "405",
+			vmime::net::imap::IMAPUtils::messageSetToSequenceSet(
+				vmime::net::imap::IMAPUtils::buildMessageSet(*vanished2->uid_set)));
+	}
+
+	class fetchDataHandler : public vmime::net::imap::IMAPParser::responseDataHandler {
+
+	public:
+
+		bool handleResponseData(const vmime::net::imap::IMAPParser::response_data& data) {
+
+			if (!data.message_data ||
+			    data.message_data->type != vmime::net::imap::IMAPParser::message_data::FETCH) {
+
+				return false;
+			}
+
+			numbers.push_back(data.message_data->number);
+
+			return true;
+		}
+
+		std::vector <size_t> numbers;
+	};
+
+	void testResponseDataHandler() {
+
+		const char* respText =
+			"* 1 FETCH (FLAGS (\\Seen) UID 11)\r\n"
+			"* 2 FETCH (FLAGS () UID 12)\r\n"
+			"* 3 EXISTS\r\n"
+			"* 3 FETCH (FLAGS (\\Answered) UID 13)\r\n"
+			"a001 OK Completed.\r\n";
+
+		auto socket = vmime::make_shared <testSocket>();
+		auto toh = vmime::make_shared <testTimeoutHandler>();
+
+		auto tag = vmime::make_shared <vmime::net::imap::IMAPTag>();
+
+		socket->localSend(respText);
+
+		auto parser = vmime::make_shared <vmime::net::imap::IMAPParser>();
+
+		parser->setSocket(socket);
+		parser->setTimeoutHandler(toh);
+
+		fetchDataHandler handler;
+
+		std::unique_ptr <vmime::net::imap::IMAPParser::response> resp(
+			parser->readResponse(*tag, NULL, &handler)
+		);
+
+		// FETCH data is given to the handler, in order
+		VASSERT_EQ("count", 3, handler.numbers.size());
+		VASSERT_EQ("number 1", 1, handler.numbers[0]);
+		VASSERT_EQ("number 2", 2, handler.numbers[1]);
+		VASSERT_EQ("number 3", 3, handler.numbers[2]);
+
+		// Other data is kept in the response
+		VASSERT_FALSE("bad", resp->isBad());
+		VASSERT_EQ("response data", 1, resp->continue_req_or_response_data.size());
+		VASSERT_TRUE("exists", resp->continue_req_or_response_data[0]->response_data->mailbox_data != NULL);
+	}
+
 VMIME_TEST_SUITE_END
@@ -0,0 +1,243 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/imap/IMAPStore.hpp"
+
+#include "IMAPTestUtils.hpp"
+
+
+/** IMAP test server which answers STATUS commands only once it has
+  * received all of them (so the client must pipeline them), and not
+  * in the order they were sent.
+  */
+class pipeliningIMAPTestSocket : public IMAPTestSocket {
+
+protected:
+
+	bool processIMAPCommand(const vmime::string& line, const vmime::string& tag, const vmime::string& cmd) {
+
+		if (cmd != "STATUS") {
+			return false;
+		}
+
+		// Mailbox name follows the tag and the command name
+		std::istringstream iss(line);
+
+		vmime::string ignored, mailbox;
+		iss >> ignored >> ignored >> mailbox;
+
+		m_statusTags.push_back(tag);
+		m_statusMailboxes.push_back(mailbox);
+
+		if (m_statusTags.size() == 3) {
+
+			localSend("* STATUS " + m_statusMailboxes[1] + " (MESSAGES 12 UNSEEN 3)\r\n");
+			localSend(m_statusTags[1] + " OK Completed\r\n");
+			localSend(m_statusTags[0] + " NO Mailbox does not exist\r\n");
+			localSend("* STATUS " + m_statusMailboxes[2] + " (MESSAGES 7 UNSEEN 0)\r\n");
+			localSend(m_statusTags[2] + " OK Completed\r\n");
+		}
+
+		return true;
+	}
+
+private:
+
+	std::vector <vmime::string> m_statusTags;
+	std::vector <vmime::string> m_statusMailboxes;
+};
+
+
+/** IMAP test server which sends the data of all STATUS commands
+  * before their completion results.
+  */
+class interleavingIMAPTestSocket : public IMAPTestSocket {
+
+protected:
+
+	bool processIMAPCommand(const vmime::string& /* line */, const vmime::string& tag, const vmime::string& cmd) {
+
+		if (cmd != "STATUS") {
+			return false;
+		}
+
+		m_statusTags.push_back(tag);
+
+		if (m_statusTags.size() == 2) {
+
+			localSend("* STATUS B (MESSAGES 5 UNSEEN 1)\r\n");
+			localSend("* STATUS inbox (MESSAGES 42 UNSEEN 2)\r\n");
+			localSend(m_statusTags[0] + " OK Completed\r\n");
+			localSend(m_statusTags[1] + " OK Completed\r\n");
+		}
+
+		return true;
+	}
+
+private:
+
+	std::vector <vmime::string> m_statusTags;
+};
+
+
+/** IMAP test server which answers STATUS commands with other forms of
+  * the mailbox names than the ones which were sent.
+  */
+class renamingIMAPTestSocket : public IMAPTestSocket {
+
+protected:
+
+	bool processIMAPCommand(const vmime::string& line, const vmime::string& tag, const vmime::string& cmd) {
+
+		if (cmd != "STATUS") {
+			return false;
+		}
+
+		std::istringstream iss(line);
+
+		vmime::string ignored, mailbox;
+		iss >> ignored >> ignored >> mailbox;
+
+		if (mailbox == "A/B") {
+
+			// Same mailbox, with a trailing hierarchy separator
+			localSend("* STATUS A/B/ (MESSAGES 3 UNSEEN 1)\r\n");
+
+		} else {
+
+			// Name which cannot be matched
+			localSend("* STATUS \"Other\" (MESSAGES 9 UNSEEN 0)\r\n");
+		}
+
+		localSend(tag + " OK Completed\r\n");
+
+		return true;
+	}
+};
+
+
+VMIME_TEST_SUITE_BEGIN(IMAPStoreTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testGetFolderStatusPipelined)
+		VMIME_TEST(testGetFolderStatusInterleaved)
+		VMIME_TEST(testGetFolderStatusOtherName)
+	VMIME_TEST_LIST_END
+
+
+	void testGetFolderStatusPipelined() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store =
+			createIMAPTestStore <pipeliningIMAPTestSocket>();
+
+		store->connect();
+
+		std::vector <vmime::net::folder::path> paths;
+		paths.push_back(vmime::net::folder::path("A"));
+		paths.push_back(vmime::net::folder::path("B"));
+		paths.push_back(vmime::net::folder::path("C"));
+
+		std::vector <vmime::shared_ptr <vmime::net::folderStatus> > statuses =
+			store->getFolderStatus(paths);
+
+		VASSERT_EQ("count", 3, statuses.size());
+
+		VASSERT_FALSE("A", statuses[0]);
+
+		VASSERT_TRUE("B", statuses[1]);
+		VASSERT_EQ("B-count", 12, statuses[1]->getMessageCount());
+		VASSERT_EQ("B-unseen", 3, statuses[1]->getUnseenCount());
+
+		VASSERT_TRUE("C", statuses[2]);
+		VASSERT_EQ("C-count", 7, statuses[2]->getMessageCount());
+
+		store->disconnect();
+	}
+
+	void testGetFolderStatusInterleaved() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store =
+			createIMAPTestStore <interleavingIMAPTestSocket>();
+
+		store->connect();
+
+		std::vector <vmime::net::folder::path> paths;
+		paths.push_back(vmime::net::folder::path("INBOX"));
+		paths.push_back(vmime::net::folder::path("B"));
+
+		std::vector <vmime::shared_ptr <vmime::net::folderStatus> > statuses =
+			store->getFolderStatus(paths);
+
+		VASSERT_EQ("count", 2, statuses.size());
+
+		VASSERT_TRUE("INBOX", statuses[0]);
+		VASSERT_EQ("INBOX-count", 42, statuses[0]->getMessageCount());
+
+		VASSERT_TRUE("B", statuses[1]);
+		VASSERT_EQ("B-count", 5, statuses[1]->getMessageCount());
+		VASSERT_EQ("B-unseen", 1, statuses[1]->getUnseenCount());
+
+		store->disconnect();
+	}
+
+	void testGetFolderStatusOtherName() {
+
+		vmime::shared_ptr <vmime::net::imap::IMAPStore> store =
+			createIMAPTestStore <renamingIMAPTestSocket>();
+
+		store->connect();
+
+		vmime::net::folder::path pathAB;
+		pathAB /= vmime::net::folder::path::component("A");
+		pathAB /= vmime::net::folder::path::component("B");
+
+		std::vector <vmime::net::folder::path> paths;
+		paths.push_back(pathAB);
+		paths.push_back(vmime::net::folder::path("C"));
+
+		std::vector <vmime::shared_ptr <vmime::net::folderStatus> > statuses =
+			store->getFolderStatus(paths);
+
+		VASSERT_EQ("count", 2, statuses.size());
+
+		VASSERT_TRUE("A/B", statuses[0]);
+		VASSERT_EQ("A/B-count", 3, statuses[0]->getMessageCount());
+
+		// Single STATUS data in the response of the command
+		VASSERT_TRUE("C", statuses[1]);
+		VASSERT_EQ("C-count", 9, statuses[1]->getMessageCount());
+
+		// Same for a single folder
+		vmime::shared_ptr <vmime::net::folderStatus> status =
+			store->getFolder(vmime::net::folder::path("C"))->getStatus();
+
+		VASSERT_EQ("folder-count", 9, status->getMessageCount());
+		VASSERT_EQ("folder-unseen", 0, status->getUnseenCount());
+
+		store->disconnect();
+	}
+
+VMIME_TEST_SUITE_END
@@ -39,6 +39,7 @@ VMIME_TEST_SUITE_BEGIN(SMTPTransportTest)
 		VMIME_TEST(testChunking)
 		VMIME_TEST(testSize_Chunking)
 		VMIME_TEST(testSize_NoChunking)
+		VMIME_TEST(testData)
 		VMIME_TEST(testSMTPUTF8_available)
 		VMIME_TEST(testSMTPUTF8_notAvailable)
 	VMIME_TEST_LIST_END
@@ -145,13 +146,17 @@ VMIME_TEST_SUITE_BEGIN(SMTPTransportTest)
 		vmime::mailboxList recips;
 		recips.appendMailbox(vmime::make_shared <vmime::mailbox>("recipient@test.vmime.org"));
 
-		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <SMTPBigTestMessage4MB>();
+		vmime::shared_ptr <SMTPBigTestMessage4MB> msg = vmime::make_shared <SMTPBigTestMessage4MB>();
 
 		VASSERT_THROW(
 			"Max size limit exception",
 			tr->send(msg, exp, recips),
 			vmime::net::smtp::SMTPMessageSizeExceedsMaxLimitsException
 		);
+
+		// With both CHUNKING and SIZE, the message is generated once
+		// to compute its exact size
+		VASSERT_EQ("Generate count", 1, msg->getGenerateCount());
 	}
 
 	void testSize_NoChunking() {
@@ -176,13 +181,41 @@ VMIME_TEST_SUITE_BEGIN(SMTPTransportTest)
 		vmime::mailboxList recips;
 		recips.appendMailbox(vmime::make_shared <vmime::mailbox>("recipient@test.vmime.org"));
 
-		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <SMTPBigTestMessage4MB>();
+		vmime::shared_ptr <SMTPBigTestMessage4MB> msg = vmime::make_shared <SMTPBigTestMessage4MB>();
 
 		VASSERT_THROW(
 			"Max size limit exception",
 			tr->send(msg, exp, recips),
 			vmime::net::smtp::SMTPMessageSizeExceedsMaxLimitsException
 		);
+
+		// Without CHUNKING, the estimated size is sent: the message is
+		// not generated before the DATA command
+		VASSERT_EQ("Generate count", 0, msg->getGenerateCount());
+	}
+
+	void testData() {
+
+		vmime::shared_ptr <vmime::net::session> session = vmime::net::session::create();
+
+		vmime::shared_ptr <vmime::net::transport> tr =
+			session->getTransport(vmime::utility::url("smtp://localhost"));
+
+		tr->setSocketFactory(vmime::make_shared <testSocketFactory <dataSMTPTestSocket> >());
+		tr->setTimeoutHandlerFactory(vmime::make_shared <testTimeoutHandlerFactory>());
+
+		tr->connect();
+
+		vmime::mailbox exp("expeditor@test.vmime.org");
+
+		vmime::mailboxList recips;
+		recips.appendMailbox(vmime::make_shared <vmime::mailbox>("recipient@test.vmime.org"));
+
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <SMTPDataTestMessage>();
+
+		tr->send(msg, exp, recips);
+
+		tr->disconnect();
 	}
 
 	void testSMTPUTF8_available() {
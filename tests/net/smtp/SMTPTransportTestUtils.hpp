@@ -582,11 +582,23 @@ class SMTPBigTestMessage : public vmime::message {
 
 public:
 
+	SMTPBigTestMessage()
+		: m_generateCount(0) {
+
+	}
+
 	size_t getGeneratedSize(const vmime::generationContext& /* ctx */) {
 
 		return SIZE;
 	}
 
+	/** Return the number of times the message has been generated.
+	  */
+	int getGenerateCount() const {
+
+		return m_generateCount;
+	}
+
 	void generateImpl(
 		const vmime::generationContext& /* ctx */,
 		vmime::utility::outputStream& outputStream,
@@ -594,16 +606,148 @@ public:
 		vmime::size_t* /* newLinePos */ = NULL
 	) const {
 
+		++m_generateCount;
+
 		for (unsigned int i = 0, n = SIZE ; i < n ; ++i) {
 			outputStream.write("X", 1);
 		}
 	}
+
+private:
+
+	mutable int m_generateCount;
 };
 
 typedef SMTPBigTestMessage <4194304> SMTPBigTestMessage4MB;
 
 
 
+/** SMTP test server 4.
+  *
+  * Test line endings conversion and dot-stuffing of message data.
+  */
+class dataSMTPTestSocket : public testSocket {
+
+public:
+
+	dataSMTPTestSocket() {
+
+		m_inData = m_dataReceived = m_quitSent = false;
+	}
+
+	~dataSMTPTestSocket() {
+
+		VASSERT("Client must send message data", m_dataReceived);
+		VASSERT("Client must send the QUIT command", m_quitSent);
+	}
+
+	void onConnected() {
+
+		localSend("220 test.vmime.org Service ready\r\n");
+	}
+
+	void onDataReceived() {
+
+		vmime::string chunk;
+		localReceive(chunk);
+
+		m_buffer += chunk;
+
+		while (true) {
+
+			if (m_inData) {
+
+				const vmime::size_t end = m_buffer.find("\r\n.\r\n");
+
+				if (end == vmime::string::npos) {
+					return;
+				}
+
+				VASSERT_EQ("Data", "Line 1\r\n..hidden\r\n...two\r\n\r\nlast\r\nA\r\n..B\r\nC", m_buffer.substr(0, end));
+
+				m_buffer.erase(0, end + 5);
+
+				localSend("250 Message accepted for delivery\r\n");
+
+				m_inData = false;
+				m_dataReceived = true;
+
+				continue;
+			}
+
+			const vmime::size_t eol = m_buffer.find("\r\n");
+
+			if (eol == vmime::string::npos) {
+				return;
+			}
+
+			std::istringstream iss(m_buffer.substr(0, eol));
+			m_buffer.erase(0, eol + 2);
+
+			std::string cmd;
+			iss >> cmd;
+
+			if (cmd == "EHLO") {
+
+				localSend("250 test.vmime.org says hello\r\n");
+
+			} else if (cmd == "MAIL" || cmd == "RCPT") {
+
+				localSend("250 OK\r\n");
+
+			} else if (cmd == "DATA") {
+
+				localSend("354 Ready to accept data; end with <CRLF>.<CRLF>\r\n");
+
+				m_inData = true;
+
+			} else if (cmd == "QUIT") {
+
+				localSend("221 test.vmime.org Service closing transmission channel\r\n");
+
+				m_quitSent = true;
+
+			} else {
+
+				localSend("502 Command not implemented\r\n");
+			}
+		}
+	}
+
+private:
+
+	vmime::string m_buffer;
+
+	bool m_inData, m_dataReceived, m_quitSent;
+};
+
+
+class SMTPDataTestMessage : public vmime::message {
+
+public:
+
+	void generateImpl(
+		const vmime::generationContext& /* ctx */,
+		vmime::utility::outputStream& outputStream,
+		const vmime::size_t /* curLinePos */ = 0,
+		vmime::size_t* /* newLinePos */ = NULL
+	) const {
+
+		// Line endings and leading dots split across writes
+		outputStream.write("Line 1\n.hid", 11);
+		outputStream.write("den\r", 4);
+		outputStream.write("\n", 1);
+		outputStream.write(".", 1);
+		outputStream.write(".two\r", 5);
+		outputStream.write("\rlast", 5);
+
+		// Canonical data mixed with data which must be converted
+		outputStream.write("\r\nA\r\n.B\nC", 9);
+	}
+};
+
+
+
 /** SMTP test server for SMTPUTF8 extension.
   */
 template <bool SUPPORTS_UTF8>
@@ -0,0 +1,158 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "tests/testUtils.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(batchParserTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testParse)
+		VMIME_TEST(testParseSharedBuffers)
+		VMIME_TEST(testParseEmptyBatch)
+		VMIME_TEST(testParsingContext)
+	VMIME_TEST_LIST_END
+
+
+	static const vmime::string buildMessage(const size_t n) {
+
+		std::ostringstream oss;
+		oss << "From: sender" << n << "@example.com\r\n"
+		    << "Subject: =?utf-8?Q?Message_#" << n << "?=\r\n"
+		    << "Content-Type: multipart/mixed; boundary=\"B" << n << "\"\r\n"
+		    << "\r\n"
+		    << "--B" << n << "\r\n"
+		    << "Content-Type: text/plain\r\n"
+		    << "Content-Transfer-Encoding: base64\r\n"
+		    << "\r\n"
+		    << "Rm9vIGJhcg==\r\n"
+		    << "--B" << n << "\r\n"
+		    << "\r\n"
+		    << vmime::string(n * 10, 'x') << "\r\n"
+		    << "--B" << n << "--\r\n";
+
+		return oss.str();
+	}
+
+	static const vmime::string extractContents(
+		const vmime::shared_ptr <const vmime::contentHandler>& cts
+	) {
+
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter os(oss);
+
+		cts->extract(os);
+
+		return oss.str();
+	}
+
+	static void checkMessage(const size_t n, const vmime::shared_ptr <vmime::message>& msg) {
+
+		std::ostringstream oss;
+		oss << "Message #" << n;
+
+		VASSERT_EQ("subject", oss.str(), msg->getHeader()->Subject()->getValue <vmime::text>()->getWholeBuffer());
+		VASSERT_EQ("part-count", 2, msg->getBody()->getPartCount());
+		VASSERT_EQ("part-2", vmime::string(n * 10, 'x'), extractContents(msg->getBody()->getPartAt(1)->getBody()->getContents()));
+	}
+
+	void testParse() {
+
+		std::vector <vmime::string> buffers;
+
+		for (size_t i = 0 ; i < 200 ; ++i) {
+			buffers.push_back(buildMessage(i));
+		}
+
+		vmime::batchParser parser(4);
+
+		VASSERT_EQ("thread-count", 4, parser.getThreadCount());
+
+		// Parse several batches with the same threads
+		for (int batch = 0 ; batch < 3 ; ++batch) {
+
+			std::vector <vmime::shared_ptr <vmime::message> > messages = parser.parse(buffers);
+
+			VASSERT_EQ("count", buffers.size(), messages.size());
+
+			for (size_t i = 0 ; i < messages.size() ; ++i) {
+				checkMessage(i, messages[i]);
+			}
+		}
+	}
+
+	void testParseSharedBuffers() {
+
+		std::vector <vmime::shared_ptr <const vmime::string> > buffers;
+
+		for (size_t i = 0 ; i < 50 ; ++i) {
+			buffers.push_back(vmime::make_shared <vmime::string>(buildMessage(i)));
+		}
+
+		vmime::batchParser parser(3);
+		parser.setUseMemoryArena(true);
+
+		std::vector <vmime::shared_ptr <vmime::message> > messages = parser.parse(buffers);
+
+		VASSERT_EQ("count", buffers.size(), messages.size());
+
+		for (size_t i = 0 ; i < messages.size() ; ++i) {
+			checkMessage(i, messages[i]);
+		}
+	}
+
+	void testParseEmptyBatch() {
+
+		vmime::batchParser parser(2);
+
+		VASSERT_EQ("empty", 0, parser.parse(std::vector <vmime::string>()).size());
+	}
+
+	void testParsingContext() {
+
+		vmime::parsingContext ctx;
+		ctx.setRetainParsedData(true);
+		ctx.setLazyBodyPartParsing(true);
+
+		vmime::batchParser parser(ctx, 2);
+
+		VASSERT_TRUE("ctx", parser.getParsingContext().getRetainParsedData());
+
+		std::vector <vmime::string> buffers;
+
+		for (size_t i = 0 ; i < 20 ; ++i) {
+			buffers.push_back(buildMessage(i));
+		}
+
+		std::vector <vmime::shared_ptr <vmime::message> > messages = parser.parse(buffers);
+
+		// Each message is parsed with the settings of the context
+		for (size_t i = 0 ; i < messages.size() ; ++i) {
+
+			VASSERT_TRUE("reusable", messages[i]->isParsedDataReusable());
+			VASSERT_EQ("generate", buffers[i], messages[i]->generate());
+		}
+	}
+
+VMIME_TEST_SUITE_END
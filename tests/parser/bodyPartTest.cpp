@@ -23,6 +23,11 @@
 
 #include "tests/testUtils.hpp"
 
+#include "vmime/contentTypeField.hpp"
+#include "vmime/utility/seekableInputStreamRegionAdapter.hpp"
+
+#include <thread>
+
 
 VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 
@@ -40,6 +45,13 @@ VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 		VMIME_TEST(testTextUsageForQPEncoding)
 		VMIME_TEST(testParseVeryBigMessage)
 		VMIME_TEST(testParseBoundaryPrefix)
+		VMIME_TEST(testParseSharedBuffer)
+		VMIME_TEST(testParseLazyParts)
+		VMIME_TEST(testParseLazyPartsConcurrentReads)
+		VMIME_TEST(testRetainParsedData)
+		VMIME_TEST(testRetainParsedDataModified)
+		VMIME_TEST(testRetainParsedDataLineEndings)
+		VMIME_TEST(testRetainParsedDataConcurrentStreamReads)
 	VMIME_TEST_LIST_END
 
 
@@ -411,4 +423,452 @@ VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 		VASSERT_EQ("part2-body", "P2", extractContents(relbd->getPartAt(1)->getBody()->getContents()));
 	}
 
+	void testParseSharedBuffer() {
+
+		vmime::shared_ptr <vmime::string> str = vmime::make_shared <vmime::string>(
+			"Subject: Shared buffer\r\n"
+			"Content-Type: multipart/mixed; boundary=\"MY-BOUNDARY\"\r\n"
+			"\r\n"
+			"--MY-BOUNDARY\r\nHEADER1\r\n\r\nBODY1\r\n"
+			"--MY-BOUNDARY\r\nHEADER2\r\n\r\nBODY2\r\n"
+			"--MY-BOUNDARY--\r\n"
+		);
+
+		vmime::shared_ptr <vmime::bodyPart> p = vmime::make_shared <vmime::bodyPart>();
+		p->parse(str);
+
+		// The parsed tree references the buffer instead of copying it
+		VASSERT("use-count", str.use_count() > 1);
+
+		VASSERT_EQ("subject", "Shared buffer", p->getHeader()->Subject()->getValue <vmime::text>()->getWholeBuffer());
+		VASSERT_EQ("count", 2, p->getBody()->getPartCount());
+		VASSERT_EQ("part1-header", "HEADER1\r\n\r\n", extractComponentString(*str, *p->getBody()->getPartAt(0)->getHeader()));
+		VASSERT_EQ("part1-body", "BODY1", extractContents(p->getBody()->getPartAt(0)->getBody()->getContents()));
+		VASSERT_EQ("part2-body", "BODY2", extractContents(p->getBody()->getPartAt(1)->getBody()->getContents()));
+
+		// Contents are still available once the caller releases the buffer
+		vmime::shared_ptr <const vmime::contentHandler> cts =
+			p->getBody()->getPartAt(1)->getBody()->getContents();
+
+		str.reset();
+		p.reset();
+
+		VASSERT_EQ("released", "BODY2", extractContents(cts));
+	}
+
+	void testParseLazyParts() {
+
+		vmime::string str =
+			"Content-Type: multipart/mixed; boundary=\"MY-BOUNDARY\"\r\n"
+			"\r\n"
+			"--MY-BOUNDARY\r\n"
+			"Content-Type: multipart/alternative; boundary=\"SUB-BOUNDARY\"\r\n"
+			"\r\n"
+			"--SUB-BOUNDARY\r\nHEADER11\r\n\r\nBODY11\r\n"
+			"--SUB-BOUNDARY\r\nHEADER12\r\n\r\nBODY12\r\n"
+			"--SUB-BOUNDARY--\r\n"
+			"--MY-BOUNDARY\r\nSubject: Part 2\r\n\r\nBODY2\r\n"
+			"--MY-BOUNDARY--\r\n";
+
+		vmime::parsingContext ctx;
+		ctx.setLazyBodyPartParsing(true);
+
+		vmime::bodyPart p;
+		p.parse(ctx, str);
+
+		VASSERT_EQ("count", 2, p.getBody()->getPartCount());
+
+		// Bounds of the parts are known before they are parsed
+		VASSERT_EQ("part2-bounds", "Subject: Part 2\r\n\r\nBODY2",
+			extractComponentString(str, *p.getBody()->getPartAt(1)));
+
+		vmime::shared_ptr <vmime::body> body1 = p.getBody()->getPartAt(0)->getBody();
+
+		VASSERT_EQ("part1-count", 2, body1->getPartCount());
+		VASSERT_EQ("part1.1-body", "BODY11", extractContents(body1->getPartAt(0)->getBody()->getContents()));
+		VASSERT_EQ("part1.2-body", "BODY12", extractContents(body1->getPartAt(1)->getBody()->getContents()));
+		VASSERT_EQ("part1.2-header", "HEADER12\r\n\r\n", extractComponentString(str, *body1->getPartAt(1)->getHeader()));
+
+		VASSERT_EQ("part2-subject", "Part 2",
+			p.getBody()->getPartAt(1)->getHeader()->Subject()->getValue <vmime::text>()->getWholeBuffer());
+		VASSERT_EQ("part2-body", "BODY2", extractContents(p.getBody()->getPartAt(1)->getBody()->getContents()));
+
+		// Output must be the same as when parsing eagerly
+		vmime::bodyPart lazy;
+		lazy.parse(ctx, str);
+
+		vmime::bodyPart eager;
+		eager.parse(str);
+
+		VASSERT_EQ("generate", eager.generate(), lazy.generate());
+	}
+
+	static const size_t LAZY_PART_COUNT = 64;
+	static const size_t LAZY_THREAD_COUNT = 8;
+
+	static const vmime::string lazyNestedMessage() {
+
+		std::ostringstream oss;
+
+		oss << "Content-Type: multipart/mixed; boundary=\"OUTER\"\r\n"
+		    << "Subject: Lazy\r\n"
+		    << "\r\n";
+
+		for (size_t i = 0 ; i < LAZY_PART_COUNT ; ++i) {
+
+			oss << "--OUTER\r\n"
+			    << "Content-Type: multipart/alternative; boundary=\"INNER\"\r\n"
+			    << "Subject: Part " << i << "\r\n"
+			    << "\r\n"
+			    << "--INNER\r\n"
+			    << "Content-Type: text/plain\r\n"
+			    << "\r\n"
+			    << "Body " << i << "\r\n"
+			    << "--INNER--\r\n";
+		}
+
+		oss << "--OUTER--\r\n";
+
+		return oss.str();
+	}
+
+	// Read the headers and inner parts of all the parts, starting from a
+	// different part in each thread. Contents are only extracted from the
+	// parts of a slice specific to the thread.
+	static void readLazyParts(
+		const vmime::bodyPart* msg,
+		const size_t thread,
+		std::vector <vmime::string>* out
+	) {
+
+		const size_t count = msg->getBody()->getPartCount();
+		const size_t first = thread * (count / LAZY_THREAD_COUNT);
+
+		for (size_t k = 0 ; k < count ; ++k) {
+
+			const size_t i = (first + k) % count;
+
+			vmime::shared_ptr <const vmime::bodyPart> part = msg->getBody()->getPartAt(i);
+			vmime::shared_ptr <const vmime::bodyPart> inner = part->getBody()->getPartAt(0);
+
+			vmime::string res =
+				part->getHeader()->findField(vmime::fields::SUBJECT)
+					->getValue <vmime::text>()->getWholeBuffer()
+				+ "|" + inner->getHeader()->findField(vmime::fields::CONTENT_TYPE)
+					->getValue <vmime::mediaType>()->generate();
+
+			if (k < count / LAZY_THREAD_COUNT) {
+				res += "|" + extractContents(inner->getBody()->getContents());
+			}
+
+			(*out)[i] = res;
+		}
+	}
+
+	void checkLazyPartsConcurrentReads(
+		const vmime::shared_ptr <vmime::utility::inputStream>& is,
+		const size_t length
+	) {
+
+		vmime::parsingContext ctx;
+		ctx.setLazyBodyPartParsing(true);
+		ctx.setLazyHeaderFieldParsing(true);
+
+		vmime::bodyPart lazy;
+		lazy.parse(ctx, is, 0, length);
+
+		VASSERT_EQ("count", static_cast <size_t>(LAZY_PART_COUNT), lazy.getBody()->getPartCount());
+
+		// Deferred parsing is triggered by const accessors, possibly
+		// from several threads at the same time
+		std::vector <vmime::string> out[LAZY_THREAD_COUNT];
+		std::vector <std::thread> threads;
+
+		for (size_t t = 0 ; t < LAZY_THREAD_COUNT ; ++t) {
+
+			out[t].resize(LAZY_PART_COUNT);
+			threads.push_back(std::thread(readLazyParts, &lazy, t, &out[t]));
+		}
+
+		for (size_t t = 0 ; t < threads.size() ; ++t) {
+			threads[t].join();
+		}
+
+		for (size_t t = 0 ; t < LAZY_THREAD_COUNT ; ++t) {
+
+			for (size_t i = 0 ; i < LAZY_PART_COUNT ; ++i) {
+
+				std::ostringstream expected;
+				expected << "Part " << i << "|text/plain";
+
+				if (i / (LAZY_PART_COUNT / LAZY_THREAD_COUNT) == t) {
+					expected << "|Body " << i;
+				}
+
+				VASSERT_EQ("part", expected.str(), out[t][i]);
+			}
+		}
+
+		// Output must be the same as when parsing eagerly
+		vmime::bodyPart eager;
+		eager.parse(lazyNestedMessage());
+
+		VASSERT_EQ("generate", eager.generate(), lazy.generate());
+	}
+
+	void testParseLazyPartsConcurrentReads() {
+
+		const vmime::string str = lazyNestedMessage();
+
+		// Data read from memory
+		checkLazyPartsConcurrentReads(
+			vmime::make_shared <vmime::utility::inputStreamStringAdapter>(str),
+			str.length()
+		);
+
+		// Data read from a stream which does not give direct access
+		// to its contents, shared by all the parts
+		checkLazyPartsConcurrentReads(
+			vmime::make_shared <vmime::utility::seekableInputStreamRegionAdapter>(
+				vmime::make_shared <vmime::utility::inputStreamStringAdapter>(str),
+				0, str.length()
+			),
+			str.length()
+		);
+	}
+
+	static const vmime::string retainedMessage() {
+
+		return
+			"From:   Foo <foo@example.com>\r\n"
+			"To: bar@example.com,\r\n"
+			"\t baz@example.com\r\n"
+			"Subject: =?utf-8?Q?Hello?=   world\r\n"
+			"Content-Type: multipart/mixed;\r\n"
+			"   boundary=\"MY-BOUNDARY\"\r\n"
+			"\r\n"
+			"Prolog  text\r\n"
+			"--MY-BOUNDARY\r\n"
+			"Content-Type:text/plain;charset=us-ascii\r\n"
+			"Content-Transfer-Encoding: base64\r\n"
+			"\r\n"
+			"Rm9v\r\nIGJh\r\ncg==\r\n"
+			"--MY-BOUNDARY\r\n"
+			"Content-Type: text/plain\r\n"
+			"\r\n"
+			"Part 2   \r\n"
+			"--MY-BOUNDARY--\r\n";
+	}
+
+	void testRetainParsedData() {
+
+		const vmime::string str = retainedMessage();
+
+		vmime::parsingContext ctx;
+		ctx.setRetainParsedData(true);
+
+		vmime::bodyPart p;
+		p.parse(ctx, str);
+
+		VASSERT_TRUE("reusable", p.isParsedDataReusable());
+		VASSERT_EQ("generate", str, p.generate());
+		VASSERT_EQ("size", str.length(), p.getGeneratedSize(vmime::generationContext::getDefaultContext()));
+
+		// Read-only access does not prevent data from being reused
+		vmime::shared_ptr <const vmime::headerField> subject =
+			vmime::shared_ptr <const vmime::header>(p.getHeader())->findField("Subject");
+
+		VASSERT_EQ("subject", "Hello   world", subject->getValue <vmime::text>()->getWholeBuffer());
+		VASSERT_EQ("generate-after-read", str, p.generate());
+
+		// Adding a field only regenerates the header: existing fields
+		// are copied as they were parsed
+		p.getHeader()->getField("X-Foo")->setValue(vmime::string("bar"));
+
+		VASSERT_FALSE("not-reusable", p.isParsedDataReusable());
+		VASSERT_TRUE("body-reusable", p.getBody()->isParsedDataReusable());
+
+		const vmime::string::size_type bodyPos = str.find("\r\n\r\n") + 2;
+
+		VASSERT_EQ("generate-new-field",
+			str.substr(0, bodyPos) + "X-Foo: bar\r\n" + str.substr(bodyPos), p.generate());
+
+		// Cloning keeps the parsed data of unmodified components
+		vmime::shared_ptr <vmime::bodyPart> copy = vmime::clone(p);
+
+		VASSERT_TRUE("clone-body-reusable", copy->getBody()->isParsedDataReusable());
+		VASSERT_EQ("clone-generate", p.generate(), copy->generate());
+
+		// Not enabled by default
+		vmime::bodyPart p2;
+		p2.parse(str);
+
+		VASSERT_FALSE("default", p2.isParsedDataReusable());
+	}
+
+	void testRetainParsedDataModified() {
+
+		const vmime::string str = retainedMessage();
+
+		vmime::parsingContext ctx;
+		ctx.setRetainParsedData(true);
+
+		// Modifying a field regenerates it
+		vmime::bodyPart p1;
+		p1.parse(ctx, str);
+
+		p1.getHeader()->Subject()->setValue(vmime::text("New subject"));
+
+		VASSERT_TRUE("subject-body-reusable", p1.getBody()->isParsedDataReusable());
+		VASSERT_TRUE("subject-new", p1.generate().find("\r\nSubject: New subject\r\n") != vmime::string::npos);
+		VASSERT_TRUE("subject-other", p1.generate().find("From:   Foo <foo@example.com>\r\n") != vmime::string::npos);
+
+		// Changing the boundary regenerates the body
+		vmime::bodyPart p2;
+		p2.parse(ctx, str);
+
+		vmime::dynamicCast <vmime::contentTypeField>(p2.getHeader()->ContentType())->setBoundary("OTHER-BOUNDARY");
+
+		VASSERT_FALSE("boundary-body", p2.getBody()->isParsedDataReusable());
+		VASSERT_TRUE("boundary-part", p2.getBody()->getPartAt(1)->isParsedDataReusable());
+
+		const vmime::string gen2 = p2.generate();
+
+		VASSERT_EQ("boundary-old", vmime::string::npos, gen2.find("MY-BOUNDARY"));
+		VASSERT_TRUE("boundary-new", gen2.find("--OTHER-BOUNDARY\r\nContent-Type: text/plain\r\n\r\nPart 2   \r\n") != vmime::string::npos);
+
+		// Modifying contents regenerates the body, not the parent header
+		vmime::bodyPart p3;
+		p3.parse(ctx, str);
+
+		p3.getBody()->getPartAt(1)->getBody()->setContents(
+			vmime::make_shared <vmime::stringContentHandler>("New contents")
+		);
+
+		VASSERT_FALSE("contents-part", p3.getBody()->getPartAt(1)->isParsedDataReusable());
+		VASSERT_TRUE("contents-header", p3.getHeader()->isParsedDataReusable());
+		VASSERT_TRUE("contents-other", p3.getBody()->getPartAt(0)->isParsedDataReusable());
+
+		const vmime::string gen3 = p3.generate();
+
+		VASSERT_EQ("contents-header-data", str.substr(0, str.find("\r\n\r\n") + 4), gen3.substr(0, str.find("\r\n\r\n") + 4));
+		VASSERT_TRUE("contents-new", gen3.find("New contents") != vmime::string::npos);
+		VASSERT_TRUE("contents-other-data", gen3.find("Rm9v\r\nIGJh\r\ncg==\r\n") != vmime::string::npos);
+
+		// Lazy parsing can be combined with raw data retention
+		ctx.setLazyBodyPartParsing(true);
+
+		vmime::bodyPart p4;
+		p4.parse(ctx, str);
+
+		VASSERT_EQ("lazy-generate", str, p4.generate());
+		VASSERT_EQ("lazy-part-body", "Part 2   ", extractContents(p4.getBody()->getPartAt(1)->getBody()->getContents()));
+		VASSERT_EQ("lazy-generate-after-parse", str, p4.generate());
+	}
+
+	void testRetainParsedDataLineEndings() {
+
+		vmime::string str = retainedMessage();
+
+		for (vmime::size_t pos ; (pos = str.find("\r\n")) != vmime::string::npos ; ) {
+			str.erase(pos, 1);
+		}
+
+		vmime::parsingContext ctx;
+		ctx.setRetainParsedData(true);
+
+		vmime::bodyPart p;
+		p.parse(ctx, str);
+
+		// Data with LF line endings is not copied, as it would be mixed
+		// with CRLF line endings of regenerated components
+		VASSERT_FALSE("reusable", p.isParsedDataReusable());
+		VASSERT_FALSE("header-reusable", p.getHeader()->isParsedDataReusable());
+		VASSERT_FALSE("body-reusable", p.getBody()->isParsedDataReusable());
+
+		p.getHeader()->Subject()->setValue(vmime::text("New subject"));
+
+		// Output is the same as without retaining parsed data
+		vmime::bodyPart p2;
+		p2.parse(str);
+
+		p2.getHeader()->Subject()->setValue(vmime::text("New subject"));
+
+		VASSERT_EQ("generate", p2.generate(), p.generate());
+		VASSERT_TRUE("header-crlf", p.generate().find("To: bar@example.com, baz@example.com\r\n") != vmime::string::npos);
+	}
+
+	// Generate all the parts several times, starting from a different
+	// part in each thread
+	static void generateParts(
+		const vmime::bodyPart* msg,
+		const size_t thread,
+		std::vector <vmime::string>* out
+	) {
+
+		const size_t count = msg->getBody()->getPartCount();
+		const size_t first = thread * (count / LAZY_THREAD_COUNT);
+
+		for (size_t k = 0 ; k < count * 32 ; ++k) {
+
+			const size_t i = (first + k) % count;
+
+			(*out)[i] = msg->getBody()->getPartAt(i)->generate();
+		}
+	}
+
+	void testRetainParsedDataConcurrentStreamReads() {
+
+		const vmime::string str = lazyNestedMessage();
+
+		vmime::parsingContext ctx;
+		ctx.setRetainParsedData(true);
+		ctx.setLazyBodyPartParsing(true);
+
+		// Parsed data is copied from a stream shared by all the parts,
+		// which does not give direct access to its contents
+		vmime::bodyPart p;
+		p.parse(
+			ctx,
+			vmime::make_shared <vmime::utility::seekableInputStreamRegionAdapter>(
+				vmime::make_shared <vmime::utility::inputStreamStringAdapter>(str),
+				0, str.length()
+			),
+			0, str.length()
+		);
+
+		VASSERT_TRUE("reusable", p.isParsedDataReusable());
+
+		std::vector <vmime::string> out[LAZY_THREAD_COUNT];
+		std::vector <std::thread> threads;
+
+		for (size_t t = 0 ; t < LAZY_THREAD_COUNT ; ++t) {
+
+			out[t].resize(LAZY_PART_COUNT);
+			threads.push_back(std::thread(generateParts, &p, t, &out[t]));
+		}
+
+		for (size_t t = 0 ; t < threads.size() ; ++t) {
+			threads[t].join();
+		}
+
+		// Parts are copied as they were parsed
+		vmime::parsingContext eagerCtx;
+		eagerCtx.setRetainParsedData(true);
+
+		vmime::bodyPart eager;
+		eager.parse(eagerCtx, str);
+
+		for (size_t i = 0 ; i < LAZY_PART_COUNT ; ++i) {
+
+			const vmime::string expected = eager.getBody()->getPartAt(i)->generate();
+
+			for (size_t t = 0 ; t < LAZY_THREAD_COUNT ; ++t) {
+				VASSERT_EQ("part", expected, out[t][i]);
+			}
+		}
+
+		VASSERT_EQ("generate", str, p.generate());
+	}
+
 VMIME_TEST_SUITE_END
@@ -24,11 +24,44 @@
 #include "tests/testUtils.hpp"
 
 
+// Content handler which counts how many times it was generated
+class generateCountingContentHandler : public vmime::stringContentHandler {
+
+public:
+
+	generateCountingContentHandler(const vmime::string& data, int* count)
+		: vmime::stringContentHandler(data),
+		  m_count(count) {
+
+	}
+
+	vmime::shared_ptr <vmime::contentHandler> clone() const {
+
+		return vmime::make_shared <generateCountingContentHandler>(*this);
+	}
+
+	void generate(
+		vmime::utility::outputStream& os,
+		const vmime::encoding& enc,
+		const size_t maxLineLength
+	) const {
+
+		++*m_count;
+		vmime::stringContentHandler::generate(os, enc, maxLineLength);
+	}
+
+private:
+
+	int* m_count;
+};
+
+
 VMIME_TEST_SUITE_BEGIN(bodyTest)
 
 	VMIME_TEST_LIST_BEGIN
 		VMIME_TEST(testGenerate_Text)
 		VMIME_TEST(testGenerate_NonText)
+		VMIME_TEST(testGenerate_EncodedContentsCache)
 	VMIME_TEST_LIST_END
 
 	void testGenerate_Text() {
@@ -76,4 +109,54 @@ VMIME_TEST_SUITE_BEGIN(bodyTest)
 		);
 	}
 
+	void testGenerate_EncodedContentsCache() {
+
+		int count = 0;
+
+		vmime::shared_ptr <generateCountingContentHandler> cth =
+			vmime::make_shared <generateCountingContentHandler>("Foo \xc3\xa9\xc3\xa9 bar", &count);
+
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+		msg->getBody()->setContents(
+			cth,
+			vmime::mediaType("text", "plain"),
+			vmime::charset("utf-8"),
+			vmime::encoding("base64")
+		);
+
+		vmime::generationContext ctx;
+		ctx.setEncodedContentsCache(vmime::make_shared <vmime::encodedContentsCache>());
+
+		const size_t size = msg->getExactGeneratedSize(ctx);
+
+		VASSERT_EQ("count 1", 1, count);
+		VASSERT_EQ("entries", 1, ctx.getEncodedContentsCache()->getEntryCount());
+		VASSERT_EQ("body size", 16, msg->getBody()->getGeneratedSize(ctx));
+
+		// Generation replays the encoded contents
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter osa(oss);
+
+		msg->generate(ctx, osa);
+
+		VASSERT_EQ("count 2", 1, count);
+		VASSERT_EQ("size", size, oss.str().length());
+		VASSERT_EQ("body", "Rm9vIMOpw6kgYmFy", msg->getBody()->generate().substr(0, 16));
+
+		// Contents are encoded again if they are changed
+		cth->setData("Foo");
+
+		msg->generate(ctx, osa);
+
+		VASSERT_EQ("count 3", 3, count);
+		VASSERT_EQ("size 2", 4, ctx.getEncodedContentsCache()->getDataSize());
+
+		// ...or if generation parameters are changed
+		msg->getBody()->setEncoding(vmime::encoding("quoted-printable"));
+		msg->generate(ctx, osa);
+
+		VASSERT_EQ("count 4", 4, count);
+		VASSERT_EQ("entries 2", 1, ctx.getEncodedContentsCache()->getEntryCount());
+	}
+
 VMIME_TEST_SUITE_END
@@ -51,6 +51,13 @@ VMIME_TEST_SUITE_BEGIN(charsetTest)
 		VMIME_TEST(testStatusWithInvalidSequence)
 
 		VMIME_TEST(testIsValidText)
+
+		VMIME_TEST(testConverterPool)
+		VMIME_TEST(testConverterPoolAfterInvalidSequence)
+
+		VMIME_TEST(testNativeConversions)
+		VMIME_TEST(testNativeConversionLongText)
+		VMIME_TEST(testNativeConversionLongASCIIRun)
 	VMIME_TEST_LIST_END
 
 
@@ -287,4 +294,155 @@ VMIME_TEST_SUITE_BEGIN(charsetTest)
 		VASSERT_EQ("valid.firstInvalidByte", 8, firstInvalidByte);
 	}
 
+	void testConverterPool() {
+
+		vmime::shared_ptr <vmime::charsetConverterPool> pool = vmime::charsetConverterPool::getInstance();
+		pool->clear();
+
+		const size_t hits = pool->getHitCount();
+		const size_t misses = pool->getMissCount();
+
+		VASSERT_EQ("1", "Gwena\xc3\xabl", convertHelper("Gwena\xebl", "iso-8859-2", "utf-8"));
+
+		VASSERT("Miss", pool->getMissCount() > misses);
+		VASSERT_EQ("Hit", hits, pool->getHitCount());
+		VASSERT("Idle", pool->getIdleCount() != 0);
+
+		const size_t misses2 = pool->getMissCount();
+
+		// Handles are reused for the same charsets, whatever the case of their names
+		VASSERT_EQ("2", "Gwena\xc3\xabl", convertHelper("Gwena\xebl", "ISO-8859-2", "UTF-8"));
+
+		VASSERT("Hit 2", pool->getHitCount() > hits);
+		VASSERT_EQ("Miss 2", misses2, pool->getMissCount());
+
+		// Pooling disabled
+		const size_t maxIdleHandles = pool->getMaxIdleHandles();
+		pool->setMaxIdleHandles(0);
+
+		VASSERT_EQ("3", "Gwena\xc3\xabl", convertHelper("Gwena\xebl", "iso-8859-2", "utf-8"));
+		VASSERT_EQ("Idle 3", static_cast <size_t>(0), pool->getIdleCount());
+
+		pool->setMaxIdleHandles(maxIdleHandles);
+	}
+
+	void testConverterPoolAfterInvalidSequence() {
+
+		vmime::charsetConverterOptions opts;
+		opts.silentlyReplaceInvalidSequences = false;
+
+		// A converter reused after a conversion interrupted by an
+		// error must start from the initial state
+		for (int i = 0 ; i < 2 ; ++i) {
+
+			VASSERT_THROW(
+				"Illegal UTF-8 sequence",
+				convertHelper("abc\xe1\x80", "utf-8", "iso-8859-15", opts),
+				vmime::exceptions::illegal_byte_sequence_for_charset
+			);
+
+			VASSERT_EQ("Valid", "Gwena\xebl", convertHelper("Gwena\xc3\xabl", "utf-8", "iso-8859-15", opts));
+		}
+	}
+
+	void testNativeConversions() {
+
+		// Common charsets are converted without the conversion library
+		VASSERT_EQ("1", "Gwena\xc3\xabl", convertHelper("Gwena\xebl", "iso-8859-1", "utf-8"));
+		VASSERT_EQ("2", "\x80 5", convertHelper("\xe2\x82\xac 5", "utf-8", "windows-1252"));
+		VASSERT_EQ("3", "\xe2\x80\x9cq\xe2\x80\x9d", convertHelper("\x93q\x94", "CP1252", "UTF-8"));
+		VASSERT_EQ("4", "abc", convertHelper("abc", "us-ascii", "utf-8"));
+
+		// Bytes undefined in Windows-1252 map to C1 controls, like ICU
+		VASSERT_EQ("5", "\xc2\x81\xc2\x8d\xc2\x8f\xc2\x90\xc2\x9d",
+			convertHelper("\x81\x8d\x8f\x90\x9d", "windows-1252", "utf-8"));
+		VASSERT_EQ("6", "\x81\x8d\x8f\x90\x9d",
+			convertHelper("\xc2\x81\xc2\x8d\xc2\x8f\xc2\x90\xc2\x9d", "utf-8", "windows-1252"));
+
+		vmime::charsetConverterOptions opts;
+		opts.silentlyReplaceInvalidSequences = false;
+
+		VASSERT_THROW(
+			"Not ASCII",
+			convertHelper("ab\xe9", "us-ascii", "utf-8", opts),
+			vmime::exceptions::illegal_byte_sequence_for_charset
+		);
+
+		VASSERT_THROW(
+			"Not representable",
+			convertHelper("\xe2\x82\xac", "utf-8", "iso-8859-1", opts),
+			vmime::exceptions::illegal_byte_sequence_for_charset
+		);
+
+		VASSERT_THROW(
+			"Overlong UTF-8",
+			convertHelper("\xc0\xaf", "utf-8", "iso-8859-1", opts),
+			vmime::exceptions::illegal_byte_sequence_for_charset
+		);
+
+		// Replacement string is converted to the destination charset
+		opts.silentlyReplaceInvalidSequences = true;
+		opts.invalidSequence = "\xc2\xbf";
+
+		VASSERT_EQ("7", "a\xbf" "b", convertHelper("a\xe2\x82\xac" "b", "utf-8", "iso-8859-1", opts));
+	}
+
+	void testNativeConversionLongText() {
+
+		vmime::string in, expected;
+
+		for (int i = 0 ; i < 5000 ; ++i) {
+
+			in += "Some ASCII text, then Gwena\xc3\xabl ";
+			expected += "Some ASCII text, then Gwena\xebl ";
+		}
+
+		// Stream conversion splits the input into blocks, possibly
+		// in the middle of a multi-byte character
+		vmime::utility::inputStreamStringAdapter is(in);
+		vmime::string out;
+		vmime::utility::outputStreamStringAdapter os(out);
+
+		vmime::charsetConverter::status st;
+		vmime::charsetConverter::create("utf-8", "iso-8859-1")->convert(is, os, &st);
+
+		VASSERT_EQ("Stream", expected, out);
+		VASSERT_EQ("inputBytesRead", in.length(), st.inputBytesRead);
+		VASSERT_EQ("outputBytesWritten", expected.length(), st.outputBytesWritten);
+
+		// Filtered output stream, written byte by byte
+		vmime::string out2;
+		vmime::utility::outputStreamStringAdapter os2(out2);
+
+		vmime::shared_ptr <vmime::utility::charsetFilteredOutputStream> fos =
+			vmime::charsetConverter::create("utf-8", "iso-8859-1")->getFilteredOutputStream(os2);
+
+		for (size_t i = 0 ; i < in.length() ; ++i) {
+			fos->write(in.data() + i, 1);
+		}
+
+		fos->flush();
+
+		VASSERT_EQ("Filtered", expected, out2);
+	}
+
+	void testNativeConversionLongASCIIRun() {
+
+		// Long ASCII runs are written directly: converted bytes before
+		// them must be output first
+		const vmime::string run(3000, 'a');
+
+		VASSERT_EQ(
+			"1",
+			"\xe9" + run + "Z",
+			convertHelper("\xc3\xa9" + run + "Z", "utf-8", "iso-8859-1")
+		);
+
+		VASSERT_EQ(
+			"2",
+			"x\xe9" + run + "\xe9" + run,
+			convertHelper("x\xc3\xa9" + run + "\xc3\xa9" + run, "utf-8", "iso-8859-1")
+		);
+	}
+
 VMIME_TEST_SUITE_END
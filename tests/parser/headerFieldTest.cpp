@@ -23,6 +23,8 @@
 
 #include "tests/testUtils.hpp"
 
+#include <thread>
+
 
 VMIME_TEST_SUITE_BEGIN(headerFieldTest)
 
@@ -31,6 +33,9 @@ VMIME_TEST_SUITE_BEGIN(headerFieldTest)
 		VMIME_TEST(testValueOnNextLine)
 		VMIME_TEST(testStripSpacesAtEnd)
 		VMIME_TEST(testValueWithEmptyLine)
+		VMIME_TEST(testLazyValueParsing)
+		VMIME_TEST(testLazyValueSetBeforeAccess)
+		VMIME_TEST(testLazyValueConcurrentReads)
 	VMIME_TEST_LIST_END
 
 
@@ -109,4 +114,88 @@ VMIME_TEST_SUITE_BEGIN(headerFieldTest)
 		VASSERT_EQ("Field value", "data1 data2 data3", hvalue->getWholeBuffer());
 	}
 
+	void testLazyValueParsing() {
+
+		vmime::parsingContext ctx;
+		ctx.setLazyHeaderFieldParsing(true);
+
+		const vmime::string buffer =
+			"From: Me <me@vmime.org>\r\n"
+			"Subject: =?us-ascii?Q?lazy_value?=\r\n"
+			"Content-Type: text/plain; charset=utf-8\r\n"
+			"\r\n";
+
+		vmime::header hdr;
+		hdr.parse(ctx, buffer);
+
+		VASSERT_EQ("Count", 3, hdr.getFieldCount());
+
+		vmime::shared_ptr <const vmime::mailbox> from =
+			hdr.From()->getValue <vmime::mailbox>();
+
+		VASSERT_EQ("From", "me@vmime.org", from->getEmail().toString());
+		VASSERT_EQ("From offset", 6, from->getParsedOffset());
+		VASSERT_EQ("From length", 17, from->getParsedLength());
+
+		VASSERT_EQ("Subject", "lazy value", hdr.Subject()->getValue <vmime::text>()->getWholeBuffer());
+
+		VASSERT_EQ("Content-Type", "text/plain", hdr.ContentType()->getValue <vmime::mediaType>()->generate());
+
+		// Output must be the same as when parsing eagerly
+		vmime::header eagerHdr;
+		eagerHdr.parse(buffer);
+
+		VASSERT_EQ("Generate", eagerHdr.generate(), hdr.generate());
+	}
+
+	void testLazyValueSetBeforeAccess() {
+
+		vmime::parsingContext ctx;
+		ctx.setLazyHeaderFieldParsing(true);
+
+		const vmime::string buffer = "Subject: old value\r\n";
+
+		vmime::shared_ptr <vmime::headerField> hfield =
+			vmime::headerField::parseNext(ctx, buffer, 0, buffer.size());
+
+		hfield->setValue(vmime::text("new value"));
+
+		VASSERT_EQ("Value", "new value", hfield->getValue <vmime::text>()->getWholeBuffer());
+	}
+
+	static void readLazySubject(const vmime::header* hdr, vmime::string* out) {
+
+		vmime::shared_ptr <const vmime::headerField> field = hdr->findField("Subject");
+
+		*out = field->getValue <vmime::text>()->getWholeBuffer();
+	}
+
+	void testLazyValueConcurrentReads() {
+
+		vmime::parsingContext ctx;
+		ctx.setLazyHeaderFieldParsing(true);
+
+		vmime::header hdr;
+		hdr.parse(ctx, "Subject: =?us-ascii?Q?lazy_value?=\r\n");
+
+		// Deferred parsing is triggered by const accessors, possibly
+		// from several threads at the same time
+		const vmime::header& chdr = hdr;
+
+		vmime::string out[4];
+		std::vector <std::thread> threads;
+
+		for (int i = 0 ; i < 4 ; ++i) {
+			threads.push_back(std::thread(readLazySubject, &chdr, &out[i]));
+		}
+
+		for (size_t i = 0 ; i < threads.size() ; ++i) {
+			threads[i].join();
+		}
+
+		for (int i = 0 ; i < 4 ; ++i) {
+			VASSERT_EQ("Subject", "lazy value", out[i]);
+		}
+	}
+
 VMIME_TEST_SUITE_END
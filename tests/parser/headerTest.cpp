@@ -24,6 +24,45 @@
 #include "tests/testUtils.hpp"
 
 
+// Input stream which cannot seek back
+class nonSeekableInputStream : public vmime::utility::inputStream {
+
+public:
+
+	nonSeekableInputStream(const vmime::string& data)
+		: m_data(data), m_pos(0) {
+
+	}
+
+	bool eof() const { return m_pos >= m_data.length(); }
+	void reset() { m_pos = 0; }
+
+	size_t read(vmime::byte_t* const data, const size_t count) {
+
+		const size_t n = std::min(count, m_data.length() - m_pos);
+		std::copy(m_data.begin() + m_pos, m_data.begin() + m_pos + n, data);
+		m_pos += n;
+
+		return n;
+	}
+
+	size_t skip(const size_t count) {
+
+		const size_t n = std::min(count, m_data.length() - m_pos);
+		m_pos += n;
+
+		return n;
+	}
+
+	size_t getPosition() const { return m_pos; }
+
+private:
+
+	vmime::string m_data;
+	size_t m_pos;
+};
+
+
 VMIME_TEST_SUITE_BEGIN(headerTest)
 
 	VMIME_TEST_LIST_BEGIN
@@ -61,6 +100,17 @@ VMIME_TEST_SUITE_BEGIN(headerTest)
 		VMIME_TEST(testFindAllFields1)
 		VMIME_TEST(testFindAllFields2)
 		VMIME_TEST(testFindAllFields3)
+
+		VMIME_TEST(testFindAfterChanges)
+		VMIME_TEST(testFindAfterRename)
+		VMIME_TEST(testFindAfterRenameDetached)
+		VMIME_TEST(testAppendFieldOfOtherHeader)
+		VMIME_TEST(testFindFieldKey)
+
+		VMIME_TEST(testParseFromStream)
+		VMIME_TEST(testParseFromStreamEmpty)
+		VMIME_TEST(testParseFromStreamNoBody)
+		VMIME_TEST(testParseFromStreamNotSeekable)
 	VMIME_TEST_LIST_END
 
 
@@ -372,4 +422,216 @@ VMIME_TEST_SUITE_BEGIN(headerTest)
 		VASSERT_EQ("Second value", "C: c2", headerTest::getFieldValue(*res[2]));
 	}
 
+	void testFindAfterChanges() {
+
+		vmime::header hdr;
+		hdr.parse("A: a1\nB: b1\nC: c1\n");
+
+		vmime::shared_ptr <vmime::headerField> b1 = hdr.findField("b");
+		VASSERT("Find b1", b1);
+
+		vmime::shared_ptr <vmime::headerField> b0 = vmime::headerFieldFactory::getInstance()->create("B", "b0");
+		hdr.insertFieldBefore(0, b0);
+
+		vmime::shared_ptr <vmime::headerField> b2 = vmime::headerFieldFactory::getInstance()->create("B", "b2");
+		hdr.appendField(b2);
+
+		std::vector <vmime::shared_ptr <vmime::headerField> > res = hdr.findAllFields("B");
+
+		VASSERT_EQ("Count", static_cast <unsigned int>(3), res.size());
+		VASSERT_EQ("First value", "B: b0", headerTest::getFieldValue(*res[0]));
+		VASSERT_EQ("Second value", "B: b1", headerTest::getFieldValue(*res[1]));
+		VASSERT_EQ("Third value", "B: b2", headerTest::getFieldValue(*res[2]));
+
+		hdr.removeField(b0);
+		hdr.removeField(b1);
+
+		VASSERT("Find b2", hdr.findField("B") == b2);
+
+		hdr.removeField(b2);
+
+		VASSERT("Has B", !hdr.hasField("B"));
+		VASSERT("Has C", hdr.hasField("c"));
+	}
+
+	void testFindAfterRename() {
+
+		vmime::header hdr;
+		hdr.parse("A: a1\nB: b1\n");
+
+		vmime::shared_ptr <vmime::headerField> b = hdr.findField("B");
+		VASSERT("Find B", b);
+
+		b->setName("X-Renamed");
+
+		VASSERT("Has B", !hdr.hasField("B"));
+		VASSERT("Find X-Renamed", hdr.findField("x-renamed") == b);
+
+		hdr.removeField(b);
+
+		VASSERT("Has X-Renamed", !hdr.hasField("X-Renamed"));
+	}
+
+	void testFindAfterRenameDetached() {
+
+		vmime::header hdr1;
+		hdr1.parse("A: a1\nB: b1\n");
+
+		vmime::shared_ptr <vmime::header> hdr2 = vmime::dynamicCast <vmime::header>(hdr1.clone());
+
+		// Renaming a field of a copy does not affect the original
+		hdr2->findField("A")->setName("C");
+
+		VASSERT("Has A", hdr1.hasField("A"));
+		VASSERT("Has C", !hdr1.hasField("C"));
+		VASSERT("Copy has A", !hdr2->hasField("A"));
+		VASSERT("Copy has C", hdr2->hasField("C"));
+
+		// Removed fields are not indexed anymore, even when renamed
+		vmime::shared_ptr <vmime::headerField> b = hdr1.findField("B");
+		hdr1.removeField(b);
+		b->setName("A");
+
+		const vmime::header& chdr1 = hdr1;
+
+		VASSERT_EQ("Count", static_cast <unsigned int>(1), hdr1.findAllFields("A").size());
+		VASSERT("Find B", !chdr1.findField("B"));
+		VASSERT_EQ("Find A", "A: a1", headerTest::getFieldValue(*chdr1.findField("a")));
+	}
+
+	void testAppendFieldOfOtherHeader() {
+
+		vmime::header hdr1;
+		hdr1.parse("A: a1\nB: b1\n");
+
+		vmime::header hdr2;
+		hdr2.parse("C: c2\n");
+
+		// A field belongs to one header only: it is moved to the new one
+		vmime::shared_ptr <vmime::headerField> a = hdr1.findField("A");
+		hdr2.appendField(a);
+
+		VASSERT_EQ("Count 1", static_cast <size_t>(1), hdr1.getFieldCount());
+		VASSERT("Has A 1", !hdr1.hasField("A"));
+		VASSERT_EQ("Count 2", static_cast <size_t>(2), hdr2.getFieldCount());
+		VASSERT("Find A 2", hdr2.findField("A") == a);
+
+		// Both indexes are up to date after renaming the field
+		a->setName("D");
+
+		VASSERT("Has D 1", !hdr1.hasField("D"));
+		VASSERT("Has A 2", !hdr2.hasField("A"));
+		VASSERT("Find D 2", hdr2.findField("D") == a);
+
+		// Same when the field is inserted
+		vmime::shared_ptr <vmime::headerField> b = hdr1.findField("B");
+		hdr2.insertFieldBefore(0, b);
+
+		VASSERT_EQ("Count 1 after insert", static_cast <size_t>(0), hdr1.getFieldCount());
+		VASSERT("Find B 2", hdr2.getFieldAt(0) == b);
+
+		hdr1.appendField(b);
+		b->setName("E");
+
+		VASSERT("Has B 2", !hdr2.hasField("B") && !hdr2.hasField("E"));
+		VASSERT("Find E 1", hdr1.findField("E") == b);
+
+		// A field added twice to the same header is still indexed
+		// after one of its occurrences is removed
+		hdr2.appendField(a);
+		hdr2.removeField(a);
+		a->setName("F");
+
+		VASSERT("Find F 2", hdr2.findField("F") == a);
+		VASSERT("Has D 2", !hdr2.hasField("D"));
+	}
+
+	void testFindFieldKey() {
+
+		const vmime::header::fieldKey key("X-Custom");
+
+		vmime::header hdr;
+		hdr.parse("From: x\nx-custom: c1\nX-CUSTOM: c2\n");
+
+		VASSERT("Has", hdr.hasField(key));
+		VASSERT_EQ("Find", "x-custom: c1", headerTest::getFieldValue(*hdr.findField(key)));
+		VASSERT_EQ("Count", static_cast <unsigned int>(2), hdr.findAllFields(key).size());
+
+		VASSERT("From", hdr.From() == hdr.findField("FROM"));
+		VASSERT("Get", hdr.getField(key) == hdr.findField(key));
+	}
+
+	// parseFromStream() tests
+	void testParseFromStream() {
+
+		const vmime::string data =
+			"From: me@vmime.org\r\n"
+			"Subject: a very\r\n  long subject\r\n"
+			"\r\n"
+			"Body\r\n\r\nX: not a header\r\n";
+
+		vmime::utility::inputStreamStringAdapter is(data);
+
+		vmime::header hdr;
+		const size_t bodyPos = hdr.parseFromStream(is);
+
+		VASSERT_EQ("Body pos", static_cast <size_t>(data.find("Body")), bodyPos);
+		VASSERT_EQ("Stream pos", bodyPos, is.getPosition());
+		VASSERT_EQ("Count", static_cast <size_t>(2), hdr.getFieldCount());
+		VASSERT_EQ("Subject", "Subject: a very long subject", headerTest::getFieldValue(*hdr.Subject()));
+
+		// LF-only line endings
+		const vmime::string data2 = "From: me@vmime.org\nTo: you@vmime.org\n\nBody\n";
+
+		vmime::utility::inputStreamStringAdapter is2(data2);
+
+		vmime::header hdr2;
+		const size_t bodyPos2 = hdr2.parseFromStream(is2);
+
+		VASSERT_EQ("Body pos 2", static_cast <size_t>(data2.find("Body")), bodyPos2);
+		VASSERT_EQ("Stream pos 2", bodyPos2, is2.getPosition());
+		VASSERT_EQ("Count 2", static_cast <size_t>(2), hdr2.getFieldCount());
+	}
+
+	void testParseFromStreamEmpty() {
+
+		vmime::utility::inputStreamStringAdapter is("\r\nBody: not a header\r\n");
+
+		vmime::header hdr;
+		hdr.appendField(vmime::headerFieldFactory::getInstance()->create("To", "x@y.z"));
+
+		VASSERT_EQ("Body pos", static_cast <size_t>(2), hdr.parseFromStream(is));
+		VASSERT_EQ("Stream pos", static_cast <size_t>(2), is.getPosition());
+		VASSERT("Empty", hdr.isEmpty());
+	}
+
+	void testParseFromStreamNoBody() {
+
+		const vmime::string data = "From: me@vmime.org\r\nTo: you@vmime.org\r\n";
+
+		vmime::utility::inputStreamStringAdapter is(data);
+
+		vmime::header hdr;
+
+		VASSERT_EQ("Body pos", data.length(), hdr.parseFromStream(is));
+		VASSERT_EQ("Count", static_cast <size_t>(2), hdr.getFieldCount());
+	}
+
+	void testParseFromStreamNotSeekable() {
+
+		const vmime::string data =
+			"From: me@vmime.org\r\n"
+			"To: you@vmime.org\r\n"
+			"\r\n"
+			"Body";
+
+		nonSeekableInputStream is(data);
+
+		vmime::header hdr;
+
+		VASSERT_EQ("Body pos", static_cast <size_t>(data.find("Body")), hdr.parseFromStream(is));
+		VASSERT_EQ("Stream pos", static_cast <size_t>(data.find("Body")), is.getPosition());
+		VASSERT_EQ("Count", static_cast <size_t>(2), hdr.getFieldCount());
+	}
+
 VMIME_TEST_SUITE_END
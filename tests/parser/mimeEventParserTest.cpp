@@ -0,0 +1,502 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "tests/testUtils.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(mimeEventParserTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testSimpleMessage)
+		VMIME_TEST(testMultipart)
+		VMIME_TEST(testNestedMessage)
+		VMIME_TEST(testMissingCloseDelimiter)
+		VMIME_TEST(testEmptyPart)
+		VMIME_TEST(testDecodeBase64)
+		VMIME_TEST(testDecodeQuotedPrintable)
+		VMIME_TEST(testChunkSizes)
+		VMIME_TEST(testLongHeaderField)
+		VMIME_TEST(testFeed)
+		VMIME_TEST(testFeedEventsBeforeFinish)
+		VMIME_TEST(testFeedStream)
+	VMIME_TEST_LIST_END
+
+
+	// Records events as text; consecutive body chunks are merged
+	class recordingHandler : public vmime::mimeEventHandler {
+
+	public:
+
+		void onPartBegin(const size_t depth) {
+
+			flushBody();
+			m_log << "begin " << depth << "\n";
+		}
+
+		void onHeaderField(const vmime::string& name, const vmime::string& value) {
+
+			m_log << "field " << name << "=" << value << "\n";
+		}
+
+		void onBodyBegin(const vmime::mediaType& type, const vmime::encoding& enc) {
+
+			m_log << "body " << type.generate() << " " << enc.generate() << "\n";
+		}
+
+		void onBodyChunk(const vmime::byte_t* data, const size_t length) {
+
+			m_body.append(reinterpret_cast <const char*>(data), length);
+			++m_chunkCount;
+		}
+
+		void onPartEnd(const size_t depth) {
+
+			flushBody();
+			m_log << "end " << depth << "\n";
+		}
+
+		const vmime::string getLog() {
+
+			flushBody();
+			return m_log.str();
+		}
+
+		size_t m_chunkCount = 0;
+
+	private:
+
+		void flushBody() {
+
+			if (!m_body.empty()) {
+				m_log << "data [" << m_body << "]\n";
+				m_body.clear();
+			}
+		}
+
+		std::ostringstream m_log;
+		vmime::string m_body;
+	};
+
+
+	static const vmime::string parse(
+		const vmime::string& data,
+		const size_t chunkSize = 65536,
+		const bool decode = false
+	) {
+
+		vmime::shared_ptr <recordingHandler> handler = vmime::make_shared <recordingHandler>();
+
+		vmime::mimeEventParser parser(handler);
+		parser.setChunkSize(chunkSize);
+		parser.setDecodeBodies(decode);
+
+		vmime::utility::inputStreamStringAdapter is(data);
+		parser.parse(is);
+
+		return handler->getLog();
+	}
+
+
+	void testSimpleMessage() {
+
+		const vmime::string data =
+			"From: me@vmime.org\r\n"
+			"Subject: first line\r\n"
+			" second line\r\n"
+			"\r\n"
+			"Body\r\n"
+			"--not a delimiter\r\n";
+
+		VASSERT_EQ(
+			"Events",
+			"begin 0\n"
+			"field From=me@vmime.org\n"
+			"field Subject=first line second line\n"
+			"body text/plain 7bit\n"
+			"data [Body\r\n--not a delimiter\r\n]\n"
+			"end 0\n",
+			parse(data)
+		);
+	}
+
+	void testMultipart() {
+
+		const vmime::string data =
+			"Content-Type: multipart/mixed; boundary=\"XYZ\"\r\n"
+			"\r\n"
+			"Preamble\r\n"
+			"--XYZ\r\n"
+			"Content-Type: text/plain\r\n"
+			"\r\n"
+			"Part 1\r\n"
+			"--XYZ  \r\n"
+			"\r\n"
+			"Part 2\r\n"
+			"--XYZX is not a delimiter\r\n"
+			"--XYZ--\r\n"
+			"Epilogue\r\n";
+
+		VASSERT_EQ(
+			"Events",
+			"begin 0\n"
+			"field Content-Type=multipart/mixed; boundary=\"XYZ\"\n"
+			"body multipart/mixed 7bit\n"
+			"begin 1\n"
+			"field Content-Type=text/plain\n"
+			"body text/plain 7bit\n"
+			"data [Part 1]\n"
+			"end 1\n"
+			"begin 1\n"
+			"body text/plain 7bit\n"
+			"data [Part 2\r\n--XYZX is not a delimiter]\n"
+			"end 1\n"
+			"end 0\n",
+			parse(data)
+		);
+	}
+
+	void testNestedMessage() {
+
+		const vmime::string data =
+			"Content-Type: multipart/mixed; boundary=outer\r\n"
+			"\r\n"
+			"--outer\r\n"
+			"Content-Type: message/rfc822\r\n"
+			"\r\n"
+			"Subject: nested\r\n"
+			"Content-Type: multipart/alternative; boundary=inner\r\n"
+			"\r\n"
+			"--inner\r\n"
+			"\r\n"
+			"Text\r\n"
+			"--inner--\r\n"
+			"\r\n"
+			"--outer--\r\n";
+
+		VASSERT_EQ(
+			"Events",
+			"begin 0\n"
+			"field Content-Type=multipart/mixed; boundary=outer\n"
+			"body multipart/mixed 7bit\n"
+			"begin 1\n"
+			"field Content-Type=message/rfc822\n"
+			"body message/rfc822 7bit\n"
+			"begin 2\n"
+			"field Subject=nested\n"
+			"field Content-Type=multipart/alternative; boundary=inner\n"
+			"body multipart/alternative 7bit\n"
+			"begin 3\n"
+			"body text/plain 7bit\n"
+			"data [Text]\n"
+			"end 3\n"
+			"end 2\n"
+			"end 1\n"
+			"end 0\n",
+			parse(data)
+		);
+	}
+
+	void testMissingCloseDelimiter() {
+
+		const vmime::string data =
+			"Content-Type: multipart/mixed; boundary=outer\r\n"
+			"\r\n"
+			"--outer\r\n"
+			"Content-Type: multipart/mixed; boundary=inner\r\n"
+			"\r\n"
+			"--inner\r\n"
+			"\r\n"
+			"Inner text\r\n"
+			"--outer\r\n"
+			"\r\n"
+			"Last part";
+
+		VASSERT_EQ(
+			"Events",
+			"begin 0\n"
+			"field Content-Type=multipart/mixed; boundary=outer\n"
+			"body multipart/mixed 7bit\n"
+			"begin 1\n"
+			"field Content-Type=multipart/mixed; boundary=inner\n"
+			"body multipart/mixed 7bit\n"
+			"begin 2\n"
+			"body text/plain 7bit\n"
+			"data [Inner text]\n"
+			"end 2\n"
+			"end 1\n"
+			"begin 1\n"
+			"body text/plain 7bit\n"
+			"data [Last part]\n"
+			"end 1\n"
+			"end 0\n",
+			parse(data)
+		);
+	}
+
+	void testEmptyPart() {
+
+		const vmime::string data =
+			"Content-Type: multipart/mixed; boundary=b\r\n"
+			"\r\n"
+			"--b\r\n"
+			"--b\r\n"
+			"X-Field: value\r\n"
+			"--b--";
+
+		VASSERT_EQ(
+			"Events",
+			"begin 0\n"
+			"field Content-Type=multipart/mixed; boundary=b\n"
+			"body multipart/mixed 7bit\n"
+			"begin 1\n"
+			"body text/plain 7bit\n"
+			"end 1\n"
+			"begin 1\n"
+			"field X-Field=value\n"
+			"body text/plain 7bit\n"
+			"end 1\n"
+			"end 0\n",
+			parse(data)
+		);
+	}
+
+	void testDecodeBase64() {
+
+		const vmime::string data =
+			"Content-Type: multipart/mixed; boundary=b\r\n"
+			"\r\n"
+			"--b\r\n"
+			"Content-Type: application/octet-stream\r\n"
+			"Content-Transfer-Encoding: base64\r\n"
+			"\r\n"
+			"VGhpcyBpcyBhIHRlc3Qgb2YgYmFzZTY0IGRlY29kaW5n\r\n"
+			"IGFjcm9zcyBjaHVua3Mu\r\n"
+			"--b--\r\n";
+
+		for (size_t chunkSize = 1 ; chunkSize < 20 ; ++chunkSize) {
+
+			std::ostringstream oss;
+			oss << "Chunk size " << chunkSize;
+
+			VASSERT_EQ(
+				oss.str(),
+				"begin 0\n"
+				"field Content-Type=multipart/mixed; boundary=b\n"
+				"body multipart/mixed 7bit\n"
+				"begin 1\n"
+				"field Content-Type=application/octet-stream\n"
+				"field Content-Transfer-Encoding=base64\n"
+				"body application/octet-stream base64\n"
+				"data [This is a test of base64 decoding across chunks.]\n"
+				"end 1\n"
+				"end 0\n",
+				parse(data, chunkSize, true)
+			);
+		}
+	}
+
+	void testDecodeQuotedPrintable() {
+
+		const vmime::string data =
+			"Content-Type: text/plain; charset=iso-8859-1\r\n"
+			"Content-Transfer-Encoding: quoted-printable\r\n"
+			"\r\n"
+			"Caf=E9 au lait, cr=E8me br=FBl=E9e, soft =\r\n"
+			"line break.\r\n";
+
+		for (size_t chunkSize = 1 ; chunkSize < 20 ; ++chunkSize) {
+
+			std::ostringstream oss;
+			oss << "Chunk size " << chunkSize;
+
+			VASSERT_EQ(
+				oss.str(),
+				"begin 0\n"
+				"field Content-Type=text/plain; charset=iso-8859-1\n"
+				"field Content-Transfer-Encoding=quoted-printable\n"
+				"body text/plain quoted-printable\n"
+				"data [Caf\xe9 au lait, cr\xe8me br\xfbl\xe9" "e, soft line break.\r\n]\n"
+				"end 0\n",
+				parse(data, chunkSize, true)
+			);
+		}
+	}
+
+	void testChunkSizes() {
+
+		const vmime::string data =
+			"Content-Type: multipart/mixed; boundary=\"=_boundary\"\r\n"
+			"\r\n"
+			"--=_boundary\r\n"
+			"Content-Type: text/plain\r\n"
+			"\r\n"
+			"Line 1\r\n"
+			"\r\n"
+			"-- signature\r\n"
+			"--=_boundar\r\n"
+			"--=_boundary\r\n"
+			"Content-Type: message/rfc822\r\n"
+			"\r\n"
+			"Subject: nested\r\n"
+			"\r\n"
+			"Nested body\r\n"
+			"--=_boundary--\r\n";
+
+		const vmime::string expected = parse(data);
+
+		for (size_t chunkSize = 1 ; chunkSize < 40 ; ++chunkSize) {
+
+			std::ostringstream oss;
+			oss << "Chunk size " << chunkSize;
+
+			VASSERT_EQ(oss.str(), expected, parse(data, chunkSize));
+		}
+	}
+
+	void testLongHeaderField() {
+
+		const vmime::string value(5000, 'x');
+		const vmime::string data = "X-Long: " + value + "\r\nX-Short: y\r\n\r\nBody";
+
+		vmime::shared_ptr <recordingHandler> handler = vmime::make_shared <recordingHandler>();
+
+		vmime::mimeEventParser parser(handler);
+		parser.setChunkSize(64);
+		parser.setMaxHeaderFieldSize(100);
+
+		vmime::utility::inputStreamStringAdapter is(data);
+		parser.parse(is);
+
+		VASSERT_EQ(
+			"Events",
+			"begin 0\n"
+			"field X-Long=" + value.substr(0, 100) + "\n"
+			"field X-Short=y\n"
+			"body text/plain 7bit\n"
+			"data [Body]\n"
+			"end 0\n",
+			handler->getLog()
+		);
+	}
+
+	void testFeed() {
+
+		const vmime::string data =
+			"Content-Type: multipart/mixed; boundary=b\r\n"
+			"\r\n"
+			"--b\r\n"
+			"Content-Transfer-Encoding: base64\r\n"
+			"\r\n"
+			"SGVsbG8sIHdvcmxkIQ==\r\n"
+			"--b--\r\n";
+
+		const vmime::string expected = parse(data, 65536, true);
+
+		// Split data in two at every possible position
+		for (size_t split = 0 ; split <= data.length() ; ++split) {
+
+			vmime::shared_ptr <recordingHandler> handler = vmime::make_shared <recordingHandler>();
+
+			vmime::mimeEventParser parser(handler);
+			parser.setDecodeBodies(true);
+
+			parser.feed(data.substr(0, split));
+			parser.feed(data.substr(split));
+			parser.finish();
+
+			std::ostringstream oss;
+			oss << "Split " << split;
+
+			VASSERT_EQ(oss.str(), expected, handler->getLog());
+		}
+	}
+
+	void testFeedEventsBeforeFinish() {
+
+		vmime::shared_ptr <recordingHandler> handler = vmime::make_shared <recordingHandler>();
+
+		vmime::mimeEventParser parser(handler);
+
+		parser.feed(
+			"Content-Type: multipart/mixed; boundary=b\r\n"
+			"\r\n"
+			"--b\r\n"
+			"\r\n"
+			"First part\r\n"
+			"--b\r\n"
+			"Subject: second part\r\n"
+		);
+
+		VASSERT_EQ(
+			"Before finish",
+			"begin 0\n"
+			"field Content-Type=multipart/mixed; boundary=b\n"
+			"body multipart/mixed 7bit\n"
+			"begin 1\n"
+			"body text/plain 7bit\n"
+			"data [First part]\n"
+			"end 1\n"
+			"begin 1\n",
+			handler->getLog()
+		);
+
+		parser.feed("\r\nSecond\r\n--b--\r\n");
+		parser.finish();
+
+		VASSERT_EQ(
+			"After finish",
+			"begin 0\n"
+			"field Content-Type=multipart/mixed; boundary=b\n"
+			"body multipart/mixed 7bit\n"
+			"begin 1\n"
+			"body text/plain 7bit\n"
+			"data [First part]\n"
+			"end 1\n"
+			"begin 1\n"
+			"field Subject=second part\n"
+			"body text/plain 7bit\n"
+			"data [Second]\n"
+			"end 1\n"
+			"end 0\n",
+			handler->getLog()
+		);
+	}
+
+	void testFeedStream() {
+
+		const vmime::string data = "Subject: test\r\n\r\nBody";
+
+		vmime::shared_ptr <recordingHandler> handler = vmime::make_shared <recordingHandler>();
+
+		vmime::mimeEventParser parser(handler);
+
+		vmime::utility::inputStreamStringAdapter is(data);
+		vmime::utility::bufferedStreamCopy(is, *parser.getFeedStream());
+
+		parser.finish();
+
+		VASSERT_EQ("Events", parse(data), handler->getLog());
+	}
+
+VMIME_TEST_SUITE_END
@@ -0,0 +1,211 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(mimeTreeBuilderTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testSimpleMessage)
+		VMIME_TEST(testMultipart)
+		VMIME_TEST(testEncapsulatedMessage)
+		VMIME_TEST(testFeedChunks)
+		VMIME_TEST(testPartsBeforeFinish)
+	VMIME_TEST_LIST_END
+
+
+	static vmime::shared_ptr <vmime::message> build(
+		const vmime::string& data,
+		const size_t chunkSize
+	) {
+
+		vmime::shared_ptr <vmime::mimeTreeBuilder> builder =
+			vmime::make_shared <vmime::mimeTreeBuilder>();
+
+		vmime::mimeEventParser parser(builder);
+
+		for (size_t pos = 0 ; pos < data.length() ; pos += chunkSize) {
+			parser.feed(data.substr(pos, chunkSize));
+		}
+
+		parser.finish();
+
+		VASSERT("Complete", builder->isComplete());
+
+		return builder->getMessage();
+	}
+
+	static const vmime::string parseAndGenerate(const vmime::string& data) {
+
+		vmime::message msg;
+		msg.parse(data);
+
+		return msg.generate();
+	}
+
+	static const vmime::string multipartMessage() {
+
+		return
+			"From: Me <me@vmime.org>\r\n"
+			"Subject: Multipart\r\n"
+			"Content-Type: multipart/mixed; boundary=\"outer\"\r\n"
+			"\r\n"
+			"--outer\r\n"
+			"Content-Type: text/plain; charset=us-ascii\r\n"
+			"\r\n"
+			"First part\r\n"
+			"--outer\r\n"
+			"Content-Type: multipart/alternative; boundary=\"inner\"\r\n"
+			"\r\n"
+			"--inner\r\n"
+			"Content-Type: text/plain\r\n"
+			"Content-Transfer-Encoding: base64\r\n"
+			"\r\n"
+			"SGVsbG8sIHdvcmxkIQ==\r\n"
+			"--inner\r\n"
+			"Content-Type: text/html\r\n"
+			"\r\n"
+			"<p>Hello</p>\r\n"
+			"--inner--\r\n"
+			"--outer--\r\n";
+	}
+
+
+	void testSimpleMessage() {
+
+		const vmime::string data =
+			"From: Me <me@vmime.org>\r\n"
+			"To: You <you@vmime.org>,\r\n"
+			"  Someone <someone@vmime.org>\r\n"
+			"Subject: Simple\r\n"
+			"\r\n"
+			"Line 1\r\n"
+			"Line 2\r\n";
+
+		vmime::shared_ptr <vmime::message> msg = build(data, 65536);
+
+		VASSERT_EQ("Subject", "Simple", msg->getHeader()->Subject()->getValue <vmime::text>()->getWholeBuffer());
+		VASSERT_EQ("To", static_cast <size_t>(2), msg->getHeader()->To()->getValue <vmime::addressList>()->getAddressCount());
+		VASSERT_EQ("Generate", parseAndGenerate(data), msg->generate());
+	}
+
+	void testMultipart() {
+
+		const vmime::string data = multipartMessage();
+
+		vmime::shared_ptr <vmime::message> msg = build(data, 65536);
+
+		VASSERT_EQ("Count", static_cast <size_t>(2), msg->getBody()->getPartCount());
+		VASSERT_EQ("Inner count", static_cast <size_t>(2),
+			msg->getBody()->getPartAt(1)->getBody()->getPartCount());
+
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter os(oss);
+
+		msg->getBody()->getPartAt(1)->getBody()->getPartAt(0)->getBody()->getContents()->extract(os);
+
+		VASSERT_EQ("Decoded", "Hello, world!", oss.str());
+		VASSERT_EQ("Generate", parseAndGenerate(data), msg->generate());
+	}
+
+	void testEncapsulatedMessage() {
+
+		const vmime::string data =
+			"Subject: Outer\r\n"
+			"Content-Type: multipart/mixed; boundary=\"b\"\r\n"
+			"\r\n"
+			"--b\r\n"
+			"Content-Type: message/rfc822\r\n"
+			"\r\n"
+			"Subject: Inner\r\n"
+			"\r\n"
+			"Inner body\r\n"
+			"--b--\r\n";
+
+		vmime::shared_ptr <vmime::message> msg = build(data, 65536);
+
+		VASSERT_EQ("Count", static_cast <size_t>(1), msg->getBody()->getPartCount());
+
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter os(oss);
+
+		msg->getBody()->getPartAt(0)->getBody()->getContents()->extract(os);
+
+		VASSERT_EQ("Contents", "Subject: Inner\r\n\r\nInner body", oss.str());
+		VASSERT_EQ("Generate", parseAndGenerate(data), msg->generate());
+	}
+
+	void testFeedChunks() {
+
+		const vmime::string data = multipartMessage();
+		const vmime::string expected = parseAndGenerate(data);
+
+		for (size_t chunkSize = 1 ; chunkSize <= 64 ; ++chunkSize) {
+
+			std::ostringstream oss;
+			oss << "Chunk size " << chunkSize;
+
+			VASSERT_EQ(oss.str(), expected, build(data, chunkSize)->generate());
+		}
+	}
+
+	void testPartsBeforeFinish() {
+
+		vmime::shared_ptr <vmime::mimeTreeBuilder> builder =
+			vmime::make_shared <vmime::mimeTreeBuilder>();
+
+		vmime::mimeEventParser parser(builder);
+
+		parser.feed(
+			"Content-Type: multipart/mixed; boundary=b\r\n"
+			"\r\n"
+			"--b\r\n"
+			"\r\n"
+			"First part\r\n"
+			"--b\r\n"
+			"Subject: second part\r\n"
+		);
+
+		// The first part can be used before the rest of the message
+		// has been received
+		VASSERT("Not complete", !builder->isComplete());
+		VASSERT_EQ("Count", static_cast <size_t>(2), builder->getMessage()->getBody()->getPartCount());
+
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter os(oss);
+
+		builder->getMessage()->getBody()->getPartAt(0)->getBody()->getContents()->extract(os);
+
+		VASSERT_EQ("First part", "First part", oss.str());
+
+		parser.feed("\r\nSecond\r\n--b--\r\n");
+		parser.finish();
+
+		VASSERT("Complete", builder->isComplete());
+		VASSERT_EQ("Subject", "second part",
+			builder->getMessage()->getBody()->getPartAt(1)->getHeader()->Subject()
+				->getValue <vmime::text>()->getWholeBuffer());
+	}
+
+VMIME_TEST_SUITE_END
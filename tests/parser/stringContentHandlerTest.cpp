@@ -38,6 +38,8 @@ VMIME_TEST_SUITE_BEGIN(stringContentHandlerTest)
 		VMIME_TEST(testExtractRaw_Encoded)
 		VMIME_TEST(testGenerate)
 		VMIME_TEST(testGenerate_Encoded)
+		VMIME_TEST(testGetStatistics)
+		VMIME_TEST(testDecideEncoding)
 	VMIME_TEST_LIST_END
 
 
@@ -162,4 +164,70 @@ VMIME_TEST_SUITE_BEGIN(stringContentHandlerTest)
 		VASSERT_EQ("generate", "Zm9vEjRWYmFy", oss.str());
 	}
 
+	void testGetStatistics() {
+
+		vmime::stringContentHandler cth("foo\r\n.bar\xe9\r\nlonger line");
+
+		vmime::shared_ptr <const vmime::utility::textStatistics> stats = cth.getStatistics();
+
+		VASSERT_EQ("length", 23, stats->getLength());
+		VASSERT_EQ("non-ascii", 1, stats->getNonASCIICount());
+		VASSERT_EQ("max line", 11, stats->getMaxLineLength());
+		VASSERT_TRUE("dot", stats->hasDotAtLineStart());
+
+		// Statistics are cached until data changes
+		VASSERT_EQ("cached", stats, cth.getStatistics());
+
+		cth.setData("Zm9vEjRW", vmime::encoding("base64"));
+
+		stats = cth.getStatistics();
+
+		// Computed on decoded data
+		VASSERT_EQ("length 2", 6, stats->getLength());
+		VASSERT_EQ("non-ascii 2", 0, stats->getNonASCIICount());
+		VASSERT_FALSE("dot 2", stats->hasDotAtLineStart());
+	}
+
+	void testDecideEncoding() {
+
+		const vmime::encoding::EncodingUsage usage = vmime::encoding::USAGE_TEXT;
+
+		VASSERT_EQ(
+			"7bit", vmime::encoding("7bit"),
+			vmime::encoding::decide(vmime::make_shared <vmime::stringContentHandler>("foo\r\nbar\r\n"), usage)
+		);
+
+		VASSERT_EQ(
+			"dot", vmime::encoding("quoted-printable"),
+			vmime::encoding::decide(vmime::make_shared <vmime::stringContentHandler>("foo\r\n.\r\n"), usage)
+		);
+
+		VASSERT_EQ(
+			"long line", vmime::encoding("quoted-printable"),
+			vmime::encoding::decide(vmime::make_shared <vmime::stringContentHandler>(vmime::string(100, 'x')), usage)
+		);
+
+		VASSERT_EQ(
+			"8bit", vmime::encoding("quoted-printable"),
+			vmime::encoding::decide(vmime::make_shared <vmime::stringContentHandler>("Hello, my name is Gwena\xc3\xabl"), usage)
+		);
+
+		VASSERT_EQ(
+			"binary", vmime::encoding("base64"),
+			vmime::encoding::decide(vmime::make_shared <vmime::stringContentHandler>("\xc3\xa9\xc3\xa9"), usage)
+		);
+
+		// Large contents are also examined
+		vmime::string large;
+
+		for (int i = 0 ; i < 10000 ; ++i) {
+			large += "Some text\r\n";
+		}
+
+		VASSERT_EQ(
+			"large", vmime::encoding("7bit"),
+			vmime::encoding::decide(vmime::make_shared <vmime::stringContentHandler>(large), usage)
+		);
+	}
+
 VMIME_TEST_SUITE_END
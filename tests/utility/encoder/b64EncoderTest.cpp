@@ -30,9 +30,29 @@ VMIME_TEST_SUITE_BEGIN(b64EncoderTest)
 
 	VMIME_TEST_LIST_BEGIN
 		VMIME_TEST(testBase64)
+		VMIME_TEST(testBase64LongData)
+		VMIME_TEST(testBase64LineLength)
+		VMIME_TEST(testBase64DecodeWhiteSpaces)
 	VMIME_TEST_LIST_END
 
 
+	static const vmime::string generateData(const size_t length) {
+
+		vmime::string data;
+		data.reserve(length);
+
+		unsigned int seed = static_cast <unsigned int>(length);
+
+		for (size_t i = 0 ; i < length ; ++i) {
+
+			seed = seed * 1103515245 + 12345;
+			data += static_cast <char>(seed >> 16);
+		}
+
+		return data;
+	}
+
+
 	void testBase64() {
 
 		static const vmime::string testSuites[] = {
@@ -165,4 +185,77 @@ VMIME_TEST_SUITE_BEGIN(b64EncoderTest)
 		}
 	}
 
+	void testBase64LongData() {
+
+		// Cover block boundaries of vectorized implementations
+		for (size_t length = 0 ; length < 200 ; ++length) {
+
+			const vmime::string data = generateData(length);
+			const vmime::string encoded = encode("base64", data);
+
+			std::ostringstream oss;
+			oss << "Length " << length;
+
+			VASSERT_EQ(oss.str() + " encoded length", ((length + 2) / 3) * 4, encoded.length());
+			VASSERT_EQ(oss.str() + " round-trip", data, decode("base64", encoded));
+		}
+
+		// Larger than the internal buffers
+		const vmime::string data = generateData(100000);
+
+		VASSERT_EQ("Large", data, decode("base64", encode("base64", data, 76)));
+	}
+
+	void testBase64LineLength() {
+
+		const vmime::string data = generateData(1000);
+
+		// Default line length is 72 characters
+		VASSERT_EQ("72", "\r\n", encode("base64", data, 76).substr(72, 2));
+
+		const size_t lengths[] = { 1, 5, 10, 11, 20, 76 };
+
+		for (size_t i = 0 ; i < sizeof(lengths) / sizeof(lengths[0]) ; ++i) {
+
+			const size_t maxLineLength = lengths[i];
+			const vmime::string encoded = encode("base64", data, static_cast <int>(maxLineLength));
+
+			std::ostringstream oss;
+			oss << "Max line length " << maxLineLength;
+
+			// All lines except the last one have the same length
+			const size_t lineLength = encoded.find("\r\n");
+
+			VASSERT(oss.str() + " cut", lineLength != vmime::string::npos);
+			VASSERT_EQ(oss.str() + " multiple of 4", static_cast <size_t>(0), lineLength % 4);
+			VASSERT(oss.str() + " longest", lineLength + 2 + 4 >= maxLineLength);
+			VASSERT(oss.str() + " shortest", lineLength == 4 || lineLength + 2 < maxLineLength);
+
+			for (size_t pos = 0 ; pos < encoded.length() ; pos += lineLength + 2) {
+
+				const size_t eol = encoded.find("\r\n", pos);
+
+				if (eol != vmime::string::npos) {
+					VASSERT_EQ(oss.str() + " line", lineLength, eol - pos);
+				} else {
+					VASSERT(oss.str() + " last line", encoded.length() - pos <= lineLength);
+				}
+			}
+
+			VASSERT_EQ(oss.str() + " round-trip", data, decode("base64", encoded));
+		}
+	}
+
+	void testBase64DecodeWhiteSpaces() {
+
+		VASSERT_EQ("1", "Hello, world!", decode("base64", " SGVs\r\nbG8s IHdv\tcmxk\nIQ==\r\n"));
+		VASSERT_EQ("2", "Hello, world!", decode("base64", "S\nG\nV\ns\nb\nG\n8\ns\nIHdvcmxkIQ=="));
+
+		// Data after padding is ignored
+		VASSERT_EQ("3", "Hello", decode("base64", "SGVsbG8=SGVsbG8="));
+
+		// Incomplete group at the end
+		VASSERT_EQ("4", "Hello,", decode("base64", "SGVsbG8sIH"));
+	}
+
 VMIME_TEST_SUITE_END
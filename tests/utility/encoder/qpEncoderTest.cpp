@@ -35,6 +35,7 @@ VMIME_TEST_SUITE_BEGIN(qpEncoderTest)
 		VMIME_TEST(testQuotedPrintable_HardLineBreakDecode)
 		VMIME_TEST(testQuotedPrintable_CRLF)
 		VMIME_TEST(testQuotedPrintable_RFC2047)
+		VMIME_TEST(testQuotedPrintable_LongRuns)
 	VMIME_TEST_LIST_END
 
 
@@ -272,4 +273,39 @@ VMIME_TEST_SUITE_BEGIN(qpEncoderTest)
 		VASSERT_EQ("especials.12", "=22", encode("quoted-printable", "\"", 10, encProps));
 	}
 
+	/** Ensure rules for spaces and dots are applied in runs of characters
+	  * which do not need encoding. */
+	void testQuotedPrintable_LongRuns() {
+
+		vmime::propertySet encProps;
+		encProps["text"] = true;
+
+		VASSERT_EQ(
+			"trailing space",
+			"0123456789abcdefghij=20\r\n=2E0123456789 abcdefghij=20",
+			encode("quoted-printable", "0123456789abcdefghij \r\n.0123456789 abcdefghij ", 0, encProps)
+		);
+
+		VASSERT_EQ(
+			"dot after soft line break",
+			"abcdefghijklmnopqrstuvwxyz=\r\n=2Eabc",
+			encode("quoted-printable", "abcdefghijklmnopqrstuvwxyz.abc", 27, encProps)
+		);
+
+		VASSERT_EQ(
+			"decode",
+			"0123456789abcdefghijklmnop=_xyz",
+			decode("quoted-printable", "0123456789abcdefghijklmnop=3D_x=\r\nyz")
+		);
+
+		vmime::propertySet rfc2047Props;
+		rfc2047Props["rfc2047"] = true;
+
+		VASSERT_EQ(
+			"rfc2047",
+			"Hello-World/Foo+Bar*Baz!0123_x=5Fy=3F",
+			encode("quoted-printable", "Hello-World/Foo+Bar*Baz!0123 x_y?", 0, rfc2047Props)
+		);
+	}
+
 VMIME_TEST_SUITE_END
@@ -0,0 +1,174 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/utility/memoryArena.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(memoryArenaTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testAllocate)
+		VMIME_TEST(testAllocateLarge)
+		VMIME_TEST(testMakeShared)
+		VMIME_TEST(testParse)
+		VMIME_TEST(testParseLazy)
+	VMIME_TEST_LIST_END
+
+
+	void testAllocate() {
+
+		vmime::utility::memoryArena arena(1024);
+
+		void* p1 = arena.allocate(3, 1);
+		void* p2 = arena.allocate(8, 8);
+		void* p3 = arena.allocate(16, 16);
+
+		VASSERT("Alignment 8", reinterpret_cast <uintptr_t>(p2) % 8 == 0);
+		VASSERT("Alignment 16", reinterpret_cast <uintptr_t>(p3) % 16 == 0);
+		VASSERT("Order", p1 < p2 && p2 < p3);
+
+		VASSERT_EQ("Size", static_cast <size_t>(27), arena.getAllocatedSize());
+		VASSERT_EQ("Blocks", static_cast <size_t>(1), arena.getBlockCount());
+
+		for (int i = 0 ; i < 100 ; ++i) {
+			arena.allocate(64, 8);
+		}
+
+		VASSERT("Blocks", arena.getBlockCount() > 1);
+	}
+
+	void testAllocateLarge() {
+
+		vmime::utility::memoryArena arena(1024);
+
+		void* p1 = arena.allocate(16, 8);
+		arena.allocate(4096, 8);
+		void* p2 = arena.allocate(16, 8);
+
+		// Large allocation has its own block: current block is still used
+		VASSERT_EQ("Blocks", static_cast <size_t>(2), arena.getBlockCount());
+		VASSERT("Same block", static_cast <char*>(p2) == static_cast <char*>(p1) + 16);
+	}
+
+	void testMakeShared() {
+
+		vmime::shared_ptr <vmime::utility::memoryArena> arena =
+			vmime::make_shared <vmime::utility::memoryArena>();
+
+		vmime::shared_ptr <vmime::word> w =
+			vmime::utility::makeShared <vmime::word>(arena, "test", vmime::charset("utf-8"));
+
+		VASSERT_EQ("Value", "test", w->getBuffer());
+		VASSERT("Allocated", arena->getAllocatedSize() >= sizeof(vmime::word));
+
+		// Objects keep the arena alive
+		vmime::utility::memoryArena* arenaPtr = arena.get();
+		arena.reset();
+
+		VASSERT_EQ("Value after reset", "test", w->getBuffer());
+		VASSERT("Arena", arenaPtr != NULL);
+
+		vmime::shared_ptr <vmime::word> w2 =
+			vmime::utility::makeShared <vmime::word>(arena, "heap", vmime::charset("utf-8"));
+
+		VASSERT_EQ("Heap", "heap", w2->getBuffer());
+	}
+
+	void testParse() {
+
+		const vmime::string str =
+			"From: Me <me@vmime.org>\r\n"
+			"To: You <you@vmime.org>, Someone <someone@vmime.org>\r\n"
+			"Subject: =?utf-8?Q?Caf=C3=A9?= test\r\n"
+			"Message-Id: <12345@vmime.org>\r\n"
+			"Content-Type: text/plain; charset=utf-8; format=flowed\r\n"
+			"\r\n"
+			"Body\r\n";
+
+		vmime::shared_ptr <vmime::message> msg1 = vmime::make_shared <vmime::message>();
+		msg1->parse(str);
+
+		vmime::shared_ptr <vmime::utility::memoryArena> arena =
+			vmime::make_shared <vmime::utility::memoryArena>();
+
+		vmime::shared_ptr <vmime::message> msg2 = vmime::make_shared <vmime::message>();
+
+		{
+			vmime::parsingContext ctx;
+			ctx.setMemoryArena(arena);
+
+			msg2->parse(ctx, str);
+		}
+
+		VASSERT("Allocated", arena->getAllocatedSize() > 0);
+
+		arena.reset();
+
+		VASSERT_EQ("Generate", msg1->generate(), msg2->generate());
+		VASSERT_EQ("Subject", "Caf\xc3\xa9 test",
+			msg2->getHeader()->Subject()->getValue <vmime::text>()->getConvertedText(vmime::charset("utf-8")));
+	}
+
+	void testParseLazy() {
+
+		const vmime::string str =
+			"From: Me <me@vmime.org>\r\n"
+			"Subject: =?utf-8?Q?Caf=C3=A9?= test\r\n"
+			"Content-Type: multipart/mixed; boundary=\"XYZ\"\r\n"
+			"\r\n"
+			"--XYZ\r\n"
+			"To: You <you@vmime.org>\r\n"
+			"\r\n"
+			"Body\r\n"
+			"--XYZ--\r\n";
+
+		vmime::shared_ptr <vmime::utility::memoryArena> arena =
+			vmime::make_shared <vmime::utility::memoryArena>();
+
+		vmime::parsingContext ctx;
+		ctx.setMemoryArena(arena);
+		ctx.setLazyHeaderFieldParsing(true);
+		ctx.setLazyBodyPartParsing(true);
+
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+		msg->parse(ctx, str);
+
+		const size_t allocatedSize = arena->getAllocatedSize();
+
+		VASSERT("Allocated", allocatedSize > 0);
+
+		// Deferred parsing may happen in any thread, so it must not
+		// allocate from the arena
+		VASSERT_EQ("Subject", "Caf\xc3\xa9 test",
+			msg->getHeader()->Subject()->getValue <vmime::text>()->getConvertedText(vmime::charset("utf-8")));
+		VASSERT_EQ("To", "\"You\" <you@vmime.org>",
+			msg->getBody()->getPartAt(0)->getHeader()->To()
+				->getValue <vmime::addressList>()->getAddressAt(0)->generate());
+
+		VASSERT_EQ("Arena", allocatedSize, arena->getAllocatedSize());
+	}
+
+VMIME_TEST_SUITE_END
@@ -0,0 +1,165 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/utility/outputStreamGatherSocketAdapter.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(outputStreamGatherSocketAdapterTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testWrite)
+		VMIME_TEST(testWriteSmallBuffered)
+		VMIME_TEST(testWriteLargeGathered)
+		VMIME_TEST(testWriteBufferFull)
+	VMIME_TEST_LIST_END
+
+
+	/** Test socket which counts the calls to sendRaw() and sendRawBlocks().
+	  */
+	class countingTestSocket : public testSocket {
+
+	public:
+
+		countingTestSocket()
+			: sendRawCount(0), sendRawBlocksCount(0), lastBlockCount(0) {
+
+		}
+
+		void sendRaw(const vmime::byte_t* buffer, const size_t count) {
+
+			++sendRawCount;
+			testSocket::sendRaw(buffer, count);
+		}
+
+		void sendRawBlocks(const block* blocks, const size_t count) {
+
+			++sendRawBlocksCount;
+			lastBlockCount = count;
+
+			for (size_t i = 0 ; i < count ; ++i) {
+				testSocket::sendRaw(blocks[i].data, blocks[i].count);
+			}
+		}
+
+		unsigned int sendRawCount;
+		unsigned int sendRawBlocksCount;
+		size_t lastBlockCount;
+	};
+
+
+	void testWrite() {
+
+		vmime::shared_ptr <testSocket> socket = vmime::make_shared <testSocket>();
+
+		vmime::utility::outputStreamGatherSocketAdapter stream(*socket);
+		stream << "some data";
+		stream.flush();
+
+		stream << "\nmore\r\ndata\r";
+		stream.flush();
+
+		vmime::string buffer;
+		socket->localReceive(buffer);
+
+		VASSERT_EQ("Write", "some data\nmore\r\ndata\r", buffer);
+	}
+
+	void testWriteSmallBuffered() {
+
+		vmime::shared_ptr <countingTestSocket> socket = vmime::make_shared <countingTestSocket>();
+
+		vmime::utility::outputStreamGatherSocketAdapter stream(*socket);
+		stream << "Subject: test\r\n";
+		stream << "From: me@vmime.org\r\n";
+		stream << "\r\n";
+
+		VASSERT_EQ("Pending", 37, stream.getPendingSize());
+		VASSERT_EQ("Not sent", 0, socket->sendRawCount + socket->sendRawBlocksCount);
+
+		stream.flush();
+
+		VASSERT_EQ("Pending after flush", 0, stream.getPendingSize());
+		VASSERT_EQ("Send calls", 1, socket->sendRawCount);
+		VASSERT_EQ("Send blocks calls", 0, socket->sendRawBlocksCount);
+
+		vmime::string buffer;
+		socket->localReceive(buffer);
+
+		VASSERT_EQ("Data", "Subject: test\r\nFrom: me@vmime.org\r\n\r\n", buffer);
+	}
+
+	void testWriteLargeGathered() {
+
+		vmime::shared_ptr <countingTestSocket> socket = vmime::make_shared <countingTestSocket>();
+
+		const vmime::string header = "Content-Type: text/plain\r\n\r\n";
+		const vmime::string body(10000, 'x');
+
+		vmime::utility::outputStreamGatherSocketAdapter stream(*socket);
+		stream << header;
+		stream << body;
+
+		// Pending data and the large block are sent together, in one call
+		VASSERT_EQ("Pending", 0, stream.getPendingSize());
+		VASSERT_EQ("Send calls", 0, socket->sendRawCount);
+		VASSERT_EQ("Send blocks calls", 1, socket->sendRawBlocksCount);
+		VASSERT_EQ("Block count", 2, socket->lastBlockCount);
+
+		stream.flush();
+
+		VASSERT_EQ("Send calls after flush", 0, socket->sendRawCount);
+
+		vmime::string buffer;
+		socket->localReceive(buffer);
+
+		VASSERT_EQ("Data", header + body, buffer);
+	}
+
+	void testWriteBufferFull() {
+
+		vmime::shared_ptr <countingTestSocket> socket = vmime::make_shared <countingTestSocket>();
+
+		vmime::utility::outputStreamGatherSocketAdapter stream(*socket);
+
+		const vmime::string line(100, 'a');
+		vmime::string expected;
+
+		for (size_t i = 0 ; i < 1000 ; ++i) {
+
+			stream << line;
+			expected += line;
+		}
+
+		stream.flush();
+
+		VASSERT_EQ("Send calls", 2, socket->sendRawCount + socket->sendRawBlocksCount);
+
+		vmime::string buffer;
+		socket->localReceive(buffer);
+
+		VASSERT_EQ("Data", expected, buffer);
+	}
+
+VMIME_TEST_SUITE_END
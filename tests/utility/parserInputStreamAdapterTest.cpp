@@ -24,12 +24,14 @@
 #include "tests/testUtils.hpp"
 
 #include "vmime/utility/parserInputStreamAdapter.hpp"
+#include "vmime/utility/seekableInputStreamRegionAdapter.hpp"
 
 
 VMIME_TEST_SUITE_BEGIN(parserInputStreamAdapterTest)
 
 	VMIME_TEST_LIST_BEGIN
 		VMIME_TEST(testEndlessLoopBufferSize)
+		VMIME_TEST(testSkipAnyOf)
 	VMIME_TEST_LIST_END
 
 
@@ -48,4 +50,43 @@ VMIME_TEST_SUITE_BEGIN(parserInputStreamAdapterTest)
 		VASSERT_EQ("Not found", vmime::string::npos, parser->findNext("token"));
 	}
 
+	void testSkipAnyOf() {
+
+		static const vmime::byte_t spaceOrTab[] = { ' ', '\t' };
+
+		const vmime::string str = "A" + vmime::string(40, ' ') + "\t \tB  ";
+
+		vmime::shared_ptr <vmime::utility::inputStreamStringAdapter> iss =
+			vmime::make_shared <vmime::utility::inputStreamStringAdapter>(str);
+
+		// Data in memory, and read from a stream
+		vmime::shared_ptr <vmime::utility::parserInputStreamAdapter> parsers[] = {
+			vmime::make_shared <vmime::utility::parserInputStreamAdapter>(iss),
+			vmime::make_shared <vmime::utility::parserInputStreamAdapter>(
+				vmime::make_shared <vmime::utility::seekableInputStreamRegionAdapter>(iss, 0, str.length())
+			)
+		};
+
+		for (size_t i = 0 ; i < 2 ; ++i) {
+
+			vmime::shared_ptr <vmime::utility::parserInputStreamAdapter> parser = parsers[i];
+
+			parser->seek(0);
+			VASSERT_EQ("none", static_cast <size_t>(0), parser->skipAnyOf(spaceOrTab, 2, str.length()));
+			VASSERT_EQ("none pos", static_cast <size_t>(0), parser->getPosition());
+
+			parser->seek(1);
+			VASSERT_EQ("run", static_cast <size_t>(43), parser->skipAnyOf(spaceOrTab, 2, str.length()));
+			VASSERT_EQ("run pos", static_cast <size_t>(44), parser->getPosition());
+
+			parser->seek(1);
+			VASSERT_EQ("limit", static_cast <size_t>(10), parser->skipAnyOf(spaceOrTab, 2, 11));
+			VASSERT_EQ("limit pos", static_cast <size_t>(11), parser->getPosition());
+
+			parser->seek(45);
+			VASSERT_EQ("end", static_cast <size_t>(2), parser->skipAnyOf(spaceOrTab, 2, str.length()));
+			VASSERT_EQ("end pos", str.length(), parser->getPosition());
+		}
+	}
+
 VMIME_TEST_SUITE_END
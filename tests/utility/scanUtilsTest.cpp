@@ -0,0 +1,211 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/utility/scanUtils.hpp"
+#include "vmime/utility/stringUtils.hpp"
+
+
+using namespace vmime::utility;
+
+
+VMIME_TEST_SUITE_BEGIN(scanUtilsTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testFindByte)
+		VMIME_TEST(testFindFirstOf)
+		VMIME_TEST(testFind)
+		VMIME_TEST(testFindEmpty)
+		VMIME_TEST(testFindAllPositions)
+		VMIME_TEST(testFindFirstNotOf)
+		VMIME_TEST(testFindFirstNonASCII)
+		VMIME_TEST(testCountNonASCII)
+	VMIME_TEST_LIST_END
+
+
+	static size_t find(const vmime::string& data, const vmime::string& token) {
+
+		return scanUtils::find(
+			stringUtils::bytesFromString(data), data.length(),
+			stringUtils::bytesFromString(token), token.length()
+		);
+	}
+
+
+	void testFindByte() {
+
+		const vmime::string str = vmime::string(100, 'a') + "b" + vmime::string(50, 'a') + "b";
+		const vmime::byte_t* data = stringUtils::bytesFromString(str);
+
+		VASSERT_EQ("1", static_cast <size_t>(100), scanUtils::findByte(data, str.length(), 'b'));
+		VASSERT_EQ("2", static_cast <size_t>(0), scanUtils::findByte(data + 101, str.length() - 101, 'a'));
+		VASSERT_EQ("3", static_cast <size_t>(50), scanUtils::findByte(data + 101, str.length() - 101, 'b'));
+		VASSERT_EQ("4", vmime::npos, scanUtils::findByte(data, 100, 'b'));
+		VASSERT_EQ("5", vmime::npos, scanUtils::findByte(data, str.length(), 'c'));
+	}
+
+	void testFindFirstOf() {
+
+		static const vmime::byte_t chars[] = { ':', ' ', '\t', '\r', '\n' };
+
+		const vmime::string str1 = "Content-Type: text/plain";
+		const vmime::string str2 = vmime::string(70, 'X') + "\r\n";
+		const vmime::string str3 = vmime::string(70, 'X');
+
+		VASSERT_EQ("1", static_cast <size_t>(12), scanUtils::findFirstOf(stringUtils::bytesFromString(str1), str1.length(), chars, 5));
+		VASSERT_EQ("2", static_cast <size_t>(70), scanUtils::findFirstOf(stringUtils::bytesFromString(str2), str2.length(), chars, 5));
+		VASSERT_EQ("3", vmime::npos, scanUtils::findFirstOf(stringUtils::bytesFromString(str3), str3.length(), chars, 5));
+	}
+
+	void testFind() {
+
+		const vmime::string str = vmime::string(200, '-') + "\n--boundary\r\n";
+
+		VASSERT_EQ("1", static_cast <size_t>(200), find(str, "\n--boundary"));
+		VASSERT_EQ("2", static_cast <size_t>(198), find(str, "--\n"));
+		VASSERT_EQ("3", vmime::npos, find(str, "\n--boundaryX"));
+		VASSERT_EQ("4", static_cast <size_t>(0), find(str, str));
+		VASSERT_EQ("5", vmime::npos, find(str, str + "X"));
+		VASSERT_EQ("6", str.length() - 2, find(str, "\r\n"));
+	}
+
+	void testFindEmpty() {
+
+		VASSERT_EQ("1", vmime::npos, find("", "abc"));
+		VASSERT_EQ("2", vmime::npos, find("abc", ""));
+		VASSERT_EQ("3", vmime::npos, scanUtils::findByte(NULL, 0, 'a'));
+
+		// Length is a multiple of the vector width: the scalar tail is empty
+		const vmime::string str(64, 'x');
+
+		VASSERT_EQ("4", vmime::npos, scanUtils::findByte(stringUtils::bytesFromString(str), str.length(), 'a'));
+	}
+
+	void testFindAllPositions() {
+
+		static const vmime::byte_t zy[] = { 'z', 'y' };
+
+		// Exercise every alignment and the end of the buffer
+		for (size_t length = 1 ; length < 80 ; ++length) {
+
+			for (size_t pos = 0 ; pos + 3 <= length ; ++pos) {
+
+				vmime::string str(length, 'a');
+				str[pos] = 'x';
+				str[pos + 1] = 'y';
+				str[pos + 2] = 'z';
+
+				const vmime::byte_t* data = stringUtils::bytesFromString(str);
+
+				VASSERT_EQ("find", pos, find(str, "xyz"));
+				VASSERT_EQ("findByte", pos + 1, scanUtils::findByte(data, length, 'y'));
+				VASSERT_EQ("findFirstOf", pos + 1, scanUtils::findFirstOf(data, length, zy, 2));
+				VASSERT_EQ("shorter", vmime::npos, find(str.substr(0, pos + 2), "xyz"));
+			}
+		}
+	}
+
+	void testFindFirstNotOf() {
+
+		static const vmime::byte_t spaceOrTab[] = { ' ', '\t' };
+
+		VASSERT_EQ("empty", vmime::npos, scanUtils::findFirstNotOf(NULL, 0, spaceOrTab, 2));
+		VASSERT_EQ("no chars", static_cast <size_t>(0), scanUtils::findFirstNotOf(stringUtils::bytesFromString(" "), 1, NULL, 0));
+
+		// Exercise every run length and the end of the buffer
+		for (size_t length = 1 ; length < 80 ; ++length) {
+
+			vmime::string str(length, ' ');
+
+			for (size_t i = 1 ; i < length ; i += 3) {
+				str[i] = '\t';
+			}
+
+			VASSERT_EQ("all", vmime::npos, scanUtils::findFirstNotOf(stringUtils::bytesFromString(str), length, spaceOrTab, 2));
+
+			for (size_t pos = 0 ; pos < length ; ++pos) {
+
+				const char prev = str[pos];
+				str[pos] = 'x';
+
+				VASSERT_EQ("run", pos, scanUtils::findFirstNotOf(stringUtils::bytesFromString(str), length, spaceOrTab, 2));
+
+				str[pos] = prev;
+			}
+		}
+	}
+
+	void testFindFirstNonASCII() {
+
+		const vmime::byte_t* empty = stringUtils::bytesFromString("");
+
+		VASSERT_EQ("empty", vmime::npos, scanUtils::findFirstNonASCII(empty, 0));
+
+		for (size_t length = 1 ; length < 80 ; ++length) {
+
+			vmime::string str(length, '\x7f');
+			const vmime::byte_t* data = stringUtils::bytesFromString(str);
+
+			VASSERT_EQ("ascii", vmime::npos, scanUtils::findFirstNonASCII(data, length));
+
+			for (size_t pos = 0 ; pos < length ; ++pos) {
+
+				str[pos] = '\x80';
+
+				VASSERT_EQ("non-ascii", pos, scanUtils::findFirstNonASCII(stringUtils::bytesFromString(str), length));
+
+				str[pos] = '\xff';
+
+				if (pos + 1 < length) {
+					str[pos + 1] = '\xc3';
+				}
+
+				VASSERT_EQ("first", pos, scanUtils::findFirstNonASCII(stringUtils::bytesFromString(str), length));
+
+				str = vmime::string(length, 'a');
+			}
+		}
+	}
+
+	void testCountNonASCII() {
+
+		VASSERT_EQ("empty", static_cast <size_t>(0), scanUtils::countNonASCII(stringUtils::bytesFromString(""), 0));
+
+		for (size_t length = 1 ; length < 80 ; ++length) {
+
+			vmime::string str(length, '\x7f');
+			size_t expected = 0;
+
+			for (size_t pos = 0 ; pos < length ; pos += 3) {
+
+				str[pos] = (pos % 2) ? '\x80' : '\xff';
+				++expected;
+			}
+
+			VASSERT_EQ("count", expected, scanUtils::countNonASCII(stringUtils::bytesFromString(str), length));
+		}
+	}
+
+VMIME_TEST_SUITE_END